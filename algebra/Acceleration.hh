@@ -0,0 +1,318 @@
+#ifndef ACCELERATION_HH
+#define ACCELERATION_HH
+
+#include "LinearSolver.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <vector>
+
+/**
+ * Acceleration - Convergence Acceleration for Numeric Fixpoints
+ * =============================================================
+ *
+ * PURPOSE
+ * -------
+ * Plain Kleene iteration xₖ₊₁ = F(xₖ) converges linearly: with contraction
+ * factor ρ, every round only gains -log₁₀(ρ) digits, and a nonlinear SCC with
+ * ρ = 0.99 needs thousands of rounds to reach a 1e-10 tolerance. An
+ * accelerator replaces the next iterate by an extrapolation computed from
+ * the iterates and images seen so far. The fixpoint and the convergence test
+ * (isConverged(x, F(x)) on every variable) are unchanged; only the sequence
+ * of points at which F is evaluated differs.
+ *
+ * STRATEGIES
+ * ----------
+ * **Aitken Δ²** (per variable, Steffensen's method): from a, b = F(a) and
+ * c = F(b), every variable jumps to
+ *   a - (b - a)² / (c - 2b + a)
+ * Exact in one cycle for an affine scalar map, one extrapolation every
+ * second round.
+ *
+ * **Anderson(m)** (across the SCC vector, Walker & Ni's type II): with the
+ * residuals fₖ = F(xₖ) - xₖ and the last m differences ΔF, ΔG of residuals
+ * and images, solve the least-squares problem min ||fₖ - ΔF·γ|| and take
+ *   xₖ₊₁ = F(xₖ) - ΔG·γ
+ * It couples the variables of the SCC, like a secant method with memory m.
+ *
+ * SAFEGUARD
+ * ---------
+ * SafeguardedAcceleration wraps a strategy. An extrapolated iterate must
+ * have a smaller residual max|F(x) - x| than the point it was extrapolated
+ * from (Aitken), or at most a few times larger (Anderson, which is not
+ * monotone). When it does not, or when an extrapolation is not finite, the
+ * iteration resumes from the plain image that the extrapolation replaced and
+ * the strategy's history is reset. After `maxResets` such events the strategy
+ * is switched off and the iteration continues plainly, so acceleration costs
+ * at most a few rounds on an SCC where it does not help and never makes a
+ * convergent iteration diverge.
+ *
+ * REFERENCES
+ * ----------
+ * - Aitken, A.C. (1926) "On Bernoulli's numerical solution of algebraic equations"
+ * - Walker, H.F., Ni, P. (2011) "Anderson Acceleration for Fixed-Point Iterations"
+ *   SIAM Journal on Numerical Analysis, 49(4), pp. 1715-1735
+ */
+
+enum class Acceleration { None, Aitken, Anderson };
+
+// Strategy interface: next iterate from the current one and its image
+template<typename T>
+class Accelerator {
+public:
+    virtual ~Accelerator() = default;
+
+    // Writes the next iterate into next; returns true if it was extrapolated,
+    // false if it is the plain image fx
+    virtual bool extrapolate(const std::vector<T>& x, const std::vector<T>& fx, std::vector<T>& next) = 0;
+
+    // Forget the history (after a safeguard event)
+    virtual void reset() = 0;
+
+    // Factor by which an extrapolation may increase the residual before the
+    // safeguard rejects it
+    virtual double residualGrowth() const { return 1.0; }
+};
+
+template<typename T>
+class AitkenAccelerator : public Accelerator<T> {
+private:
+    std::vector<T> fStart;     // a, the start of the current cycle
+    bool fHaveStart = false;
+
+public:
+    bool extrapolate(const std::vector<T>& x, const std::vector<T>& fx, std::vector<T>& next) override {
+        if (!fHaveStart) {
+            // a = x, take the plain step to b = F(a)
+            fStart = x;
+            fHaveStart = true;
+            next = fx;
+            return false;
+        }
+
+        // x = b = F(a), fx = c = F(b)
+        fHaveStart = false;
+        next.resize(x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            const T a = fStart[i];
+            const T b = x[i];
+            const T c = fx[i];
+            const T d = c - b - b + a;
+            const T scale = std::abs(a) + std::abs(b) + std::abs(c);
+            if (std::abs(d) > scale * T(1e-12) && d != T(0)) {
+                next[i] = a - (b - a) * (b - a) / d;
+            } else {
+                next[i] = c;  // Already converged or degenerate
+            }
+        }
+        return true;
+    }
+
+    void reset() override {
+        fHaveStart = false;
+    }
+};
+
+template<typename T>
+class AndersonAccelerator : public Accelerator<T> {
+private:
+    size_t fDepth;
+    std::vector<T> fPrevResidual;
+    std::vector<T> fPrevImage;
+    std::deque<std::vector<T>> fResidualDiffs;   // ΔF columns, oldest first
+    std::deque<std::vector<T>> fImageDiffs;      // ΔG columns, oldest first
+    std::deque<std::deque<double>> fGram;        // ΔFᵀΔF, updated as columns come and go
+
+public:
+    explicit AndersonAccelerator(size_t depth) : fDepth(depth) {}
+
+    bool extrapolate(const std::vector<T>& x, const std::vector<T>& fx, std::vector<T>& next) override {
+        const size_t n = x.size();
+        std::vector<T> residual(n);
+        for (size_t i = 0; i < n; ++i) {
+            residual[i] = fx[i] - x[i];
+        }
+
+        if (!fPrevResidual.empty() && fDepth > 0) {
+            std::vector<T> df(n);
+            std::vector<T> dg(n);
+            for (size_t i = 0; i < n; ++i) {
+                df[i] = residual[i] - fPrevResidual[i];
+                dg[i] = fx[i] - fPrevImage[i];
+            }
+            fResidualDiffs.push_back(std::move(df));
+            fImageDiffs.push_back(std::move(dg));
+            
+            // New row and column of the Gram matrix
+            const std::vector<T>& added = fResidualDiffs.back();
+            std::deque<double> row;
+            for (const auto& column : fResidualDiffs) {
+                double dot = 0.0;
+                for (size_t i = 0; i < n; ++i) {
+                    dot += static_cast<double>(column[i]) * static_cast<double>(added[i]);
+                }
+                row.push_back(dot);
+            }
+            for (size_t a = 0; a < fGram.size(); ++a) {
+                fGram[a].push_back(row[a]);
+            }
+            fGram.push_back(std::move(row));
+            
+            if (fResidualDiffs.size() > fDepth) {
+                fResidualDiffs.pop_front();
+                fImageDiffs.pop_front();
+                fGram.pop_front();
+                for (auto& gramRow : fGram) {
+                    gramRow.pop_front();
+                }
+            }
+        }
+        fPrevResidual = residual;
+        fPrevImage = fx;
+
+        const size_t m = fResidualDiffs.size();
+        if (m == 0) {
+            next = fx;
+            return false;
+        }
+
+        // Normal equations (ΔFᵀΔF + λI)·γ = ΔFᵀf, slightly regularized
+        double trace = 0.0;
+        for (size_t a = 0; a < m; ++a) {
+            trace += fGram[a][a];
+        }
+        if (!(trace > 0.0)) {
+            next = fx;
+            return false;
+        }
+        LinearSystem system(m);
+        for (size_t a = 0; a < m; ++a) {
+            double rhs = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                rhs += static_cast<double>(fResidualDiffs[a][i]) * static_cast<double>(residual[i]);
+            }
+            system.setRhs(a, rhs);
+            for (size_t b = 0; b < m; ++b) {
+                system.add(a, b, fGram[a][b] + (a == b ? 1e-12 * trace : 0.0));
+            }
+        }
+        std::vector<double> gamma;
+        if (!system.solveDense(gamma)) {
+            next = fx;
+            return false;
+        }
+
+        next = fx;
+        for (size_t a = 0; a < m; ++a) {
+            const T g = static_cast<T>(gamma[a]);
+            for (size_t i = 0; i < n; ++i) {
+                next[i] -= g * fImageDiffs[a][i];
+            }
+        }
+        return true;
+    }
+
+    // Anderson mixing is not monotone: the residual often grows for a round
+    // before the secant information pays off
+    double residualGrowth() const override { return 4.0; }
+
+    void reset() override {
+        fPrevResidual.clear();
+        fPrevImage.clear();
+        fResidualDiffs.clear();
+        fImageDiffs.clear();
+        fGram.clear();
+    }
+};
+
+template<typename T>
+std::unique_ptr<Accelerator<T>> makeAccelerator(Acceleration kind, size_t andersonDepth) {
+    switch (kind) {
+        case Acceleration::Aitken:
+            return std::make_unique<AitkenAccelerator<T>>();
+        case Acceleration::Anderson:
+            return std::make_unique<AndersonAccelerator<T>>(andersonDepth);
+        case Acceleration::None:
+            break;
+    }
+    return nullptr;
+}
+
+// Strategy with a divergence safeguard, see SAFEGUARD above
+template<typename T>
+class SafeguardedAcceleration {
+private:
+    std::unique_ptr<Accelerator<T>> fAccelerator;
+    size_t fMaxResets;
+    bool fExtrapolated = false;    // The current iterate is an extrapolation
+    T fResidualBefore = T(0);      // Residual of the point it was extrapolated from
+    std::vector<T> fPlainPoint;    // Plain image it replaced
+
+public:
+    size_t resets = 0;
+
+    explicit SafeguardedAcceleration(std::unique_ptr<Accelerator<T>> accelerator, size_t maxResets = 3)
+        : fAccelerator(std::move(accelerator)), fMaxResets(maxResets) {}
+
+    bool enabled() const {
+        return fAccelerator != nullptr;
+    }
+
+    // Next iterate from x and F(x), always written to out: F(x), an extrapolation,
+    // or the plain image a rejected extrapolation replaced; returns true if it
+    // was extrapolated
+    bool next(const std::vector<T>& x, const std::vector<T>& fx, std::vector<T>& out) {
+        if (!fAccelerator) {
+            out = fx;
+            return false;
+        }
+
+        T residual = T(0);
+        for (size_t i = 0; i < x.size(); ++i) {
+            residual = std::max(residual, static_cast<T>(std::abs(fx[i] - x[i])));
+        }
+        if (fExtrapolated) {
+            fExtrapolated = false;
+            if (!(residual < static_cast<T>(fAccelerator->residualGrowth()) * fResidualBefore)) {
+                // The extrapolation did not improve: resume from the plain image
+                fallBack();
+                out = fPlainPoint;
+                return false;
+            }
+        }
+        if (!std::isfinite(residual)) {
+            fallBack();
+            out = fx;
+            return false;
+        }
+
+        bool extrapolated = fAccelerator->extrapolate(x, fx, out);
+        for (const T& value : out) {
+            if (!std::isfinite(value)) {
+                fallBack();
+                out = fx;
+                return false;
+            }
+        }
+        if (extrapolated) {
+            fExtrapolated = true;
+            fResidualBefore = residual;
+            fPlainPoint = fx;
+        }
+        return extrapolated;
+    }
+
+private:
+    void fallBack() {
+        ++resets;
+        if (resets >= fMaxResets) {
+            fAccelerator.reset();  // Plain iteration from now on
+        } else {
+            fAccelerator->reset();
+        }
+    }
+};
+
+#endif
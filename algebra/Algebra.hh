@@ -1,7 +1,31 @@
 #ifndef ALGEBRA_HH
 #define ALGEBRA_HH
 
+#include <atomic>
+#include <cstdint>
 #include <stdexcept>
+#include <string>
+
+/**
+ * AlgebraInstance - Serial number of an algebra object in the process,
+ * see Algebra::instance(). A copy is another object and gets its own
+ * number; assignment keeps it.
+ */
+class AlgebraInstance {
+  uint64_t fValue = next();
+
+  static uint64_t next() {
+    static std::atomic<uint64_t> counter{0};
+    return ++counter;
+  }
+
+public:
+  AlgebraInstance() = default;
+  AlgebraInstance(const AlgebraInstance &) {}
+  AlgebraInstance &operator=(const AlgebraInstance &) { return *this; }
+
+  uint64_t value() const { return fValue; }
+};
 
 /**
  * Algebra<T> - Algebraic Signature Interface
@@ -35,12 +59,25 @@
  * 
  * Our signature:
  * Σ = { num: → T,           // constant (nullary)
- *       abs: T → T,         // unary operation
- *       add: T × T → T,     // binary operation
+ *       abs: T → T,         // unary operations
+ *       sqrt, exp, log, sin, cos, tanh: T → T,
+ *       add: T × T → T,     // binary operations
  *       sub: T × T → T,
  *       mul: T × T → T,
  *       div: T × T → T,
- *       mod: T × T → T }
+ *       mod: T × T → T,
+ *       min, max, pow: T × T → T,
+ *       select: T × T × T → T }   // select(c, a, b) = c > 0 ? a : b
+ * 
+ * The arithmetic operations (num to abs) are pure virtual: every algebra
+ * interprets them. The elementary functions and min, max, pow throw
+ * std::runtime_error by default, so that algebras without a sensible
+ * interpretation (exp in exact integers, say) need not invent one.
+ * 
+ * select is the only operation that need not look at all its operands:
+ * branch(c) tells an evaluator which of a and b the result depends on,
+ * so that it evaluates only that one (see TreeAlgebra). The default,
+ * Branch::Both, evaluates both and calls select(c, a, b).
  * 
  * The concrete implementations (DoubleAlgebra, TreeAlgebra, etc.) are the
  * actual Σ-algebras that provide semantic interpretations of this signature.
@@ -118,7 +155,7 @@ public:
    */
   enum class ConstantOp {
     Real = 0,    // Real number constants
-    Integer = 1, // Integer constants (reserved for future use)
+    Integer = 1, // Integer constants, interpreted by integer()
     COUNT        // Marker for array sizing
   };
 
@@ -130,7 +167,12 @@ public:
    */
   enum class UnaryOp {
     Abs = 0,     // Absolute value: |x|
-    // Future extensions: Neg, Sin, Cos, Exp, Log, etc.
+    Sqrt = 1,    // Square root: √x
+    Exp = 2,     // Exponential: eˣ
+    Log = 3,     // Natural logarithm: ln x
+    Sin = 4,     // Sine (radians)
+    Cos = 5,     // Cosine (radians)
+    Tanh = 6,    // Hyperbolic tangent
     COUNT
   };
 
@@ -148,10 +190,21 @@ public:
     Mul = 2,     // Multiplication: x × y
     Div = 3,     // Division: x ÷ y
     Mod = 4,     // Modulo: x mod y
-    // Future extensions: Pow, Min, Max, etc.
+    Min = 5,     // Minimum: min(x, y)
+    Max = 6,     // Maximum: max(x, y)
+    Pow = 7,     // Power: xʸ
     COUNT
   };
 
+  /**
+   * Operands a conditional select(c, a, b) depends on, given c
+   */
+  enum class Branch {
+    Then,   // a: the condition holds (c > 0)
+    Else,   // b: it does not (c <= 0, or NaN)
+    Both    // Undecided (an interval straddling 0), or not a value (a tree)
+  };
+
 protected:
   /**
    * Dynamic Dispatch Tables
@@ -169,6 +222,11 @@ protected:
   UnaryMethod fUnaryOps[static_cast<int>(UnaryOp::COUNT)];
   BinaryMethod fBinaryOps[static_cast<int>(BinaryOp::COUNT)];
 
+private:
+  AlgebraInstance fInstance;
+
+protected:
+
   /**
    * Constructor - Initialize Dispatch Tables
    * 
@@ -179,6 +237,12 @@ protected:
   Algebra() {
     // Initialize unary operations table
     fUnaryOps[static_cast<int>(UnaryOp::Abs)] = &Algebra<T>::abs;
+    fUnaryOps[static_cast<int>(UnaryOp::Sqrt)] = &Algebra<T>::sqrt;
+    fUnaryOps[static_cast<int>(UnaryOp::Exp)] = &Algebra<T>::exp;
+    fUnaryOps[static_cast<int>(UnaryOp::Log)] = &Algebra<T>::log;
+    fUnaryOps[static_cast<int>(UnaryOp::Sin)] = &Algebra<T>::sin;
+    fUnaryOps[static_cast<int>(UnaryOp::Cos)] = &Algebra<T>::cos;
+    fUnaryOps[static_cast<int>(UnaryOp::Tanh)] = &Algebra<T>::tanh;
 
     // Initialize binary operations table
     fBinaryOps[static_cast<int>(BinaryOp::Add)] = &Algebra<T>::add;
@@ -186,11 +250,22 @@ protected:
     fBinaryOps[static_cast<int>(BinaryOp::Mul)] = &Algebra<T>::mul;
     fBinaryOps[static_cast<int>(BinaryOp::Div)] = &Algebra<T>::div;
     fBinaryOps[static_cast<int>(BinaryOp::Mod)] = &Algebra<T>::mod;
+    fBinaryOps[static_cast<int>(BinaryOp::Min)] = &Algebra<T>::min;
+    fBinaryOps[static_cast<int>(BinaryOp::Max)] = &Algebra<T>::max;
+    fBinaryOps[static_cast<int>(BinaryOp::Pow)] = &Algebra<T>::pow;
   }
 
 public:
   virtual ~Algebra() = default;
 
+  /**
+   * Distinct for every algebra object of the process, unlike its address
+   * (which a later object may reuse): keys values cached per algebra, such
+   * as the side tables of TreeAlgebra::query(). A TreeAlgebra also tags
+   * its nodes with it, to tell apart the node ids of two algebras.
+   */
+  uint64_t instance() const { return fInstance.value(); }
+
   /**
    * Generic Operation Dispatchers
    * ------------------------------
@@ -249,6 +324,19 @@ public:
    */
   virtual T num(double value) const = 0;
   
+  /**
+   * Interpret an integer constant (ConstantOp::Integer)
+   * 
+   * Defaults to num(value) for algebras without a notion of integers.
+   * Exact algebras override it so that integer constants never go
+   * through double (which is only exact up to 2⁵³):
+   * - IntegerAlgebra, RationalAlgebra: exact value
+   * - TreeAlgebra: creates an integer Num node
+   */
+  virtual T integer(int64_t value) const {
+    return num(static_cast<double>(value));
+  }
+  
   // Binary operations - the core of our algebraic structure
   virtual T add(const T &a, const T &b) const = 0;
   virtual T sub(const T &a, const T &b) const = 0;
@@ -259,6 +347,51 @@ public:
   // Unary operations
   virtual T abs(const T &a) const = 0;
 
+  /**
+   * Elementary functions and order operations
+   * 
+   * Optional: the defaults throw std::runtime_error. Floating-point,
+   * interval, string, cost and tree algebras interpret all of them;
+   * the exact algebras only min and max.
+   */
+  virtual T sqrt(const T &) const { return unsupported("sqrt"); }
+  virtual T exp(const T &) const { return unsupported("exp"); }
+  virtual T log(const T &) const { return unsupported("log"); }
+  virtual T sin(const T &) const { return unsupported("sin"); }
+  virtual T cos(const T &) const { return unsupported("cos"); }
+  virtual T tanh(const T &) const { return unsupported("tanh"); }
+  virtual T min(const T &, const T &) const { return unsupported("min"); }
+  virtual T max(const T &, const T &) const { return unsupported("max"); }
+  virtual T pow(const T &, const T &) const { return unsupported("pow"); }
+
+  /**
+   * Conditional: select(c, a, b) is a when c > 0, b otherwise
+   * 
+   * Evaluators call branch(c) first and evaluate only the operand it
+   * names; select() is called when it returns Both. Algebras whose values
+   * decide the condition override both, consistently: select(c, a, b)
+   * must not depend on an operand that branch(c) excludes.
+   */
+  virtual Branch branch(const T &) const { return Branch::Both; }
+  virtual T select(const T &, const T &, const T &) const { return unsupported("select"); }
+
+  /**
+   * Fused forms: mulAdd(a, b, c) = a·b + c, addMul(a, b, c) = a + b·c
+   * 
+   * Not operations of the signature (no tree node has this shape): a
+   * compiled Tape calls them for a product read only by a sum. The
+   * defaults are the two operations, operands in the order of the
+   * expression, so every algebra gives the result of the unfused tree.
+   * NumericAlgebra rounds once instead when built with
+   * Contraction::FusedMultiplyAdd.
+   */
+  virtual T mulAdd(const T &a, const T &b, const T &c) const { return add(mul(a, b), c); }
+  virtual T addMul(const T &a, const T &b, const T &c) const { return add(a, mul(b, c)); }
+
+private:
+  [[noreturn]] static T unsupported(const char *op) {
+    throw std::runtime_error(std::string("Operation ") + op + " is not supported by this algebra");
+  }
 };
 
 #endif
\ No newline at end of file
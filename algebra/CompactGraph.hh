@@ -0,0 +1,857 @@
+#ifndef COMPACT_GRAPH_HH
+#define COMPACT_GRAPH_HH
+
+#include "TreeAlgebra.hh"
+#include "SemanticAlgebra.hh"
+#include "StronglyConnected.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * CompactGraph - Reachable Nodes Copied into One Array, Operands First
+ * ====================================================================
+ *
+ * PURPOSE
+ * -------
+ * TreeAlgebra allocates every node on its own, in creation order, and
+ * reaches operands through shared pointers: a bottom-up evaluation of a
+ * large DAG jumps across the heap and pays a cache miss for most nodes it
+ * visits. compact(roots) copies the nodes reachable from the roots into a
+ * contiguous array of 12-byte records, in dependency order, so that an
+ * evaluator sweeps it front to back and finds the values of the operands
+ * in a parallel array, most of them a few entries behind.
+ *
+ * LAYOUT
+ * ------
+ * Nodes are numbered by position. A node record holds its type, its
+ * operator, its flags and two 32-bit fields:
+ *
+ *   Num      a = index into the real or integer constant pool
+ *   Unary    a = operand
+ *   Binary   a = left operand, b = right operand
+ *   Var      a = definition (NONE for an input), b = variable index
+ *   Select   a = condition, b = index k of its branches: the then and
+ *            else operands are branches[2k] and branches[2k + 1]
+ *
+ * The order is a depth-first post-order from the roots (left operand
+ * first): every operand comes before the nodes using it, and the nodes of
+ * a subterm are stored together. Definitions are the exception: a cycle of
+ * definitions cannot be ordered. The strongly connected components of the
+ * graph (Tarjan) are stored one after the other, and a recursive component
+ * occupies a range of positions, in post-order inside the range with the
+ * edges from its variables to their definitions ignored. Every cycle goes
+ * through a variable, so that order is a valid evaluation order for one
+ * fixpoint round.
+ *
+ * A node is guarded (flag GUARDED) when every path to it from the roots
+ * goes through the then or else operand of a select. A recursive
+ * component is entered as a whole: once a path reaches one of its nodes,
+ * its variables are not guarded.
+ *
+ * EVALUATION
+ * ----------
+ * evaluate() computes the value of every node in one sweep. A recursive
+ * range is iterated from bottom() as TreeAlgebra does, round by round
+ * (each round reads the variable values of the previous one) until
+ * isConverged() holds for every variable, then swept once more so that
+ * every node of the range is consistent with the final variable values.
+ * Algebras without a bottom (InitialAlgebra) only evaluate graphs without
+ * recursion. The affine solving and the acceleration of TreeAlgebra are
+ * not applied: the rounds are plain Kleene iteration.
+ *
+ * A sweep skips the guarded nodes. A select computes the operands its
+ * condition takes (both when Algebra::branch() cannot decide) and what
+ * they need, so an operand that would throw, a division by zero of an
+ * exact algebra or a variable without a definition, is an error only
+ * when it is taken, as in TreeAlgebra. A recursive component only
+ * reached through selects is solved when one takes it. Inside a
+ * component, its guarded nodes are computed again in every round by the
+ * selects that take them; all of its variables are iterated, where
+ * TreeAlgebra leaves out those that only an untaken operand reaches.
+ * Guarded nodes that no select took are left at T().
+ *
+ * PARALLEL EVALUATION
+ * -------------------
+ * Wide graphs have far more nodes than levels. With CompactLayout::Levels,
+ * nodes are stored by depth level instead: a node is one level above its
+ * highest operand, leaves are at level 0, and a recursive component is
+ * placed as a whole one level above its highest operand outside it. The
+ * order is stable, so the nodes of a level keep their post-order. The
+ * nodes of a level are independent: evaluate(algebra, values, pool) runs
+ * each level as a parallel loop over a ThreadPool, its recursive
+ * components one per task, with a barrier before the next level. Levels
+ * of few nodes run on the calling thread only. Guarded nodes are computed
+ * under a lock, by the thread whose select takes them.
+ *
+ * A CompactGraph is an immutable snapshot: later define() calls on the
+ * TreeAlgebra do not change it, and it holds no reference to the trees.
+ * Its arrays hold positions, not pointers: a NodeStore writes them to a
+ * file that other processes map and evaluate through a CompactView.
+ *
+ * REFERENCES
+ * ----------
+ * - Chilimbi, T.M., Hill, M.D., Larus, J.R. (1999) "Cache-Conscious
+ *   Structure Layout", PLDI'99
+ */
+
+struct CompactNode {
+    static constexpr uint32_t NONE = 0xffffffff;
+    static constexpr uint8_t GUARDED = 1;   // Only reached through select operands
+
+    uint8_t type;    // Tree::NodeType
+    uint8_t op;      // ConstantOp, UnaryOp or BinaryOp
+    uint8_t flags;
+    uint32_t a;
+    uint32_t b;
+
+    Tree::NodeType getType() const { return static_cast<Tree::NodeType>(type); }
+    bool isGuarded() const { return flags & GUARDED; }
+};
+
+static_assert(sizeof(CompactNode) == 12, "CompactNode records are 12 bytes");
+
+enum class CompactLayout {
+    PostOrder,   // Depth-first post-order from the roots
+    Levels       // By depth level, for level-synchronous parallel evaluation
+};
+
+// Positions [begin, end) of a level: its nodes in [begin, plainEnd), then
+// its recursive components (componentsBegin to componentsEnd, counted over
+// the components of the graph in position order)
+struct CompactLevel {
+    uint32_t begin = 0;
+    uint32_t plainEnd = 0;
+    uint32_t end = 0;
+    uint32_t componentsBegin = 0;
+    uint32_t componentsEnd = 0;
+};
+
+// Positions [begin, end) of a recursive component, and its variables at
+// positions variables[varsBegin, varsEnd)
+struct CompactComponent {
+    uint32_t begin;
+    uint32_t end;
+    uint32_t varsBegin;
+    uint32_t varsEnd;
+};
+
+// State of one evaluation: the guarded nodes computed so far and the
+// components solved because a select took them. Allocated on first use.
+struct CompactDemand {
+    enum : uint8_t { Pending, OnPath, Done };
+
+    std::vector<uint8_t> state;             // By position
+    std::vector<uint8_t> solved;            // By component
+    size_t rounds = 0;                      // Of the components solved here
+    std::recursive_mutex* lock = nullptr;   // Parallel evaluation
+
+    void prepare(size_t nodes, size_t components) {
+        if (state.empty()) {
+            state.assign(nodes, Pending);
+            solved.assign(components, 0);
+        }
+    }
+};
+
+// The arrays of a compact graph, wherever they are stored (the vectors of
+// a CompactGraph, the mapping of a NodeStore), and their evaluation
+struct CompactView {
+    const CompactNode* nodes = nullptr;
+    size_t nodeCount = 0;
+    const double* reals = nullptr;
+    const int64_t* integers = nullptr;
+    const CompactComponent* components = nullptr;   // In position order
+    size_t componentCount = 0;
+    const uint32_t* variables = nullptr;
+    const uint32_t* branches = nullptr;     // Then and else operands of the selects
+
+    // Value of every node, by position. Returns the number of fixpoint rounds.
+    template<typename T>
+    size_t evaluate(const Algebra<T>& algebra, std::vector<T>& values) const {
+        auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra);
+        if (componentCount && !semanticAlg) {
+            throw std::runtime_error("Recursive definitions need a semantic algebra to be evaluated");
+        }
+        values.resize(nodeCount);
+        CompactDemand demand;
+        size_t rounds = 0;
+        uint32_t position = 0;
+        for (size_t c = 0; c < componentCount; ++c) {
+            sweep(position, components[c].begin, algebra, values, demand);
+            if (isLazy(components[c])) {
+                clear(components[c], values);
+            } else {
+                rounds += solve(components[c], *semanticAlg, values, demand);
+            }
+            position = components[c].end;
+        }
+        sweep(position, static_cast<uint32_t>(nodeCount), algebra, values, demand);
+        return rounds + demand.rounds;
+    }
+
+    // A component only reached through selects, solved when one takes it
+    bool isLazy(const CompactComponent& component) const {
+        return component.varsBegin < component.varsEnd && nodes[variables[component.varsBegin]].isGuarded();
+    }
+
+    // Index of the recursive component holding a position, NONE if none does
+    uint32_t componentAt(uint32_t position) const {
+        const CompactComponent* end = components + componentCount;
+        const CompactComponent* c = std::upper_bound(components, end, position,
+            [](uint32_t p, const CompactComponent& component) { return p < component.begin; });
+        if (c == components || position >= (c - 1)->end) {
+            return CompactNode::NONE;
+        }
+        return static_cast<uint32_t>(c - 1 - components);
+    }
+
+    template<typename T>
+    T apply(const CompactNode& n, const Algebra<T>& algebra, const std::vector<T>& values) const {
+        switch (n.getType()) {
+            case Tree::NodeType::Num:
+                return static_cast<ConstantOp>(n.op) == ConstantOp::Integer
+                    ? algebra.integer(integers[n.a])
+                    : algebra.num(reals[n.a]);
+            case Tree::NodeType::Unary:
+                return algebra.unary(static_cast<typename Algebra<T>::UnaryOp>(n.op), values[n.a]);
+            case Tree::NodeType::Binary:
+                return algebra.binary(static_cast<typename Algebra<T>::BinaryOp>(n.op), values[n.a], values[n.b]);
+            case Tree::NodeType::Var:
+                if (n.a == CompactNode::NONE) {
+                    throw std::runtime_error("Variable " + std::to_string(n.b) + " has no definition");
+                }
+                return values[n.a];
+            case Tree::NodeType::Select: {
+                const uint32_t* operands = branches + 2 * static_cast<size_t>(n.b);
+                switch (algebra.branch(values[n.a])) {
+                    case Algebra<T>::Branch::Then: return values[operands[0]];
+                    case Algebra<T>::Branch::Else: return values[operands[1]];
+                    case Algebra<T>::Branch::Both: break;
+                }
+                return algebra.select(values[n.a], values[operands[0]], values[operands[1]]);
+            }
+        }
+        throw std::runtime_error("Unknown tree node type");
+    }
+
+    // k-th operand a node needs, NONE past the last: the condition of a
+    // select, then the operands it takes
+    template<typename T>
+    uint32_t operand(const CompactNode& n, uint32_t k, const Algebra<T>& algebra, const std::vector<T>& values) const {
+        switch (n.getType()) {
+            case Tree::NodeType::Num:
+                return CompactNode::NONE;
+            case Tree::NodeType::Unary:
+            case Tree::NodeType::Var:   // NONE for an input: apply() throws
+                return k == 0 ? n.a : CompactNode::NONE;
+            case Tree::NodeType::Binary:
+                return k == 0 ? n.a : k == 1 ? n.b : CompactNode::NONE;
+            case Tree::NodeType::Select: {
+                if (k == 0) {
+                    return n.a;
+                }
+                const uint32_t* operands = branches + 2 * static_cast<size_t>(n.b);
+                switch (algebra.branch(values[n.a])) {
+                    case Algebra<T>::Branch::Then: return k == 1 ? operands[0] : CompactNode::NONE;
+                    case Algebra<T>::Branch::Else: return k == 1 ? operands[1] : CompactNode::NONE;
+                    case Algebra<T>::Branch::Both: return k <= 2 ? operands[k - 1] : CompactNode::NONE;
+                }
+            }
+        }
+        return CompactNode::NONE;
+    }
+
+    // Computes a guarded node, after the guarded nodes it needs (depth
+    // first, iterative). A variable of a recursive component holds its
+    // value: the component is solved first if it has not been.
+    template<typename T>
+    void require(uint32_t position, const Algebra<T>& algebra, std::vector<T>& values, CompactDemand& demand) const {
+        if (!nodes[position].isGuarded()) {
+            return;
+        }
+        std::unique_lock<std::recursive_mutex> hold;
+        if (demand.lock) {
+            hold = std::unique_lock<std::recursive_mutex>(*demand.lock);
+        }
+        demand.prepare(nodeCount, componentCount);
+        if (demand.state[position] == CompactDemand::Done) {
+            return;
+        }
+        std::vector<std::pair<uint32_t, uint32_t>> stack;   // (position, operands done)
+        demand.state[position] = CompactDemand::OnPath;
+        stack.emplace_back(position, 0);
+        while (!stack.empty()) {
+            const uint32_t i = stack.back().first;
+            const uint32_t k = stack.back().second++;
+            const CompactNode& n = nodes[i];
+            const uint32_t c = n.getType() == Tree::NodeType::Var ? componentAt(i) : CompactNode::NONE;
+            const uint32_t w = c == CompactNode::NONE ? operand(n, k, algebra, values) : CompactNode::NONE;
+            if (w != CompactNode::NONE) {
+                if (nodes[w].isGuarded() && demand.state[w] != CompactDemand::Done) {
+                    if (demand.state[w] == CompactDemand::OnPath) {
+                        throw std::runtime_error("Cycle of definitions outside a recursive component at node "
+                                                 + std::to_string(w));
+                    }
+                    demand.state[w] = CompactDemand::OnPath;
+                    stack.emplace_back(w, 0);
+                }
+                continue;
+            }
+            if (c != CompactNode::NONE) {
+                if (!demand.solved[c]) {
+                    demand.solved[c] = 1;
+                    auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra);   // Checked by evaluate()
+                    demand.rounds += solve(components[c], *semanticAlg, values, demand);
+                }
+            } else {
+                values[i] = apply(n, algebra, values);
+            }
+            demand.state[i] = CompactDemand::Done;
+            stack.pop_back();
+        }
+    }
+
+    // A select of a sweep: the operands it takes are computed first when
+    // the sweep skipped them
+    template<typename T>
+    T select(const CompactNode& n, const Algebra<T>& algebra, std::vector<T>& values, CompactDemand& demand) const {
+        const uint32_t* operands = branches + 2 * static_cast<size_t>(n.b);
+        const auto branch = algebra.branch(values[n.a]);
+        if (branch != Algebra<T>::Branch::Else) {
+            require(operands[0], algebra, values, demand);
+        }
+        if (branch != Algebra<T>::Branch::Then) {
+            require(operands[1], algebra, values, demand);
+        }
+        return apply(n, algebra, values);
+    }
+
+    // Nodes [begin, end) but the guarded ones, left at T() until a select
+    // takes them
+    template<typename T>
+    void sweep(uint32_t begin, uint32_t end, const Algebra<T>& algebra, std::vector<T>& values,
+               CompactDemand& demand) const {
+        for (uint32_t i = begin; i < end; ++i) {
+            const CompactNode& n = nodes[i];
+            if (n.isGuarded()) {
+                values[i] = T();
+            } else if (n.getType() == Tree::NodeType::Select) {
+                values[i] = select(n, algebra, values, demand);
+            } else {
+                values[i] = apply(n, algebra, values);
+            }
+        }
+    }
+
+    // Values of a lazy component until a select takes it
+    template<typename T>
+    void clear(const CompactComponent& component, std::vector<T>& values) const {
+        std::fill(values.begin() + component.begin, values.begin() + component.end, T());
+    }
+
+    // Operators of a recursive range, variables keeping their value. Its
+    // guarded nodes are computed again, when the selects of the round
+    // take them.
+    template<typename T>
+    void sweepOperators(const CompactComponent& component, const Algebra<T>& algebra, std::vector<T>& values,
+                        CompactDemand& demand) const {
+        for (uint32_t i = component.begin; i < component.end; ++i) {
+            const CompactNode& n = nodes[i];
+            if (n.isGuarded()) {
+                if (!demand.state.empty()) {
+                    demand.state[i] = CompactDemand::Pending;
+                }
+                if (n.getType() != Tree::NodeType::Var) {
+                    values[i] = T();
+                }
+            } else if (n.getType() == Tree::NodeType::Select) {
+                values[i] = select(n, algebra, values, demand);
+            } else if (n.getType() != Tree::NodeType::Var) {
+                values[i] = apply(n, algebra, values);
+            }
+        }
+    }
+
+    // Definitions of the variables of a component, those of a lazy
+    // component being guarded
+    template<typename T>
+    void requireDefinitions(const CompactComponent& component, const Algebra<T>& algebra, std::vector<T>& values,
+                            CompactDemand& demand) const {
+        for (uint32_t v = component.varsBegin; v < component.varsEnd; ++v) {
+            require(nodes[variables[v]].a, algebra, values, demand);
+        }
+    }
+
+    // Returns the number of rounds
+    template<typename T>
+    size_t solve(const CompactComponent& component, const SemanticAlgebra<T>& algebra, std::vector<T>& values,
+                 CompactDemand& demand) const {
+        const int MAX_ITER = 10000;  // As TreeAlgebra::iterate
+        for (uint32_t v = component.varsBegin; v < component.varsEnd; ++v) {
+            values[variables[v]] = algebra.bottom();
+        }
+        bool converged = false;
+        size_t rounds = 0;
+        for (int iteration = 0; iteration < MAX_ITER && !converged; ++iteration) {
+            sweepOperators(component, algebra, values, demand);
+            requireDefinitions(component, algebra, values, demand);
+            rounds++;
+            converged = true;
+            for (uint32_t v = component.varsBegin; v < component.varsEnd; ++v) {
+                const uint32_t var = variables[v];
+                T next = values[nodes[var].a];
+                if (converged && !algebra.isConverged(values[var], next)) {
+                    converged = false;
+                }
+                values[var] = std::move(next);
+            }
+        }
+        if (!converged) {
+            throw std::runtime_error("Fixpoint computation did not converge");
+        }
+        sweepOperators(component, algebra, values, demand);
+        requireDefinitions(component, algebra, values, demand);
+        return rounds;
+    }
+};
+
+struct CompactGraphStats {
+    size_t nodes = 0;
+    size_t recursiveComponents = 0;
+    size_t recursiveNodes = 0;
+    size_t guardedNodes = 0;   // Only reached through select operands
+};
+
+class CompactGraph {
+private:
+    using Component = CompactComponent;
+
+    std::vector<CompactNode> fNodes;
+    std::vector<double> fReals;
+    std::vector<int64_t> fIntegers;
+    std::vector<uint32_t> fRoots;
+    std::vector<Component> fComponents;   // In position order
+    std::vector<uint32_t> fVariables;
+    std::vector<uint32_t> fBranches;      // Then and else operands of the selects
+    std::vector<uint32_t> fPositions;     // Tree id -> position, NONE if not reachable
+    std::vector<CompactLevel> fLevels;    // Levels layout only
+    CompactGraphStats fStats;
+
+public:
+    explicit CompactGraph(const std::vector<std::shared_ptr<Tree>>& roots,
+                          CompactLayout layout = CompactLayout::PostOrder) {
+        build(roots, layout);
+    }
+
+    size_t size() const { return fNodes.size(); }
+    const CompactNode& node(size_t position) const { return fNodes[position]; }
+    const std::vector<CompactNode>& nodes() const { return fNodes; }
+    const std::vector<uint32_t>& roots() const { return fRoots; }
+    double real(const CompactNode& n) const { return fReals[n.a]; }
+    int64_t integer(const CompactNode& n) const { return fIntegers[n.a]; }
+    const CompactGraphStats& stats() const { return fStats; }
+
+    // Position of a tree, NONE if it was not reachable from the roots
+    uint32_t position(const std::shared_ptr<Tree>& tree) const {
+        return tree->getId() < fPositions.size() ? fPositions[tree->getId()] : CompactNode::NONE;
+    }
+
+    bool hasRecursion() const { return !fComponents.empty(); }
+    const std::vector<double>& reals() const { return fReals; }
+    const std::vector<int64_t>& integers() const { return fIntegers; }
+    const std::vector<Component>& components() const { return fComponents; }
+    const std::vector<uint32_t>& variables() const { return fVariables; }
+    const std::vector<uint32_t>& branches() const { return fBranches; }
+
+    CompactView view() const {
+        return CompactView{fNodes.data(), fNodes.size(), fReals.data(), fIntegers.data(),
+                           fComponents.data(), fComponents.size(), fVariables.data(), fBranches.data()};
+    }
+
+    // Depth levels, empty unless compacted with CompactLayout::Levels
+    const std::vector<CompactLevel>& levels() const { return fLevels; }
+
+    // Memory of the node records and constant pools
+    size_t bytes() const {
+        return fNodes.capacity() * sizeof(CompactNode) + fReals.capacity() * sizeof(double)
+             + fIntegers.capacity() * sizeof(int64_t) + fRoots.capacity() * sizeof(uint32_t)
+             + fComponents.capacity() * sizeof(Component) + fVariables.capacity() * sizeof(uint32_t)
+             + fBranches.capacity() * sizeof(uint32_t);
+    }
+
+    // Value of every node, by position. values is reused when its
+    // capacity allows. Returns the number of fixpoint rounds, over all
+    // recursive components.
+    template<typename T>
+    size_t evaluate(const Algebra<T>& algebra, std::vector<T>& values) const {
+        return view().evaluate(algebra, values);
+    }
+
+    // Level by level on the threads of the pool, a barrier between levels:
+    // the nodes of a level in chunks of `grain`, its recursive components
+    // one per task. The algebra is called concurrently. Needs a graph
+    // compacted with CompactLayout::Levels; the values and the rounds are
+    // those of the sequential evaluation.
+    template<typename T>
+    size_t evaluate(const Algebra<T>& algebra, std::vector<T>& values, ThreadPool& pool, size_t grain = 1024) const {
+        auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra);
+        if (hasRecursion() && !semanticAlg) {
+            throw std::runtime_error("Recursive definitions need a semantic algebra to be evaluated");
+        }
+        if (fLevels.empty() && !fNodes.empty()) {
+            throw std::runtime_error("Parallel evaluation needs a graph compacted by levels");
+        }
+        values.resize(fNodes.size());
+        const CompactView arrays = view();
+        std::recursive_mutex lock;
+        CompactDemand demand;
+        demand.lock = &lock;
+        demand.prepare(fNodes.size(), fComponents.size());   // Not resized while tasks run
+        std::atomic<size_t> rounds{0};
+        for (const CompactLevel& level : fLevels) {
+            pool.parallelFor(level.begin, level.plainEnd, grain, [&](size_t first, size_t last) {
+                arrays.sweep(static_cast<uint32_t>(first), static_cast<uint32_t>(last), algebra, values, demand);
+            });
+            pool.parallelFor(level.componentsBegin, level.componentsEnd, 1, [&](size_t first, size_t last) {
+                for (size_t c = first; c < last; ++c) {
+                    if (arrays.isLazy(fComponents[c])) {
+                        arrays.clear(fComponents[c], values);
+                    } else {
+                        rounds += arrays.solve(fComponents[c], *semanticAlg, values, demand);
+                    }
+                }
+            });
+        }
+        return rounds + demand.rounds;
+    }
+
+    template<typename T>
+    std::vector<T> evaluate(const Algebra<T>& algebra) const {
+        std::vector<T> values;
+        evaluate(algebra, values);
+        return values;
+    }
+
+private:
+    void build(const std::vector<std::shared_ptr<Tree>>& roots, CompactLayout layout) {
+        // Reachable nodes and their operands, as an explicit graph
+        std::vector<Tree*> trees;
+        std::vector<std::vector<size_t>> operands;
+        std::vector<uint32_t> vertexOf;   // Tree id -> vertex
+        std::vector<size_t> pending;
+        auto vertex = [&](Tree* tree) {
+            if (tree->getId() >= vertexOf.size()) {
+                vertexOf.resize(tree->getId() * 2 + 1, CompactNode::NONE);
+            }
+            uint32_t& v = vertexOf[tree->getId()];
+            if (v == CompactNode::NONE) {
+                if (trees.size() >= CompactNode::NONE) {
+                    throw std::runtime_error("Too many nodes for a compact graph");
+                }
+                v = static_cast<uint32_t>(trees.size());
+                trees.push_back(tree);
+                operands.emplace_back();
+                pending.push_back(v);
+            }
+            return static_cast<size_t>(v);
+        };
+        for (const auto& root : roots) {
+            vertex(root.get());
+        }
+        while (!pending.empty()) {
+            size_t v = pending.back();
+            pending.pop_back();
+            Tree* tree = trees[v];
+            switch (tree->getType()) {
+                case Tree::NodeType::Num:
+                    break;
+                case Tree::NodeType::Unary:
+                    operands[v] = {vertex(tree->getOperand().get())};
+                    break;
+                case Tree::NodeType::Binary: {
+                    size_t left = vertex(tree->getLeft().get());
+                    size_t right = vertex(tree->getRight().get());
+                    operands[v] = {left, right};
+                    break;
+                }
+                case Tree::NodeType::Var:
+                    if (tree->getDefinition()) {
+                        operands[v] = {vertex(tree->getDefinition().get())};
+                    }
+                    break;
+                case Tree::NodeType::Select: {
+                    size_t condition = vertex(tree->getCondition().get());
+                    size_t then = vertex(tree->getThen().get());
+                    size_t otherwise = vertex(tree->getElse().get());
+                    operands[v] = {condition, then, otherwise};
+                    break;
+                }
+            }
+        }
+
+        // Components in dependency order; Tarjan's search is depth-first
+        // from the roots, so acyclic parts come out in post-order
+        StronglyConnectedComponents sccs = stronglyConnectedComponents(operands);
+        std::vector<uint32_t> positionOf(trees.size(), CompactNode::NONE);
+        std::vector<size_t> order;
+        std::vector<std::pair<uint32_t, uint32_t>> ranges;   // Recursive components
+        order.reserve(trees.size());
+        for (size_t c = 0; c < sccs.components.size(); ++c) {
+            const auto& component = sccs.components[c];
+            if (!sccs.isRecursive(c, operands)) {
+                positionOf[component[0]] = static_cast<uint32_t>(order.size());
+                order.push_back(component[0]);
+                continue;
+            }
+            const uint32_t begin = static_cast<uint32_t>(order.size());
+            orderComponent(component, c, sccs, trees, operands, positionOf, order);
+            ranges.emplace_back(begin, static_cast<uint32_t>(order.size()));
+            fStats.recursiveComponents++;
+            fStats.recursiveNodes += component.size();
+        }
+        if (layout == CompactLayout::Levels) {
+            orderByLevel(operands, order, ranges, positionOf);
+        }
+        for (const auto& [begin, end] : ranges) {
+            Component range{begin, end, static_cast<uint32_t>(fVariables.size()), 0};
+            for (uint32_t p = begin; p < end; ++p) {
+                if (trees[order[p]]->getType() == Tree::NodeType::Var) {
+                    fVariables.push_back(p);
+                }
+            }
+            range.varsEnd = static_cast<uint32_t>(fVariables.size());
+            fComponents.push_back(range);
+        }
+
+        // Node records
+        fNodes.resize(order.size());
+        for (size_t p = 0; p < order.size(); ++p) {
+            Tree* tree = trees[order[p]];
+            CompactNode& n = fNodes[p];
+            n.type = static_cast<uint8_t>(tree->getType());
+            n.op = 0;
+            n.flags = 0;
+            n.a = CompactNode::NONE;
+            n.b = CompactNode::NONE;
+            const auto& ops = operands[order[p]];
+            switch (tree->getType()) {
+                case Tree::NodeType::Num:
+                    n.op = static_cast<uint8_t>(tree->getConstantOp());
+                    if (tree->getConstantOp() == ConstantOp::Integer) {
+                        n.a = static_cast<uint32_t>(fIntegers.size());
+                        fIntegers.push_back(tree->getInteger());
+                    } else {
+                        n.a = static_cast<uint32_t>(fReals.size());
+                        fReals.push_back(tree->getValue());
+                    }
+                    break;
+                case Tree::NodeType::Unary:
+                    n.op = static_cast<uint8_t>(tree->getUnaryOp());
+                    n.a = positionOf[ops[0]];
+                    break;
+                case Tree::NodeType::Binary:
+                    n.op = static_cast<uint8_t>(tree->getBinaryOp());
+                    n.a = positionOf[ops[0]];
+                    n.b = positionOf[ops[1]];
+                    break;
+                case Tree::NodeType::Var:
+                    n.a = ops.empty() ? CompactNode::NONE : positionOf[ops[0]];
+                    n.b = static_cast<uint32_t>(tree->getVarIndex());
+                    break;
+                case Tree::NodeType::Select:
+                    n.a = positionOf[ops[0]];
+                    n.b = static_cast<uint32_t>(fBranches.size() / 2);
+                    fBranches.push_back(positionOf[ops[1]]);
+                    fBranches.push_back(positionOf[ops[2]]);
+                    break;
+            }
+        }
+        for (const auto& root : roots) {
+            fRoots.push_back(positionOf[vertexOf[root->getId()]]);
+        }
+        fPositions.assign(vertexOf.size(), CompactNode::NONE);
+        for (size_t id = 0; id < vertexOf.size(); ++id) {
+            if (vertexOf[id] != CompactNode::NONE) {
+                fPositions[id] = positionOf[vertexOf[id]];
+            }
+        }
+        markGuarded();
+        fStats.nodes = fNodes.size();
+    }
+
+    // Flags the nodes that only the operands of selects reach: a search
+    // from the roots that does not follow them, and that enters a
+    // recursive component by all of its variables
+    void markGuarded() {
+        std::vector<uint32_t> componentAt(fNodes.size(), CompactNode::NONE);
+        for (size_t c = 0; c < fComponents.size(); ++c) {
+            std::fill(componentAt.begin() + fComponents[c].begin, componentAt.begin() + fComponents[c].end,
+                      static_cast<uint32_t>(c));
+        }
+        std::vector<bool> reached(fNodes.size(), false);
+        std::vector<bool> entered(fComponents.size(), false);
+        std::vector<uint32_t> pending;
+        auto reach = [&](uint32_t p) {
+            if (p != CompactNode::NONE && !reached[p]) {
+                reached[p] = true;
+                pending.push_back(p);
+            }
+        };
+        for (uint32_t root : fRoots) {
+            reach(root);
+        }
+        while (!pending.empty()) {
+            const uint32_t p = pending.back();
+            pending.pop_back();
+            const uint32_t c = componentAt[p];
+            if (c != CompactNode::NONE && !entered[c]) {
+                entered[c] = true;
+                for (uint32_t v = fComponents[c].varsBegin; v < fComponents[c].varsEnd; ++v) {
+                    reach(fVariables[v]);
+                }
+            }
+            const CompactNode& n = fNodes[p];
+            switch (n.getType()) {
+                case Tree::NodeType::Num:
+                    break;
+                case Tree::NodeType::Binary:
+                    reach(n.b);
+                    reach(n.a);
+                    break;
+                case Tree::NodeType::Unary:
+                case Tree::NodeType::Var:
+                case Tree::NodeType::Select:   // The condition only
+                    reach(n.a);
+                    break;
+            }
+        }
+        for (size_t p = 0; p < fNodes.size(); ++p) {
+            if (!reached[p]) {
+                fNodes[p].flags |= CompactNode::GUARDED;
+                fStats.guardedNodes++;
+            }
+        }
+    }
+
+    // Stable reordering by level: a unit (a node, or a recursive component
+    // as a whole) is one level above its highest operand outside the unit.
+    // Each level stores its nodes, then its recursive components.
+    void orderByLevel(const std::vector<std::vector<size_t>>& operands, std::vector<size_t>& order,
+                      std::vector<std::pair<uint32_t, uint32_t>>& ranges, std::vector<uint32_t>& positionOf) {
+        struct Unit {
+            uint32_t begin;
+            uint32_t end;
+            uint32_t level;
+            bool recursive;
+        };
+        std::vector<Unit> units;
+        std::vector<uint32_t> levelOf(order.size(), 0);   // By vertex
+        uint32_t levels = 0;
+        size_t r = 0;
+        for (uint32_t p = 0; p < order.size();) {
+            const bool recursive = r < ranges.size() && ranges[r].first == p;
+            const uint32_t end = recursive ? ranges[r++].second : p + 1;
+            uint32_t level = 0;
+            for (uint32_t q = p; q < end; ++q) {
+                for (size_t w : operands[order[q]]) {
+                    if (positionOf[w] < p || positionOf[w] >= end) {
+                        level = std::max(level, levelOf[w] + 1);
+                    }
+                }
+            }
+            for (uint32_t q = p; q < end; ++q) {
+                levelOf[order[q]] = level;
+            }
+            units.push_back({p, end, level, recursive});
+            levels = std::max(levels, level + 1);
+            p = end;
+        }
+
+        // Counting sort on (level, recursive)
+        std::vector<uint32_t> start(2 * static_cast<size_t>(levels) + 1, 0);
+        for (const Unit& u : units) {
+            start[2 * u.level + u.recursive + 1] += u.end - u.begin;
+        }
+        for (size_t k = 1; k < start.size(); ++k) {
+            start[k] += start[k - 1];
+        }
+        fLevels.resize(levels);
+        for (uint32_t l = 0; l < levels; ++l) {
+            fLevels[l].begin = start[2 * l];
+            fLevels[l].plainEnd = start[2 * l + 1];
+            fLevels[l].end = start[2 * l + 2];
+        }
+        std::vector<size_t> sorted(order.size());
+        std::vector<std::pair<uint32_t, uint32_t>> sortedRanges;
+        sortedRanges.reserve(ranges.size());
+        for (const Unit& u : units) {
+            uint32_t& next = start[2 * u.level + u.recursive];
+            if (u.recursive) {
+                sortedRanges.emplace_back(next, next + (u.end - u.begin));
+            }
+            for (uint32_t q = u.begin; q < u.end; ++q) {
+                positionOf[order[q]] = next;
+                sorted[next++] = order[q];
+            }
+        }
+        std::sort(sortedRanges.begin(), sortedRanges.end());
+        uint32_t c = 0;
+        for (CompactLevel& level : fLevels) {
+            level.componentsBegin = c;
+            while (c < sortedRanges.size() && sortedRanges[c].first < level.end) {
+                c++;
+            }
+            level.componentsEnd = c;
+        }
+        order = std::move(sorted);
+        ranges = std::move(sortedRanges);
+    }
+
+    // Post-order of a recursive component, not following the edges from
+    // its variables to their definitions
+    static void orderComponent(const std::vector<size_t>& component, size_t c,
+                               const StronglyConnectedComponents& sccs,
+                               const std::vector<Tree*>& trees,
+                               const std::vector<std::vector<size_t>>& operands,
+                               std::vector<uint32_t>& positionOf, std::vector<size_t>& order) {
+        std::vector<std::pair<size_t, size_t>> frames;   // (vertex, next operand)
+        const uint32_t onPath = CompactNode::NONE - 1;
+        for (size_t start : component) {
+            if (positionOf[start] != CompactNode::NONE) continue;
+            positionOf[start] = onPath;
+            frames.emplace_back(start, 0);
+            while (!frames.empty()) {
+                auto& [v, next] = frames.back();
+                const bool follow = trees[v]->getType() != Tree::NodeType::Var;
+                if (follow && next < operands[v].size()) {
+                    size_t w = operands[v][next++];
+                    if (sccs.componentOf[w] == c && positionOf[w] == CompactNode::NONE) {
+                        positionOf[w] = onPath;
+                        frames.emplace_back(w, 0);
+                    }
+                    continue;
+                }
+                positionOf[v] = static_cast<uint32_t>(order.size());
+                order.push_back(v);
+                frames.pop_back();
+            }
+        }
+    }
+};
+
+// Compact copy of the graph reachable from the roots
+inline CompactGraph compact(const std::vector<std::shared_ptr<Tree>>& roots,
+                            CompactLayout layout = CompactLayout::PostOrder) {
+    return CompactGraph(roots, layout);
+}
+
+#endif
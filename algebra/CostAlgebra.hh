@@ -0,0 +1,278 @@
+#ifndef COST_ALGEBRA_HH
+#define COST_ALGEBRA_HH
+
+#include "SemanticAlgebra.hh"
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * CostAlgebra - Static Estimate of the Cost of an Evaluation
+ * ==========================================================
+ *
+ * MATHEMATICAL FOUNDATION
+ * -----------------------
+ * CostAlgebra interprets an expression as the resources its evaluation
+ * needs, in the work/span model of parallel computation:
+ *
+ *   Cost = (work, span)
+ *   work  total latency of the operations, what one core spends
+ *   span  latency of the longest chain of dependent operations, what
+ *         infinitely many cores would still spend
+ *
+ * An operation of latency ℓ combines the costs of its operands as
+ *
+ *   op(a, b) = (a.work + b.work + ℓ, max(a.span, b.span) + ℓ)
+ *
+ * and work / span bounds the speedup any parallel schedule can reach
+ * (Brent's theorem: p cores need at least max(work / p, span)).
+ *
+ * LATENCY TABLES
+ * --------------
+ * The latency of every UnaryOp and BinaryOp depends on the algebra that
+ * will evaluate the expression, so it comes from a LatencyTable. The
+ * presets are in approximate cycles on a current x86-64 core, library
+ * calls (fmod) and allocations included:
+ *
+ *   ops                      +    -    ×    ÷    mod   abs  sqrt  math
+ *   singlePrecision()        4    4    4   11    30     1    12    20
+ *   doublePrecision()        4    4    4   14    40     1    18    40
+ *   extendedPrecision()      3    3    5   20    60     2    30    80
+ *   interval()              10   10   30   60   120     6    40   100
+ *   integer()                2    2    3   26    26     2     -     -
+ *   rational()             120  120   90   90   160    40     -     -
+ *
+ * `math` is the latency of exp, log, sin, cos and tanh (a library call);
+ * pow costs two of them and a multiplication (exp(b·log a)), min and max
+ * as much as an addition. The exact algebras have no elementary functions.
+ *
+ * A conditional select(c, a, b) evaluates c, then one of a and b: it is
+ * priced for the dearer branch, after the condition, plus a comparison
+ * (the latency of an addition):
+ *
+ *   select(c, a, b) = (c.work + max(a.work, b.work) + ℓ,
+ *                      c.span + max(a.span, b.span) + ℓ)
+ *
+ * Only ratios matter: a table measured in nanoseconds works as well.
+ *
+ * An interpreter also pays a fixed overhead per node it visits (dispatch,
+ * memo lookups), often larger than the operation itself: `dispatch` is
+ * added to every constant and operation. It is 0 in the presets, which
+ * price compiled code.
+ *
+ * SHARING AND RECURSION
+ * ---------------------
+ * Like every algebra, CostAlgebra sees an expression as a tree: an operand
+ * shared by two operations is paid twice, which is the cost of evaluating
+ * without memoization. The fixpoint iteration accepts its first round, so
+ * a recursive variable costs two unfoldings of its definition: the one
+ * that discovers the cycle and the round that closes it. CostModel
+ * (CostModel.hh) works on the DAG instead, pays every node once and
+ * prices recursive components per fixpoint round.
+ *
+ * REFERENCES
+ * ----------
+ * - Blumofe, R.D., Leiserson, C.E. (1999) "Scheduling Multithreaded
+ *   Computations by Work Stealing", Journal of the ACM, 46(5), pp. 720-748
+ * - Brent, R.P. (1974) "The Parallel Evaluation of General Arithmetic
+ *   Expressions", Journal of the ACM, 21(2), pp. 201-206
+ * - Fog, A. "Instruction Tables", https://www.agner.org/optimize/
+ */
+
+struct Cost {
+    double work = 0.0;
+    double span = 0.0;
+
+    // Upper bound of the speedup of a parallel evaluation
+    double parallelism() const {
+        return span > 0.0 ? work / span : 1.0;
+    }
+
+    bool operator==(const Cost& other) const {
+        return work == other.work && span == other.span;
+    }
+
+    bool operator!=(const Cost& other) const {
+        return !(*this == other);
+    }
+};
+
+struct LatencyTable {
+    using UnaryOp = Algebra<Cost>::UnaryOp;
+    using BinaryOp = Algebra<Cost>::BinaryOp;
+
+    double constant = 0.0;   // Loading a constant
+    double dispatch = 0.0;   // Evaluator overhead per constant or operation node
+    double unary[static_cast<int>(UnaryOp::COUNT)] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+    double binary[static_cast<int>(BinaryOp::COUNT)] = {1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+
+    double constantLatency() const {
+        return constant + dispatch;
+    }
+
+    // Any algebra's operation enums share the numbering of Algebra<T>
+    template<typename Op>
+    double unaryLatency(Op op) const {
+        return unary[static_cast<int>(op)] + dispatch;
+    }
+
+    template<typename Op>
+    double binaryLatency(Op op) const {
+        return binary[static_cast<int>(op)] + dispatch;
+    }
+
+    LatencyTable withDispatch(double overhead) const {
+        LatencyTable table = *this;
+        table.dispatch = overhead;
+        return table;
+    }
+
+    static LatencyTable make(double add, double sub, double mul, double div, double mod, double abs,
+                             double sqrt = 0.0, double math = 0.0) {
+        LatencyTable table;
+        table.binary[static_cast<int>(BinaryOp::Add)] = add;
+        table.binary[static_cast<int>(BinaryOp::Sub)] = sub;
+        table.binary[static_cast<int>(BinaryOp::Mul)] = mul;
+        table.binary[static_cast<int>(BinaryOp::Div)] = div;
+        table.binary[static_cast<int>(BinaryOp::Mod)] = mod;
+        table.binary[static_cast<int>(BinaryOp::Min)] = add;
+        table.binary[static_cast<int>(BinaryOp::Max)] = add;
+        table.binary[static_cast<int>(BinaryOp::Pow)] = 2 * math + mul;
+        table.unary[static_cast<int>(UnaryOp::Abs)] = abs;
+        table.unary[static_cast<int>(UnaryOp::Sqrt)] = sqrt;
+        for (UnaryOp op : {UnaryOp::Exp, UnaryOp::Log, UnaryOp::Sin, UnaryOp::Cos, UnaryOp::Tanh}) {
+            table.unary[static_cast<int>(op)] = math;
+        }
+        return table;
+    }
+
+    // Every operation costs 1: work counts operations, span counts levels
+    static LatencyTable unit() {
+        LatencyTable table = make(1, 1, 1, 1, 1, 1, 1, 1);
+        table.binary[static_cast<int>(BinaryOp::Pow)] = 1;
+        return table;
+    }
+
+    static LatencyTable singlePrecision() {
+        return make(4, 4, 4, 11, 30, 1, 12, 20);
+    }
+
+    static LatencyTable doublePrecision() {
+        return make(4, 4, 4, 14, 40, 1, 18, 40);
+    }
+
+    static LatencyTable extendedPrecision() {
+        return make(3, 3, 5, 20, 60, 2, 30, 80);
+    }
+
+    static LatencyTable interval() {
+        return make(10, 10, 30, 60, 120, 6, 40, 100);
+    }
+
+    static LatencyTable integer() {
+        return make(2, 2, 3, 26, 26, 2);
+    }
+
+    static LatencyTable rational() {
+        return make(120, 120, 90, 90, 160, 40);
+    }
+};
+
+class CostAlgebra : public SemanticAlgebra<Cost> {
+private:
+    LatencyTable fLatencies;
+
+    Cost combine(const Cost& a, const Cost& b, double latency) const {
+        return Cost{a.work + b.work + latency, std::max(a.span, b.span) + latency};
+    }
+
+    Cost apply(const Cost& a, double latency) const {
+        return Cost{a.work + latency, a.span + latency};
+    }
+
+public:
+    explicit CostAlgebra(const LatencyTable& latencies = LatencyTable::doublePrecision())
+        : fLatencies(latencies) {}
+
+    const LatencyTable& latencies() const { return fLatencies; }
+
+    Cost num(double) const override {
+        return Cost{fLatencies.constantLatency(), fLatencies.constantLatency()};
+    }
+
+    Cost add(const Cost& a, const Cost& b) const override {
+        return combine(a, b, fLatencies.binaryLatency(BinaryOp::Add));
+    }
+
+    Cost sub(const Cost& a, const Cost& b) const override {
+        return combine(a, b, fLatencies.binaryLatency(BinaryOp::Sub));
+    }
+
+    Cost mul(const Cost& a, const Cost& b) const override {
+        return combine(a, b, fLatencies.binaryLatency(BinaryOp::Mul));
+    }
+
+    Cost div(const Cost& a, const Cost& b) const override {
+        return combine(a, b, fLatencies.binaryLatency(BinaryOp::Div));
+    }
+
+    Cost mod(const Cost& a, const Cost& b) const override {
+        return combine(a, b, fLatencies.binaryLatency(BinaryOp::Mod));
+    }
+
+    Cost min(const Cost& a, const Cost& b) const override {
+        return combine(a, b, fLatencies.binaryLatency(BinaryOp::Min));
+    }
+
+    Cost max(const Cost& a, const Cost& b) const override {
+        return combine(a, b, fLatencies.binaryLatency(BinaryOp::Max));
+    }
+
+    Cost pow(const Cost& a, const Cost& b) const override {
+        return combine(a, b, fLatencies.binaryLatency(BinaryOp::Pow));
+    }
+
+    Cost abs(const Cost& a) const override {
+        return apply(a, fLatencies.unaryLatency(UnaryOp::Abs));
+    }
+
+    Cost sqrt(const Cost& a) const override {
+        return apply(a, fLatencies.unaryLatency(UnaryOp::Sqrt));
+    }
+
+    Cost exp(const Cost& a) const override {
+        return apply(a, fLatencies.unaryLatency(UnaryOp::Exp));
+    }
+
+    Cost log(const Cost& a) const override {
+        return apply(a, fLatencies.unaryLatency(UnaryOp::Log));
+    }
+
+    Cost sin(const Cost& a) const override {
+        return apply(a, fLatencies.unaryLatency(UnaryOp::Sin));
+    }
+
+    Cost cos(const Cost& a) const override {
+        return apply(a, fLatencies.unaryLatency(UnaryOp::Cos));
+    }
+
+    Cost tanh(const Cost& a) const override {
+        return apply(a, fLatencies.unaryLatency(UnaryOp::Tanh));
+    }
+
+    Cost select(const Cost& c, const Cost& a, const Cost& b) const override {
+        const double latency = fLatencies.binaryLatency(BinaryOp::Add);
+        return Cost{c.work + std::max(a.work, b.work) + latency, c.span + std::max(a.span, b.span) + latency};
+    }
+
+    // SemanticAlgebra methods: a recursive variable is free until the
+    // first round, which is accepted
+    Cost bottom() const override {
+        return Cost{};
+    }
+
+    bool isConverged(const Cost&, const Cost&) const override {
+        return true;
+    }
+};
+
+#endif
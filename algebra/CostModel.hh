@@ -0,0 +1,240 @@
+#ifndef COST_MODEL_HH
+#define COST_MODEL_HH
+
+#include "TreeAlgebra.hh"
+#include "CostAlgebra.hh"
+#include "StronglyConnected.hh"
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * CostModel - Work and Span of a Shared Expression Graph
+ * ======================================================
+ *
+ * PURPOSE
+ * -------
+ * Choosing how to evaluate a graph (memoized evaluation, a compiled form,
+ * several threads) needs an estimate of its cost before paying it. The
+ * model prices the graph reachable from the roots with a LatencyTable, in
+ * one linear pass, and answers:
+ *
+ * - work: every node once, as a memoizing evaluation pays it
+ * - span: the critical path, which bounds any parallel schedule
+ * - per node: its latency, the span up to it (its earliest completion
+ *   time), and on demand the work of the subgraph below it
+ *
+ * RECURSION
+ * ---------
+ * The graph is split into strongly connected components (Tarjan). The work
+ * of a recursive component is paid once per fixpoint round: `work` counts
+ * one round, `recursiveWork` the part that is repeated, and
+ * workFor(rounds) the total for a number of rounds. Rounds of a component
+ * are sequential and its nodes depend on each other, so the component adds
+ * its whole round to the span of the paths through it.
+ *
+ * Variables are free: they alias their definition (inputs, undefined
+ * variables, alias nothing).
+ *
+ * A select costs a comparison (an addition) and counts both branches, so
+ * work is an upper bound for graphs whose evaluation skips untaken ones.
+ */
+
+struct CostEstimate {
+    size_t nodes = 0;
+    size_t operations = 0;          // Unary, binary and select nodes
+    size_t recursiveComponents = 0;
+    size_t recursiveNodes = 0;
+    double work = 0.0;              // One evaluation, recursive components for one round
+    double recursiveWork = 0.0;     // Part of the work repeated by every fixpoint round
+    double span = 0.0;
+
+    // Total work when every recursive component takes `rounds` rounds
+    double workFor(size_t rounds) const {
+        return work + recursiveWork * static_cast<double>(rounds > 0 ? rounds - 1 : 0);
+    }
+
+    double parallelism() const {
+        return span > 0.0 ? work / span : 1.0;
+    }
+
+    Cost total() const {
+        return Cost{work, span};
+    }
+};
+
+class CostModel {
+private:
+    LatencyTable fLatencies;
+    std::unordered_map<Tree*, size_t> fIds;
+    std::vector<Tree*> fNodes;
+    std::vector<std::vector<size_t>> fOperands;
+    std::vector<double> fLatency;
+    std::vector<double> fSpan;
+    CostEstimate fEstimate;
+
+public:
+    explicit CostModel(const LatencyTable& latencies = LatencyTable::doublePrecision())
+        : fLatencies(latencies) {}
+
+    const LatencyTable& latencies() const { return fLatencies; }
+
+    // Work and span of the graph reachable from the roots
+    const CostEstimate& estimate(const std::vector<std::shared_ptr<Tree>>& roots) {
+        collect(roots);
+        StronglyConnectedComponents sccs = stronglyConnectedComponents(fOperands);
+        fSpan.assign(fNodes.size(), 0.0);
+
+        // Components come operands first
+        for (size_t c = 0; c < sccs.components.size(); ++c) {
+            const auto& component = sccs.components[c];
+            double ready = 0.0;      // Latest completion of an operand outside the component
+            double round = 0.0;
+            for (size_t id : component) {
+                round += fLatency[id];
+                for (size_t operand : fOperands[id]) {
+                    if (sccs.componentOf[operand] != c) {
+                        ready = std::max(ready, fSpan[operand]);
+                    }
+                }
+            }
+            if (sccs.isRecursive(c, fOperands)) {
+                fEstimate.recursiveComponents++;
+                fEstimate.recursiveNodes += component.size();
+                fEstimate.recursiveWork += round;
+            }
+            fEstimate.work += round;
+            for (size_t id : component) {
+                fSpan[id] = ready + round;
+            }
+        }
+        for (double span : fSpan) {
+            fEstimate.span = std::max(fEstimate.span, span);
+        }
+        return fEstimate;
+    }
+
+    const CostEstimate& estimate(const std::shared_ptr<Tree>& root) {
+        return estimate(std::vector<std::shared_ptr<Tree>>{root});
+    }
+
+    const CostEstimate& lastEstimate() const { return fEstimate; }
+
+    // Latency of the node itself, 0 outside the last estimated graph
+    double latency(const std::shared_ptr<Tree>& tree) const {
+        auto it = fIds.find(tree.get());
+        return it == fIds.end() ? 0.0 : fLatency[it->second];
+    }
+
+    // Earliest completion of the node with unlimited cores
+    double span(const std::shared_ptr<Tree>& tree) const {
+        auto it = fIds.find(tree.get());
+        return it == fIds.end() ? 0.0 : fSpan[it->second];
+    }
+
+    // Work and span of the subgraph below a node of the last estimated
+    // graph, shared nodes counted once
+    Cost cost(const std::shared_ptr<Tree>& tree) const {
+        auto it = fIds.find(tree.get());
+        if (it == fIds.end()) {
+            return Cost{};
+        }
+        std::vector<bool> seen(fNodes.size(), false);
+        std::vector<size_t> pending = {it->second};
+        seen[it->second] = true;
+        double work = 0.0;
+        while (!pending.empty()) {
+            size_t id = pending.back();
+            pending.pop_back();
+            work += fLatency[id];
+            for (size_t operand : fOperands[id]) {
+                if (!seen[operand]) {
+                    seen[operand] = true;
+                    pending.push_back(operand);
+                }
+            }
+        }
+        return Cost{work, fSpan[it->second]};
+    }
+
+private:
+    double latencyOf(Tree* tree) const {
+        switch (tree->getType()) {
+            case Tree::NodeType::Num:
+                return fLatencies.constantLatency();
+            case Tree::NodeType::Unary:
+                return fLatencies.unaryLatency(tree->getUnaryOp());
+            case Tree::NodeType::Binary:
+                return fLatencies.binaryLatency(tree->getBinaryOp());
+            case Tree::NodeType::Select:
+                return fLatencies.binaryLatency(BinaryOp::Add);
+            case Tree::NodeType::Var:
+                return 0.0;
+        }
+        return 0.0;
+    }
+
+    void collect(const std::vector<std::shared_ptr<Tree>>& roots) {
+        const size_t previous = fNodes.size();
+        fIds.clear();
+        fIds.reserve(previous);
+        fNodes.clear();
+        fOperands.clear();
+        fLatency.clear();
+        fEstimate = CostEstimate();
+        std::vector<size_t> pending;
+        auto idOf = [&](Tree* tree) {
+            auto [it, inserted] = fIds.emplace(tree, fNodes.size());
+            if (inserted) {
+                pending.push_back(fNodes.size());
+                fNodes.push_back(tree);
+                fOperands.emplace_back();
+                fLatency.push_back(latencyOf(tree));
+            }
+            return it->second;
+        };
+        for (const auto& root : roots) {
+            idOf(root.get());
+        }
+        while (!pending.empty()) {
+            size_t id = pending.back();
+            pending.pop_back();
+            Tree* tree = fNodes[id];
+            switch (tree->getType()) {
+                case Tree::NodeType::Num:
+                    break;
+                case Tree::NodeType::Unary: {
+                    size_t operand = idOf(tree->getOperand().get());
+                    fOperands[id] = {operand};
+                    fEstimate.operations++;
+                    break;
+                }
+                case Tree::NodeType::Binary: {
+                    size_t left = idOf(tree->getLeft().get());
+                    size_t right = idOf(tree->getRight().get());
+                    fOperands[id] = {left, right};
+                    fEstimate.operations++;
+                    break;
+                }
+                case Tree::NodeType::Select: {
+                    size_t condition = idOf(tree->getCondition().get());
+                    size_t then = idOf(tree->getThen().get());
+                    size_t otherwise = idOf(tree->getElse().get());
+                    fOperands[id] = {condition, then, otherwise};
+                    fEstimate.operations++;
+                    break;
+                }
+                case Tree::NodeType::Var:
+                    if (tree->getDefinition()) {
+                        size_t definition = idOf(tree->getDefinition().get());
+                        fOperands[id] = {definition};
+                    }
+                    break;
+            }
+        }
+        fEstimate.nodes = fNodes.size();
+    }
+};
+
+#endif
@@ -0,0 +1,167 @@
+#ifndef DEFINITION_TABLE_HH
+#define DEFINITION_TABLE_HH
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class Tree;
+
+/**
+ * DefinitionTable - Copy-on-Write Definitions of Variables, by Node Id
+ * ===================================================================
+ *
+ * PURPOSE
+ * -------
+ * TreeAlgebra::define() records the definition of a variable in the
+ * variable itself and in a DefinitionTable indexed by node id. Copying the
+ * table is cheap and the copy never changes afterwards: it is the
+ * definition half of a TreeSnapshot, read by evaluations on other threads
+ * while the owner keeps defining.
+ *
+ * STRUCTURE
+ * ---------
+ * Ids are split into chunks of 1024 entries held by shared pointers. A
+ * copy shares all the chunks of the original; set() copies a chunk before
+ * writing into it unless the table owns it (path copying, as in persistent
+ * vectors). Ownership is explicit: each table has a generation, each chunk
+ * the generation of the table that created it, and taking a copy gives
+ * both tables new generations, so that neither owns the chunks they share.
+ * Taking a copy costs one pointer per chunk, and after it each chunk the
+ * owner writes to is copied once.
+ *
+ * THREADS
+ * -------
+ * A table is written by one thread. Its copies may be read by any number
+ * of threads, concurrently with writes to the original: a chunk is only
+ * written in place by the table that created it after the last copy, and
+ * new copies of the original are taken by the writing thread. Reference
+ * counts play no part: use_count() is a relaxed snapshot that a concurrent
+ * copy of a chunk pointer may not show yet.
+ *
+ * REFERENCES
+ * ----------
+ * - Driscoll, J.R., Sarnak, N., Sleator, D.D., Tarjan, R.E. (1989)
+ *   "Making Data Structures Persistent", JCSS 38(1), pp. 86-124
+ */
+
+class DefinitionTable {
+public:
+    static constexpr size_t CHUNK_BITS = 10;
+    static constexpr size_t CHUNK_SIZE = size_t(1) << CHUNK_BITS;
+
+private:
+    struct Chunk {
+        uint64_t owner;   // Generation of the table allowed to write it
+        std::array<std::shared_ptr<Tree>, CHUNK_SIZE> entries;
+    };
+
+    std::vector<std::shared_ptr<Chunk>> fChunks;
+    size_t fCount = 0;   // Variables with a definition
+    mutable std::atomic<uint64_t> fGeneration{nextGeneration()};   // Changed by every copy
+
+    static uint64_t nextGeneration() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+public:
+    DefinitionTable() = default;
+
+    // The copy and the original share their chunks, and own none of them
+    DefinitionTable(const DefinitionTable& other) : fChunks(other.fChunks), fCount(other.fCount) {
+        other.fGeneration.store(nextGeneration(), std::memory_order_relaxed);
+    }
+
+    DefinitionTable& operator=(const DefinitionTable& other) {
+        if (this != &other) {
+            fChunks = other.fChunks;
+            fCount = other.fCount;
+            fGeneration.store(nextGeneration(), std::memory_order_relaxed);
+            other.fGeneration.store(nextGeneration(), std::memory_order_relaxed);
+        }
+        return *this;
+    }
+
+    // The chunks move with their ownership
+    DefinitionTable(DefinitionTable&& other) noexcept
+        : fChunks(std::move(other.fChunks)), fCount(other.fCount),
+          fGeneration(other.fGeneration.load(std::memory_order_relaxed)) {
+        other.clear();
+    }
+
+    DefinitionTable& operator=(DefinitionTable&& other) noexcept {
+        if (this != &other) {
+            fChunks = std::move(other.fChunks);
+            fCount = other.fCount;
+            fGeneration.store(other.fGeneration.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.clear();
+        }
+        return *this;
+    }
+
+    // Definition of the variable of id, nullptr if none
+    const std::shared_ptr<Tree>* find(size_t id) const {
+        const size_t c = id >> CHUNK_BITS;
+        if (c >= fChunks.size() || !fChunks[c]) {
+            return nullptr;
+        }
+        const std::shared_ptr<Tree>& definition = fChunks[c]->entries[id & (CHUNK_SIZE - 1)];
+        return definition ? &definition : nullptr;
+    }
+
+    std::shared_ptr<Tree> get(size_t id) const {
+        const std::shared_ptr<Tree>* definition = find(id);
+        return definition ? *definition : nullptr;
+    }
+
+    void set(size_t id, std::shared_ptr<Tree> definition) {
+        const size_t c = id >> CHUNK_BITS;
+        if (c >= fChunks.size()) {
+            fChunks.resize(c + 1);
+        }
+        const uint64_t generation = fGeneration.load(std::memory_order_relaxed);
+        std::shared_ptr<Chunk>& chunk = fChunks[c];
+        if (!chunk) {
+            chunk = std::make_shared<Chunk>();
+            chunk->owner = generation;
+        } else if (chunk->owner != generation) {
+            chunk = std::make_shared<Chunk>(*chunk);   // Possibly shared with a copy
+            chunk->owner = generation;
+        }
+        std::shared_ptr<Tree>& slot = chunk->entries[id & (CHUNK_SIZE - 1)];
+        if (!slot && definition) fCount++;
+        if (slot && !definition) fCount--;
+        slot = std::move(definition);
+    }
+
+    // Number of defined variables
+    size_t size() const {
+        return fCount;
+    }
+
+    size_t chunks() const {
+        return fChunks.size();
+    }
+
+    // Chunks written in place by the next set(), the others are copied first
+    size_t ownedChunks() const {
+        const uint64_t generation = fGeneration.load(std::memory_order_relaxed);
+        size_t owned = 0;
+        for (const auto& chunk : fChunks) {
+            if (chunk && chunk->owner == generation) owned++;
+        }
+        return owned;
+    }
+
+    void clear() {
+        fChunks.clear();
+        fCount = 0;
+        fGeneration.store(nextGeneration(), std::memory_order_relaxed);
+    }
+};
+
+#endif
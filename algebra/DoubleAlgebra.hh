@@ -1,8 +1,7 @@
 #ifndef DOUBLE_ALGEBRA_HH
 #define DOUBLE_ALGEBRA_HH
 
-#include "SemanticAlgebra.hh"
-#include <cmath>
+#include "NumericAlgebra.hh"
 
 /**
  * DoubleAlgebra - Standard Floating-Point Computation
@@ -25,6 +24,9 @@
  * - 0.0: Bottom element for fixpoint iteration
  * - isConverged: Combined absolute/relative tolerance test
  * 
+ * DoubleAlgebra is the double instance of NumericAlgebra (see
+ * NumericAlgebra.hh for the float and mixed-precision instances).
+ * 
  * COMPUTATIONAL SEMANTICS
  * -----------------------
  * 
@@ -214,60 +216,9 @@
  *   Birkhäuser, 2nd Edition
  *   [Modern comprehensive reference on floating-point arithmetic]
  */
-class DoubleAlgebra : public SemanticAlgebra<double> {
+class DoubleAlgebra : public NumericAlgebra<double> {
 public:
-    double num(double value) const override {
-        return value;
-    }
-    
-    double add(const double& a, const double& b) const override {
-        return a + b;
-    }
-    
-    double sub(const double& a, const double& b) const override {
-        return a - b;
-    }
-    
-    double mul(const double& a, const double& b) const override {
-        return a * b;
-    }
-    
-    double div(const double& a, const double& b) const override {
-        return a / b;
-    }
-    
-    double mod(const double& a, const double& b) const override {
-        return std::fmod(a, b);
-    }
-    
-    double abs(const double& a) const override {
-        return std::abs(a);
-    }
-    
-    // SemanticAlgebra method
-    double bottom() const override {
-        return 0.0;  // Use 0.0 as bottom value for numerical computation
-    }
-    
-    // SemanticAlgebra convergence method
-    bool isConverged(const double& prev, const double& current) const override {
-        // Use relative and absolute tolerance for robust floating-point comparison
-        const double epsilon = 1e-10;  // Convergence tolerance
-        const double abs_diff = std::abs(prev - current);
-        
-        // Absolute tolerance for values near zero
-        if (abs_diff < epsilon) {
-            return true;
-        }
-        
-        // Relative tolerance for larger values
-        const double max_val = std::max(std::abs(prev), std::abs(current));
-        if (max_val > 0.0 && abs_diff / max_val < epsilon) {
-            return true;
-        }
-        
-        return false;
-    }
+    using NumericAlgebra<double>::NumericAlgebra;
 };
 
 #endif
\ No newline at end of file
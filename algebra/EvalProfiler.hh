@@ -0,0 +1,432 @@
+#ifndef EVAL_PROFILER_HH
+#define EVAL_PROFILER_HH
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * EvalProfiler - Where the Evaluation of a Graph Spends its Time
+ * ==============================================================
+ *
+ * PURPOSE
+ * -------
+ * When one formula is slow to evaluate, the profiler tells which part of
+ * its graph is responsible. While a profiler is installed on a thread
+ * (EvalProfiler::Scope), TreeAlgebra::eval(), query() and Tree::operator()
+ * report to it:
+ *
+ *   - every visit of a node (memo hits included) and every evaluation of
+ *     a node (memo misses),
+ *   - every fixpoint solved by iteration: the SCC, the number of rounds
+ *     re-evaluating its definitions and the node evaluations they cost,
+ *   - the time spent, by sampling.
+ *
+ * Without a profiler, the cost is one thread-local load per node.
+ *
+ * SAMPLING
+ * --------
+ * Entering and leaving a node (or an iteration round) are events; every
+ * samplePeriod events the clock is read and the time elapsed since the
+ * previous reading is charged to the frame on top of the evaluation stack.
+ * With a period of 1 every node gets its exact self time, at the cost of
+ * two clock readings per node; larger periods give a statistical profile
+ * whose overhead is a counter decrement per event.
+ *
+ * CONTEXTS
+ * --------
+ * Times are kept per calling context: the path of nodes, from the root,
+ * along which the evaluation reached a node (a node shared by several
+ * parents is evaluated once, in the context of the first one). The
+ * contexts form a tree, exported as folded stacks for flame graph tools:
+ *
+ *   mul#12;add#9;fix(var2#4) 153000
+ *
+ * one line per context, frames separated by ';', weighted by the self
+ * time of the context in nanoseconds. The ranked report aggregates self
+ * times per node and per SCC.
+ *
+ * THREADS
+ * -------
+ * The profiler installed by a Scope is only seen by its thread: profile
+ * concurrent evaluations with one profiler per thread.
+ *
+ * REFERENCES
+ * ----------
+ * - Ammons, G., Ball, T., Larus, J.R. (1997) "Exploiting Hardware
+ *   Performance Counters with Flow and Context Sensitive Profiling", PLDI
+ *   [Calling context trees]
+ * - Gregg, B. (2016) "The Flame Graph", Communications of the ACM 59(6)
+ *   [Folded stacks and their visualization]
+ */
+
+class EvalProfiler {
+public:
+    enum class FrameKind : uint8_t { Node, Fixpoint };
+
+    struct NodeProfile {
+        std::string label;          // Empty while the node was never entered
+        uint64_t visits = 0;        // Memo hits included
+        uint64_t evaluations = 0;
+        uint64_t samples = 0;
+        double seconds = 0.0;       // Self time
+    };
+
+    struct SCCProfile {
+        size_t head = 0;            // Node id of the variable the SCC was entered by
+        std::string label;
+        size_t size = 0;            // Variables
+        uint64_t solves = 0;
+        uint64_t rounds = 0;        // Re-evaluations of the definitions
+        uint64_t nodeEvaluations = 0;
+        double seconds = 0.0;       // Self time of the iterations
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Context {
+        uint32_t parent;
+        FrameKind kind;
+        size_t id;
+        uint64_t samples = 0;
+        double seconds = 0.0;
+    };
+
+    struct ContextKey {
+        uint32_t parent;
+        FrameKind kind;
+        size_t id;
+
+        bool operator==(const ContextKey& other) const {
+            return parent == other.parent && kind == other.kind && id == other.id;
+        }
+    };
+
+    struct ContextKeyHash {
+        size_t operator()(const ContextKey& key) const {
+            return std::hash<size_t>()(key.id) * 31 + key.parent * 2 + static_cast<size_t>(key.kind);
+        }
+    };
+
+    static constexpr uint32_t NO_CONTEXT = 0xffffffff;
+
+    int64_t fPeriod;
+    int64_t fCountdown;
+    Clock::time_point fLast;
+
+    std::vector<NodeProfile> fNodes;                       // By node id
+    struct LastContext {
+        uint32_t context = NO_CONTEXT;
+        uint32_t parent = NO_CONTEXT;
+    };
+    std::vector<LastContext> fLastContexts;                // By node id, the context it was last entered in
+    std::vector<SCCProfile> fSCCs;
+    std::unordered_map<size_t, size_t> fSCCIndex;          // Head id -> fSCCs
+    std::vector<Context> fContexts;
+    std::unordered_map<ContextKey, uint32_t, ContextKeyHash> fChildren;   // Except last contexts
+    std::vector<uint32_t> fStack;                          // Contexts being evaluated
+    uint64_t fSamples = 0;
+    double fSeconds = 0.0;
+
+    static EvalProfiler*& slot() {
+        static thread_local EvalProfiler* profiler = nullptr;
+        return profiler;
+    }
+
+    NodeProfile& nodeProfile(size_t id) {
+        if (id >= fNodes.size()) {
+            fNodes.resize(std::max(id + 1, 2 * fNodes.size()));
+            fLastContexts.resize(fNodes.size());
+        }
+        return fNodes[id];
+    }
+
+    // Charges the time since the last reading to the top of the stack
+    void sample() {
+        const Clock::time_point now = Clock::now();
+        const double elapsed = std::chrono::duration<double>(now - fLast).count();
+        fLast = now;
+        fCountdown = fPeriod;
+        if (fStack.empty()) {
+            return;
+        }
+        Context& context = fContexts[fStack.back()];
+        context.samples++;
+        context.seconds += elapsed;
+        if (context.kind == FrameKind::Node) {
+            fNodes[context.id].samples++;
+            fNodes[context.id].seconds += elapsed;
+        } else {
+            fSCCs[fSCCIndex[context.id]].seconds += elapsed;
+        }
+        fSamples++;
+        fSeconds += elapsed;
+    }
+
+    void tick(int64_t events) {
+        fCountdown -= events;
+        if (fCountdown <= 0) {
+            sample();
+        }
+    }
+
+    void push(FrameKind kind, size_t id) {
+        if (fStack.empty()) {
+            // Time between evaluations is not charged to anyone
+            fLast = Clock::now();
+            fCountdown = fPeriod;
+        } else {
+            tick(1);
+        }
+        const uint32_t parent = fStack.empty() ? NO_CONTEXT : fStack.back();
+        if (kind == FrameKind::Node) {
+            // A node is usually entered from the same parent every time:
+            // its last context is checked before the map
+            LastContext& last = fLastContexts[id];
+            if (last.context != NO_CONTEXT && last.parent == parent) {
+                fStack.push_back(last.context);
+                return;
+            }
+            if (last.context != NO_CONTEXT) {
+                fChildren.emplace(ContextKey{last.parent, kind, id}, last.context);
+            }
+            last.context = context(parent, kind, id);
+            last.parent = parent;
+            fStack.push_back(last.context);
+        } else {
+            fStack.push_back(context(parent, kind, id));
+        }
+    }
+
+    uint32_t context(uint32_t parent, FrameKind kind, size_t id) {
+        auto it = fChildren.find(ContextKey{parent, kind, id});
+        if (it != fChildren.end()) {
+            return it->second;
+        }
+        fContexts.push_back(Context{parent, kind, id});
+        const uint32_t created = static_cast<uint32_t>(fContexts.size() - 1);
+        if (kind == FrameKind::Fixpoint) {
+            fChildren.emplace(ContextKey{parent, kind, id}, created);
+        }
+        return created;
+    }
+
+    std::string contextLabel(const Context& context) const {
+        if (context.kind == FrameKind::Node) {
+            return fNodes[context.id].label;
+        }
+        return fSCCs[fSCCIndex.at(context.id)].label;
+    }
+
+public:
+    explicit EvalProfiler(uint32_t samplePeriod = 16)
+        : fPeriod(std::max<uint32_t>(samplePeriod, 1)), fCountdown(fPeriod) {}
+
+    // Profiler installed on the calling thread, if any
+    static EvalProfiler* current() {
+        return slot();
+    }
+
+    // Installs a profiler on the calling thread for the lifetime of the scope
+    class Scope {
+    private:
+        EvalProfiler* fPrevious;
+
+    public:
+        explicit Scope(EvalProfiler& profiler) : fPrevious(slot()) { slot() = &profiler; }
+        ~Scope() { slot() = fPrevious; }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    };
+
+    // An evaluation frame, left when destroyed (exceptions included). The
+    // label is only built the first time a node or an SCC is entered.
+    class Frame {
+    private:
+        EvalProfiler* fProfiler;
+
+    public:
+        template<typename Label>
+        Frame(EvalProfiler* profiler, size_t id, Label&& label) : fProfiler(profiler) {
+            if (fProfiler) {
+                fProfiler->enter(id, label);
+            }
+        }
+
+        template<typename Label>
+        Frame(EvalProfiler* profiler, size_t head, size_t size, Label&& label) : fProfiler(profiler) {
+            if (fProfiler) {
+                fProfiler->enterFixpoint(head, size, label);
+            }
+        }
+
+        ~Frame() {
+            if (fProfiler) {
+                fProfiler->leave();
+            }
+        }
+
+        Frame(const Frame&) = delete;
+        Frame& operator=(const Frame&) = delete;
+    };
+
+    // Hooks of the evaluators
+
+    void visit(size_t id) {
+        nodeProfile(id).visits++;
+    }
+
+    template<typename Label>
+    void enter(size_t id, Label&& label) {
+        NodeProfile& node = nodeProfile(id);
+        if (node.label.empty()) {
+            node.label = label();
+        }
+        node.evaluations++;
+        push(FrameKind::Node, id);
+    }
+
+    template<typename Label>
+    void enterFixpoint(size_t head, size_t size, Label&& label) {
+        auto [it, inserted] = fSCCIndex.emplace(head, fSCCs.size());
+        if (inserted) {
+            SCCProfile scc;
+            scc.head = head;
+            scc.label = label();
+            scc.size = size;
+            fSCCs.push_back(std::move(scc));
+        }
+        fSCCs[it->second].solves++;
+        push(FrameKind::Fixpoint, head);
+    }
+
+    // One iteration round of the fixpoint on top of the stack
+    void round(size_t nodeEvaluations) {
+        SCCProfile& scc = fSCCs[fSCCIndex[fContexts[fStack.back()].id]];
+        scc.rounds++;
+        scc.nodeEvaluations += nodeEvaluations;
+        tick(static_cast<int64_t>(std::max<size_t>(nodeEvaluations, 1)));
+    }
+
+    void leave() {
+        if (fStack.size() == 1) {
+            sample();   // The tail of the evaluation
+        } else {
+            tick(1);
+        }
+        fStack.pop_back();
+    }
+
+    // Results
+
+    uint32_t samplePeriod() const { return static_cast<uint32_t>(fPeriod); }
+    size_t depth() const { return fStack.size(); }
+    uint64_t samples() const { return fSamples; }
+    double seconds() const { return fSeconds; }   // Sampled time, over all frames
+    size_t contexts() const { return fContexts.size(); }
+
+    const NodeProfile* node(size_t id) const {
+        return id < fNodes.size() && (fNodes[id].visits || fNodes[id].evaluations) ? &fNodes[id] : nullptr;
+    }
+
+    const std::vector<SCCProfile>& sccs() const { return fSCCs; }
+
+    // Profiled nodes by decreasing self time
+    std::vector<std::pair<size_t, const NodeProfile*>> ranked() const {
+        std::vector<std::pair<size_t, const NodeProfile*>> nodes;
+        for (size_t id = 0; id < fNodes.size(); ++id) {
+            if (fNodes[id].evaluations) {
+                nodes.emplace_back(id, &fNodes[id]);
+            }
+        }
+        std::stable_sort(nodes.begin(), nodes.end(), [](const auto& a, const auto& b) {
+            return a.second->seconds > b.second->seconds;
+        });
+        return nodes;
+    }
+
+    // The limit most expensive nodes, then the SCCs by decreasing time
+    void report(std::ostream& out, size_t limit = 20) const {
+        const double total = fSeconds > 0.0 ? fSeconds : 1.0;
+        uint64_t visits = 0;
+        uint64_t evaluations = 0;
+        for (const auto& node : fNodes) {
+            visits += node.visits;
+            evaluations += node.evaluations;
+        }
+        const auto flags = out.flags();
+        const auto precision = out.precision();
+        out << std::fixed << std::setprecision(3) << fSeconds * 1e3 << " ms sampled (" << fSamples
+            << " samples, period " << fPeriod << "), " << visits << " visits, " << evaluations
+            << " evaluations, " << fContexts.size() << " contexts" << std::endl
+            << std::right << std::setw(12) << "self ms" << std::setw(8) << "%"
+            << std::setw(12) << "visits" << std::setw(12) << "evals" << "  node" << std::endl;
+        auto nodes = ranked();
+        for (size_t i = 0; i < nodes.size() && i < limit; ++i) {
+            const NodeProfile& node = *nodes[i].second;
+            out << std::setw(12) << std::setprecision(3) << node.seconds * 1e3
+                << std::setw(8) << std::setprecision(1) << 100.0 * node.seconds / total
+                << std::setw(12) << node.visits << std::setw(12) << node.evaluations
+                << "  " << node.label << std::endl;
+        }
+        if (!fSCCs.empty()) {
+            std::vector<const SCCProfile*> sccs;
+            for (const auto& scc : fSCCs) sccs.push_back(&scc);
+            std::stable_sort(sccs.begin(), sccs.end(), [](const SCCProfile* a, const SCCProfile* b) {
+                return a->seconds > b->seconds;
+            });
+            out << std::setw(12) << "self ms" << std::setw(8) << "%" << std::setw(12) << "solves"
+                << std::setw(12) << "rounds" << std::setw(12) << "node evals" << std::setw(8) << "vars"
+                << "  fixpoint" << std::endl;
+            for (size_t i = 0; i < sccs.size() && i < limit; ++i) {
+                const SCCProfile& scc = *sccs[i];
+                out << std::setw(12) << std::setprecision(3) << scc.seconds * 1e3
+                    << std::setw(8) << std::setprecision(1) << 100.0 * scc.seconds / total
+                    << std::setw(12) << scc.solves << std::setw(12) << scc.rounds
+                    << std::setw(12) << scc.nodeEvaluations << std::setw(8) << scc.size
+                    << "  " << scc.label << std::endl;
+            }
+        }
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    // Folded stacks: one line per context with a self time, in nanoseconds
+    void writeFolded(std::ostream& out) const {
+        std::vector<std::string> paths(fContexts.size());
+        for (uint32_t c = 0; c < fContexts.size(); ++c) {
+            // Parents are created before their children
+            const Context& context = fContexts[c];
+            paths[c] = context.parent == NO_CONTEXT ? contextLabel(context)
+                                                    : paths[context.parent] + ";" + contextLabel(context);
+            const long long nanoseconds = std::llround(context.seconds * 1e9);
+            if (nanoseconds > 0) {
+                out << paths[c] << ' ' << nanoseconds << '\n';
+            }
+        }
+    }
+
+    void clear() {
+        fNodes.clear();
+        fLastContexts.clear();
+        fSCCs.clear();
+        fSCCIndex.clear();
+        fContexts.clear();
+        fChildren.clear();
+        fStack.clear();
+        fSamples = 0;
+        fSeconds = 0.0;
+        fCountdown = fPeriod;
+    }
+};
+
+#endif
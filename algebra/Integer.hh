@@ -0,0 +1,550 @@
+#ifndef INTEGER_HH
+#define INTEGER_HH
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Integer - Exact Integers with a Small-Value Fast Path
+ * =====================================================
+ *
+ * MATHEMATICAL THEORY
+ * -------------------
+ * Integer represents ℤ exactly: no operation rounds or wraps around. It is
+ * the carrier of IntegerAlgebra and the numerator/denominator type of
+ * Rational.
+ *
+ * REPRESENTATION
+ * --------------
+ * **Small values** (the common case: indices, sizes, strides) are stored
+ * inline as an int64_t. Every operation first tries the native instruction
+ * and detects overflow with the compiler's checked-arithmetic builtins
+ * (__builtin_add_overflow, ...), which compile to the operation plus a
+ * branch on the overflow flag.
+ *
+ * **Large values** are promoted to a heap-allocated BigInt (sign and
+ * magnitude in base 2³²), shared and immutable. Results that fit in 64 bits
+ * again are demoted, so a value has a unique representation: fBig is set
+ * if and only if the value does not fit in an int64_t.
+ *
+ * DIVISION
+ * --------
+ * Division truncates toward zero and the remainder has the sign of the
+ * dividend, as for C++ built-in integers: a = (a / b)·b + a % b.
+ * Dividing by zero throws std::runtime_error.
+ *
+ * REFERENCES
+ * ----------
+ * - Knuth, D.E. (1997) "The Art of Computer Programming, Vol. 2:
+ *   Seminumerical Algorithms", 3rd ed., Section 4.3.1 (Algorithm D)
+ * - Warren, H.S. (2012) "Hacker's Delight", 2nd ed., Section 9-2
+ */
+
+// Arbitrary-precision integer, sign and magnitude (base 2³², little-endian)
+class BigInt {
+public:
+    using Magnitude = std::vector<uint32_t>;
+
+private:
+    bool fNegative = false;  // Never set for zero
+    Magnitude fMagnitude;    // No leading zero limbs; empty for zero
+
+    static void trim(Magnitude& m) {
+        while (!m.empty() && m.back() == 0) {
+            m.pop_back();
+        }
+    }
+
+    static int compareMagnitudes(const Magnitude& a, const Magnitude& b) {
+        if (a.size() != b.size()) {
+            return a.size() < b.size() ? -1 : 1;
+        }
+        for (size_t i = a.size(); i-- > 0;) {
+            if (a[i] != b[i]) {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    static Magnitude addMagnitudes(const Magnitude& a, const Magnitude& b) {
+        const Magnitude& longer = a.size() >= b.size() ? a : b;
+        const Magnitude& shorter = a.size() >= b.size() ? b : a;
+        Magnitude result(longer.size() + 1);
+        uint64_t carry = 0;
+        for (size_t i = 0; i < longer.size(); ++i) {
+            uint64_t sum = uint64_t(longer[i]) + (i < shorter.size() ? shorter[i] : 0) + carry;
+            result[i] = static_cast<uint32_t>(sum);
+            carry = sum >> 32;
+        }
+        result[longer.size()] = static_cast<uint32_t>(carry);
+        trim(result);
+        return result;
+    }
+
+    // a - b, requires |a| >= |b|
+    static Magnitude subMagnitudes(const Magnitude& a, const Magnitude& b) {
+        Magnitude result(a.size());
+        int64_t borrow = 0;
+        for (size_t i = 0; i < a.size(); ++i) {
+            int64_t diff = int64_t(a[i]) - (i < b.size() ? b[i] : 0) - borrow;
+            borrow = diff < 0 ? 1 : 0;
+            result[i] = static_cast<uint32_t>(diff + (borrow << 32));
+        }
+        trim(result);
+        return result;
+    }
+
+    static Magnitude mulMagnitudes(const Magnitude& a, const Magnitude& b) {
+        if (a.empty() || b.empty()) {
+            return {};
+        }
+        Magnitude result(a.size() + b.size(), 0);
+        for (size_t i = 0; i < a.size(); ++i) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < b.size(); ++j) {
+                uint64_t t = uint64_t(a[i]) * b[j] + result[i + j] + carry;
+                result[i + j] = static_cast<uint32_t>(t);
+                carry = t >> 32;
+            }
+            result[i + b.size()] = static_cast<uint32_t>(carry);
+        }
+        trim(result);
+        return result;
+    }
+
+    // Quotient and remainder of magnitudes (Knuth's Algorithm D), v non-zero
+    static void divModMagnitudes(const Magnitude& u, const Magnitude& v, Magnitude& q, Magnitude& r) {
+        if (compareMagnitudes(u, v) < 0) {
+            q.clear();
+            r = u;
+            return;
+        }
+        const uint64_t base = uint64_t(1) << 32;
+        const size_t m = u.size();
+        const size_t n = v.size();
+
+        if (n == 1) {
+            // Short division
+            q.assign(m, 0);
+            uint64_t rest = 0;
+            for (size_t j = m; j-- > 0;) {
+                uint64_t cur = (rest << 32) | u[j];
+                q[j] = static_cast<uint32_t>(cur / v[0]);
+                rest = cur % v[0];
+            }
+            trim(q);
+            r.clear();
+            if (rest) r.push_back(static_cast<uint32_t>(rest));
+            return;
+        }
+
+        // Normalize so that the top limb of the divisor has its high bit set
+        int shift = 0;
+        while ((v[n - 1] << shift & 0x80000000u) == 0) {
+            ++shift;
+        }
+        Magnitude vn(n);
+        Magnitude un(m + 1);
+        for (size_t i = n - 1; i > 0; --i) {
+            vn[i] = (v[i] << shift) | (shift ? static_cast<uint32_t>(uint64_t(v[i - 1]) >> (32 - shift)) : 0);
+        }
+        vn[0] = v[0] << shift;
+        un[m] = shift ? static_cast<uint32_t>(uint64_t(u[m - 1]) >> (32 - shift)) : 0;
+        for (size_t i = m - 1; i > 0; --i) {
+            un[i] = (u[i] << shift) | (shift ? static_cast<uint32_t>(uint64_t(u[i - 1]) >> (32 - shift)) : 0);
+        }
+        un[0] = u[0] << shift;
+
+        q.assign(m - n + 1, 0);
+        for (size_t j = m - n + 1; j-- > 0;) {
+            uint64_t numerator = (uint64_t(un[j + n]) << 32) | un[j + n - 1];
+            uint64_t qhat = numerator / vn[n - 1];
+            uint64_t rhat = numerator % vn[n - 1];
+            while (qhat >= base || qhat * vn[n - 2] > ((rhat << 32) | un[j + n - 2])) {
+                --qhat;
+                rhat += vn[n - 1];
+                if (rhat >= base) break;
+            }
+
+            // Multiply and subtract
+            int64_t borrow = 0;
+            for (size_t i = 0; i < n; ++i) {
+                uint64_t p = qhat * vn[i];
+                int64_t t = int64_t(un[i + j]) - borrow - int64_t(p & 0xFFFFFFFFu);
+                un[i + j] = static_cast<uint32_t>(t);
+                borrow = int64_t(p >> 32) - (t >> 32);
+            }
+            int64_t t = int64_t(un[j + n]) - borrow;
+            un[j + n] = static_cast<uint32_t>(t);
+
+            q[j] = static_cast<uint32_t>(qhat);
+            if (t < 0) {
+                // qhat was one too large: add back
+                q[j] -= 1;
+                uint64_t carry = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    uint64_t sum = uint64_t(un[i + j]) + vn[i] + carry;
+                    un[i + j] = static_cast<uint32_t>(sum);
+                    carry = sum >> 32;
+                }
+                un[j + n] = static_cast<uint32_t>(un[j + n] + carry);
+            }
+        }
+        trim(q);
+
+        // Unnormalize the remainder
+        r.assign(n, 0);
+        for (size_t i = 0; i < n; ++i) {
+            r[i] = (un[i] >> shift) | (shift ? static_cast<uint32_t>(uint64_t(un[i + 1]) << (32 - shift)) : 0);
+        }
+        trim(r);
+    }
+
+    BigInt(bool negative, Magnitude magnitude) : fNegative(negative), fMagnitude(std::move(magnitude)) {
+        trim(fMagnitude);
+        if (fMagnitude.empty()) fNegative = false;
+    }
+
+public:
+    BigInt() = default;
+
+    BigInt(int64_t value) : fNegative(value < 0) {
+        // Magnitude of INT64_MIN does not fit in int64_t: work in uint64_t
+        uint64_t magnitude = value < 0 ? uint64_t(0) - uint64_t(value) : uint64_t(value);
+        while (magnitude) {
+            fMagnitude.push_back(static_cast<uint32_t>(magnitude));
+            magnitude >>= 32;
+        }
+    }
+
+    // 2^k
+    static BigInt powerOfTwo(unsigned k) {
+        Magnitude m(k / 32 + 1, 0);
+        m.back() = uint32_t(1) << (k % 32);
+        return BigInt(false, std::move(m));
+    }
+
+    bool isNegative() const { return fNegative; }
+    bool isZero() const { return fMagnitude.empty(); }
+    const Magnitude& magnitude() const { return fMagnitude; }
+
+    // Value as int64_t if it fits
+    bool toInt64(int64_t& out) const {
+        if (fMagnitude.size() > 2) return false;
+        uint64_t magnitude = 0;
+        for (size_t i = fMagnitude.size(); i-- > 0;) {
+            magnitude = (magnitude << 32) | fMagnitude[i];
+        }
+        if (fNegative) {
+            if (magnitude > uint64_t(1) << 63) return false;
+            out = static_cast<int64_t>(uint64_t(0) - magnitude);
+        } else {
+            if (magnitude > uint64_t(std::numeric_limits<int64_t>::max())) return false;
+            out = static_cast<int64_t>(magnitude);
+        }
+        return true;
+    }
+
+    double toDouble() const {
+        double result = 0.0;
+        for (size_t i = fMagnitude.size(); i-- > 0;) {
+            result = result * 4294967296.0 + fMagnitude[i];
+        }
+        return fNegative ? -result : result;
+    }
+
+    std::string toString() const {
+        if (isZero()) return "0";
+        // Peel off base-10⁹ digits by short division
+        std::vector<uint32_t> chunks;
+        Magnitude rest = fMagnitude;
+        Magnitude q;
+        Magnitude r;
+        const Magnitude billion = {1000000000u};
+        while (!rest.empty()) {
+            divModMagnitudes(rest, billion, q, r);
+            chunks.push_back(r.empty() ? 0 : r[0]);
+            rest.swap(q);
+        }
+        std::string result = fNegative ? "-" : "";
+        result += std::to_string(chunks.back());
+        for (size_t i = chunks.size() - 1; i-- > 0;) {
+            std::string digits = std::to_string(chunks[i]);
+            result += std::string(9 - digits.size(), '0') + digits;
+        }
+        return result;
+    }
+
+    BigInt operator-() const {
+        return BigInt(!fNegative, fMagnitude);
+    }
+
+    friend BigInt operator+(const BigInt& a, const BigInt& b) {
+        if (a.fNegative == b.fNegative) {
+            return BigInt(a.fNegative, addMagnitudes(a.fMagnitude, b.fMagnitude));
+        }
+        if (compareMagnitudes(a.fMagnitude, b.fMagnitude) >= 0) {
+            return BigInt(a.fNegative, subMagnitudes(a.fMagnitude, b.fMagnitude));
+        }
+        return BigInt(b.fNegative, subMagnitudes(b.fMagnitude, a.fMagnitude));
+    }
+
+    friend BigInt operator-(const BigInt& a, const BigInt& b) {
+        return a + (-b);
+    }
+
+    friend BigInt operator*(const BigInt& a, const BigInt& b) {
+        return BigInt(a.fNegative != b.fNegative, mulMagnitudes(a.fMagnitude, b.fMagnitude));
+    }
+
+    // Truncated division: quotient toward zero, remainder with the sign of a
+    static void divMod(const BigInt& a, const BigInt& b, BigInt& quotient, BigInt& remainder) {
+        if (b.isZero()) {
+            throw std::runtime_error("Integer division by zero");
+        }
+        Magnitude q;
+        Magnitude r;
+        divModMagnitudes(a.fMagnitude, b.fMagnitude, q, r);
+        quotient = BigInt(a.fNegative != b.fNegative, std::move(q));
+        remainder = BigInt(a.fNegative, std::move(r));
+    }
+
+    static int compare(const BigInt& a, const BigInt& b) {
+        if (a.fNegative != b.fNegative) {
+            return a.fNegative ? -1 : 1;
+        }
+        int c = compareMagnitudes(a.fMagnitude, b.fMagnitude);
+        return a.fNegative ? -c : c;
+    }
+};
+
+// Exact integer: inline int64_t, promoted to a shared BigInt on overflow
+class Integer {
+private:
+    // Shared, immutable big value. The reference count is intrusive so that
+    // copying and destroying a small Integer is a null test, not a call.
+    struct BigNode {
+        BigInt value;
+        mutable std::atomic<size_t> refs{1};
+        explicit BigNode(BigInt v) : value(std::move(v)) {}
+    };
+
+    int64_t fSmall = 0;
+    const BigNode* fBig = nullptr;  // Set only for values outside int64_t
+
+    static Integer fromBig(BigInt big) {
+        int64_t small;
+        if (big.toInt64(small)) {
+            return Integer(small);
+        }
+        Integer result;
+        result.fBig = new BigNode(std::move(big));
+        return result;
+    }
+
+    static void release(const BigNode* node) {
+        if (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete node;
+        }
+    }
+
+    BigInt toBig() const {
+        return fBig ? fBig->value : BigInt(fSmall);
+    }
+
+public:
+    Integer() = default;
+    Integer(int64_t value) : fSmall(value) {}
+    Integer(int value) : fSmall(value) {}
+
+    Integer(const Integer& other) : fSmall(other.fSmall), fBig(other.fBig) {
+        if (fBig) fBig->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Integer(Integer&& other) noexcept : fSmall(other.fSmall), fBig(other.fBig) {
+        other.fBig = nullptr;
+    }
+
+    Integer& operator=(const Integer& other) {
+        if (other.fBig) other.fBig->refs.fetch_add(1, std::memory_order_relaxed);
+        release(fBig);
+        fSmall = other.fSmall;
+        fBig = other.fBig;
+        return *this;
+    }
+
+    Integer& operator=(Integer&& other) noexcept {
+        if (this != &other) {
+            release(fBig);
+            fSmall = other.fSmall;
+            fBig = other.fBig;
+            other.fBig = nullptr;
+        }
+        return *this;
+    }
+
+    ~Integer() {
+        release(fBig);
+    }
+
+    // Exact conversion of an integral double, throws otherwise
+    static Integer fromDouble(double value) {
+        if (!std::isfinite(value) || std::trunc(value) != value) {
+            throw std::runtime_error("Not an integer: " + std::to_string(value));
+        }
+        if (std::abs(value) < 9.2e18) {
+            return Integer(static_cast<int64_t>(value));
+        }
+        int exponent;
+        double mantissa = std::frexp(std::abs(value), &exponent);  // value = mantissa·2^exponent
+        int64_t digits = static_cast<int64_t>(std::ldexp(mantissa, 53));
+        BigInt big = BigInt(digits) * BigInt::powerOfTwo(static_cast<unsigned>(exponent - 53));
+        return fromBig(value < 0 ? -big : big);
+    }
+
+    static Integer powerOfTwo(unsigned k) {
+        return k < 63 ? Integer(int64_t(1) << k) : fromBig(BigInt::powerOfTwo(k));
+    }
+
+    bool isSmall() const { return !fBig; }
+    int64_t small() const { return fSmall; }
+    bool isZero() const { return !fBig && fSmall == 0; }
+    bool isNegative() const { return fBig ? fBig->value.isNegative() : fSmall < 0; }
+
+    double toDouble() const {
+        return fBig ? fBig->value.toDouble() : static_cast<double>(fSmall);
+    }
+
+    std::string toString() const {
+        return fBig ? fBig->value.toString() : std::to_string(fSmall);
+    }
+
+    Integer operator-() const {
+        int64_t r;
+        if (!fBig && !__builtin_sub_overflow(int64_t(0), fSmall, &r)) {
+            return Integer(r);
+        }
+        return fromBig(-toBig());
+    }
+
+    friend Integer operator+(const Integer& a, const Integer& b) {
+        int64_t r;
+        if (!a.fBig && !b.fBig && !__builtin_add_overflow(a.fSmall, b.fSmall, &r)) {
+            return Integer(r);
+        }
+        return fromBig(a.toBig() + b.toBig());
+    }
+
+    friend Integer operator-(const Integer& a, const Integer& b) {
+        int64_t r;
+        if (!a.fBig && !b.fBig && !__builtin_sub_overflow(a.fSmall, b.fSmall, &r)) {
+            return Integer(r);
+        }
+        return fromBig(a.toBig() - b.toBig());
+    }
+
+    friend Integer operator*(const Integer& a, const Integer& b) {
+        int64_t r;
+        if (!a.fBig && !b.fBig && !__builtin_mul_overflow(a.fSmall, b.fSmall, &r)) {
+            return Integer(r);
+        }
+        return fromBig(a.toBig() * b.toBig());
+    }
+
+    // Truncated division and remainder, throw on division by zero
+    static void divMod(const Integer& a, const Integer& b, Integer& quotient, Integer& remainder) {
+        if (b.isZero()) {
+            throw std::runtime_error("Integer division by zero");
+        }
+        // INT64_MIN / -1 is the only overflowing small case
+        if (!a.fBig && !b.fBig && !(a.fSmall == std::numeric_limits<int64_t>::min() && b.fSmall == -1)) {
+            quotient = Integer(a.fSmall / b.fSmall);
+            remainder = Integer(a.fSmall % b.fSmall);
+            return;
+        }
+        BigInt q;
+        BigInt r;
+        BigInt::divMod(a.toBig(), b.toBig(), q, r);
+        quotient = fromBig(std::move(q));
+        remainder = fromBig(std::move(r));
+    }
+
+    friend Integer operator/(const Integer& a, const Integer& b) {
+        if (!a.fBig && !b.fBig && b.fSmall != 0 && b.fSmall != -1) {
+            return Integer(a.fSmall / b.fSmall);
+        }
+        Integer q;
+        Integer r;
+        divMod(a, b, q, r);
+        return q;
+    }
+
+    friend Integer operator%(const Integer& a, const Integer& b) {
+        if (!a.fBig && !b.fBig && b.fSmall != 0 && b.fSmall != -1) {
+            return Integer(a.fSmall % b.fSmall);
+        }
+        Integer q;
+        Integer r;
+        divMod(a, b, q, r);
+        return r;
+    }
+
+    Integer abs() const {
+        return isNegative() ? -*this : *this;
+    }
+
+    // Non-negative greatest common divisor, gcd(0, 0) = 0
+    static Integer gcd(Integer a, Integer b) {
+        a = a.abs();
+        b = b.abs();
+        while (!b.isZero()) {
+            if (a.isSmall() && b.isSmall()) {
+                // Both non-negative int64_t: plain Euclid
+                int64_t x = a.fSmall;
+                int64_t y = b.fSmall;
+                while (y) {
+                    int64_t t = x % y;
+                    x = y;
+                    y = t;
+                }
+                return Integer(x);
+            }
+            Integer r = a % b;
+            a = std::move(b);
+            b = std::move(r);
+        }
+        return a;
+    }
+
+    static int compare(const Integer& a, const Integer& b) {
+        if (!a.fBig && !b.fBig) {
+            return a.fSmall < b.fSmall ? -1 : (a.fSmall > b.fSmall ? 1 : 0);
+        }
+        return BigInt::compare(a.toBig(), b.toBig());
+    }
+
+    friend bool operator==(const Integer& a, const Integer& b) {
+        if (!a.fBig && !b.fBig) return a.fSmall == b.fSmall;
+        return compare(a, b) == 0;
+    }
+    friend bool operator!=(const Integer& a, const Integer& b) { return !(a == b); }
+    friend bool operator<(const Integer& a, const Integer& b) { return compare(a, b) < 0; }
+    friend bool operator>(const Integer& a, const Integer& b) { return compare(a, b) > 0; }
+    friend bool operator<=(const Integer& a, const Integer& b) { return compare(a, b) <= 0; }
+    friend bool operator>=(const Integer& a, const Integer& b) { return compare(a, b) >= 0; }
+
+    friend std::ostream& operator<<(std::ostream& os, const Integer& value) {
+        return os << value.toString();
+    }
+};
+
+#endif
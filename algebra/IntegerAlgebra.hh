@@ -0,0 +1,107 @@
+#ifndef INTEGER_ALGEBRA_HH
+#define INTEGER_ALGEBRA_HH
+
+#include "SemanticAlgebra.hh"
+#include "Integer.hh"
+#include <string>
+
+/**
+ * IntegerAlgebra - Exact Integer Computation
+ * ==========================================
+ * 
+ * MATHEMATICAL FOUNDATION
+ * -----------------------
+ * IntegerAlgebra interprets the signature over ℤ without rounding or
+ * wrap-around. It is meant for index, size and stride computations, where
+ * DoubleAlgebra silently loses exactness above 2⁵³.
+ * 
+ * FORMAL STRUCTURE
+ * ----------------
+ * IntegerAlgebra = (ℤ, {op_ℤ}_{op∈Σ}, 0, =)
+ * 
+ * Where:
+ * - ℤ: Integer values (inline int64_t, BigInt beyond)
+ * - {op_ℤ}: Exact arithmetic; div and mod truncate toward zero
+ * - 0: Bottom element for fixpoint iteration
+ * - =: Convergence is exact equality (no tolerance is meaningful)
+ * 
+ * CONSTANTS
+ * ---------
+ * - integer(n): exact, the natural interpretation of ConstantOp::Integer
+ * - num(x): accepted when x is integral (exactly converted, even above 2⁶³);
+ *   a fractional real constant has no meaning in ℤ and throws
+ * 
+ * ERRORS
+ * ------
+ * Division or modulo by zero throws std::runtime_error.
+ * 
+ * PERFORMANCE
+ * -----------
+ * Values that fit in 64 bits never allocate: each operation is the native
+ * instruction plus an overflow check (see Integer.hh).
+ */
+class IntegerAlgebra : public SemanticAlgebra<Integer> {
+public:
+    Integer num(double value) const override {
+        return Integer::fromDouble(value);
+    }
+    
+    Integer integer(int64_t value) const override {
+        return Integer(value);
+    }
+    
+    Integer add(const Integer& a, const Integer& b) const override {
+        return a + b;
+    }
+    
+    Integer sub(const Integer& a, const Integer& b) const override {
+        return a - b;
+    }
+    
+    Integer mul(const Integer& a, const Integer& b) const override {
+        return a * b;
+    }
+    
+    Integer div(const Integer& a, const Integer& b) const override {
+        return a / b;
+    }
+    
+    Integer mod(const Integer& a, const Integer& b) const override {
+        return a % b;
+    }
+    
+    Integer abs(const Integer& a) const override {
+        return a.abs();
+    }
+
+    // Exact comparisons; the elementary functions have no exact values
+    Integer min(const Integer& a, const Integer& b) const override {
+        return b < a ? b : a;
+    }
+
+    Integer max(const Integer& a, const Integer& b) const override {
+        return a < b ? b : a;
+    }
+
+    // Exact test of the condition: one operand is evaluated, the other
+    // may divide by zero
+    Branch branch(const Integer& c) const override {
+        return Integer(0) < c ? Branch::Then : Branch::Else;
+    }
+
+    Integer select(const Integer& c, const Integer& a, const Integer& b) const override {
+        return Integer(0) < c ? a : b;
+    }
+    
+    // SemanticAlgebra method
+    Integer bottom() const override {
+        return Integer(0);
+    }
+    
+    // Integer sequences converge when they become stationary
+    bool isConverged(const Integer& prev, const Integer& current) const override {
+        return prev == current;
+    }
+};
+
+#endif
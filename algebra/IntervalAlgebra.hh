@@ -5,6 +5,7 @@
 #include "Interval.hh"
 #include <algorithm>
 #include <cmath>
+#include <limits>
 
 /**
  * IntervalAlgebra - Guaranteed Bounds Computation
@@ -78,6 +79,32 @@
  * - Conservative approximation: [0, max(|c|,|d|)]
  * - Exact analysis possible for special cases
  * 
+ * **Monotone functions: sqrt, exp, log, tanh, min, max**
+ * - f([a,b]) = [f(a), f(b)]; min and max bound by bound
+ * - sqrt and log drop the part of the interval outside their domain
+ *   (empty if nothing is left), log([0,b]) starts at −∞
+ * 
+ * **Periodic functions: sin, cos**
+ * - Hull of the values at the bounds, extended to 1 (−1) when the
+ *   interval contains a maximum (minimum) of the function, π/2 + 2kπ
+ *   for sin and 2kπ for cos (3π/2 + 2kπ and π + 2kπ for the minima)
+ * - [−1, 1] for intervals of width 2π or more, unbounded ones, and
+ *   bounds beyond 10⁶ where k·2π loses too many digits
+ * 
+ * **Power: [a,b]^[c,d]**
+ * - Point integer exponent n: x^n is monotone for odd n, monotone in |x|
+ *   for even n, and the reciprocal of x^−n for negative n (empty if that
+ *   contains 0, as division)
+ * - Otherwise x^y = exp(y·ln x) for x ≥ 0 (negative bases are dropped):
+ *   y·ln x is bilinear, so the extremes are at the four corners
+ * 
+ * **Conditional: select([c₁,c₂], A, B)**
+ * - A if c₁ > 0, B if c₂ ≤ 0: branch() names the one operand to evaluate
+ * - A ∪ B (hull) when [c₁,c₂] straddles 0, ∅ when it is empty
+ * 
+ * The library computes elementary functions within an ulp or so, not
+ * correctly rounded: their bounds are moved outward by one ulp.
+ * 
  * FIXPOINT COMPUTATION THEORY
  * ---------------------------
  * 
@@ -188,6 +215,67 @@
  *   [Standardization of interval arithmetic operations]
  */
 class IntervalAlgebra : public SemanticAlgebra<Interval> {
+private:
+    static constexpr double PI = 3.14159265358979323846;
+    static constexpr double TWO_PI = 6.28318530717958647692;
+    static constexpr double PERIODIC_LIMIT = 1e6;   // Beyond, sin and cos give [-1, 1]
+
+    // One ulp outward, for the results of library functions
+    static double down(double x) {
+        return std::nextafter(x, -std::numeric_limits<double>::infinity());
+    }
+
+    static double up(double x) {
+        return std::nextafter(x, std::numeric_limits<double>::infinity());
+    }
+
+    // Whether a contains phase + 2kπ for some integer k
+    static bool reaches(const Interval& a, double phase) {
+        const double k = std::ceil((a.inf - phase) / TWO_PI);
+        return phase + k * TWO_PI <= a.sup;
+    }
+
+    // sin or cos, with its maxima at top + 2kπ and minima at bottom + 2kπ
+    template<typename F>
+    static Interval periodic(const Interval& a, F f, double top, double bottom) {
+        if (a.isEmpty()) {
+            return Interval::empty();
+        }
+        if (!(a.width() < TWO_PI) || std::max(std::abs(a.inf), std::abs(a.sup)) > PERIODIC_LIMIT) {
+            return Interval(-1.0, 1.0);
+        }
+        const double x = f(a.inf);
+        const double y = f(a.sup);
+        const double lo = reaches(a, bottom) ? -1.0 : std::max(-1.0, down(std::min(x, y)));
+        const double hi = reaches(a, top) ? 1.0 : std::min(1.0, up(std::max(x, y)));
+        return Interval(lo, hi);
+    }
+
+    Interval integerPower(const Interval& a, double n) const {
+        if (n == 0.0) {
+            return Interval::point(1.0);
+        }
+        if (n < 0.0) {
+            // 1/x^|n|: unbounded on a side of a pole at 0, which div() does not allow
+            const Interval p = integerPower(a, -n);
+            if (!p.contains(0.0)) {
+                return div(Interval::point(1.0), p);
+            }
+            const double inf = std::numeric_limits<double>::infinity();
+            if (p.inf < 0.0) {
+                return Interval::universe();
+            }
+            return Interval(p.sup > 0.0 ? down(1.0 / p.sup) : inf, inf);
+        }
+        if (std::fmod(n, 2.0) != 0.0) {
+            // Odd: increasing
+            return Interval(down(std::pow(a.inf, n)), up(std::pow(a.sup, n)));
+        }
+        // Even: increasing in |x|
+        const Interval m = abs(a);
+        return Interval(std::max(0.0, down(std::pow(m.inf, n))), up(std::pow(m.sup, n)));
+    }
+
 public:
     // Basic operations from Algebra<Interval>
     
@@ -314,6 +402,94 @@ public:
         }
     }
     
+    Interval sqrt(const Interval& a) const override {
+        if (a.isEmpty() || a.sup < 0.0) {
+            return Interval::empty();
+        }
+        const double lo = a.inf > 0.0 ? std::max(0.0, down(std::sqrt(a.inf))) : 0.0;
+        return Interval(lo, up(std::sqrt(a.sup)));
+    }
+
+    Interval exp(const Interval& a) const override {
+        if (a.isEmpty()) {
+            return Interval::empty();
+        }
+        return Interval(std::max(0.0, down(std::exp(a.inf))), up(std::exp(a.sup)));
+    }
+
+    Interval log(const Interval& a) const override {
+        if (a.isEmpty() || a.sup < 0.0) {
+            return Interval::empty();
+        }
+        const double lo = a.inf > 0.0 ? down(std::log(a.inf)) : -std::numeric_limits<double>::infinity();
+        return Interval(lo, up(std::log(a.sup)));
+    }
+
+    Interval sin(const Interval& a) const override {
+        return periodic(a, [](double x) { return std::sin(x); }, PI / 2, -PI / 2);
+    }
+
+    Interval cos(const Interval& a) const override {
+        return periodic(a, [](double x) { return std::cos(x); }, 0.0, PI);
+    }
+
+    Interval tanh(const Interval& a) const override {
+        if (a.isEmpty()) {
+            return Interval::empty();
+        }
+        return Interval(std::max(-1.0, down(std::tanh(a.inf))), std::min(1.0, up(std::tanh(a.sup))));
+    }
+
+    Interval min(const Interval& a, const Interval& b) const override {
+        if (a.isEmpty() || b.isEmpty()) {
+            return Interval::empty();
+        }
+        return Interval(std::min(a.inf, b.inf), std::min(a.sup, b.sup));
+    }
+
+    Interval max(const Interval& a, const Interval& b) const override {
+        if (a.isEmpty() || b.isEmpty()) {
+            return Interval::empty();
+        }
+        return Interval(std::max(a.inf, b.inf), std::max(a.sup, b.sup));
+    }
+
+    Interval pow(const Interval& a, const Interval& b) const override {
+        if (a.isEmpty() || b.isEmpty()) {
+            return Interval::empty();
+        }
+        if (b.inf == b.sup && b.inf == std::trunc(b.inf) && std::abs(b.inf) <= 0x1p53) {
+            return integerPower(a, b.inf);
+        }
+        // Real exponents: x^y = exp(y·ln x), defined for x ≥ 0
+        const Interval base = a.intersect(Interval(0.0, std::numeric_limits<double>::infinity()));
+        if (base.isEmpty()) {
+            return Interval::empty();
+        }
+        double p[] = {std::pow(base.inf, b.inf), std::pow(base.inf, b.sup),
+                      std::pow(base.sup, b.inf), std::pow(base.sup, b.sup)};
+        return Interval(std::max(0.0, down(*std::min_element(p, p + 4))), up(*std::max_element(p, p + 4)));
+    }
+
+    Branch branch(const Interval& c) const override {
+        if (!c.isEmpty() && c.inf > 0.0) {
+            return Branch::Then;
+        }
+        if (!c.isEmpty() && c.sup <= 0.0) {
+            return Branch::Else;
+        }
+        return Branch::Both;
+    }
+
+    Interval select(const Interval& c, const Interval& a, const Interval& b) const override {
+        switch (branch(c)) {
+            case Branch::Then: return a;
+            case Branch::Else: return b;
+            case Branch::Both: break;
+        }
+        return c.isEmpty() ? Interval::empty() : a.hull(b);
+    }
+
     // SemanticAlgebra method
     Interval bottom() const override {
         // For fixpoint computation, bottom represents maximum uncertainty
@@ -0,0 +1,233 @@
+#ifndef LINEAR_SOLVER_HH
+#define LINEAR_SOLVER_HH
+
+#include <cmath>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+/**
+ * LinearSolver - Affine Forms and Linear Systems for Fixpoints
+ * ============================================================
+ *
+ * PURPOSE
+ * -------
+ * Support for the affine fast path of TreeAlgebra's fixpoint computation.
+ * When every definition of an SCC is affine in the SCC variables,
+ *   xᵢ = Σⱼ aᵢⱼ·xⱼ + bᵢ
+ * the fixpoint is the solution of the linear system (I - A)·x = b, which is
+ * computed directly instead of by Kleene iteration.
+ *
+ * AFFINE FORMS
+ * ------------
+ * AffineForm represents Σⱼ aⱼ·xⱼ + c with its terms sorted by variable
+ * index. Forms are combined linearly; anything else (the product of two
+ * non-constant forms, abs, mod, ...) is not affine and makes the caller
+ * fall back to iteration.
+ *
+ * SOLVERS
+ * -------
+ * - solveDense: Gaussian elimination with partial pivoting on a dense copy,
+ *   O(n³), for small systems.
+ * - solveSparse: Gaussian elimination on sparse rows in natural order, for
+ *   large systems. It does not pivot, which is stable when the matrix is
+ *   strictly diagonally dominant by rows. This is the case for I - A when
+ *   ||A||∞ < 1, the condition under which the caller uses the fast path.
+ *   Elimination stops when the fill-in exceeds a budget (dense coupling).
+ *
+ * Both return false instead of producing a result they cannot vouch for.
+ */
+
+struct AffineForm {
+    std::vector<std::pair<size_t, double>> terms;  // (variable, coefficient), sorted by variable
+    double constant = 0.0;
+
+    static AffineForm variable(size_t index) {
+        AffineForm form;
+        form.terms.emplace_back(index, 1.0);
+        return form;
+    }
+
+    static AffineForm value(double c) {
+        AffineForm form;
+        form.constant = c;
+        return form;
+    }
+
+    bool isConstant() const {
+        return terms.empty();
+    }
+
+    // ka·a + kb·b
+    static AffineForm combine(const AffineForm& a, double ka, const AffineForm& b, double kb) {
+        AffineForm result;
+        result.constant = ka * a.constant + kb * b.constant;
+        result.terms.reserve(a.terms.size() + b.terms.size());
+        size_t i = 0;
+        size_t j = 0;
+        while (i < a.terms.size() || j < b.terms.size()) {
+            if (j == b.terms.size() || (i < a.terms.size() && a.terms[i].first < b.terms[j].first)) {
+                result.terms.emplace_back(a.terms[i].first, ka * a.terms[i].second);
+                ++i;
+            } else if (i == a.terms.size() || b.terms[j].first < a.terms[i].first) {
+                result.terms.emplace_back(b.terms[j].first, kb * b.terms[j].second);
+                ++j;
+            } else {
+                result.terms.emplace_back(a.terms[i].first, ka * a.terms[i].second + kb * b.terms[j].second);
+                ++i;
+                ++j;
+            }
+        }
+        return result;
+    }
+
+    AffineForm scaled(double k) const {
+        AffineForm result;
+        result.constant = k * constant;
+        result.terms.reserve(terms.size());
+        for (const auto& [index, coefficient] : terms) {
+            result.terms.emplace_back(index, k * coefficient);
+        }
+        return result;
+    }
+};
+
+class LinearSystem {
+private:
+    std::vector<std::map<size_t, double>> fRows;  // Sparse rows of the matrix
+    std::vector<double> fRhs;                     // Right-hand side
+
+public:
+    explicit LinearSystem(size_t n) : fRows(n), fRhs(n, 0.0) {}
+
+    size_t size() const {
+        return fRows.size();
+    }
+
+    size_t nonZeros() const {
+        size_t count = 0;
+        for (const auto& row : fRows) {
+            count += row.size();
+        }
+        return count;
+    }
+
+    // Accumulate value into the coefficient at (row, col)
+    void add(size_t row, size_t col, double value) {
+        fRows[row][col] += value;
+    }
+
+    void setRhs(size_t row, double value) {
+        fRhs[row] = value;
+    }
+
+    // Gaussian elimination with partial pivoting, false if the matrix is singular
+    bool solveDense(std::vector<double>& x) const {
+        const size_t n = size();
+        std::vector<double> a(n * n, 0.0);
+        std::vector<double> b = fRhs;
+        for (size_t i = 0; i < n; ++i) {
+            for (const auto& [j, value] : fRows[i]) {
+                a[i * n + j] = value;
+            }
+        }
+
+        for (size_t k = 0; k < n; ++k) {
+            size_t pivot = k;
+            for (size_t i = k + 1; i < n; ++i) {
+                if (std::abs(a[i * n + k]) > std::abs(a[pivot * n + k])) {
+                    pivot = i;
+                }
+            }
+            if (a[pivot * n + k] == 0.0) {
+                return false;
+            }
+            if (pivot != k) {
+                for (size_t j = k; j < n; ++j) {
+                    std::swap(a[k * n + j], a[pivot * n + j]);
+                }
+                std::swap(b[k], b[pivot]);
+            }
+            for (size_t i = k + 1; i < n; ++i) {
+                double factor = a[i * n + k] / a[k * n + k];
+                if (factor == 0.0) continue;
+                for (size_t j = k + 1; j < n; ++j) {
+                    a[i * n + j] -= factor * a[k * n + j];
+                }
+                b[i] -= factor * b[k];
+            }
+        }
+
+        x.assign(n, 0.0);
+        for (size_t i = n; i-- > 0;) {
+            double sum = b[i];
+            for (size_t j = i + 1; j < n; ++j) {
+                sum -= a[i * n + j] * x[j];
+            }
+            x[i] = sum / a[i * n + i];
+        }
+        return true;
+    }
+
+    // Sparse Gaussian elimination without pivoting (diagonally dominant
+    // matrices), false on a zero pivot or when more than fillBudget new
+    // entries would be created
+    bool solveSparse(std::vector<double>& x, size_t fillBudget) const {
+        const size_t n = size();
+        std::vector<std::map<size_t, double>> rows = fRows;
+        std::vector<double> b = fRhs;
+
+        // Rows below the diagonal holding an entry in each column
+        std::vector<std::vector<size_t>> below(n);
+        for (size_t i = 0; i < n; ++i) {
+            for (const auto& entry : rows[i]) {
+                if (entry.first < i) {
+                    below[entry.first].push_back(i);
+                }
+            }
+        }
+
+        size_t fill = 0;
+        for (size_t k = 0; k < n; ++k) {
+            auto diagonal = rows[k].find(k);
+            if (diagonal == rows[k].end() || diagonal->second == 0.0) {
+                return false;
+            }
+            const double pivot = diagonal->second;
+
+            for (size_t i : below[k]) {
+                auto entry = rows[i].find(k);
+                if (entry == rows[i].end()) continue;
+                double factor = entry->second / pivot;
+                rows[i].erase(entry);
+
+                for (auto it = rows[k].upper_bound(k); it != rows[k].end(); ++it) {
+                    auto [target, inserted] = rows[i].emplace(it->first, 0.0);
+                    target->second -= factor * it->second;
+                    if (inserted) {
+                        if (++fill > fillBudget) {
+                            return false;
+                        }
+                        if (it->first < i) {
+                            below[it->first].push_back(i);
+                        }
+                    }
+                }
+                b[i] -= factor * b[k];
+            }
+        }
+
+        x.assign(n, 0.0);
+        for (size_t i = n; i-- > 0;) {
+            double sum = b[i];
+            for (auto it = rows[i].upper_bound(i); it != rows[i].end(); ++it) {
+                sum -= it->second * x[it->first];
+            }
+            x[i] = sum / rows[i].at(i);
+        }
+        return true;
+    }
+};
+
+#endif
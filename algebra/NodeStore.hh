@@ -0,0 +1,330 @@
+#ifndef NODE_STORE_HH
+#define NODE_STORE_HH
+
+#include "CompactGraph.hh"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * NodeStore - A Compact Graph in a File, Mapped by Many Processes
+ * ===============================================================
+ *
+ * PURPOSE
+ * -------
+ * Worker processes that evaluate the same large model would each build
+ * their own TreeAlgebra: N copies of the nodes in memory and N times the
+ * startup time. One process writes the model once (write()), and the
+ * others map the file read-only (open()): the pages are those of the page
+ * cache, shared by every process that maps them, and attaching costs a
+ * mmap() whatever the size of the model. A path under /dev/shm is a
+ * shared-memory segment (tmpfs) that never reaches a disk.
+ *
+ * FORMAT
+ * ------
+ * The arrays of a CompactGraph, which hold positions instead of pointers,
+ * written as they are in memory after a header:
+ *
+ *   header      "ALGNODE2", record size and byte order (checked on open),
+ *               count and offset of each section, file size
+ *   nodes       12-byte CompactNode records, operands first; a variable
+ *               holds the position of its definition, a node only
+ *               reached through select operands is flagged GUARDED
+ *   reals       constant pool of real constants (double)
+ *   integers    constant pool of integer constants (int64)
+ *   roots       positions of the roots given to write()
+ *   components  recursive ranges, then the positions of their variables
+ *   branches    then and else operands of the select nodes
+ *
+ * Sections are aligned to 8 bytes. The file is written under a temporary
+ * name then renamed, so a process opening the path sees either the old
+ * store or the new one, complete.
+ *
+ * EVALUATION
+ * ----------
+ * A NodeStore evaluates through a CompactView over the mapping, with the
+ * standard algebras, exactly as a CompactGraph does: one sweep, Kleene
+ * iteration of the recursive ranges (no affine solving, no acceleration).
+ * It has no mutable state: threads may share one.
+ *
+ * TRUST
+ * -----
+ * open() checks the header and that every section lies inside the file.
+ * verify() also checks every record (operand positions, constant indices,
+ * component ranges), reading the whole store: a store that passed it cannot
+ * make an evaluation read outside the mapping. Stores written by another
+ * program should be verified once after opening.
+ */
+
+class NodeStore {
+private:
+    static constexpr char MAGIC[8] = {'A', 'L', 'G', 'N', 'O', 'D', 'E', '2'};
+    static constexpr uint32_t ORDER_MARK = 0x01020304;
+
+    struct Section {
+        uint64_t count;
+        uint64_t offset;
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t nodeSize;
+        uint32_t byteOrder;
+        Section nodes;
+        Section reals;
+        Section integers;
+        Section roots;
+        Section components;
+        Section variables;
+        Section branches;
+        uint64_t size;
+    };
+
+    const char* fData = nullptr;
+    size_t fSize = 0;
+    const Header* fHeader = nullptr;
+
+    NodeStore(const char* data, size_t size) : fData(data), fSize(size), fHeader(reinterpret_cast<const Header*>(data)) {}
+
+    template<typename T>
+    const T* section(const Section& s) const {
+        return reinterpret_cast<const T*>(fData + s.offset);
+    }
+
+    template<typename T>
+    static void place(Section& s, size_t count, uint64_t& offset) {
+        s.count = count;
+        s.offset = offset;
+        offset += (count * sizeof(T) + 7) & ~uint64_t(7);
+    }
+
+    template<typename T>
+    static void writeSection(std::ofstream& out, const Section& s, const T* data) {
+        out.seekp(static_cast<std::streamoff>(s.offset));
+        out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(s.count * sizeof(T)));
+    }
+
+    template<typename T>
+    bool inside(const Section& s) const {
+        return s.offset % 8 == 0 && s.offset <= fSize && s.count <= (fSize - s.offset) / sizeof(T);
+    }
+
+    void unmap() {
+        if (fData) {
+            munmap(const_cast<char*>(fData), fSize);
+            fData = nullptr;
+        }
+    }
+
+public:
+    // Writes the arrays of graph to path, replacing it atomically
+    static void write(const std::string& path, const CompactGraph& graph) {
+        Header header{};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.nodeSize = sizeof(CompactNode);
+        header.byteOrder = ORDER_MARK;
+        uint64_t offset = (sizeof(Header) + 7) & ~uint64_t(7);
+        place<CompactNode>(header.nodes, graph.size(), offset);
+        place<double>(header.reals, graph.reals().size(), offset);
+        place<int64_t>(header.integers, graph.integers().size(), offset);
+        place<uint32_t>(header.roots, graph.roots().size(), offset);
+        place<CompactComponent>(header.components, graph.components().size(), offset);
+        place<uint32_t>(header.variables, graph.variables().size(), offset);
+        place<uint32_t>(header.branches, graph.branches().size(), offset);
+        header.size = offset;
+
+        const std::string temporary = path + ".tmp" + std::to_string(::getpid());
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                throw std::runtime_error("Cannot create node store " + temporary);
+            }
+            out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+            writeSection(out, header.nodes, graph.nodes().data());
+            writeSection(out, header.reals, graph.reals().data());
+            writeSection(out, header.integers, graph.integers().data());
+            writeSection(out, header.roots, graph.roots().data());
+            writeSection(out, header.components, graph.components().data());
+            writeSection(out, header.variables, graph.variables().data());
+            writeSection(out, header.branches, graph.branches().data());
+            if (header.size > sizeof(Header)) {
+                out.seekp(static_cast<std::streamoff>(header.size - 1));
+                out.put('\0');   // Padding of the last section
+            }
+            if (!out) {
+                std::remove(temporary.c_str());
+                throw std::runtime_error("Cannot write node store " + temporary);
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        if (error) {
+            std::remove(temporary.c_str());
+            throw std::runtime_error("Cannot publish node store " + path + ": " + error.message());
+        }
+    }
+
+    static void write(const std::string& path, const std::vector<std::shared_ptr<Tree>>& roots) {
+        write(path, CompactGraph(roots));
+    }
+
+    // Maps the store at path read-only. The header and the bounds of the
+    // sections are checked, not the records (see verify()).
+    static NodeStore open(const std::string& path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open node store " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Header)) {
+            ::close(fd);
+            throw std::runtime_error("Not a node store: " + path);
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map node store " + path);
+        }
+        NodeStore store(static_cast<const char*>(data), size);
+        const Header& h = *store.fHeader;
+        if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("Not a node store: " + path);
+        }
+        if (h.nodeSize != sizeof(CompactNode) || h.byteOrder != ORDER_MARK) {
+            throw std::runtime_error("Node store written for another architecture: " + path);
+        }
+        if (h.size != size || !store.inside<CompactNode>(h.nodes) || !store.inside<double>(h.reals) ||
+            !store.inside<int64_t>(h.integers) || !store.inside<uint32_t>(h.roots) ||
+            !store.inside<CompactComponent>(h.components) || !store.inside<uint32_t>(h.variables) ||
+            !store.inside<uint32_t>(h.branches) ||
+            h.nodes.count >= CompactNode::NONE) {
+            throw std::runtime_error("Truncated or corrupt node store: " + path);
+        }
+        return store;
+    }
+
+    NodeStore(NodeStore&& other) noexcept
+        : fData(std::exchange(other.fData, nullptr)), fSize(other.fSize), fHeader(other.fHeader) {}
+
+    NodeStore& operator=(NodeStore&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            fData = std::exchange(other.fData, nullptr);
+            fSize = other.fSize;
+            fHeader = other.fHeader;
+        }
+        return *this;
+    }
+
+    NodeStore(const NodeStore&) = delete;
+    NodeStore& operator=(const NodeStore&) = delete;
+
+    ~NodeStore() {
+        unmap();
+    }
+
+    // Checks every record: throws std::runtime_error on the first invalid one
+    void verify() const {
+        const CompactView v = view();
+        const size_t reals = fHeader->reals.count;
+        const size_t integers = fHeader->integers.count;
+        auto fail = [](const std::string& what, size_t at) {
+            throw std::runtime_error("Corrupt node store: " + what + " " + std::to_string(at));
+        };
+        for (size_t i = 0; i < v.nodeCount; ++i) {
+            const CompactNode& n = v.nodes[i];
+            if (n.flags & ~CompactNode::GUARDED) {
+                fail("flags of node", i);
+            }
+            switch (n.getType()) {
+                case Tree::NodeType::Num:
+                    if (n.a >= (static_cast<ConstantOp>(n.op) == ConstantOp::Integer ? integers : reals)) {
+                        fail("constant of node", i);
+                    }
+                    break;
+                case Tree::NodeType::Unary:
+                    if (n.a >= i) fail("operand of node", i);
+                    break;
+                case Tree::NodeType::Binary:
+                    if (n.a >= i || n.b >= i) fail("operand of node", i);
+                    break;
+                case Tree::NodeType::Var:
+                    if (n.a != CompactNode::NONE && n.a >= v.nodeCount) fail("definition of node", i);
+                    break;
+                case Tree::NodeType::Select:
+                    if (n.a >= i || n.b >= fHeader->branches.count / 2 ||
+                        v.branches[2 * static_cast<size_t>(n.b)] >= i || v.branches[2 * static_cast<size_t>(n.b) + 1] >= i) {
+                        fail("operand of node", i);
+                    }
+                    break;
+                default:
+                    fail("type of node", i);
+            }
+        }
+        for (size_t r = 0; r < rootCount(); ++r) {
+            if (root(r) >= v.nodeCount) fail("root", r);
+        }
+        uint32_t previous = 0;
+        for (size_t c = 0; c < v.componentCount; ++c) {
+            const CompactComponent& component = v.components[c];
+            if (component.begin < previous || component.begin > component.end || component.end > v.nodeCount ||
+                component.varsBegin > component.varsEnd || component.varsEnd > fHeader->variables.count) {
+                fail("component", c);
+            }
+            for (uint32_t k = component.varsBegin; k < component.varsEnd; ++k) {
+                const uint32_t var = v.variables[k];
+                if (var < component.begin || var >= component.end ||
+                    v.nodes[var].getType() != Tree::NodeType::Var || v.nodes[var].a == CompactNode::NONE) {
+                    fail("variable of component", c);
+                }
+            }
+            previous = component.end;
+        }
+    }
+
+    size_t size() const { return fHeader->nodes.count; }
+    size_t bytes() const { return fSize; }
+    size_t rootCount() const { return fHeader->roots.count; }
+    uint32_t root(size_t i) const { return section<uint32_t>(fHeader->roots)[i]; }
+    const CompactNode& node(size_t position) const { return section<CompactNode>(fHeader->nodes)[position]; }
+    bool hasRecursion() const { return fHeader->components.count != 0; }
+
+    CompactView view() const {
+        return CompactView{section<CompactNode>(fHeader->nodes), fHeader->nodes.count,
+                           section<double>(fHeader->reals), section<int64_t>(fHeader->integers),
+                           section<CompactComponent>(fHeader->components), fHeader->components.count,
+                           section<uint32_t>(fHeader->variables), section<uint32_t>(fHeader->branches)};
+    }
+
+    // Value of every node, by position; returns the number of fixpoint rounds
+    template<typename T>
+    size_t evaluate(const Algebra<T>& algebra, std::vector<T>& values) const {
+        return view().evaluate(algebra, values);
+    }
+
+    // Values of the roots given to write(), in their order
+    template<typename T>
+    std::vector<T> evalRoots(const Algebra<T>& algebra) const {
+        std::vector<T> values;
+        evaluate(algebra, values);
+        std::vector<T> roots;
+        roots.reserve(rootCount());
+        for (size_t r = 0; r < rootCount(); ++r) {
+            roots.push_back(values[root(r)]);
+        }
+        return roots;
+    }
+};
+
+#endif
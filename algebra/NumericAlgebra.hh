@@ -0,0 +1,367 @@
+#ifndef NUMERIC_ALGEBRA_HH
+#define NUMERIC_ALGEBRA_HH
+
+#include "SemanticAlgebra.hh"
+#include "MathKernels.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * NumericAlgebra - Floating-Point Computation at a Chosen Precision
+ * =================================================================
+ *
+ * MATHEMATICAL FOUNDATION
+ * -----------------------
+ * NumericAlgebra<T, Compute> interprets the signature over the IEEE 754
+ * format T (float, double or long double). Values are stored as T; every
+ * operation converts its operands to Compute, applies the operation there
+ * and rounds the result back to T.
+ *
+ *   NumericAlgebra<double>         DoubleAlgebra, the reference semantics
+ *   NumericAlgebra<float>          FloatAlgebra: half the memory, twice the
+ *                                  values per SIMD register
+ *   NumericAlgebra<float, double>  MixedAlgebra: float storage, double
+ *                                  arithmetic
+ *
+ * For +, -, × and ÷ the mixed algebra gives the same results as the float
+ * one (double has more than 2·24 + 2 bits, so rounding twice is innocuous);
+ * it differs where float arithmetic is not correctly rounded, fmod of
+ * operands of very different magnitudes for instance.
+ *
+ * FIXPOINT COMPUTATION
+ * --------------------
+ * - bottom() = 0
+ * - isConverged: absolute or relative difference below
+ *   NumericTraits<T>::tolerance
+ *
+ * The tolerance is scaled to the precision of T: it must stay well above
+ * the rounding noise of an iteration, which can oscillate between
+ * neighbouring values, and well below the precision expected from the
+ * result.
+ *
+ *   float         1e-5   (~84 ulps at 1.0, ε = 1.2e-7)
+ *   double        1e-10  (ε = 2.2e-16)
+ *   long double   1e-13  (ε = 1.1e-19 on x87)
+ *
+ * All instances have linear semantics, so TreeAlgebra's affine fast path
+ * and convergence acceleration apply to them (solved in double, then
+ * rounded to T and verified by the usual rounds).
+ *
+ * ELEMENTARY FUNCTIONS
+ * --------------------
+ * sqrt, exp, log, sin, cos, tanh and pow are those of <cmath> at the
+ * precision Compute; min and max return NaN when an operand is NaN.
+ *
+ * CONDITIONAL
+ * -----------
+ * A number decides select(c, a, b): branch(c) is Then for c > 0, Else
+ * otherwise (NaN included), so TreeAlgebra evaluates only the taken
+ * operand.
+ *
+ * CONTRACTION
+ * -----------
+ * mulAdd(a, b, c) and addMul(a, b, c), the fused forms a compiled Tape
+ * uses for a product read only by a sum, round twice by default, as the
+ * two operations of the tree do: a tape gives the values of the tree
+ * bit for bit (unless the compiler contracts them itself: GNU modes do on
+ * targets with FMA, -march=haswell and later, unless -ffp-contract=off).
+ * Built with Contraction::FusedMultiplyAdd, the algebra
+ * computes them with std::fma in Compute and rounds once, as a compiler
+ * contracting floating-point expressions would (-ffp-contract=fast): at
+ * least as accurate, but no longer the values of TreeAlgebra's eval().
+ *
+ * The class and its operations stay open: DoubleAlgebra derives from it,
+ * and so may user algebras that change an operation (add(), div()...) or
+ * the fixpoint parameters (bottom(), isConverged()).
+ *
+ * BATCHED OPERATIONS
+ * ------------------
+ * unary(op, a, out, n) and binary(op, a, b, out, n) apply one operation to
+ * n values, for evaluators that hold a node's values for many inputs in an
+ * array (SignalEngine's blocks, parameter sweeps). +, -, ×, ÷, abs, sqrt,
+ * min and max are exactly the scalar operations, in loops the compiler
+ * vectorizes. exp, log, sin, cos and tanh in float and double run on
+ * MathKernels: vectorized where that beats the library on the target,
+ * within 2 ulps of <cmath> but not bit-identical to the scalar
+ * operations. mod and pow stay one library call per value. The loops and
+ * kernels compute the operations of NumericAlgebra itself, whatever a
+ * subclass overrides.
+ */
+
+// Convergence tolerance of a floating-point type
+template<typename T>
+struct NumericTraits;
+
+template<>
+struct NumericTraits<float> {
+    static constexpr float tolerance = 1e-5f;
+};
+
+template<>
+struct NumericTraits<double> {
+    static constexpr double tolerance = 1e-10;
+};
+
+template<>
+struct NumericTraits<long double> {
+    static constexpr long double tolerance = 1e-13L;
+};
+
+// Whether a·b + c may be rounded once (see CONTRACTION above)
+enum class Contraction {
+    None,               // Two roundings, as the tree: exact reference semantics
+    FusedMultiplyAdd    // std::fma, one rounding
+};
+
+template<typename T, typename Compute = T>
+class NumericAlgebra : public SemanticAlgebra<T> {
+    static_assert(std::is_floating_point_v<T> && std::is_floating_point_v<Compute>,
+                  "NumericAlgebra requires floating-point types");
+
+    using UnaryOp = typename SemanticAlgebra<T>::UnaryOp;
+    using BinaryOp = typename SemanticAlgebra<T>::BinaryOp;
+    using Branch = typename SemanticAlgebra<T>::Branch;
+
+    static T round(Compute value) {
+        return static_cast<T>(value);
+    }
+
+    Contraction fContraction;
+
+    // Chunks of 8 values loaded into locals, computed, stored: the loops
+    // vectorize, and out may be one of the operands
+    static constexpr size_t CHUNK = 8;
+
+    // NaN if either operand is NaN (a when a is, else b)
+    static T minOf(T a, T b) {
+        const T m = b < a ? b : a;
+        return b != b ? b : m;
+    }
+
+    static T maxOf(T a, T b) {
+        const T m = b > a ? b : a;
+        return b != b ? b : m;
+    }
+
+    template<typename F>
+    static void each(const T* a, T* out, size_t n, F f) {
+        const size_t whole = n - n % CHUNK;
+        for (size_t i = 0; i < whole; i += CHUNK) {
+            T x[CHUNK];
+            for (size_t j = 0; j < CHUNK; ++j) x[j] = a[i + j];
+            for (size_t j = 0; j < CHUNK; ++j) x[j] = f(x[j]);
+            for (size_t j = 0; j < CHUNK; ++j) out[i + j] = x[j];
+        }
+        for (size_t i = whole; i < n; ++i) {
+            out[i] = f(a[i]);
+        }
+    }
+
+    template<typename F>
+    static void each(const T* a, const T* b, T* out, size_t n, F f) {
+        const size_t whole = n - n % CHUNK;
+        for (size_t i = 0; i < whole; i += CHUNK) {
+            T x[CHUNK], y[CHUNK];
+            for (size_t j = 0; j < CHUNK; ++j) {
+                x[j] = a[i + j];
+                y[j] = b[i + j];
+            }
+            for (size_t j = 0; j < CHUNK; ++j) x[j] = f(x[j], y[j]);
+            for (size_t j = 0; j < CHUNK; ++j) out[i + j] = x[j];
+        }
+        for (size_t i = whole; i < n; ++i) {
+            out[i] = f(a[i], b[i]);
+        }
+    }
+
+public:
+    explicit NumericAlgebra(Contraction contraction = Contraction::None) : fContraction(contraction) {}
+
+    Contraction contraction() const { return fContraction; }
+
+    T num(double value) const override {
+        return static_cast<T>(value);
+    }
+
+    T integer(int64_t value) const override {
+        return static_cast<T>(value);
+    }
+
+    T add(const T& a, const T& b) const override {
+        return round(Compute(a) + Compute(b));
+    }
+
+    T sub(const T& a, const T& b) const override {
+        return round(Compute(a) - Compute(b));
+    }
+
+    T mul(const T& a, const T& b) const override {
+        return round(Compute(a) * Compute(b));
+    }
+
+    T div(const T& a, const T& b) const override {
+        return round(Compute(a) / Compute(b));
+    }
+
+    T mod(const T& a, const T& b) const override {
+        return round(std::fmod(Compute(a), Compute(b)));
+    }
+
+    T abs(const T& a) const override {
+        return std::abs(a);
+    }
+
+    T sqrt(const T& a) const override {
+        return round(std::sqrt(Compute(a)));
+    }
+
+    T exp(const T& a) const override {
+        return round(std::exp(Compute(a)));
+    }
+
+    T log(const T& a) const override {
+        return round(std::log(Compute(a)));
+    }
+
+    T sin(const T& a) const override {
+        return round(std::sin(Compute(a)));
+    }
+
+    T cos(const T& a) const override {
+        return round(std::cos(Compute(a)));
+    }
+
+    T tanh(const T& a) const override {
+        return round(std::tanh(Compute(a)));
+    }
+
+    T min(const T& a, const T& b) const override {
+        return minOf(a, b);
+    }
+
+    T max(const T& a, const T& b) const override {
+        return maxOf(a, b);
+    }
+
+    T pow(const T& a, const T& b) const override {
+        return round(std::pow(Compute(a), Compute(b)));
+    }
+
+    Branch branch(const T& c) const override {
+        return c > T(0) ? Branch::Then : Branch::Else;
+    }
+
+    T select(const T& c, const T& a, const T& b) const override {
+        return c > T(0) ? a : b;
+    }
+
+    T mulAdd(const T& a, const T& b, const T& c) const override {
+        if (fContraction == Contraction::FusedMultiplyAdd) {
+            return round(std::fma(Compute(a), Compute(b), Compute(c)));
+        }
+        return add(mul(a, b), c);
+    }
+
+    T addMul(const T& a, const T& b, const T& c) const override {
+        if (fContraction == Contraction::FusedMultiplyAdd) {
+            return round(std::fma(Compute(b), Compute(c), Compute(a)));
+        }
+        return add(a, mul(b, c));
+    }
+
+    // out[i] = op(a[i]) for i < n; out may be a
+    void unary(UnaryOp op, const T* a, T* out, size_t n) const {
+        constexpr bool kernels = !std::is_same_v<T, long double> && !std::is_same_v<Compute, long double>;
+        switch (op) {
+            case UnaryOp::Abs:
+                each(a, out, n, [](T x) { return std::abs(x); });
+                return;
+            case UnaryOp::Sqrt:
+                if constexpr (std::is_same_v<T, Compute> && kernels) {
+                    MathKernels::sqrt(a, out, n);   // Correctly rounded in T
+                    return;
+                }
+                break;
+            case UnaryOp::Exp:
+                if constexpr (kernels) { MathKernels::exp(a, out, n); return; }
+                break;
+            case UnaryOp::Log:
+                if constexpr (kernels) { MathKernels::log(a, out, n); return; }
+                break;
+            case UnaryOp::Sin:
+                if constexpr (kernels) { MathKernels::sin(a, out, n); return; }
+                break;
+            case UnaryOp::Cos:
+                if constexpr (kernels) { MathKernels::cos(a, out, n); return; }
+                break;
+            case UnaryOp::Tanh:
+                if constexpr (kernels) { MathKernels::tanh(a, out, n); return; }
+                break;
+            default:
+                throw std::runtime_error("Unknown unary operator");
+        }
+        // Operations without a kernel in T
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = this->unary(op, a[i]);
+        }
+    }
+
+    // out[i] = op(a[i], b[i]) for i < n; out may be a or b
+    void binary(BinaryOp op, const T* a, const T* b, T* out, size_t n) const {
+        switch (op) {
+            case BinaryOp::Add: each(a, b, out, n, [](T x, T y) { return round(Compute(x) + Compute(y)); }); break;
+            case BinaryOp::Sub: each(a, b, out, n, [](T x, T y) { return round(Compute(x) - Compute(y)); }); break;
+            case BinaryOp::Mul: each(a, b, out, n, [](T x, T y) { return round(Compute(x) * Compute(y)); }); break;
+            case BinaryOp::Div: each(a, b, out, n, [](T x, T y) { return round(Compute(x) / Compute(y)); }); break;
+            case BinaryOp::Min: each(a, b, out, n, [](T x, T y) { return minOf(x, y); }); break;
+            case BinaryOp::Max: each(a, b, out, n, [](T x, T y) { return maxOf(x, y); }); break;
+            default:
+                for (size_t i = 0; i < n; ++i) {
+                    out[i] = this->binary(op, a[i], b[i]);
+                }
+                break;
+        }
+    }
+
+    // out[i] = select(c[i], a[i], b[i]) for i < n, both operands computed;
+    // out may be any of them
+    void select(const T* c, const T* a, const T* b, T* out, size_t n) const {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = c[i] > T(0) ? a[i] : b[i];
+        }
+    }
+
+    using SemanticAlgebra<T>::unary;
+    using SemanticAlgebra<T>::binary;
+    using SemanticAlgebra<T>::select;
+
+    // SemanticAlgebra method
+    T bottom() const override {
+        return T(0);
+    }
+
+    // Absolute tolerance near zero, relative tolerance for larger values
+    bool isConverged(const T& prev, const T& current) const override {
+        const T epsilon = NumericTraits<T>::tolerance;
+        const T absDiff = std::abs(prev - current);
+        if (absDiff < epsilon) {
+            return true;
+        }
+        const T maxVal = std::max(std::abs(prev), std::abs(current));
+        return maxVal > T(0) && absDiff / maxVal < epsilon;
+    }
+
+    // Affine recursive definitions can be solved as linear systems
+    bool hasLinearSemantics() const override {
+        return true;
+    }
+};
+
+using FloatAlgebra = NumericAlgebra<float>;
+using MixedAlgebra = NumericAlgebra<float, double>;
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef PRECISION_REPORT_HH
+#define PRECISION_REPORT_HH
+
+#include "TreeAlgebra.hh"
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+/**
+ * PrecisionReport - Error Analysis of a Reduced-Precision Evaluation
+ * ==================================================================
+ *
+ * comparePrecision() evaluates the same roots in a low-precision algebra
+ * (typically FloatAlgebra) and in a reference algebra (DoubleAlgebra) and
+ * measures, root by root, the error of the low-precision result against the
+ * reference:
+ *
+ * - absolute error |low - ref|
+ * - relative error |low - ref| / |ref| (absolute error when ref = 0)
+ * - error in ulps of the low-precision type at ref: how many representable
+ *   values separate the result from the correctly rounded reference
+ *
+ * A root whose low-precision value is not finite while the reference is
+ * (overflow of float's smaller range) is counted in `overflows` and left out
+ * of the statistics; roots whose reference is not finite are skipped.
+ *
+ * The report tells whether a workload can be deployed in single precision:
+ * a few ulps on every root is rounding noise, a large maximum points at
+ * cancellation or an ill-conditioned recursion.
+ */
+
+struct PrecisionReport {
+    size_t count = 0;          // Roots compared
+    size_t overflows = 0;      // Not finite at low precision only
+    size_t skipped = 0;        // Reference not finite
+    double maxAbsError = 0.0;
+    double maxRelError = 0.0;
+    double meanRelError = 0.0;
+    double maxUlps = 0.0;
+    size_t worstRoot = 0;      // Index of the root with the largest relative error
+
+    // Decimal digits guaranteed on every compared root
+    double digits() const {
+        return maxRelError > 0.0 ? -std::log10(maxRelError) : std::numeric_limits<double>::infinity();
+    }
+
+    void print(std::ostream& os) const {
+        os << "roots compared:     " << count << std::endl
+           << "low-only overflows: " << overflows << std::endl
+           << "skipped (ref inf):  " << skipped << std::endl
+           << std::scientific << std::setprecision(3)
+           << "max abs error:      " << maxAbsError << std::endl
+           << "max rel error:      " << maxRelError << " (root " << worstRoot << ")" << std::endl
+           << "mean rel error:     " << meanRelError << std::endl
+           << std::fixed << std::setprecision(1)
+           << "max error (ulps):   " << maxUlps << std::endl
+           << "digits:             " << digits() << std::endl;
+        os << std::defaultfloat;
+    }
+};
+
+template<typename Low, typename Ref>
+PrecisionReport comparePrecision(const TreeAlgebra& alg, const std::vector<std::shared_ptr<Tree>>& roots,
+                                 const Algebra<Low>& low, const Algebra<Ref>& reference) {
+    PrecisionReport report;
+    double sumRelError = 0.0;
+    // One pass per algebra: the roots share their subterms
+    const std::vector<Ref> refs = alg.eval(roots, reference);
+    const std::vector<Low> values = alg.eval(roots, low);
+    for (size_t i = 0; i < roots.size(); ++i) {
+        const double ref = static_cast<double>(refs[i]);
+        const double value = static_cast<double>(values[i]);
+        if (!std::isfinite(ref)) {
+            report.skipped++;
+            continue;
+        }
+        if (!std::isfinite(value)) {
+            report.overflows++;
+            continue;
+        }
+
+        const double absError = std::abs(value - ref);
+        const double relError = ref != 0.0 ? absError / std::abs(ref) : absError;
+        // Spacing of Low's representable values around ref (its least normal below)
+        const double magnitude = std::max(std::abs(ref), static_cast<double>(std::numeric_limits<Low>::min()));
+        const double ulp = std::ldexp(static_cast<double>(std::numeric_limits<Low>::epsilon()),
+                                      std::ilogb(magnitude));
+
+        report.count++;
+        sumRelError += relError;
+        report.maxAbsError = std::max(report.maxAbsError, absError);
+        report.maxUlps = std::max(report.maxUlps, absError / ulp);
+        if (relError > report.maxRelError) {
+            report.maxRelError = relError;
+            report.worstRoot = i;
+        }
+    }
+    report.meanRelError = report.count ? sumRelError / static_cast<double>(report.count) : 0.0;
+    return report;
+}
+
+#endif
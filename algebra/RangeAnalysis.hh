@@ -0,0 +1,398 @@
+#ifndef RANGE_ANALYSIS_HH
+#define RANGE_ANALYSIS_HH
+
+#include "TreeAlgebra.hh"
+#include "IntervalAlgebra.hh"
+#include "SignalEngine.hh"
+#include "StronglyConnected.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+/**
+ * RangeAnalysis - Sound Value Ranges of Recursive Signal Graphs
+ * =============================================================
+ *
+ * PURPOSE
+ * -------
+ * Fixed-point formats and buffer sizes need, for every node of a signal
+ * graph, an interval containing every value the node takes over time. The
+ * fixpoint solver cannot compute them: IntervalAlgebra iterates from its
+ * [-1000, 1000] bottom until two rounds agree, which on a feedback loop
+ * that amplifies its bounds (x = 0.5*x + in) only ends at MAX_ITER. This
+ * pass annotates every node reachable from the roots in one run, by
+ * abstract interpretation with widening.
+ *
+ * SIGNAL SEMANTICS
+ * ----------------
+ * As in SignalEngine, a recursive variable and a delay tap start from
+ * silence, so their ranges always contain 0:
+ *   range(x) = hull({0}, range(definition))
+ * Inputs (undefined variables) get the range given by setInputRange(), the
+ * whole real line by default. Other variables are aliases of their
+ * definition.
+ *
+ * ALGORITHM
+ * ---------
+ * The graph is split into strongly connected components (Tarjan), analyzed
+ * in dependency order:
+ *
+ * - A non-recursive node is evaluated once from the ranges of its operands.
+ * - A recursive component starts with its variables at [0, 0] and is
+ *   iterated round by round (chaotic iteration in dependency order inside
+ *   the component). From round `wideningDelay` on, every variable is
+ *   widened: a bound that moved goes to the next threshold, or to ±∞
+ *   beyond the last one. Every cycle passes through a variable, and a bound
+ *   can only move a finite number of times, so the iteration terminates.
+ * - `narrowingPasses` decreasing rounds then intersect the variables with
+ *   their recomputed ranges, recovering bounds that widening overshot.
+ *
+ * THRESHOLDS
+ * ----------
+ * The widening thresholds are derived from the constants of the graph and
+ * the bounds of the input ranges: every magnitude c and its products by the
+ * powers of two 2^k, k = 0..64, with both signs. A gain-g feedback loop
+ * settles at a small multiple of its input bound, which is close to one of
+ * them; powers of two are also the boundaries between fixed-point formats.
+ *
+ * SOUNDNESS
+ * ---------
+ * Transfer functions are IntervalAlgebra's, except where it has no sound
+ * answer for unbounded operands: 0·∞ is 0 in products, a division or a
+ * modulo by an interval containing 0 (and any NaN bound) gives the whole
+ * line, and fmod keeps the sign of the dividend with |a mod b| < max|b|.
+ * A select keeps the range of the one operand its condition range
+ * decides, and joins both only when the condition range straddles 0.
+ *
+ * REFERENCES
+ * ----------
+ * - Cousot, P., Cousot, R. (1977) "Abstract Interpretation: A Unified Lattice
+ *   Model for Static Analysis of Programs by Construction or Approximation
+ *   of Fixpoints", POPL'77, pp. 238-252
+ * - Blanchet, B. et al. (2003) "A Static Analyzer for Large Safety-Critical
+ *   Software", PLDI'03 (widening with thresholds)
+ */
+
+struct RangeStats {
+    size_t nodes = 0;
+    size_t sccs = 0;
+    size_t recursiveSCCs = 0;
+    size_t rounds = 0;          // Rounds over recursive components, narrowing included
+    size_t widenings = 0;       // Variable bounds moved by widening
+    size_t unbounded = 0;       // Nodes whose range is not bounded
+};
+
+class RangeAnalysis {
+public:
+    size_t wideningDelay = 3;      // Plain rounds before widening starts
+    size_t narrowingPasses = 2;
+
+private:
+    std::unordered_map<Tree*, Interval> fInputRanges;
+    std::unordered_set<Tree*> fDelayed;   // Variables that start from silence
+    std::unordered_map<Tree*, size_t> fIds;
+    std::vector<Interval> fRanges;
+    std::vector<double> fThresholds;           // Sorted, both signs
+    RangeStats fStats;
+    IntervalAlgebra fIntervals;
+
+public:
+    // Range of an input (an undefined variable)
+    void setInputRange(const std::shared_ptr<Tree>& input, const Interval& range) {
+        fInputRanges[input.get()] = range;
+    }
+
+    // A non-recursive variable that starts from silence (a delay tap)
+    void setDelayed(const std::shared_ptr<Tree>& var) {
+        fDelayed.insert(var.get());
+    }
+
+    // Ranges of every node reachable from the roots
+    void analyze(const std::vector<std::shared_ptr<Tree>>& roots) {
+        std::vector<Tree*> nodes;
+        std::vector<std::vector<size_t>> operands;
+        collect(roots, nodes, operands);
+        makeThresholds(nodes);
+
+        StronglyConnectedComponents sccs = stronglyConnectedComponents(operands);
+        fStats.sccs = sccs.components.size();
+        fRanges.assign(nodes.size(), Interval::empty());
+
+        std::vector<bool> inComponent(nodes.size(), false);
+        for (size_t c = 0; c < sccs.components.size(); ++c) {
+            const auto& component = sccs.components[c];
+            if (!sccs.isRecursive(c, operands)) {
+                size_t id = component[0];
+                fRanges[id] = transfer(nodes[id], operands[id], isDelayed(nodes[id]));
+                continue;
+            }
+            fStats.recursiveSCCs++;
+            for (size_t id : component) inComponent[id] = true;
+            solveComponent(component, nodes, operands, inComponent);
+            for (size_t id : component) inComponent[id] = false;
+        }
+
+        for (const Interval& range : fRanges) {
+            if (!range.isBounded()) fStats.unbounded++;
+        }
+    }
+
+    // Inputs, delay taps and outputs of a signal program
+    void analyze(const SignalProgram& program, const std::vector<Interval>& inputRanges) {
+        for (size_t c = 0; c < program.inputs().size() && c < inputRanges.size(); ++c) {
+            setInputRange(program.inputs()[c], inputRanges[c]);
+        }
+        for (const auto& tap : program.taps()) {
+            setDelayed(tap);
+        }
+        analyze(program.outputs());
+    }
+
+    Interval range(const std::shared_ptr<Tree>& tree) const {
+        auto it = fIds.find(tree.get());
+        return it == fIds.end() ? Interval::empty() : fRanges[it->second];
+    }
+
+    const RangeStats& stats() const { return fStats; }
+    const std::vector<double>& thresholds() const { return fThresholds; }
+
+private:
+    bool isDelayed(Tree* tree) const {
+        return fDelayed.count(tree) > 0;
+    }
+
+    void collect(const std::vector<std::shared_ptr<Tree>>& roots,
+                 std::vector<Tree*>& nodes, std::vector<std::vector<size_t>>& operands) {
+        fIds.clear();
+        fStats = RangeStats();
+        std::vector<Tree*> pending;
+        auto idOf = [&](Tree* tree) {
+            auto [it, inserted] = fIds.emplace(tree, nodes.size());
+            if (inserted) {
+                nodes.push_back(tree);
+                operands.emplace_back();
+                pending.push_back(tree);
+            }
+            return it->second;
+        };
+        for (const auto& root : roots) {
+            idOf(root.get());
+        }
+        while (!pending.empty()) {
+            Tree* tree = pending.back();
+            pending.pop_back();
+            std::vector<size_t> children;
+            switch (tree->getType()) {
+                case Tree::NodeType::Num:
+                    break;
+                case Tree::NodeType::Unary:
+                    children.push_back(idOf(tree->getOperand().get()));
+                    break;
+                case Tree::NodeType::Binary:
+                    children.push_back(idOf(tree->getLeft().get()));
+                    children.push_back(idOf(tree->getRight().get()));
+                    break;
+                case Tree::NodeType::Select:
+                    children.push_back(idOf(tree->getCondition().get()));
+                    children.push_back(idOf(tree->getThen().get()));
+                    children.push_back(idOf(tree->getElse().get()));
+                    break;
+                case Tree::NodeType::Var:
+                    if (tree->getDefinition() && !fInputRanges.count(tree)) {
+                        children.push_back(idOf(tree->getDefinition().get()));
+                    }
+                    break;
+            }
+            operands[fIds[tree]] = std::move(children);
+        }
+        fStats.nodes = nodes.size();
+    }
+
+    void makeThresholds(const std::vector<Tree*>& nodes) {
+        std::vector<double> magnitudes;
+        for (Tree* tree : nodes) {
+            if (tree->getType() == Tree::NodeType::Num) {
+                magnitudes.push_back(std::abs(tree->getValue()));
+            }
+        }
+        for (const auto& [input, range] : fInputRanges) {
+            if (range.isEmpty()) continue;
+            magnitudes.push_back(std::abs(range.inf));
+            magnitudes.push_back(std::abs(range.sup));
+        }
+        std::sort(magnitudes.begin(), magnitudes.end());
+        magnitudes.erase(std::unique(magnitudes.begin(), magnitudes.end()), magnitudes.end());
+
+        fThresholds.clear();
+        fThresholds.push_back(0.0);
+        for (double c : magnitudes) {
+            if (!std::isfinite(c) || c == 0.0) continue;
+            for (int k = 0; k <= 64; ++k) {
+                double t = std::ldexp(c, k);
+                fThresholds.push_back(t);
+                fThresholds.push_back(-t);
+            }
+        }
+        std::sort(fThresholds.begin(), fThresholds.end());
+        fThresholds.erase(std::unique(fThresholds.begin(), fThresholds.end()), fThresholds.end());
+    }
+
+    // Widening with thresholds: moved bounds jump to the next threshold
+    Interval widen(const Interval& previous, const Interval& next) {
+        if (previous.isEmpty()) return next;
+        if (next.isEmpty()) return previous;
+        const double infinity = std::numeric_limits<double>::infinity();
+        double inf = previous.inf;
+        double sup = previous.sup;
+        if (next.inf < previous.inf) {
+            auto it = std::upper_bound(fThresholds.begin(), fThresholds.end(), next.inf);
+            inf = it == fThresholds.begin() ? -infinity : *std::prev(it);
+            fStats.widenings++;
+        }
+        if (next.sup > previous.sup) {
+            auto it = std::lower_bound(fThresholds.begin(), fThresholds.end(), next.sup);
+            sup = it == fThresholds.end() ? infinity : *it;
+            fStats.widenings++;
+        }
+        return Interval(inf, sup);
+    }
+
+    static Interval universe() {
+        return Interval::universe();
+    }
+
+    // Products with 0·∞ = 0
+    static Interval multiply(const Interval& a, const Interval& b) {
+        auto product = [](double x, double y) { return (x == 0.0 || y == 0.0) ? 0.0 : x * y; };
+        double p[] = {product(a.inf, b.inf), product(a.inf, b.sup), product(a.sup, b.inf), product(a.sup, b.sup)};
+        return Interval(*std::min_element(p, p + 4), *std::max_element(p, p + 4));
+    }
+
+    static Interval modulo(const Interval& a, const Interval& b) {
+        if (b.contains(0.0)) return universe();
+        const double m = std::max(std::abs(b.inf), std::abs(b.sup));
+        if (a.inf >= 0.0) return Interval(0.0, std::min(a.sup, m));
+        if (a.sup <= 0.0) return Interval(std::max(a.inf, -m), 0.0);
+        return Interval(std::max(a.inf, -m), std::min(a.sup, m));
+    }
+
+    Interval transfer(Tree* tree, const std::vector<size_t>& operands, bool delayed) const {
+        switch (tree->getType()) {
+            case Tree::NodeType::Num:
+                return Interval::point(tree->getValue());
+            case Tree::NodeType::Var: {
+                if (auto it = fInputRanges.find(tree); it != fInputRanges.end()) return it->second;
+                if (operands.empty()) return universe();
+                Interval value = fRanges[operands[0]];
+                return delayed ? value.hull(Interval::point(0.0)) : value;
+            }
+            case Tree::NodeType::Unary: {
+                const Interval& a = fRanges[operands[0]];
+                if (a.isEmpty()) return a;
+                return fIntervals.unary(static_cast<Algebra<Interval>::UnaryOp>(tree->getUnaryOp()), a);
+            }
+            case Tree::NodeType::Binary: {
+                const Interval& a = fRanges[operands[0]];
+                const Interval& b = fRanges[operands[1]];
+                if (a.isEmpty() || b.isEmpty()) return Interval::empty();
+                Interval result;
+                switch (tree->getBinaryOp()) {
+                    case BinaryOp::Mul: result = multiply(a, b); break;
+                    case BinaryOp::Div: result = b.contains(0.0) ? universe() : fIntervals.div(a, b); break;
+                    case BinaryOp::Mod: result = modulo(a, b); break;
+                    default:
+                        result = fIntervals.binary(static_cast<Algebra<Interval>::BinaryOp>(tree->getBinaryOp()), a, b);
+                        break;
+                }
+                // ∞ - ∞ and other NaN bounds
+                return result.isEmpty() ? universe() : result;
+            }
+            case Tree::NodeType::Select: {
+                const Interval& c = fRanges[operands[0]];
+                if (c.isEmpty()) return c;
+                return fIntervals.select(c, fRanges[operands[1]], fRanges[operands[2]]);
+            }
+        }
+        return universe();
+    }
+
+    void solveComponent(const std::vector<size_t>& component, const std::vector<Tree*>& nodes,
+                        const std::vector<std::vector<size_t>>& operands, const std::vector<bool>& inComponent) {
+        // Order: post-order from every variable, not crossing variables (every
+        // cycle goes through one, so this is acyclic)
+        std::vector<size_t> order;
+        std::vector<bool> placed(component.size(), false);
+        std::unordered_map<size_t, size_t> local;
+        for (size_t i = 0; i < component.size(); ++i) local[component[i]] = i;
+        auto isVar = [&](size_t id) { return nodes[id]->getType() == Tree::NodeType::Var; };
+        for (size_t root : component) {
+            if (!isVar(root) || placed[local[root]]) continue;
+            std::vector<std::pair<size_t, size_t>> stack{{root, 0}};
+            placed[local[root]] = true;
+            while (!stack.empty()) {
+                auto& [v, next] = stack.back();
+                if (next < operands[v].size()) {
+                    size_t w = operands[v][next++];
+                    if (inComponent[w] && !isVar(w) && !placed[local[w]]) {
+                        placed[local[w]] = true;
+                        stack.emplace_back(w, 0);
+                    }
+                    continue;
+                }
+                order.push_back(v);
+                stack.pop_back();
+            }
+        }
+
+        // Variables start from silence
+        for (size_t id : component) {
+            fRanges[id] = isVar(id) ? Interval::point(0.0) : Interval::empty();
+        }
+
+        // Increasing iteration with widening at the variables
+        bool changed = true;
+        for (size_t round = 0; changed; ++round) {
+            changed = false;
+            fStats.rounds++;
+            for (size_t id : order) {
+                Interval next = transfer(nodes[id], operands[id], isVar(id));
+                if (isVar(id)) {
+                    next = next.hull(fRanges[id]);
+                    if (round >= wideningDelay) {
+                        next = widen(fRanges[id], next);
+                    }
+                }
+                if (next != fRanges[id]) {
+                    fRanges[id] = next;
+                    changed = true;
+                }
+            }
+        }
+
+        // Decreasing iteration
+        for (size_t pass = 0; pass < narrowingPasses; ++pass) {
+            fStats.rounds++;
+            bool narrowed = false;
+            for (size_t id : order) {
+                Interval next = transfer(nodes[id], operands[id], isVar(id));
+                if (isVar(id)) {
+                    next = fRanges[id].intersect(next);   // Stays above the least fixpoint
+                }
+                if (next != fRanges[id]) {
+                    fRanges[id] = next;
+                    narrowed = true;
+                }
+            }
+            if (!narrowed) break;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef RATIONAL_HH
+#define RATIONAL_HH
+
+#include "Integer.hh"
+#include <cmath>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+/**
+ * Rational - Exact Rational Numbers
+ * =================================
+ *
+ * MATHEMATICAL THEORY
+ * -------------------
+ * Rational represents ℚ exactly as a fraction p/q in canonical form:
+ *   q > 0 and gcd(p, q) = 1
+ * so that two rationals are equal if and only if their numerators and
+ * denominators are. Zero is 0/1.
+ *
+ * Numerator and denominator are Integer values, so the small-value fast path
+ * applies to the common case of small fractions; they grow into BigInt only
+ * when they need to.
+ *
+ * CONVERSION FROM DOUBLE
+ * ----------------------
+ * Every finite double is a dyadic rational m·2^e, which fromDouble()
+ * converts without rounding: 0.1 becomes 3602879701896397/36028797018963968,
+ * not 1/10. Infinities and NaN have no rational value and throw.
+ *
+ * MODULO
+ * ------
+ * a mod b = a - b·trunc(a/b), the remainder of the truncated division, with
+ * the sign of a (as std::fmod and Integer's %).
+ */
+class Rational {
+private:
+    Integer fNum;
+    Integer fDen = Integer(1);
+
+    void normalize() {
+        if (fDen.isZero()) {
+            throw std::runtime_error("Rational with zero denominator");
+        }
+        if (fDen.isNegative()) {
+            fNum = -fNum;
+            fDen = -fDen;
+        }
+        Integer g = Integer::gcd(fNum, fDen);
+        if (g != Integer(1)) {
+            fNum = fNum / g;
+            fDen = fDen / g;
+        }
+    }
+
+public:
+    Rational() = default;
+    Rational(Integer value) : fNum(std::move(value)) {}
+    Rational(int64_t value) : fNum(value) {}
+    Rational(int value) : fNum(value) {}
+
+    Rational(Integer num, Integer den) : fNum(std::move(num)), fDen(std::move(den)) {
+        normalize();
+    }
+
+    // Exact value of a finite double
+    static Rational fromDouble(double value) {
+        if (!std::isfinite(value)) {
+            throw std::runtime_error("Not a rational: " + std::to_string(value));
+        }
+        if (std::trunc(value) == value) {
+            return Rational(Integer::fromDouble(value));
+        }
+        int exponent;
+        double mantissa = std::frexp(value, &exponent);  // value = mantissa·2^exponent, 0.5 ≤ |mantissa| < 1
+        Integer digits(static_cast<int64_t>(std::ldexp(mantissa, 53)));
+        exponent -= 53;
+        // Not an integer, so exponent < 0
+        return Rational(digits, Integer::powerOfTwo(static_cast<unsigned>(-exponent)));
+    }
+
+    const Integer& numerator() const { return fNum; }
+    const Integer& denominator() const { return fDen; }
+
+    bool isZero() const { return fNum.isZero(); }
+    bool isInteger() const { return fDen == Integer(1); }
+    bool isNegative() const { return fNum.isNegative(); }
+
+    double toDouble() const {
+        return fNum.toDouble() / fDen.toDouble();
+    }
+
+    std::string toString() const {
+        return isInteger() ? fNum.toString() : fNum.toString() + "/" + fDen.toString();
+    }
+
+    // Integer part, rounded toward zero
+    Integer trunc() const {
+        return fNum / fDen;
+    }
+
+    Rational operator-() const {
+        Rational result;
+        result.fNum = -fNum;
+        result.fDen = fDen;
+        return result;
+    }
+
+    friend Rational operator+(const Rational& a, const Rational& b) {
+        if (a.isInteger() && b.isInteger()) {
+            return Rational(a.fNum + b.fNum);
+        }
+        return Rational(a.fNum * b.fDen + b.fNum * a.fDen, a.fDen * b.fDen);
+    }
+
+    friend Rational operator-(const Rational& a, const Rational& b) {
+        if (a.isInteger() && b.isInteger()) {
+            return Rational(a.fNum - b.fNum);
+        }
+        return Rational(a.fNum * b.fDen - b.fNum * a.fDen, a.fDen * b.fDen);
+    }
+
+    friend Rational operator*(const Rational& a, const Rational& b) {
+        if (a.isInteger() && b.isInteger()) {
+            return Rational(a.fNum * b.fNum);
+        }
+        return Rational(a.fNum * b.fNum, a.fDen * b.fDen);
+    }
+
+    friend Rational operator/(const Rational& a, const Rational& b) {
+        if (b.isZero()) {
+            throw std::runtime_error("Rational division by zero");
+        }
+        return Rational(a.fNum * b.fDen, a.fDen * b.fNum);
+    }
+
+    // a - b·trunc(a/b)
+    friend Rational operator%(const Rational& a, const Rational& b) {
+        return a - b * Rational((a / b).trunc());
+    }
+
+    Rational abs() const {
+        return isNegative() ? -*this : *this;
+    }
+
+    friend bool operator==(const Rational& a, const Rational& b) {
+        return a.fNum == b.fNum && a.fDen == b.fDen;
+    }
+    friend bool operator!=(const Rational& a, const Rational& b) { return !(a == b); }
+    friend bool operator<(const Rational& a, const Rational& b) {
+        return a.fNum * b.fDen < b.fNum * a.fDen;  // Denominators are positive
+    }
+    friend bool operator>(const Rational& a, const Rational& b) { return b < a; }
+    friend bool operator<=(const Rational& a, const Rational& b) { return !(b < a); }
+    friend bool operator>=(const Rational& a, const Rational& b) { return !(a < b); }
+
+    friend std::ostream& operator<<(std::ostream& os, const Rational& value) {
+        return os << value.toString();
+    }
+};
+
+#endif
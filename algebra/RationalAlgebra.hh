@@ -0,0 +1,111 @@
+#ifndef RATIONAL_ALGEBRA_HH
+#define RATIONAL_ALGEBRA_HH
+
+#include "SemanticAlgebra.hh"
+#include "Rational.hh"
+
+/**
+ * RationalAlgebra - Exact Rational Computation
+ * ============================================
+ * 
+ * MATHEMATICAL FOUNDATION
+ * -----------------------
+ * RationalAlgebra interprets the signature over ℚ: +, -, × and ÷ are exact,
+ * so results do not depend on evaluation order or on the sharing of
+ * subterms, unlike their floating-point counterparts.
+ * 
+ * FORMAL STRUCTURE
+ * ----------------
+ * RationalAlgebra = (ℚ, {op_ℚ}_{op∈Σ}, 0, =)
+ * 
+ * Where:
+ * - ℚ: Canonical fractions p/q (see Rational.hh)
+ * - {op_ℚ}: Exact field operations; mod is a - b·trunc(a/b)
+ * - 0: Bottom element for fixpoint iteration
+ * - =: Convergence is exact equality
+ * 
+ * CONSTANTS
+ * ---------
+ * - integer(n): the integer n
+ * - num(x): the exact value of the double x (0.1 is 3602879701896397/2⁵⁵);
+ *   write 1/10 as div(integer(1), integer(10)) to get one tenth
+ * 
+ * FIXPOINTS
+ * ---------
+ * Kleene iteration over ℚ only stops when the sequence becomes stationary,
+ * which contracting affine recursions never do: each round adds digits to
+ * the denominators. RationalAlgebra suits non-recursive terms and recursive
+ * ones that stabilize exactly (e.g. through mod or abs).
+ * 
+ * ERRORS
+ * ------
+ * Division by zero and modulo by zero throw std::runtime_error.
+ */
+class RationalAlgebra : public SemanticAlgebra<Rational> {
+public:
+    Rational num(double value) const override {
+        return Rational::fromDouble(value);
+    }
+    
+    Rational integer(int64_t value) const override {
+        return Rational(value);
+    }
+    
+    Rational add(const Rational& a, const Rational& b) const override {
+        return a + b;
+    }
+    
+    Rational sub(const Rational& a, const Rational& b) const override {
+        return a - b;
+    }
+    
+    Rational mul(const Rational& a, const Rational& b) const override {
+        return a * b;
+    }
+    
+    Rational div(const Rational& a, const Rational& b) const override {
+        return a / b;
+    }
+    
+    Rational mod(const Rational& a, const Rational& b) const override {
+        if (b.isZero()) {
+            throw std::runtime_error("Rational modulo by zero");
+        }
+        return a % b;
+    }
+    
+    Rational abs(const Rational& a) const override {
+        return a.abs();
+    }
+
+    // Exact comparisons; the elementary functions have no exact values
+    Rational min(const Rational& a, const Rational& b) const override {
+        return b < a ? b : a;
+    }
+
+    Rational max(const Rational& a, const Rational& b) const override {
+        return a < b ? b : a;
+    }
+
+    // Exact test of the condition: one operand is evaluated, the other
+    // may divide by zero
+    Branch branch(const Rational& c) const override {
+        return Rational(0) < c ? Branch::Then : Branch::Else;
+    }
+
+    Rational select(const Rational& c, const Rational& a, const Rational& b) const override {
+        return Rational(0) < c ? a : b;
+    }
+    
+    // SemanticAlgebra method
+    Rational bottom() const override {
+        return Rational(0);
+    }
+    
+    // Rational sequences converge when they become stationary
+    bool isConverged(const Rational& prev, const Rational& current) const override {
+        return prev == current;
+    }
+};
+
+#endif
@@ -0,0 +1,429 @@
+#ifndef RESULT_CACHE_HH
+#define RESULT_CACHE_HH
+
+#include "TreeAlgebra.hh"
+#include "StructuralHash.hh"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * ResultCache - Persistent Results of Analyses, Keyed by Content
+ * ==============================================================
+ *
+ * PURPOSE
+ * -------
+ * Interval and fixpoint analyses of large models are slow, and from one
+ * run to the next most roots of a model are unchanged. The cache keeps the
+ * value of each root in a local directory, keyed by the algebra and the
+ * StructuralHash of the root (its content, definitions included): a run
+ * over an edited model only evaluates the roots whose content changed.
+ *
+ * STORAGE
+ * -------
+ * One file per algebra id in the cache directory, named by a hash of the
+ * id, is an append-only log:
+ *
+ *   header   "ALGCACH1", id length (uint32), id
+ *   record   key (2 x uint64), payload size (uint32), checksum (uint32),
+ *            evaluation time in seconds (double), payload
+ *
+ * The first lookup for an algebra maps the file in memory and indexes its
+ * records; lookups then decode values straight from the mapping, which is
+ * extended when the file has grown. A truncated or corrupt record (an
+ * interrupted run) ends the log: it is cut off and rewritten by later
+ * stores. Records are appended with one write() each, and indexed at the
+ * offset that write landed at; processes sharing a directory do not see
+ * each other's records until they reopen it. A lookup checks the key and
+ * the checksum of the record it serves.
+ *
+ * ALGEBRA IDS
+ * -----------
+ * By default the id is the demangled type of the algebra. Algebras whose
+ * results depend on parameters (a latency table, a precision) must be given
+ * an id naming them: the cache cannot tell two instances of the same type
+ * apart.
+ *
+ * VALUES
+ * ------
+ * CacheCodec<T> serializes values: trivially copyable types (double,
+ * Interval, Cost) are stored as their bytes, std::string as its
+ * characters. Other types need a specialization.
+ *
+ * STATISTICS
+ * ----------
+ * Each record keeps the time its evaluation took: stats() reports the hit
+ * rate, the time spent hashing and evaluating, and the evaluation time the
+ * hits saved.
+ */
+
+template<typename T, typename Enable = void>
+struct CacheCodec {
+    static_assert(sizeof(T) == 0, "No CacheCodec for this value type: specialize CacheCodec<T>");
+};
+
+template<typename T>
+struct CacheCodec<T, std::enable_if_t<std::is_trivially_copyable_v<T>>> {
+    static void encode(const T& value, std::string& bytes) {
+        bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    static bool decode(const char* data, size_t size, T& value) {
+        if (size != sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data, sizeof(T));
+        return true;
+    }
+};
+
+template<>
+struct CacheCodec<std::string> {
+    static void encode(const std::string& value, std::string& bytes) {
+        bytes += value;
+    }
+
+    static bool decode(const char* data, size_t size, std::string& value) {
+        value.assign(data, size);
+        return true;
+    }
+};
+
+struct ResultCacheStats {
+    size_t lookups = 0;
+    size_t hits = 0;
+    size_t stores = 0;
+    size_t bytesRead = 0;          // Payloads decoded by hits
+    size_t bytesWritten = 0;       // Records appended
+    double hashSeconds = 0.0;      // Structural hashing of the roots
+    double evalSeconds = 0.0;      // Evaluations of the misses
+    double savedSeconds = 0.0;     // Recorded evaluation time of the hits
+
+    size_t misses() const { return lookups - hits; }
+
+    double hitRate() const {
+        return lookups ? static_cast<double>(hits) / static_cast<double>(lookups) : 0.0;
+    }
+};
+
+class ResultCache {
+private:
+    static constexpr char MAGIC[8] = {'A', 'L', 'G', 'C', 'A', 'C', 'H', '1'};
+
+    struct RecordHeader {
+        uint64_t high;
+        uint64_t low;
+        uint32_t size;
+        uint32_t checksum;
+        double seconds;
+    };
+
+    struct Record {
+        size_t offset;     // Of the payload
+        uint32_t size;
+        double seconds;
+    };
+
+    struct KeyHash {
+        size_t operator()(const StructuralHash& key) const { return key.low; }
+    };
+
+    // The log of one algebra, open for reading (mapping) and appending
+    class Log {
+    private:
+        int fFd = -1;
+        const char* fData = nullptr;
+        size_t fMapped = 0;
+        size_t fSize = 0;       // Valid length of the file
+        std::unordered_map<StructuralHash, Record, KeyHash> fIndex;
+
+        void map(size_t length) {
+            unmap();
+            if (length == 0) {
+                return;
+            }
+            void* data = mmap(nullptr, length, PROT_READ, MAP_SHARED, fFd, 0);
+            if (data == MAP_FAILED) {
+                throw std::runtime_error("Cannot map the result cache file");
+            }
+            fData = static_cast<const char*>(data);
+            fMapped = length;
+        }
+
+        void unmap() {
+            if (fData) {
+                munmap(const_cast<char*>(fData), fMapped);
+                fData = nullptr;
+                fMapped = 0;
+            }
+        }
+
+        // Returns the offset the bytes were written at. O_APPEND places them at
+        // the end of the file as it is at write time, which another process may
+        // have extended since fSize was read: the offset comes from the write.
+        size_t append(const std::string& bytes) {
+            ssize_t written = ::write(fFd, bytes.data(), bytes.size());
+            if (written != static_cast<ssize_t>(bytes.size())) {
+                throw std::runtime_error("Cannot write to the result cache file");
+            }
+            off_t end = lseek(fFd, 0, SEEK_CUR);
+            if (end < 0) {
+                throw std::runtime_error("Cannot locate the result cache record");
+            }
+            fSize = std::max(fSize, static_cast<size_t>(end));
+            return static_cast<size_t>(end) - bytes.size();
+        }
+
+        // Index the records, cutting the file after the last valid one
+        void scan(const std::string& id) {
+            const size_t headerSize = sizeof(MAGIC) + sizeof(uint32_t) + id.size();
+            if (fSize < headerSize || std::memcmp(fData, MAGIC, sizeof(MAGIC)) != 0) {
+                throw std::runtime_error("Not a result cache file");
+            }
+            uint32_t idSize = 0;
+            std::memcpy(&idSize, fData + sizeof(MAGIC), sizeof(idSize));
+            if (idSize != id.size() || std::memcmp(fData + sizeof(MAGIC) + sizeof(idSize), id.data(), id.size()) != 0) {
+                throw std::runtime_error("Result cache file of another algebra: " + id);
+            }
+            size_t offset = headerSize;
+            while (offset + sizeof(RecordHeader) <= fSize) {
+                RecordHeader header;
+                std::memcpy(&header, fData + offset, sizeof(header));
+                const size_t payload = offset + sizeof(RecordHeader);
+                if (payload + header.size > fSize || checksum(fData + payload, header.size) != header.checksum) {
+                    break;
+                }
+                fIndex.emplace(StructuralHash{header.high, header.low}, Record{payload, header.size, header.seconds});
+                offset = payload + header.size;
+            }
+            if (offset < fSize) {
+                if (ftruncate(fFd, static_cast<off_t>(offset)) != 0) {
+                    throw std::runtime_error("Cannot repair the result cache file");
+                }
+                fSize = offset;
+            }
+        }
+
+    public:
+        Log(const std::string& path, const std::string& id) {
+            fFd = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+            if (fFd < 0) {
+                throw std::runtime_error("Cannot open the result cache file " + path);
+            }
+            struct stat info;
+            if (fstat(fFd, &info) != 0) {
+                ::close(fFd);
+                throw std::runtime_error("Cannot read the result cache file " + path);
+            }
+            fSize = static_cast<size_t>(info.st_size);
+            try {
+                if (fSize == 0) {
+                    std::string header(MAGIC, sizeof(MAGIC));
+                    uint32_t idSize = static_cast<uint32_t>(id.size());
+                    header.append(reinterpret_cast<const char*>(&idSize), sizeof(idSize));
+                    header += id;
+                    append(header);
+                }
+                map(fSize);
+                scan(id);
+            } catch (...) {
+                unmap();
+                ::close(fFd);
+                throw;
+            }
+        }
+
+        ~Log() {
+            unmap();
+            ::close(fFd);
+        }
+
+        Log(const Log&) = delete;
+        Log& operator=(const Log&) = delete;
+
+        size_t entries() const { return fIndex.size(); }
+        size_t bytes() const { return fSize; }
+
+        // Payload of a record, nullptr if absent
+        const char* find(const StructuralHash& key, uint32_t& size, double& seconds) {
+            auto it = fIndex.find(key);
+            if (it == fIndex.end()) {
+                return nullptr;
+            }
+            const Record& record = it->second;
+            if (record.offset + record.size > fMapped) {
+                map(fSize);   // Appended since the last mapping
+            }
+            // Check the record against its key before serving it
+            RecordHeader header;
+            std::memcpy(&header, fData + record.offset - sizeof(RecordHeader), sizeof(header));
+            if (header.high != key.high || header.low != key.low || header.size != record.size ||
+                checksum(fData + record.offset, record.size) != header.checksum) {
+                fIndex.erase(it);
+                return nullptr;
+            }
+            size = record.size;
+            seconds = record.seconds;
+            return fData + record.offset;
+        }
+
+        // Returns the bytes appended, 0 if the key was already there
+        size_t add(const StructuralHash& key, const std::string& payload, double seconds) {
+            if (fIndex.count(key)) {
+                return 0;
+            }
+            RecordHeader header{key.high, key.low, static_cast<uint32_t>(payload.size()),
+                                checksum(payload.data(), payload.size()), seconds};
+            std::string record(reinterpret_cast<const char*>(&header), sizeof(header));
+            record += payload;
+            const size_t offset = append(record) + sizeof(RecordHeader);
+            fIndex.emplace(key, Record{offset, header.size, seconds});
+            return record.size();
+        }
+    };
+
+    std::string fDirectory;
+    std::map<std::string, std::unique_ptr<Log>> fLogs;   // By algebra id
+    StructuralHasher fHasher;
+    ResultCacheStats fStats;
+
+    static uint32_t checksum(const char* data, size_t size) {
+        uint64_t h = hashMix(size);
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, sizeof(word));
+            h = hashCombine(h, word);
+        }
+        for (; i < size; ++i) {
+            h = hashCombine(h, static_cast<unsigned char>(data[i]));
+        }
+        return static_cast<uint32_t>(h);
+    }
+
+    Log& log(const std::string& algebraId) {
+        auto it = fLogs.find(algebraId);
+        if (it != fLogs.end()) {
+            return *it->second;
+        }
+        uint64_t h = hashMix(algebraId.size());
+        for (char c : algebraId) {
+            h = hashCombine(h, static_cast<unsigned char>(c));
+        }
+        const std::string name = StructuralHash{h, 0}.hex().substr(0, 16) + ".cache";
+        auto entry = std::make_unique<Log>((std::filesystem::path(fDirectory) / name).string(), algebraId);
+        return *fLogs.emplace(algebraId, std::move(entry)).first->second;
+    }
+
+    static double since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+public:
+    // Opens, or creates, the cache directory
+    explicit ResultCache(const std::string& directory) : fDirectory(directory) {
+        std::error_code error;
+        std::filesystem::create_directories(directory, error);
+        if (error || !std::filesystem::is_directory(directory)) {
+            throw std::runtime_error("Cannot create the result cache directory " + directory);
+        }
+    }
+
+    const std::string& directory() const { return fDirectory; }
+    const ResultCacheStats& stats() const { return fStats; }
+    void resetStats() { fStats = ResultCacheStats(); }
+
+    // Structural hash of a root, the key of its results
+    StructuralHash key(const TreeAlgebra& alg, const std::shared_ptr<Tree>& root) {
+        auto start = std::chrono::steady_clock::now();
+        StructuralHash h = fHasher.hash(alg, root);
+        fStats.hashSeconds += since(start);
+        return h;
+    }
+
+    template<typename T>
+    std::optional<T> lookup(const std::string& algebraId, const StructuralHash& key) {
+        fStats.lookups++;
+        uint32_t size = 0;
+        double seconds = 0.0;
+        const char* data = log(algebraId).find(key, size, seconds);
+        T value;
+        if (!data || !CacheCodec<T>::decode(data, size, value)) {
+            return std::nullopt;
+        }
+        fStats.hits++;
+        fStats.bytesRead += size;
+        fStats.savedSeconds += seconds;
+        return value;
+    }
+
+    // Keeps the first value stored under a key
+    template<typename T>
+    void store(const std::string& algebraId, const StructuralHash& key, const T& value, double seconds = 0.0) {
+        std::string payload;
+        CacheCodec<T>::encode(value, payload);
+        size_t written = log(algebraId).add(key, payload, seconds);
+        if (written) {
+            fStats.stores++;
+            fStats.bytesWritten += written;
+        }
+    }
+
+    // Value of a root: from the cache, or evaluated and stored
+    template<typename T>
+    T evaluate(const TreeAlgebra& alg, const std::shared_ptr<Tree>& root, const Algebra<T>& algebra,
+               const std::string& algebraId) {
+        const StructuralHash k = key(alg, root);
+        if (std::optional<T> cached = lookup<T>(algebraId, k)) {
+            return *cached;
+        }
+        auto start = std::chrono::steady_clock::now();
+        T value = alg.eval(root, algebra);
+        const double seconds = since(start);
+        fStats.evalSeconds += seconds;
+        store(algebraId, k, value, seconds);
+        return value;
+    }
+
+    template<typename T>
+    T evaluate(const TreeAlgebra& alg, const std::shared_ptr<Tree>& root, const Algebra<T>& algebra) {
+        return evaluate(alg, root, algebra, TreeAlgebra::typeName(algebra));
+    }
+
+    template<typename T>
+    std::vector<T> evaluate(const TreeAlgebra& alg, const std::vector<std::shared_ptr<Tree>>& roots,
+                            const Algebra<T>& algebra, const std::string& algebraId) {
+        std::vector<T> values;
+        values.reserve(roots.size());
+        for (const auto& root : roots) {
+            values.push_back(evaluate(alg, root, algebra, algebraId));
+        }
+        return values;
+    }
+
+    template<typename T>
+    std::vector<T> evaluate(const TreeAlgebra& alg, const std::vector<std::shared_ptr<Tree>>& roots,
+                            const Algebra<T>& algebra) {
+        return evaluate(alg, roots, algebra, TreeAlgebra::typeName(algebra));
+    }
+
+    // Results stored for an algebra, and the size of its file
+    size_t entries(const std::string& algebraId) { return log(algebraId).entries(); }
+    size_t fileBytes(const std::string& algebraId) { return log(algebraId).bytes(); }
+};
+
+#endif
@@ -206,6 +206,21 @@ public:
      * @return true if values are sufficiently close for termination
      */
     virtual bool isConverged(const T& prev, const T& current) const = 0;
+    
+    /**
+     * Linear Semantics - Affine Fast Path
+     * -----------------------------------
+     * True when the carrier is a floating-point type and num, add, sub, mul
+     * and div are the field operations of ℝ. Recursive definitions that are
+     * affine in their variables, such as x = 0.5·x + 0.3·y + 1, can then be
+     * solved as the linear system (I - A)·x = b instead of being iterated.
+     * 
+     * Interval or abstract domains must keep the default: their operations
+     * are not the real ones and their fixpoints are not linear solutions.
+     * 
+     * @return true if affine SCCs may be solved by linear algebra
+     */
+    virtual bool hasLinearSemantics() const { return false; }
 };
 
 #endif
\ No newline at end of file
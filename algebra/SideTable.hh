@@ -0,0 +1,131 @@
+#ifndef SIDE_TABLE_HH
+#define SIDE_TABLE_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * SideTable<T> - Per-Node Values Indexed by Node Id
+ * =================================================
+ *
+ * PURPOSE
+ * -------
+ * TreeAlgebra numbers its nodes densely as it interns them (Tree::getId()).
+ * A side table attaches one value of type T to a node through that id: a
+ * lookup is a bounds check, a stamp comparison and an array load, where a
+ * std::map keyed by Tree* costs a tree walk and a cache miss per level.
+ *
+ * EPOCHS
+ * ------
+ * Every entry carries the generation of the table that stored it, and an
+ * entry is valid only while the table is still at that generation. clear()
+ * starts a new generation, invalidating every entry in O(1) without
+ * touching the arrays. When the 32-bit generation counter wraps around,
+ * the stamps are reset once.
+ *
+ * Invalid entries keep their last value until overwritten: a table of
+ * resource-owning values (strings, big integers) holds on to them until
+ * release().
+ *
+ * MEMORY
+ * ------
+ * Arrays grow to the largest id stored (doubling), so a table costs
+ * sizeof(T) + 4 bytes per node of the TreeAlgebra, whatever the number of
+ * valid entries; bytes() reports it. Heap memory owned by the values
+ * themselves is not counted.
+ */
+
+// Type-erased interface, for the tables a TreeAlgebra keeps per algebra
+class SideTableBase {
+public:
+    virtual ~SideTableBase() = default;
+    virtual void clear() = 0;
+    virtual void release() = 0;
+    virtual size_t size() const = 0;
+    virtual size_t capacity() const = 0;
+    virtual size_t bytes() const = 0;
+};
+
+template<typename T>
+class SideTable : public SideTableBase {
+private:
+    std::vector<T> fValues;
+    std::vector<uint32_t> fStamps;
+    uint32_t fGeneration = 1;   // Stamps start at 0: nothing is valid
+    size_t fCount = 0;
+
+    void grow(size_t id) {
+        size_t capacity = fValues.size() < 64 ? 64 : fValues.size();
+        while (capacity <= id) capacity *= 2;
+        fValues.resize(capacity);
+        fStamps.resize(capacity, 0);
+    }
+
+public:
+    // Valid value of a node, nullptr if none
+    const T* find(size_t id) const {
+        return id < fStamps.size() && fStamps[id] == fGeneration ? &fValues[id] : nullptr;
+    }
+
+    bool contains(size_t id) const {
+        return find(id) != nullptr;
+    }
+
+    void set(size_t id, const T& value) {
+        if (id >= fValues.size()) {
+            grow(id);
+        }
+        if (fStamps[id] != fGeneration) {
+            fStamps[id] = fGeneration;
+            fCount++;
+        }
+        fValues[id] = value;
+    }
+
+    // Stores value unless the node already has one
+    void insert(size_t id, const T& value) {
+        if (!contains(id)) {
+            set(id, value);
+        }
+    }
+
+    // Invalidate every entry
+    void clear() override {
+        if (++fGeneration == 0) {
+            std::fill(fStamps.begin(), fStamps.end(), 0);
+            fGeneration = 1;
+        }
+        fCount = 0;
+    }
+
+    // Invalidate every entry and free the arrays
+    void release() override {
+        std::vector<T>().swap(fValues);
+        std::vector<uint32_t>().swap(fStamps);
+        fGeneration = 1;
+        fCount = 0;
+    }
+
+    // Valid entries
+    size_t size() const override { return fCount; }
+
+    // Ids the arrays can hold without growing
+    size_t capacity() const override { return fValues.size(); }
+
+    size_t bytes() const override {
+        return sizeof(*this) + fValues.capacity() * sizeof(T) + fStamps.capacity() * sizeof(uint32_t);
+    }
+};
+
+// Memory report of one side table attached to a TreeAlgebra
+struct SideTableUsage {
+    std::string algebra;    // Type of the algebra whose values it holds
+    size_t entries = 0;     // Valid entries
+    size_t capacity = 0;
+    size_t bytes = 0;
+};
+
+#endif
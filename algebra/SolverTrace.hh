@@ -0,0 +1,249 @@
+#ifndef SOLVER_TRACE_HH
+#define SOLVER_TRACE_HH
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * SolverTrace - Timeline of the Fixpoint Solver, as Chrome Trace Events
+ * =====================================================================
+ *
+ * PURPOSE
+ * -------
+ * A slow recursive model is understood by looking at the timeline of its
+ * solve: which variables were evaluated in which order, where SCCs were
+ * discovered and merged, how many rounds each fixpoint took and how fast
+ * the iterates converged. A SolverTrace given to a TreeAlgebra
+ * (setTrace()) records, for every semantic evaluation:
+ *
+ *   eval         the whole evaluation (eval() or query()), with its root
+ *   var          the evaluation of one variable, nested as the solver
+ *                recursed through the definitions
+ *   merge        a back edge merging the SCCs of the stack (instant)
+ *   spine        the compilation of an SCC into its dependent spine
+ *   solveAffine  the linear solve of an affine SCC
+ *   iterate      the iteration of an SCC: id, size, rounds, convergence
+ *   round        one round: SCC id, round number, the number of variables
+ *                that changed and the largest change (delta)
+ *   promote      the move of an SCC's results to the definitive memo
+ *
+ * SCCs are identified by the node id of their head variable (the one the
+ * solver entered them by), variables by their node id.
+ *
+ * FORMAT
+ * ------
+ * write() produces the JSON object format of the Trace Event Format, read
+ * by chrome://tracing and ui.perfetto.dev: complete events ("ph": "X")
+ * with a start and a duration in microseconds, instant events ("ph": "i"),
+ * and their arguments.
+ *
+ * DELTAS
+ * ------
+ * The delta of a round is the largest distance between the old and new
+ * values of a variable: |a - b| for floating-point values, the largest
+ * move of a bound for intervals (types with inf and sup members). Other
+ * types only report the number of changed variables.
+ *
+ * COST
+ * ----
+ * Without a trace, every hook of the solver is one test of a null
+ * pointer. With a trace, events are kept in memory until written.
+ *
+ * REFERENCES
+ * ----------
+ * - Trace Event Format, Google (2016), docs.google.com/document/d/
+ *   1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ */
+
+class SolverTrace {
+public:
+    struct Event {
+        std::string name;
+        const char* category;
+        char phase;             // 'X' complete, 'i' instant
+        double start;           // Microseconds since the trace was created
+        double duration;
+        std::string args;       // JSON members, without braces
+    };
+
+    // Arguments of an event, rendered as JSON members
+    class Args {
+    private:
+        std::string fText;
+
+        void key(const char* name) {
+            if (!fText.empty()) {
+                fText += ',';
+            }
+            fText += '"';
+            fText += name;
+            fText += "\":";
+        }
+
+    public:
+        Args& add(const char* name, uint64_t value) {
+            key(name);
+            fText += std::to_string(value);
+            return *this;
+        }
+
+        Args& add(const char* name, double value) {
+            key(name);
+            if (std::isfinite(value)) {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+                fText += buffer;
+            } else {
+                fText += "null";   // JSON has no infinities
+            }
+            return *this;
+        }
+
+        Args& add(const char* name, bool value) {
+            key(name);
+            fText += value ? "true" : "false";
+            return *this;
+        }
+
+        Args& add(const char* name, const std::string& value) {
+            key(name);
+            fText += '"';
+            fText += escape(value);
+            fText += '"';
+            return *this;
+        }
+
+        const std::string& str() const { return fText; }
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point fOrigin = Clock::now();
+    std::vector<Event> fEvents;
+
+    template<typename T, typename = void>
+    struct HasBounds : std::false_type {};
+
+    template<typename T>
+    struct HasBounds<T, std::void_t<decltype(std::declval<T>().inf), decltype(std::declval<T>().sup)>>
+        : std::true_type {};
+
+    static std::string escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+                escaped += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                escaped += buffer;
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+public:
+    // Microseconds since the trace was created: the start of an event
+    double now() const {
+        return std::chrono::duration<double, std::micro>(Clock::now() - fOrigin).count();
+    }
+
+    // An event that started at start and ends now
+    void complete(std::string name, const char* category, double start, std::string args = "") {
+        fEvents.push_back(Event{std::move(name), category, 'X', start, now() - start, std::move(args)});
+    }
+
+    void instant(std::string name, const char* category, std::string args = "") {
+        fEvents.push_back(Event{std::move(name), category, 'i', now(), 0.0, std::move(args)});
+    }
+
+    // Distance between two iterates of a variable, when T has one
+    template<typename T>
+    static std::optional<double> distance(const T& a, const T& b) {
+        if constexpr (std::is_floating_point_v<T>) {
+            if (a == b) return 0.0;   // Equal infinities
+            return static_cast<double>(std::abs(a - b));
+        } else if constexpr (HasBounds<T>::value) {
+            double d = 0.0;
+            if (a.inf != b.inf) d = std::max(d, static_cast<double>(std::abs(a.inf - b.inf)));
+            if (a.sup != b.sup) d = std::max(d, static_cast<double>(std::abs(a.sup - b.sup)));
+            return d;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    // A complete event from its construction to its destruction (exceptions
+    // included), recorded when the trace is not null
+    class Span {
+    private:
+        SolverTrace* fTrace;
+        const char* fCategory;
+        std::string fName;
+        std::string fArgs;
+        double fStart = 0.0;
+
+    public:
+        Span(SolverTrace* trace, const char* category, const char* name)
+            : fTrace(trace), fCategory(category) {
+            if (fTrace) {
+                fName = name;
+                fStart = fTrace->now();
+            }
+        }
+
+        ~Span() {
+            if (fTrace) {
+                fTrace->complete(std::move(fName), fCategory, fStart, std::move(fArgs));
+            }
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        explicit operator bool() const { return fTrace != nullptr; }
+        void rename(std::string name) { fName = std::move(name); }
+        void setArgs(std::string args) { fArgs = std::move(args); }
+    };
+
+    const std::vector<Event>& events() const { return fEvents; }
+    size_t size() const { return fEvents.size(); }
+    void clear() { fEvents.clear(); }
+
+    // Trace Event Format, JSON object form
+    void write(std::ostream& out) const {
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        char times[64];
+        for (size_t i = 0; i < fEvents.size(); ++i) {
+            const Event& e = fEvents[i];
+            out << (i ? ",\n" : "\n") << "{\"name\":\"" << escape(e.name) << "\",\"cat\":\"" << e.category
+                << "\",\"ph\":\"" << e.phase << "\",\"pid\":1,\"tid\":1";
+            if (e.phase == 'X') {
+                std::snprintf(times, sizeof(times), ",\"ts\":%.3f,\"dur\":%.3f", e.start, e.duration);
+            } else {
+                std::snprintf(times, sizeof(times), ",\"ts\":%.3f,\"s\":\"t\"", e.start);
+            }
+            out << times;
+            if (!e.args.empty()) {
+                out << ",\"args\":{" << e.args << "}";
+            }
+            out << "}";
+        }
+        out << "\n]}\n";
+    }
+};
+
+#endif
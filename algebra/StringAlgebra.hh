@@ -39,7 +39,8 @@
  * 
  * **Precedence Hierarchy**:
  * ```
- * Level 100: Numbers, Variables, Function calls (abs)
+ * Level 100: Numbers, Variables, Function calls (abs, sqrt, exp, log,
+ *            sin, cos, tanh, min, max, pow, select)
  * Level 50:  Multiplication, Division, Modulo  
  * Level 10:  Addition, Subtraction
  * ```
@@ -226,6 +227,16 @@
 class StringAlgebra : public InitialAlgebra<std::pair<std::string, int>> {
 private:
     mutable int fVarCounter = 0;  // Counter for generating unique variable names
+
+    // Function call notation: arguments never need parentheses
+    static std::pair<std::string, int> call(const char* name, const std::pair<std::string, int>& a) {
+        return {std::string(name) + "(" + a.first + ")", 100};
+    }
+
+    static std::pair<std::string, int> call(const char* name, const std::pair<std::string, int>& a,
+                                            const std::pair<std::string, int>& b) {
+        return {std::string(name) + "(" + a.first + ", " + b.first + ")", 100};
+    }
     
 public:
     std::pair<std::string, int> num(double value) const override {
@@ -234,6 +245,10 @@ public:
         return {oss.str(), 100}; // highest priority
     }
     
+    std::pair<std::string, int> integer(int64_t value) const override {
+        return {std::to_string(value), 100}; // exact digits, highest priority
+    }
+    
     std::pair<std::string, int> add(const std::pair<std::string, int>& a, 
                                     const std::pair<std::string, int>& b) const override {
         std::string result = a.first + " + " + b.first;
@@ -276,6 +291,50 @@ public:
         std::string result = "abs(" + a.first + ")";
         return {result, 100}; // highest priority (like a function call)
     }
+
+    std::pair<std::string, int> sqrt(const std::pair<std::string, int>& a) const override {
+        return call("sqrt", a);
+    }
+
+    std::pair<std::string, int> exp(const std::pair<std::string, int>& a) const override {
+        return call("exp", a);
+    }
+
+    std::pair<std::string, int> log(const std::pair<std::string, int>& a) const override {
+        return call("log", a);
+    }
+
+    std::pair<std::string, int> sin(const std::pair<std::string, int>& a) const override {
+        return call("sin", a);
+    }
+
+    std::pair<std::string, int> cos(const std::pair<std::string, int>& a) const override {
+        return call("cos", a);
+    }
+
+    std::pair<std::string, int> tanh(const std::pair<std::string, int>& a) const override {
+        return call("tanh", a);
+    }
+
+    std::pair<std::string, int> min(const std::pair<std::string, int>& a,
+                                    const std::pair<std::string, int>& b) const override {
+        return call("min", a, b);
+    }
+
+    std::pair<std::string, int> max(const std::pair<std::string, int>& a,
+                                    const std::pair<std::string, int>& b) const override {
+        return call("max", a, b);
+    }
+
+    std::pair<std::string, int> pow(const std::pair<std::string, int>& a,
+                                    const std::pair<std::string, int>& b) const override {
+        return call("pow", a, b);
+    }
+
+    std::pair<std::string, int> select(const std::pair<std::string, int>& c, const std::pair<std::string, int>& a,
+                                       const std::pair<std::string, int>& b) const override {
+        return {"select(" + c.first + ", " + a.first + ", " + b.first + ")", 100};
+    }
     
     // InitialAlgebra methods
     std::pair<std::string, int> var() const override {
@@ -0,0 +1,104 @@
+#ifndef STRONGLY_CONNECTED_HH
+#define STRONGLY_CONNECTED_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * StronglyConnected - Tarjan's Algorithm on an Explicit Graph
+ * ===========================================================
+ *
+ * TreeAlgebra discovers the SCCs of a definition system on the fly, during
+ * evaluation. Compilers and analyses that first collect the reachable nodes
+ * into a graph (signal engine, range analysis) use this explicit version
+ * instead.
+ *
+ * The graph is given by successor lists over vertices 0..n-1. Components are
+ * returned in reverse topological order: every edge u → v goes from a
+ * component to itself or to an earlier one. When edges mean "depends on",
+ * this is an evaluation order.
+ *
+ * The depth-first search is iterative, so deep graphs (long chains of
+ * definitions) do not exhaust the stack.
+ *
+ * REFERENCES
+ * ----------
+ * - Tarjan, R.E. (1972) "Depth-First Search and Linear Graph Algorithms"
+ *   SIAM Journal on Computing, 1(2), pp. 146-160
+ */
+
+struct StronglyConnectedComponents {
+    std::vector<std::vector<size_t>> components;  // Reverse topological order
+    std::vector<size_t> componentOf;              // Component index of each vertex
+
+    // A component is recursive if it has a cycle: several vertices or a self-loop
+    bool isRecursive(size_t component, const std::vector<std::vector<size_t>>& successors) const {
+        const auto& vertices = components[component];
+        if (vertices.size() > 1) {
+            return true;
+        }
+        const auto& next = successors[vertices[0]];
+        return std::find(next.begin(), next.end(), vertices[0]) != next.end();
+    }
+};
+
+inline StronglyConnectedComponents stronglyConnectedComponents(const std::vector<std::vector<size_t>>& successors) {
+    const size_t n = successors.size();
+    const size_t unvisited = static_cast<size_t>(-1);
+    std::vector<size_t> index(n, unvisited);
+    std::vector<size_t> lowlink(n, 0);
+    std::vector<bool> onStack(n, false);
+    std::vector<size_t> stack;
+    std::vector<std::pair<size_t, size_t>> frames;  // (vertex, next successor to visit)
+    size_t counter = 0;
+
+    StronglyConnectedComponents result;
+    result.componentOf.assign(n, 0);
+
+    for (size_t root = 0; root < n; ++root) {
+        if (index[root] != unvisited) continue;
+        frames.emplace_back(root, 0);
+        while (!frames.empty()) {
+            auto& [v, next] = frames.back();
+            if (next == 0) {
+                index[v] = lowlink[v] = counter++;
+                stack.push_back(v);
+                onStack[v] = true;
+            }
+            if (next < successors[v].size()) {
+                size_t w = successors[v][next++];
+                if (index[w] == unvisited) {
+                    frames.emplace_back(w, 0);
+                } else if (onStack[w]) {
+                    lowlink[v] = std::min(lowlink[v], index[w]);
+                }
+                continue;
+            }
+
+            // All successors visited: v is finished
+            const size_t finished = v;
+            frames.pop_back();
+            if (!frames.empty()) {
+                size_t parent = frames.back().first;
+                lowlink[parent] = std::min(lowlink[parent], lowlink[finished]);
+            }
+            if (lowlink[finished] == index[finished]) {
+                std::vector<size_t> component;
+                size_t w;
+                do {
+                    w = stack.back();
+                    stack.pop_back();
+                    onStack[w] = false;
+                    result.componentOf[w] = result.components.size();
+                    component.push_back(w);
+                } while (w != finished);
+                result.components.push_back(std::move(component));
+            }
+        }
+    }
+    return result;
+}
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef STRUCTURAL_HASH_HH
+#define STRUCTURAL_HASH_HH
+
+#include "TreeAlgebra.hh"
+#include "SideTable.hh"
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * StructuralHash - Content Digest of a Definition System
+ * ======================================================
+ *
+ * PURPOSE
+ * -------
+ * A result computed for a root can be reused by another process, or by a
+ * later run on an edited model, when the root means the same thing: the
+ * same operators on the same constants, and variables with the same
+ * definitions. TreeHash cannot serve as a key: it hashes operand addresses
+ * and variable indices, which change from run to run. The structural hash
+ * only depends on the content reachable from the root.
+ *
+ * DEFINITION
+ * ----------
+ * Variables are numbered in the order a depth-first walk from the root
+ * meets them (left operand first, then the definitions of the variables
+ * met, in that order). A node hashes its kind, its operator and:
+ *
+ *   constant   its bits (integer and real distinct, 0.0 = -0.0)
+ *   operator   the hashes of its operands
+ *   variable   its number in the walk, never its definition
+ *
+ * and the hash of the root combines the hash of the root node with the
+ * hashes of the definitions of its variables, in their order (an input,
+ * an undefined variable, counts as such). Cycles of definitions are thus
+ * hashed without unfolding them, and systems that only differ by the
+ * names (indices) of their variables have the same hash. Two roots
+ * sharing a subterm get the same hash for it only when the subterm has no
+ * variable: the number of a variable depends on the root.
+ *
+ * The digest has 128 bits, two 64-bit lanes mixed with different seeds, so
+ * that results can be keyed by it without checking the structure.
+ *
+ * COST
+ * ----
+ * Subterms without variables have the same hash in every root: they are
+ * hashed once and kept in a side table by node id. Ids are those of one
+ * TreeAlgebra: the table is dropped when the hasher is given the roots of
+ * another. The other subterms are hashed again for every root, in one
+ * walk over the part of the graph that depends on a variable. The walks
+ * are iterative (no recursion on deep graphs).
+ */
+
+struct StructuralHash {
+    uint64_t high = 0;
+    uint64_t low = 0;
+
+    bool operator==(const StructuralHash& other) const { return high == other.high && low == other.low; }
+    bool operator!=(const StructuralHash& other) const { return !(*this == other); }
+
+    // 32 hexadecimal digits
+    std::string hex() const {
+        static const char* digits = "0123456789abcdef";
+        std::string text(32, '0');
+        for (int i = 0; i < 16; ++i) {
+            text[15 - i] = digits[(high >> (4 * i)) & 0xf];
+            text[31 - i] = digits[(low >> (4 * i)) & 0xf];
+        }
+        return text;
+    }
+};
+
+class StructuralHasher {
+private:
+    // Hash of a node, and whether a variable is reachable from it
+    struct Entry {
+        StructuralHash hash;
+        bool closed = true;
+    };
+
+    static constexpr uint64_t SEED_HIGH = 0x243f6a8885a308d3ULL;   // Digits of pi
+    static constexpr uint64_t SEED_LOW = 0x13198a2e03707344ULL;
+
+    SideTable<StructuralHash> fClosed;   // Subterms without variables, kept across roots
+    SideTable<StructuralHash> fRoots;    // Roots hashed since the last definition change
+    uint64_t fInstance = 0;              // TreeAlgebra::instance() whose ids the tables use
+    uint64_t fEpoch = 0;                 // Its definitionEpoch() when fRoots was filled
+    SideTable<Entry> fOpen;              // Every node of the current root
+    SideTable<uint64_t> fVarNumbers;     // Variables of the current root
+    std::vector<Tree*> fVars;            // In walk order
+
+    static StructuralHash mix(const StructuralHash& h, uint64_t value) {
+        return {hashCombine(h.high, value), hashCombine(h.low, value ^ SEED_LOW)};
+    }
+
+    static StructuralHash mix(const StructuralHash& h, const StructuralHash& value) {
+        return {hashCombine(h.high, value.high), hashCombine(h.low, value.low)};
+    }
+
+    static StructuralHash start(uint64_t kind) {
+        return {hashMix(SEED_HIGH + kind), hashMix(SEED_LOW + kind)};
+    }
+
+    uint64_t varNumber(Tree* var) {
+        if (const uint64_t* number = fVarNumbers.find(var->getId())) {
+            return *number;
+        }
+        fVarNumbers.set(var->getId(), fVars.size());
+        fVars.push_back(var);
+        return fVars.size() - 1;
+    }
+
+    const Entry* known(Tree* tree) const {
+        return fOpen.find(tree->getId());
+    }
+
+    // Hash of the nodes reachable from tree without going through a
+    // variable definition, in post-order
+    Entry walk(Tree* tree) {
+        std::vector<std::pair<Tree*, bool>> stack;   // (node, operands done)
+        stack.emplace_back(tree, false);
+        while (!stack.empty()) {
+            auto [t, expanded] = stack.back();
+            if (known(t)) {
+                stack.pop_back();
+                continue;
+            }
+            if (const StructuralHash* closed = fClosed.find(t->getId())) {
+                fOpen.set(t->getId(), Entry{*closed, true});
+                stack.pop_back();
+                continue;
+            }
+            if (!expanded) {
+                stack.back().second = true;
+                // Pushed right first: the left operand is walked first
+                if (t->getType() == Tree::NodeType::Binary) {
+                    stack.emplace_back(t->getRight().get(), false);
+                    stack.emplace_back(t->getLeft().get(), false);
+                } else if (t->getType() == Tree::NodeType::Unary) {
+                    stack.emplace_back(t->getOperand().get(), false);
+                } else if (t->getType() == Tree::NodeType::Select) {
+                    stack.emplace_back(t->getElse().get(), false);
+                    stack.emplace_back(t->getThen().get(), false);
+                    stack.emplace_back(t->getCondition().get(), false);
+                } else if (t->getType() == Tree::NodeType::Var) {
+                    varNumber(t);
+                }
+                continue;
+            }
+            stack.pop_back();
+            Entry entry = node(t);
+            fOpen.set(t->getId(), entry);
+            if (entry.closed) {
+                fClosed.set(t->getId(), entry.hash);
+            }
+        }
+        return *known(tree);
+    }
+
+    // Hash of a node whose operands are hashed
+    Entry node(Tree* t) {
+        Entry entry;
+        switch (t->getType()) {
+            case Tree::NodeType::Num: {
+                if (t->getConstantOp() == ConstantOp::Integer) {
+                    entry.hash = mix(start(1), static_cast<uint64_t>(t->getInteger()));
+                } else {
+                    double value = t->getValue();
+                    uint64_t bits = 0;
+                    if (value != 0.0) {
+                        std::memcpy(&bits, &value, sizeof(bits));
+                    }
+                    entry.hash = mix(start(2), bits);
+                }
+                break;
+            }
+            case Tree::NodeType::Unary: {
+                const Entry& operand = *known(t->getOperand().get());
+                entry.hash = mix(mix(start(3), static_cast<uint64_t>(t->getUnaryOp())), operand.hash);
+                entry.closed = operand.closed;
+                break;
+            }
+            case Tree::NodeType::Binary: {
+                const Entry& left = *known(t->getLeft().get());
+                const Entry& right = *known(t->getRight().get());
+                entry.hash = mix(mix(mix(start(4), static_cast<uint64_t>(t->getBinaryOp())), left.hash), right.hash);
+                entry.closed = left.closed && right.closed;
+                break;
+            }
+            case Tree::NodeType::Var:
+                entry.hash = mix(start(5), varNumber(t));
+                entry.closed = false;
+                break;
+            case Tree::NodeType::Select: {
+                const Entry& condition = *known(t->getCondition().get());
+                const Entry& then = *known(t->getThen().get());
+                const Entry& otherwise = *known(t->getElse().get());
+                entry.hash = mix(mix(mix(start(9), condition.hash), then.hash), otherwise.hash);
+                entry.closed = condition.closed && then.closed && otherwise.closed;
+                break;
+            }
+        }
+        return entry;
+    }
+
+public:
+    // Hash of a root of alg
+    StructuralHash hash(const TreeAlgebra& alg, const std::shared_ptr<Tree>& root) {
+        if (alg.instance() != fInstance) {
+            fClosed.clear();
+            fRoots.clear();
+            fInstance = alg.instance();
+        } else if (alg.definitionEpoch() != fEpoch) {
+            fRoots.clear();
+        }
+        fEpoch = alg.definitionEpoch();
+        if (const StructuralHash* known = fRoots.find(root->getId())) {
+            return *known;
+        }
+        fOpen.clear();
+        fVarNumbers.clear();
+        fVars.clear();
+        StructuralHash h = mix(start(6), walk(root.get()).hash);
+        // Definitions in the order their variables were met; walking one
+        // may meet new variables
+        for (size_t i = 0; i < fVars.size(); ++i) {
+            auto definition = fVars[i]->getDefinition();
+            h = definition ? mix(mix(h, 7), walk(definition.get()).hash) : mix(h, 8);
+        }
+        fRoots.set(root->getId(), h);
+        return h;
+    }
+
+    // Forget the hashes of roots and of subterms without variables
+    void clear() {
+        fClosed.release();
+        fRoots.release();
+        fOpen.release();
+        fVarNumbers.release();
+        fVars.clear();
+    }
+
+    size_t bytes() const {
+        return fClosed.bytes() + fRoots.bytes() + fOpen.bytes() + fVarNumbers.bytes() + fVars.capacity() * sizeof(Tree*);
+    }
+};
+
+#endif
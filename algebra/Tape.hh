@@ -0,0 +1,537 @@
+#ifndef TAPE_HH
+#define TAPE_HH
+
+#include "CompactGraph.hh"
+#include "DoubleAlgebra.hh"
+#include "NumericAlgebra.hh"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <typeinfo>
+#include <vector>
+
+/**
+ * Tape - Straight-Line Code of an Acyclic Graph, with Peephole Passes
+ * ===================================================================
+ *
+ * PURPOSE
+ * -------
+ * A CompactGraph sweep interprets node records: it switches on the node
+ * type, then Algebra<T>::binary switches on the operator through a table
+ * of member pointers, then the algebra's virtual method runs. A Tape
+ * compiles the records of an acyclic graph once into instructions
+ *
+ *   slot[dst] = op(slot[a], slot[b], slot[c])
+ *
+ * with one opcode per operation, so an evaluation is one switch per
+ * instruction. Variables are aliases of their definitions and get no
+ * instruction. Evaluated by a NumericAlgebra<T> or a DoubleAlgebra, the
+ * opcodes call their operations directly: no virtual call is left. Any
+ * other algebra, subclasses of these included (they may replace an
+ * operation), is called through the vtable.
+ *
+ * PASSES
+ * ------
+ * TapeOptions selects the passes run after that translation:
+ *
+ * - **fuse**: superinstructions for the pairs the generated DAGs are full
+ *   of. add(mul(a, b), c) becomes MulAdd and add(c, mul(a, b)) AddMul, when
+ *   the product is read by that sum only; abs(sub(a, b)) becomes AbsDiff
+ *   on the same condition. One dispatch and one slot less per pair.
+ * - **eliminateDead**: drops the instructions whose slot no root reads,
+ *   directly or not (the products and differences fused away), and
+ *   renumbers the slots densely.
+ * - **schedule**: reorders by depth level (a node one level above its
+ *   deepest operand), stable, so that consecutive instructions are
+ *   independent and an out-of-order core overlaps their latencies,
+ *   where the post-order puts a chain of dependent operations back to
+ *   back. Off by default: it also stretches the live ranges of the
+ *   slots, which costs more cache than the overlap gains once a graph
+ *   outgrows L1 (see bench_tape).
+ * - **allocate**: register allocation of the slots. A value is live from
+ *   its instruction to its last reader (roots: to the end); walking the
+ *   code in order, the slot of a value is released right after its last
+ *   reader runs and handed to the next instruction that needs one, the
+ *   most recently released first (it is still in cache). The slot count
+ *   drops from one per instruction to the peak number of live values,
+ *   close to the width of the DAG for most orders: evaluating a large DAG
+ *   again and again then streams that working set instead of one value
+ *   per node through the cache (see bench_allocation). An instruction
+ *   may write the slot of one of its operands: the algebra's result is
+ *   computed before it is stored.
+ *
+ * SEMANTICS OF THE FUSED FORMS
+ * ----------------------------
+ * The passes never change a value. MulAdd and AddMul call the algebra's
+ * mulAdd() and addMul(), whose defaults are the two operations in the
+ * order of the tree, and AbsDiff calls sub then abs: a tape evaluated by
+ * any algebra gives what a CompactGraph sweep gives, bit for bit in
+ * floating point, the same strings in StringAlgebra. The choice of a
+ * contracted multiply-add belongs to the algebra, not to the tape: a
+ * NumericAlgebra built with Contraction::FusedMultiplyAdd rounds a·b + c
+ * once. One tape serves every algebra.
+ *
+ * LIMITS
+ * ------
+ * A select computes both of its operands, where a CompactGraph sweep
+ * computes the one its condition takes: an untaken operand that throws
+ * (an exact division by zero) makes the tape throw. Recursive
+ * definitions are rejected (std::runtime_error), as are variables
+ * without a definition: a tape is for the acyclic graphs evaluated many
+ * times, where the compilation is paid once.
+ */
+
+enum class TapeOp : uint8_t {
+    Num, Integer,                               // a = constant pool index
+    Add, Sub, Mul, Div, Mod, Min, Max, Pow,     // a, b
+    Abs, Sqrt, Exp, Log, Sin, Cos, Tanh,        // a
+    Select,                                     // a = condition, b = then, c = else
+    MulAdd,                                     // a·b + c
+    AddMul,                                     // a + b·c
+    AbsDiff                                     // |a - b|
+};
+
+struct TapeInstruction {
+    TapeOp op;
+    uint32_t dst;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+};
+
+struct TapeOptions {
+    bool fuse = true;
+    bool eliminateDead = true;
+    bool schedule = false;
+    bool allocate = true;
+};
+
+struct TapeStats {
+    size_t nodes = 0;          // Records of the compact graph
+    size_t instructions = 0;
+    size_t slots = 0;          // One per instruction, or the peak of live values once allocated
+    size_t mulAdds = 0;        // MulAdd and AddMul
+    size_t absDiffs = 0;
+    size_t eliminated = 0;     // Instructions dropped as dead
+    size_t depth = 0;          // Longest chain of dependent instructions
+    size_t width = 0;          // Most instructions on one depth level
+};
+
+class Tape {
+private:
+    std::vector<TapeInstruction> fCode;
+    std::vector<double> fReals;
+    std::vector<int64_t> fIntegers;
+    std::vector<uint32_t> fOutputs;   // Slot of every root
+    size_t fSlots = 0;
+    TapeStats fStats;
+
+public:
+    explicit Tape(const CompactGraph& graph, const TapeOptions& options = TapeOptions()) {
+        if (graph.hasRecursion()) {
+            throw std::runtime_error("Tapes need a graph without recursion");
+        }
+        fStats.nodes = graph.size();
+        lower(graph);
+        if (options.fuse) {
+            fuse();
+        }
+        if (options.eliminateDead) {
+            eliminateDead();
+        }
+        if (options.schedule) {
+            schedule();
+        }
+        renumber();
+        fStats.instructions = fCode.size();
+        std::vector<size_t> levelSizes;
+        for (uint32_t level : levels()) {
+            if (level >= levelSizes.size()) {
+                levelSizes.resize(level + 1, 0);
+            }
+            levelSizes[level]++;
+        }
+        fStats.depth = levelSizes.size();
+        fStats.width = levelSizes.empty() ? 0 : *std::max_element(levelSizes.begin(), levelSizes.end());
+        if (options.allocate) {
+            allocate();
+        }
+        fStats.slots = fSlots;
+    }
+
+    const std::vector<TapeInstruction>& code() const { return fCode; }
+    const std::vector<uint32_t>& outputs() const { return fOutputs; }
+    size_t slotCount() const { return fSlots; }
+    const TapeStats& stats() const { return fStats; }
+
+    // Runs the tape: the value of root r is then slots[outputs()[r]].
+    // slots is reused when its capacity allows.
+    template<typename T>
+    void evaluate(const Algebra<T>& algebra, std::vector<T>& slots) const {
+        slots.resize(fSlots);
+        if constexpr (std::is_floating_point_v<T>) {
+            if (isExactlyNumeric(algebra)) {
+                run(DirectNumeric<T>{static_cast<const NumericAlgebra<T>&>(algebra)}, slots.data());
+                return;
+            }
+        }
+        run(algebra, slots.data());
+    }
+
+    // Values of the roots
+    template<typename T>
+    std::vector<T> evaluate(const Algebra<T>& algebra) const {
+        std::vector<T> slots;
+        evaluate(algebra, slots);
+        std::vector<T> values;
+        values.reserve(fOutputs.size());
+        for (uint32_t slot : fOutputs) {
+            values.push_back(slots[slot]);
+        }
+        return values;
+    }
+
+private:
+    // True when the operations of algebra are those of NumericAlgebra<T>
+    template<typename T>
+    static bool isExactlyNumeric(const Algebra<T>& algebra) {
+        if (typeid(algebra) == typeid(NumericAlgebra<T>)) return true;
+        if constexpr (std::is_same_v<T, double>) {
+            return typeid(algebra) == typeid(DoubleAlgebra);   // Adds no operation
+        }
+        return false;
+    }
+
+    // The operations of NumericAlgebra<T> by qualified calls, which bypass the vtable
+    template<typename T>
+    struct DirectNumeric {
+        using Numeric = NumericAlgebra<T>;
+        const Numeric& algebra;
+
+        T num(double value) const { return algebra.Numeric::num(value); }
+        T integer(int64_t value) const { return algebra.Numeric::integer(value); }
+        T add(const T& a, const T& b) const { return algebra.Numeric::add(a, b); }
+        T sub(const T& a, const T& b) const { return algebra.Numeric::sub(a, b); }
+        T mul(const T& a, const T& b) const { return algebra.Numeric::mul(a, b); }
+        T div(const T& a, const T& b) const { return algebra.Numeric::div(a, b); }
+        T mod(const T& a, const T& b) const { return algebra.Numeric::mod(a, b); }
+        T min(const T& a, const T& b) const { return algebra.Numeric::min(a, b); }
+        T max(const T& a, const T& b) const { return algebra.Numeric::max(a, b); }
+        T pow(const T& a, const T& b) const { return algebra.Numeric::pow(a, b); }
+        T abs(const T& a) const { return algebra.Numeric::abs(a); }
+        T sqrt(const T& a) const { return algebra.Numeric::sqrt(a); }
+        T exp(const T& a) const { return algebra.Numeric::exp(a); }
+        T log(const T& a) const { return algebra.Numeric::log(a); }
+        T sin(const T& a) const { return algebra.Numeric::sin(a); }
+        T cos(const T& a) const { return algebra.Numeric::cos(a); }
+        T tanh(const T& a) const { return algebra.Numeric::tanh(a); }
+        typename Algebra<T>::Branch branch(const T& c) const { return algebra.Numeric::branch(c); }
+        T select(const T& c, const T& a, const T& b) const { return algebra.Numeric::select(c, a, b); }
+
+        // Unfused, NumericAlgebra::mulAdd() would call add() and mul() virtually
+        T mulAdd(const T& a, const T& b, const T& c) const {
+            if (algebra.contraction() == Contraction::FusedMultiplyAdd) return algebra.Numeric::mulAdd(a, b, c);
+            return add(mul(a, b), c);
+        }
+        T addMul(const T& a, const T& b, const T& c) const {
+            if (algebra.contraction() == Contraction::FusedMultiplyAdd) return algebra.Numeric::addMul(a, b, c);
+            return add(a, mul(b, c));
+        }
+    };
+
+    // A is Algebra<T> (virtual calls) or DirectNumeric<T> (direct calls)
+    template<typename A, typename T>
+    void run(const A& algebra, T* s) const {
+        for (const TapeInstruction& in : fCode) {
+            switch (in.op) {
+                case TapeOp::Num: s[in.dst] = algebra.num(fReals[in.a]); break;
+                case TapeOp::Integer: s[in.dst] = algebra.integer(fIntegers[in.a]); break;
+                case TapeOp::Add: s[in.dst] = algebra.add(s[in.a], s[in.b]); break;
+                case TapeOp::Sub: s[in.dst] = algebra.sub(s[in.a], s[in.b]); break;
+                case TapeOp::Mul: s[in.dst] = algebra.mul(s[in.a], s[in.b]); break;
+                case TapeOp::Div: s[in.dst] = algebra.div(s[in.a], s[in.b]); break;
+                case TapeOp::Mod: s[in.dst] = algebra.mod(s[in.a], s[in.b]); break;
+                case TapeOp::Min: s[in.dst] = algebra.min(s[in.a], s[in.b]); break;
+                case TapeOp::Max: s[in.dst] = algebra.max(s[in.a], s[in.b]); break;
+                case TapeOp::Pow: s[in.dst] = algebra.pow(s[in.a], s[in.b]); break;
+                case TapeOp::Abs: s[in.dst] = algebra.abs(s[in.a]); break;
+                case TapeOp::Sqrt: s[in.dst] = algebra.sqrt(s[in.a]); break;
+                case TapeOp::Exp: s[in.dst] = algebra.exp(s[in.a]); break;
+                case TapeOp::Log: s[in.dst] = algebra.log(s[in.a]); break;
+                case TapeOp::Sin: s[in.dst] = algebra.sin(s[in.a]); break;
+                case TapeOp::Cos: s[in.dst] = algebra.cos(s[in.a]); break;
+                case TapeOp::Tanh: s[in.dst] = algebra.tanh(s[in.a]); break;
+                case TapeOp::Select:
+                    switch (algebra.branch(s[in.a])) {
+                        case Algebra<T>::Branch::Then: s[in.dst] = s[in.b]; break;
+                        case Algebra<T>::Branch::Else: s[in.dst] = s[in.c]; break;
+                        case Algebra<T>::Branch::Both: s[in.dst] = algebra.select(s[in.a], s[in.b], s[in.c]); break;
+                    }
+                    break;
+                case TapeOp::MulAdd: s[in.dst] = algebra.mulAdd(s[in.a], s[in.b], s[in.c]); break;
+                case TapeOp::AddMul: s[in.dst] = algebra.addMul(s[in.a], s[in.b], s[in.c]); break;
+                case TapeOp::AbsDiff: s[in.dst] = algebra.abs(algebra.sub(s[in.a], s[in.b])); break;
+            }
+        }
+    }
+
+    static size_t arity(TapeOp op) {
+        switch (op) {
+            case TapeOp::Num: case TapeOp::Integer:
+                return 0;
+            case TapeOp::Abs: case TapeOp::Sqrt: case TapeOp::Exp: case TapeOp::Log:
+            case TapeOp::Sin: case TapeOp::Cos: case TapeOp::Tanh:
+                return 1;
+            case TapeOp::Select: case TapeOp::MulAdd: case TapeOp::AddMul:
+                return 3;
+            default:
+                return 2;
+        }
+    }
+
+    // Calls f on every slot an instruction reads
+    template<typename F>
+    static void forOperands(TapeInstruction& in, F f) {
+        const size_t n = arity(in.op);
+        if (n > 0) f(in.a);
+        if (n > 1) f(in.b);
+        if (n > 2) f(in.c);
+    }
+
+    static TapeOp opOf(UnaryOp op) {
+        switch (op) {
+            case UnaryOp::Abs: return TapeOp::Abs;
+            case UnaryOp::Sqrt: return TapeOp::Sqrt;
+            case UnaryOp::Exp: return TapeOp::Exp;
+            case UnaryOp::Log: return TapeOp::Log;
+            case UnaryOp::Sin: return TapeOp::Sin;
+            case UnaryOp::Cos: return TapeOp::Cos;
+            case UnaryOp::Tanh: return TapeOp::Tanh;
+            default: break;
+        }
+        throw std::runtime_error("Unknown unary operator");
+    }
+
+    static TapeOp opOf(BinaryOp op) {
+        switch (op) {
+            case BinaryOp::Add: return TapeOp::Add;
+            case BinaryOp::Sub: return TapeOp::Sub;
+            case BinaryOp::Mul: return TapeOp::Mul;
+            case BinaryOp::Div: return TapeOp::Div;
+            case BinaryOp::Mod: return TapeOp::Mod;
+            case BinaryOp::Min: return TapeOp::Min;
+            case BinaryOp::Max: return TapeOp::Max;
+            case BinaryOp::Pow: return TapeOp::Pow;
+            default: break;
+        }
+        throw std::runtime_error("Unknown binary operator");
+    }
+
+    // One instruction per operator or constant record, its slot being the
+    // record's position; a variable reads the slot of its definition
+    void lower(const CompactGraph& graph) {
+        const size_t n = graph.size();
+        std::vector<uint32_t> slotOf(n, CompactNode::NONE);
+        fCode.reserve(n);
+        for (size_t p = 0; p < n; ++p) {
+            const CompactNode& node = graph.node(p);
+            const uint32_t dst = static_cast<uint32_t>(p);
+            switch (node.getType()) {
+                case Tree::NodeType::Num:
+                    if (static_cast<ConstantOp>(node.op) == ConstantOp::Integer) {
+                        fCode.push_back({TapeOp::Integer, dst, static_cast<uint32_t>(fIntegers.size()), 0, 0});
+                        fIntegers.push_back(graph.integer(node));
+                    } else {
+                        fCode.push_back({TapeOp::Num, dst, static_cast<uint32_t>(fReals.size()), 0, 0});
+                        fReals.push_back(graph.real(node));
+                    }
+                    break;
+                case Tree::NodeType::Unary:
+                    fCode.push_back({opOf(static_cast<UnaryOp>(node.op)), dst, slotOf[node.a], 0, 0});
+                    break;
+                case Tree::NodeType::Binary:
+                    fCode.push_back({opOf(static_cast<BinaryOp>(node.op)), dst, slotOf[node.a], slotOf[node.b], 0});
+                    break;
+                case Tree::NodeType::Select: {
+                    const uint32_t* branches = graph.branches().data() + 2 * static_cast<size_t>(node.b);
+                    fCode.push_back({TapeOp::Select, dst, slotOf[node.a], slotOf[branches[0]], slotOf[branches[1]]});
+                    break;
+                }
+                case Tree::NodeType::Var:
+                    if (node.a == CompactNode::NONE) {
+                        throw std::runtime_error("Variable " + std::to_string(node.b) + " has no definition");
+                    }
+                    slotOf[p] = slotOf[node.a];
+                    continue;
+            }
+            slotOf[p] = dst;
+        }
+        fSlots = n;
+        for (uint32_t root : graph.roots()) {
+            fOutputs.push_back(slotOf[root]);
+        }
+    }
+
+    // Readers of every slot, roots counting as one
+    std::vector<uint32_t> uses() {
+        std::vector<uint32_t> count(fSlots, 0);
+        for (TapeInstruction& in : fCode) {
+            forOperands(in, [&](uint32_t slot) { count[slot]++; });
+        }
+        for (uint32_t slot : fOutputs) {
+            count[slot]++;
+        }
+        return count;
+    }
+
+    void fuse() {
+        std::vector<uint32_t> count = uses();
+        std::vector<const TapeInstruction*> producer(fSlots, nullptr);
+        for (const TapeInstruction& in : fCode) {
+            producer[in.dst] = &in;
+        }
+        auto single = [&](uint32_t slot, TapeOp op) {
+            return count[slot] == 1 && producer[slot]->op == op ? producer[slot] : nullptr;
+        };
+        // The fused operand keeps its instruction (its reader is gone, so
+        // eliminateDead drops it); producers come before their readers, so
+        // rewriting in order reads operands that are not rewritten yet
+        for (TapeInstruction& in : fCode) {
+            if (in.op == TapeOp::Add) {
+                if (auto* product = single(in.a, TapeOp::Mul)) {
+                    in = {TapeOp::MulAdd, in.dst, product->a, product->b, in.b};
+                    fStats.mulAdds++;
+                } else if (auto* product = single(in.b, TapeOp::Mul)) {
+                    in = {TapeOp::AddMul, in.dst, in.a, product->a, product->b};
+                    fStats.mulAdds++;
+                }
+            } else if (in.op == TapeOp::Abs) {
+                if (auto* difference = single(in.a, TapeOp::Sub)) {
+                    in = {TapeOp::AbsDiff, in.dst, difference->a, difference->b, 0};
+                    fStats.absDiffs++;
+                }
+            }
+        }
+    }
+
+    void eliminateDead() {
+        std::vector<bool> live(fSlots, false);
+        for (uint32_t slot : fOutputs) {
+            live[slot] = true;
+        }
+        std::vector<TapeInstruction> kept;
+        kept.reserve(fCode.size());
+        for (size_t i = fCode.size(); i-- > 0;) {
+            TapeInstruction& in = fCode[i];
+            if (!live[in.dst]) {
+                fStats.eliminated++;
+                continue;
+            }
+            forOperands(in, [&](uint32_t slot) { live[slot] = true; });
+            kept.push_back(in);
+        }
+        std::reverse(kept.begin(), kept.end());
+        fCode = std::move(kept);
+    }
+
+    // Depth level of every instruction, in code order
+    std::vector<uint32_t> levels() {
+        std::vector<uint32_t> levelOf(fSlots, 0);
+        std::vector<uint32_t> result;
+        result.reserve(fCode.size());
+        for (TapeInstruction& in : fCode) {
+            uint32_t level = 0;
+            forOperands(in, [&](uint32_t slot) { level = std::max(level, levelOf[slot] + 1); });
+            levelOf[in.dst] = level;
+            result.push_back(level);
+        }
+        return result;
+    }
+
+    void schedule() {
+        const std::vector<uint32_t> levelOf = levels();
+        std::vector<size_t> order(fCode.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&](size_t x, size_t y) { return levelOf[x] < levelOf[y]; });
+        std::vector<TapeInstruction> code;
+        code.reserve(fCode.size());
+        for (size_t i : order) {
+            code.push_back(fCode[i]);
+        }
+        fCode = std::move(code);
+    }
+
+    // Slot i is written by instruction i
+    void renumber() {
+        std::vector<uint32_t> slotOf(fSlots, CompactNode::NONE);
+        for (size_t i = 0; i < fCode.size(); ++i) {
+            TapeInstruction& in = fCode[i];
+            forOperands(in, [&](uint32_t& slot) { slot = slotOf[slot]; });
+            slotOf[in.dst] = static_cast<uint32_t>(i);
+            in.dst = static_cast<uint32_t>(i);
+        }
+        for (uint32_t& slot : fOutputs) {
+            slot = slotOf[slot];
+        }
+        fSlots = fCode.size();
+    }
+
+    // After renumber(): value i is the result of instruction i
+    void allocate() {
+        const uint32_t NONE = CompactNode::NONE;
+        std::vector<uint32_t> lastUse(fCode.size(), NONE);
+        for (size_t i = 0; i < fCode.size(); ++i) {
+            forOperands(fCode[i], [&](uint32_t value) { lastUse[value] = static_cast<uint32_t>(i); });
+        }
+        std::vector<bool> isOutput(fCode.size(), false);
+        for (uint32_t value : fOutputs) {
+            isOutput[value] = true;
+        }
+        std::vector<uint32_t> slotOf(fCode.size(), NONE);
+        std::vector<uint32_t> released;   // Free slots, the last released on top
+        uint32_t slots = 0;
+        for (size_t i = 0; i < fCode.size(); ++i) {
+            TapeInstruction& in = fCode[i];
+            // Operands read for the last time free their slot, once even
+            // when read twice (mul(x, x))
+            forOperands(in, [&](uint32_t& operand) {
+                const uint32_t value = operand;
+                operand = slotOf[value];
+                if (lastUse[value] == i && !isOutput[value]) {
+                    released.push_back(operand);
+                    lastUse[value] = NONE;
+                }
+            });
+            uint32_t slot = slots;
+            if (released.empty()) {
+                slots++;
+            } else {
+                slot = released.back();
+                released.pop_back();
+            }
+            const uint32_t value = in.dst;
+            slotOf[value] = slot;
+            in.dst = slot;
+            if (lastUse[value] == NONE && !isOutput[value]) {
+                released.push_back(slot);   // Never read (dead code kept)
+            }
+        }
+        for (uint32_t& slot : fOutputs) {
+            slot = slotOf[slot];
+        }
+        fSlots = slots;
+    }
+};
+
+// Tape of the graph reachable from the roots
+inline Tape compileTape(const std::vector<std::shared_ptr<Tree>>& roots, const TapeOptions& options = TapeOptions()) {
+    return Tape(compact(roots), options);
+}
+
+#endif
@@ -0,0 +1,156 @@
+#ifndef THREAD_POOL_HH
+#define THREAD_POOL_HH
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * ThreadPool - Fixed Set of Workers for Blocking Parallel Loops
+ * =============================================================
+ *
+ * A pool of `size` threads: size - 1 workers and the calling thread, which
+ * takes part in every loop. parallelFor(begin, end, grain, body) splits
+ * [begin, end) into chunks of `grain` indices, hands them out through an
+ * atomic counter (threads that finish early take more chunks), and returns
+ * once every chunk has run: each call is a barrier. body(first, last) is
+ * called concurrently on disjoint chunks.
+ *
+ * A loop of at most `grain` indices, or any loop on a pool of one thread,
+ * runs inline without waking the workers. Workers sleep on a condition
+ * variable between loops.
+ *
+ * The first exception thrown by body is rethrown by parallelFor once the
+ * loop is over; the chunks not yet started are skipped.
+ *
+ * One loop runs at a time: parallelFor must not be called from body or
+ * from several threads at once.
+ */
+
+class ThreadPool {
+private:
+    std::vector<std::thread> fWorkers;
+    std::mutex fMutex;
+    std::condition_variable fWake;
+    std::condition_variable fDone;
+    uint64_t fGeneration = 0;   // Incremented by every loop handed to the workers
+    bool fStop = false;
+
+    // Current loop, published under fMutex
+    void* fBody = nullptr;
+    void (*fInvoke)(void*, size_t, size_t) = nullptr;
+    std::atomic<size_t> fNext{0};
+    size_t fEnd = 0;
+    size_t fGrain = 1;
+    size_t fActive = 0;         // Workers still running the loop
+    std::atomic<bool> fFailed{false};
+    std::exception_ptr fError;
+
+    void runChunks() {
+        for (;;) {
+            size_t first = fNext.fetch_add(fGrain, std::memory_order_relaxed);
+            if (first >= fEnd || fFailed.load(std::memory_order_relaxed)) {
+                return;
+            }
+            try {
+                fInvoke(fBody, first, std::min(first + fGrain, fEnd));
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(fMutex);
+                if (!fError) {
+                    fError = std::current_exception();
+                }
+                fFailed.store(true, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void work() {
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(fMutex);
+                fWake.wait(lock, [&]() { return fStop || fGeneration != seen; });
+                if (fStop) {
+                    return;
+                }
+                seen = fGeneration;
+            }
+            runChunks();
+            std::lock_guard<std::mutex> lock(fMutex);
+            if (--fActive == 0) {
+                fDone.notify_one();
+            }
+        }
+    }
+
+public:
+    // size threads in all, the caller included (at least one)
+    explicit ThreadPool(size_t size = std::max(1u, std::thread::hardware_concurrency())) {
+        for (size_t i = 1; i < size; ++i) {
+            fWorkers.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            fStop = true;
+        }
+        fWake.notify_all();
+        for (auto& worker : fWorkers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return fWorkers.size() + 1; }
+
+    template<typename F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F&& body) {
+        if (begin >= end) {
+            return;
+        }
+        grain = std::max<size_t>(grain, 1);
+        if (fWorkers.empty() || end - begin <= grain) {
+            body(begin, end);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(fMutex);
+            // F is a reference type when body is an lvalue
+            using Body = std::remove_reference_t<F>;
+            fBody = const_cast<void*>(static_cast<const void*>(&body));
+            fInvoke = [](void* f, size_t first, size_t last) { (*static_cast<Body*>(f))(first, last); };
+            fNext.store(begin, std::memory_order_relaxed);
+            fEnd = end;
+            fGrain = grain;
+            fActive = fWorkers.size();
+            fFailed.store(false, std::memory_order_relaxed);
+            fError = nullptr;
+            ++fGeneration;
+        }
+        fWake.notify_all();
+        runChunks();
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(fMutex);
+            fDone.wait(lock, [&]() { return fActive == 0; });
+            error = fError;
+            fError = nullptr;
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+#endif
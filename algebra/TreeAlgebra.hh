@@ -3,10 +3,23 @@
 
 #include "InitialAlgebra.hh"
 #include "SemanticAlgebra.hh"
+#include "LinearSolver.hh"
+#include "Acceleration.hh"
+#include "SideTable.hh"
+#include "FlatHashSet.hh"
+#include "EvalProfiler.hh"
+#include "SolverTrace.hh"
+#include "DefinitionTable.hh"
+#include <algorithm>
+#include <atomic>
+#include <cxxabi.h>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <variant>
 #include <tuple>
 #include <unordered_set>
+#include <unordered_map>
 #include <functional>
 #include <stdexcept>
 #include <vector>
@@ -14,7 +27,9 @@
 #include <set>
 #include <optional>
 #include <iostream>
+#include <sstream>
 #include <type_traits>
+#include <typeinfo>
 
 /**
  * TreeAlgebra - The Canonical Initial Algebra Implementation
@@ -95,14 +110,15 @@
  * Trees are implemented as discriminated unions (std::variant):
  * 
  * ```cpp
- * Tree = Num(double)                    // Numeric constants
+ * Tree = Num(double | int64)            // Numeric constants (ConstantOp::Real | Integer)
  *      | Unary(UnaryOp, Tree)          // Unary operations  
  *      | Binary(BinaryOp, Tree, Tree)  // Binary operations
  *      | Var(int, Definition?)         // Variables with optional definitions
+ *      | Select(Tree, Tree, Tree)      // Conditional: c > 0 ? a : b
  * ```
  * 
  * This structure directly mirrors the mathematical BNF grammar:
- *   e ::= n | op₁(e) | op₂(e,e) | x
+ *   e ::= n | op₁(e) | op₂(e,e) | x | select(e,e,e)
  * 
  * EVALUATION STRATEGIES
  * ---------------------
@@ -163,8 +179,59 @@
  * **Fixpoint Iteration**:
  * - Convergence depends on semantic algebra properties
  * - SCC analysis minimizes recomputation
+ * - Rounds re-evaluate only the SCC-dependent spine (see fixpointStats())
  * - Early termination through isConverged() methods
  * 
+ * **Conditionals**:
+ * - select(c, a, b) evaluates c, asks the algebra which operand it
+ *   decides (Algebra::branch) and evaluates only that one: the untaken
+ *   branch is never visited, and never memoized. Numbers always decide,
+ *   intervals unless they straddle 0 (both are then joined)
+ * - Inside a recursive SCC, a condition that depends on the hypotheses
+ *   may change between rounds: the select stays in the spine as a lazy
+ *   step, and each round evaluates the operand its condition takes (the
+ *   other one may divide by zero). A taken operand that reaches new
+ *   variables of the SCC restarts the iteration with them. A condition
+ *   independent of the SCC is decided once, and the select is compiled as
+ *   its taken operand
+ * 
+ * **Batch Evaluation**:
+ * - eval(roots, algebra) evaluates many outputs of a model with one memo:
+ *   sub-DAGs and SCCs shared by several roots are evaluated once, where
+ *   one eval() per root starts each from an empty memo
+ * 
+ * **Import**:
+ * - import(src, roots) copies nodes built in another TreeAlgebra (say, on
+ *   a worker thread) bottom-up with a translation table indexed by source
+ *   id: every node is interned once, source variables become fresh
+ *   variables with translated definitions
+ * 
+ * **Node Ids and Side Tables**:
+ * - intern() numbers every new node densely (Tree::getId()) and records
+ *   its owner: ids are per algebra, so evaluations reject foreign nodes
+ * - The definitive memo of an evaluation is a SideTable indexed by id:
+ *   a lookup is one array load, and clearing it between evaluations is O(1)
+ * - query() keeps one side table per algebra across calls, so repeated
+ *   queries from different roots share their results; every definition
+ *   change of one of its variables (define() or Tree::setDefinition())
+ *   starts a new epoch of this algebra that invalidates them
+ * 
+ * **Snapshots**:
+ * - define() also records definitions in a copy-on-write DefinitionTable;
+ *   a TreeSnapshot (Snapshot.hh) freezes it with the node count, and
+ *   SnapshotReaders evaluate it on other threads without locks while this
+ *   algebra keeps building and defining
+ * 
+ * **Tracing**:
+ * - setTrace() records the phases of the solver (variables, SCC merges,
+ *   iteration rounds with their deltas, promotions) as Chrome trace events;
+ *   without a trace every hook is one null test
+ * 
+ * **Profiling**:
+ * - With an EvalProfiler installed on the thread, eval(), query() and
+ *   Tree::operator() count node visits and evaluations, fixpoint rounds
+ *   per SCC, and sample the time along the evaluation stack
+ * 
  * **Alpha-Equivalence**:
  * - Memoization prevents exponential blowup
  * - Hash-consing enables pointer-equality optimization
@@ -201,26 +268,43 @@ using VarOp = InitialAlgebra<std::shared_ptr<Tree>>::VarOp;
 using UnaryOp = Algebra<std::shared_ptr<Tree>>::UnaryOp;
 using BinaryOp = Algebra<std::shared_ptr<Tree>>::BinaryOp;
 
+// Name of a node in profiles: operator or value, and id
+inline std::string profileLabel(const Tree& tree);
+
 class Tree {
 public:
-    enum class NodeType { Num, Unary, Binary, Var };
+    enum class NodeType { Num, Unary, Binary, Var, Select };
     
 private:
     
     NodeType fType;
     std::variant<
-        std::pair<ConstantOp, double>,                                     // For Num (constants: real numbers, integers)
+        std::pair<ConstantOp, double>,                                     // For Num (real constants)
+        std::pair<ConstantOp, int64_t>,                                    // For Num (integer constants)
         std::pair<VarOp, int>,                                             // For Var (variable index)
         std::pair<UnaryOp, std::shared_ptr<Tree>>,                         // For Unary
-        std::tuple<BinaryOp, std::shared_ptr<Tree>, std::shared_ptr<Tree>> // For Binary
+        std::tuple<BinaryOp, std::shared_ptr<Tree>, std::shared_ptr<Tree>>, // For Binary
+        std::tuple<std::shared_ptr<Tree>, std::shared_ptr<Tree>, std::shared_ptr<Tree>> // For Select
     > fData;
     
     // Mutable field for variable definitions
     mutable std::shared_ptr<Tree> fDefinition;
     
+    // Dense id assigned by TreeAlgebra::intern, index into side tables
+    size_t fId = 0;
+    
+    // TreeAlgebra::instance() of the algebra that interned it: ids are per algebra
+    uint64_t fOwner = 0;
+    
+    // Definition counter of the owning algebra (variables only), see
+    // TreeAlgebra::definitionEpoch(). Shared: a variable may outlive it.
+    std::shared_ptr<std::atomic<uint64_t>> fEpoch;
+    
     // Private constructors - only TreeAlgebra can create Trees
     Tree(double value) : fType(NodeType::Num), fData(std::make_pair(ConstantOp::Real, value)) {}
     
+    Tree(ConstantOp op, int64_t value) : fType(NodeType::Num), fData(std::make_pair(op, value)) {}
+    
     Tree(UnaryOp op, std::shared_ptr<Tree> operand) 
         : fType(NodeType::Unary), fData(std::make_pair(op, operand)) {}
     
@@ -229,16 +313,39 @@ private:
     
     Tree(int index) : fType(NodeType::Var), fData(std::make_pair(VarOp::Index, index)), fDefinition(nullptr) {}
     
+    Tree(std::shared_ptr<Tree> condition, std::shared_ptr<Tree> then, std::shared_ptr<Tree> otherwise)
+        : fType(NodeType::Select), fData(std::make_tuple(condition, then, otherwise)) {}
+    
     friend class TreeAlgebra;
     
 public:
     // Getters for hash-consing
     NodeType getType() const { return fType; }
     
+    size_t getId() const { return fId; }
+    
+    uint64_t getOwner() const { return fOwner; }
+    
+    ConstantOp getConstantOp() const {
+        if (auto* integer = std::get_if<std::pair<ConstantOp, int64_t>>(&fData)) {
+            return integer->first;
+        }
+        return std::get<std::pair<ConstantOp, double>>(fData).first;
+    }
+    
+    // Value of a constant as a double (integer constants are converted)
     double getValue() const { 
+        if (auto* integer = std::get_if<std::pair<ConstantOp, int64_t>>(&fData)) {
+            return static_cast<double>(integer->second);
+        }
         return std::get<std::pair<ConstantOp, double>>(fData).second; 
     }
     
+    // Exact value of an integer constant
+    int64_t getInteger() const {
+        return std::get<std::pair<ConstantOp, int64_t>>(fData).second;
+    }
+    
     UnaryOp getUnaryOp() const { 
         return std::get<std::pair<UnaryOp, std::shared_ptr<Tree>>>(fData).first; 
     }
@@ -259,6 +366,19 @@ public:
         return std::get<2>(std::get<std::tuple<BinaryOp, std::shared_ptr<Tree>, std::shared_ptr<Tree>>>(fData)); 
     }
     
+    // Operands of a select: condition, value when it holds, value otherwise
+    std::shared_ptr<Tree> getCondition() const {
+        return std::get<0>(std::get<std::tuple<std::shared_ptr<Tree>, std::shared_ptr<Tree>, std::shared_ptr<Tree>>>(fData));
+    }
+    
+    std::shared_ptr<Tree> getThen() const {
+        return std::get<1>(std::get<std::tuple<std::shared_ptr<Tree>, std::shared_ptr<Tree>, std::shared_ptr<Tree>>>(fData));
+    }
+    
+    std::shared_ptr<Tree> getElse() const {
+        return std::get<2>(std::get<std::tuple<std::shared_ptr<Tree>, std::shared_ptr<Tree>, std::shared_ptr<Tree>>>(fData));
+    }
+    
     int getVarIndex() const {
         return std::get<std::pair<VarOp, int>>(fData).second;
     }
@@ -267,17 +387,28 @@ public:
         return fDefinition;
     }
     
+    // Starts a new definition epoch of the algebra that owns the variable
     void setDefinition(std::shared_ptr<Tree> def) const {
         fDefinition = def;
+        if (fEpoch) {
+            fEpoch->fetch_add(1, std::memory_order_relaxed);
+        }
     }
     
     // Evaluation operator
     template<typename T>
     T operator()(const Algebra<T>& algebra) const {
+        EvalProfiler* profiler = EvalProfiler::current();
+        if (profiler) {
+            profiler->visit(fId);
+        }
+        EvalProfiler::Frame frame(profiler, fId, [this]() { return profileLabel(*this); });
         switch(fType) {
             case NodeType::Num: {
-                auto& [constantOp, value] = std::get<std::pair<ConstantOp, double>>(fData);
-                return algebra.num(value);
+                if (getConstantOp() == ConstantOp::Integer) {
+                    return algebra.integer(getInteger());
+                }
+                return algebra.num(getValue());
             }
             case NodeType::Unary: {
                 auto& [op, operand] = std::get<std::pair<UnaryOp, std::shared_ptr<Tree>>>(fData);
@@ -287,6 +418,17 @@ public:
                 auto& [op, left, right] = std::get<std::tuple<BinaryOp, std::shared_ptr<Tree>, std::shared_ptr<Tree>>>(fData);
                 return algebra.binary(static_cast<typename Algebra<T>::BinaryOp>(op), (*left)(algebra), (*right)(algebra));
             }
+            case NodeType::Select: {
+                auto& [condition, then, otherwise] =
+                    std::get<std::tuple<std::shared_ptr<Tree>, std::shared_ptr<Tree>, std::shared_ptr<Tree>>>(fData);
+                T c = (*condition)(algebra);
+                switch (algebra.branch(c)) {
+                    case Algebra<T>::Branch::Then: return (*then)(algebra);
+                    case Algebra<T>::Branch::Else: return (*otherwise)(algebra);
+                    case Algebra<T>::Branch::Both: break;
+                }
+                return algebra.select(c, (*then)(algebra), (*otherwise)(algebra));
+            }
             case NodeType::Var: {
                 if (fDefinition) {
                     return (*fDefinition)(algebra);
@@ -300,32 +442,63 @@ public:
 };
 
 // Hash and equality functors for hash-consing
+
+// 64-bit finalizer of SplitMix64 / MurmurHash3 (Stafford's variant 13):
+// every input bit flips each output bit with probability close to 1/2
+inline uint64_t hashMix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+inline uint64_t hashCombine(uint64_t seed, uint64_t value) {
+    return hashMix(seed + 0x9e3779b97f4a7c15ULL + value * 0xff51afd7ed558ccdULL);
+}
+
+// Node hash for the intern table (FlatHashSet uses its low bits to place
+// a node and its top 7 bits as a tag, so all bits must be mixed): the
+// kind and operator, then the constant bits or the operand addresses
 struct TreeHash {
     size_t operator()(const std::shared_ptr<Tree>& t) const {
-        size_t h = 0;
-        
         switch(t->getType()) {
-            case Tree::NodeType::Num:
-                h = std::hash<double>{}(t->getValue());
-                break;
+            case Tree::NodeType::Num: {
+                // Integer 2 and real 2.0 are different constants
+                if (t->getConstantOp() == ConstantOp::Integer) {
+                    return hashCombine(1, static_cast<uint64_t>(t->getInteger()));
+                }
+                // 0.0 and -0.0 are equal constants
+                double value = t->getValue();
+                uint64_t bits = 0;
+                if (value != 0.0) {
+                    std::memcpy(&bits, &value, sizeof(bits));
+                }
+                return hashCombine(2, bits);
+            }
                 
             case Tree::NodeType::Unary:
-                h = std::hash<int>{}(static_cast<int>(t->getUnaryOp()));
-                h ^= std::hash<void*>{}(t->getOperand().get()) + 0x9e3779b9 + (h << 6) + (h >> 2);
-                break;
+                return hashCombine(hashCombine(3, static_cast<uint64_t>(t->getUnaryOp())),
+                                   reinterpret_cast<uintptr_t>(t->getOperand().get()));
                 
-            case Tree::NodeType::Binary:
-                h = std::hash<int>{}(static_cast<int>(t->getBinaryOp()));
-                h ^= std::hash<void*>{}(t->getLeft().get()) + 0x9e3779b9 + (h << 6) + (h >> 2);
-                h ^= std::hash<void*>{}(t->getRight().get()) + 0x517cc1b7 + (h << 6) + (h >> 2);
-                break;
+            case Tree::NodeType::Binary: {
+                uint64_t h = hashCombine(4, static_cast<uint64_t>(t->getBinaryOp()));
+                h = hashCombine(h, reinterpret_cast<uintptr_t>(t->getLeft().get()));
+                return hashCombine(h, reinterpret_cast<uintptr_t>(t->getRight().get()));
+            }
                 
             case Tree::NodeType::Var:
                 // Hash only the variable index, not the definition
-                h = std::hash<int>{}(t->getVarIndex()) ^ 0xdeadbeef;
-                break;
+                return hashCombine(5, static_cast<uint64_t>(t->getVarIndex()));
+                
+            case Tree::NodeType::Select: {
+                uint64_t h = hashCombine(6, reinterpret_cast<uintptr_t>(t->getCondition().get()));
+                h = hashCombine(h, reinterpret_cast<uintptr_t>(t->getThen().get()));
+                return hashCombine(h, reinterpret_cast<uintptr_t>(t->getElse().get()));
+            }
         }
-        return h;
+        return 0;
     }
 };
 
@@ -335,6 +508,8 @@ struct TreeEqual {
         
         switch(a->getType()) {
             case Tree::NodeType::Num:
+                if (a->getConstantOp() != b->getConstantOp()) return false;
+                if (a->getConstantOp() == ConstantOp::Integer) return a->getInteger() == b->getInteger();
                 return a->getValue() == b->getValue();
                 
             case Tree::NodeType::Unary:
@@ -350,43 +525,237 @@ struct TreeEqual {
                 // Two variables are equal if they have the same index
                 // Note: we don't compare definitions
                 return a->getVarIndex() == b->getVarIndex();
+                
+            case Tree::NodeType::Select:
+                return a->getCondition() == b->getCondition() &&
+                       a->getThen() == b->getThen() &&
+                       a->getElse() == b->getElse();
         }
         return false;
     }
 };
 
+inline std::string profileLabel(const Tree& tree) {
+    static const char* unaryNames[] = {"abs", "sqrt", "exp", "log", "sin", "cos", "tanh"};
+    static const char* binaryNames[] = {"add", "sub", "mul", "div", "mod", "min", "max", "pow"};
+    static_assert(sizeof(unaryNames) / sizeof(*unaryNames) == static_cast<size_t>(UnaryOp::COUNT));
+    static_assert(sizeof(binaryNames) / sizeof(*binaryNames) == static_cast<size_t>(BinaryOp::COUNT));
+    std::string label;
+    switch (tree.getType()) {
+        case Tree::NodeType::Num:
+            if (tree.getConstantOp() == ConstantOp::Integer) {
+                label = "int(" + std::to_string(tree.getInteger()) + ")";
+            } else {
+                std::ostringstream value;
+                value << tree.getValue();
+                label = "num(" + value.str() + ")";
+            }
+            break;
+        case Tree::NodeType::Unary:
+            label = unaryNames[static_cast<size_t>(tree.getUnaryOp())];
+            break;
+        case Tree::NodeType::Binary:
+            label = binaryNames[static_cast<size_t>(tree.getBinaryOp())];
+            break;
+        case Tree::NodeType::Var:
+            label = "var" + std::to_string(tree.getVarIndex());
+            break;
+        case Tree::NodeType::Select:
+            label = "select";
+            break;
+    }
+    return label + "#" + std::to_string(tree.getId());
+}
+
 // Forward declaration
 class Tree;
 
 // SCC Frame for the evaluation stack
+//
+// Frames are the elements of a union-find structure. When a back-edge merges
+// the frames from some stack position to the top, they are all linked to one
+// representative which takes their place on the stack. Variable sets and memos
+// are spliced (std::set::merge / std::map::merge relink nodes, nothing is
+// copied) from the smaller frames into the largest one, so each variable
+// changes frame at most O(log n) times.
 template<typename T>
 struct SCCFrame {
     std::set<Tree*> scc;                      // Variables in this SCC
     std::map<Tree*, T> hypotheticalMemo;      // Hypothetical memoization for this SCC
+    mutable size_t parent;                    // Union-find parent (itself for a representative)
+    size_t position;                          // Stack position while a representative is on the stack
     
-    SCCFrame(const std::set<Tree*>& variables) : scc(variables) {}
+    SCCFrame(size_t id, size_t pos) : parent(id), position(pos) {}
 };
 
+// Dependencies of an evaluation result on hypothetical values: the lowest
+// stack position whose hypotheses were read (Tarjan's low-link), or nullopt
+// when the result is definitive.
+using SCCDependencies = std::optional<size_t>;
+
+inline SCCDependencies combineDependencies(SCCDependencies a, SCCDependencies b) {
+    if (!a) return b;
+    if (!b) return a;
+    return std::min(*a, *b);
+}
+
 // Hypotheses being tested during fixpoint computation
 template<typename T>
 struct Hypotheses {
-    std::vector<SCCFrame<T>> sccStack;        // Stack of SCCs being computed
-    std::map<Tree*, T> hypotheticalValues;    // Hypothetical variable values
+    static constexpr size_t NOT_ON_STACK = static_cast<size_t>(-1);
+    
+    std::vector<SCCFrame<T>> frames;             // Every frame pushed during this evaluation
+    std::vector<size_t> sccStack;                // Representative frame at each stack position
+    std::unordered_map<Tree*, size_t> varFrame;  // Frame in which each stacked variable was pushed
+    std::map<Tree*, T> hypotheticalValues;       // Hypothetical variable values
+    std::map<Tree*, T> equations;                // Initial algebras: var ↦ define(placeholder, definition)
+    
+    // Union-find representative, with path halving
+    size_t find(size_t frame) const {
+        while (frames[frame].parent != frame) {
+            frames[frame].parent = frames[frames[frame].parent].parent;
+            frame = frames[frame].parent;
+        }
+        return frame;
+    }
     
     // Find SCC position for a variable, returns nullopt if not on stack
     std::optional<size_t> findSCCPosition(Tree* var) const {
-        for (size_t i = 0; i < sccStack.size(); ++i) {
-            if (sccStack[i].scc.count(var) > 0) {
-                return i;
-            }
+        auto it = varFrame.find(var);
+        if (it == varFrame.end()) {
+            return std::nullopt;  // Not found
         }
-        return std::nullopt;  // Not found
+        size_t position = frames[find(it->second)].position;
+        if (position == NOT_ON_STACK) {
+            return std::nullopt;
+        }
+        return position;
     }
     
     // Check if variable is on stack
     bool isOnStack(Tree* var) const {
         return findSCCPosition(var).has_value();
     }
+    
+    bool empty() const { return sccStack.empty(); }
+    
+    SCCFrame<T>& top() { return frames[sccStack.back()]; }
+    const SCCFrame<T>& top() const { return frames[sccStack.back()]; }
+    
+    // Push a new singleton SCC for var, returns its stack position
+    size_t push(Tree* var) {
+        size_t id = frames.size();
+        size_t position = sccStack.size();
+        frames.emplace_back(id, position);
+        frames.back().scc.insert(var);
+        varFrame[var] = id;
+        sccStack.push_back(id);
+        return position;
+    }
+    
+    // True when var's SCC is the top of the stack and sits at the given position,
+    // i.e. var is the entry point (Tarjan root) of the SCC it belongs to
+    bool isHead(Tree* var, size_t position) const {
+        if (sccStack.size() != position + 1) return false;
+        auto it = varFrame.find(var);
+        return it != varFrame.end() && find(it->second) == sccStack.back();
+    }
+    
+    // Pop the top SCC, its variables are no longer on the stack
+    void pop() {
+        SCCFrame<T>& frame = top();
+        for (Tree* var : frame.scc) {
+            varFrame.erase(var);
+        }
+        frame.scc.clear();
+        frame.hypotheticalMemo.clear();
+        frame.position = NOT_ON_STACK;
+        sccStack.pop_back();
+    }
+    
+    // Merge the SCCs from position to the top into a single SCC at position
+    void merge(size_t position) {
+        if (position + 1 >= sccStack.size()) return;  // Already a single frame
+        
+        // Union by size: the largest frame absorbs the others
+        auto weight = [this](size_t f) { return frames[f].scc.size() + frames[f].hypotheticalMemo.size(); };
+        size_t rep = sccStack[position];
+        for (size_t i = position + 1; i < sccStack.size(); ++i) {
+            if (weight(sccStack[i]) > weight(rep)) rep = sccStack[i];
+        }
+        
+        for (size_t i = position; i < sccStack.size(); ++i) {
+            size_t f = sccStack[i];
+            if (f == rep) continue;
+            frames[rep].scc.merge(frames[f].scc);
+            frames[rep].hypotheticalMemo.merge(frames[f].hypotheticalMemo);
+            frames[f].hypotheticalMemo.clear();  // Entries already present in rep stay behind
+            frames[f].parent = rep;
+            frames[f].position = NOT_ON_STACK;
+        }
+        
+        frames[rep].position = position;
+        sccStack.resize(position + 1);
+        sccStack[position] = rep;
+    }
+};
+
+// Dependent spine of an SCC, built once after the discovery pass
+//
+// The discovery pass classifies every subterm: results without dependencies
+// are already in the definitive memo, the others depend on the hypotheses of
+// the SCC. Only the latter are compiled into steps, in post-order, so that an
+// iteration round re-evaluates the dependent spine and reads everything else
+// from slots filled once.
+//
+// Slots: the SCC variables first, then independent operands and step results
+// in the order the compilation met them.
+//
+// A select whose condition depends on the hypotheses is a lazy step: only
+// its condition is compiled, and each round evaluates the operand the
+// condition takes with evalInternal, from the hypotheses of that round.
+template<typename T>
+struct SCCSpine {
+    struct Step {
+        Tree* tree;      // Unary, Binary or Select node
+        size_t left;     // Operand slot (the only one for a unary node, the condition of a select)
+        size_t right;    // Right operand slot (the then operand of a select)
+        size_t result;   // Result slot
+        size_t otherwise = 0;   // Else operand slot of a select
+        bool lazy = false;      // Select whose operands are evaluated by the rounds, no operand slots
+    };
+
+    std::vector<T> slots;
+    std::vector<Step> steps;            // Post-order: operands come before their users
+    std::vector<size_t> definitions;    // Slot holding the definition of each variable
+    size_t independentNodes = 0;        // Operands read from the definitive memo
+    size_t lazySteps = 0;
+};
+
+// Options of the fixpoint computation
+struct FixpointOptions {
+    bool solveAffine = true;        // Solve affine SCCs as linear systems (algebras with linear semantics)
+    size_t denseLimit = 64;         // Largest SCC always solved by dense elimination
+    size_t denseMatrixLimit = 1024; // Largest SCC solved by dense elimination when a quarter of A is non-zero
+    size_t fillFactor = 4;          // Budget of affine terms and of sparse fill-in, in multiples of the input size
+    Acceleration acceleration = Acceleration::None;  // Extrapolation of the iterates (algebras with linear semantics)
+    size_t andersonDepth = 5;       // History depth m of Anderson(m)
+};
+
+// Statistics of the fixpoint iterations of the last semantic evaluation
+struct FixpointStats {
+    size_t sccs = 0;                // SCCs solved by iteration
+    size_t affineSCCs = 0;          // Among them, SCCs whose fixpoint was solved as a linear system
+    size_t rounds = 0;              // Iteration rounds, over all SCCs
+    size_t dependentNodes = 0;      // Spine nodes, over all SCCs
+    size_t independentNodes = 0;    // Subterms evaluated once and read from the definitive memo
+    size_t nodeEvaluations = 0;     // Node evaluations performed by the rounds
+    size_t acceleratedRounds = 0;   // Rounds followed by an extrapolated iterate
+    size_t accelerationResets = 0;  // Safeguard events (diverging or non-finite extrapolation)
+
+    double evaluationsPerRound() const {
+        return rounds ? static_cast<double>(nodeEvaluations) / static_cast<double>(rounds) : 0.0;
+    }
 };
 
 // Alpha-equivalence structures and algorithms
@@ -418,22 +787,67 @@ struct AlphaEquivContext {
 class TreeAlgebra : public InitialAlgebra<std::shared_ptr<Tree>> {
 private:
     // Hash-consing table
-    mutable std::unordered_set<std::shared_ptr<Tree>, TreeHash, TreeEqual> fTrees;
+    mutable FlatHashSet<std::shared_ptr<Tree>, TreeHash, TreeEqual> fTrees;
     
     // Counter for generating fresh variables in bottom()
     mutable int fVarCounter = 0;
     
+    // Ids given to interned nodes
+    mutable size_t fNodeCount = 0;
+    
+    // Definitions made by define(), by variable id (copied by snapshots),
+    // and the table evaluations read instead of the variables, if any
+    mutable DefinitionTable fDefinitions;
+    const DefinitionTable* fDefinitionSource = nullptr;
+    
+    // Algebra whose nodes evaluations accept: this one, or the writer of
+    // the table in fDefinitionSource
+    uint64_t fNodeOwner = 0;
+    
+    // Nodes imported from other algebras: by source instance, the node of
+    // this algebra for each source id (nullptr if not imported yet)
+    mutable std::unordered_map<uint64_t, std::vector<std::shared_ptr<Tree>>> fImports;
+    
+    // Definition changes of the variables of this algebra, see definitionEpoch()
+    std::shared_ptr<std::atomic<uint64_t>> fDefinitionEpoch = std::make_shared<std::atomic<uint64_t>>(0);
+    
+    // Memos are indexed by node id: a node of another algebra would read
+    // the value of the node of ours that has its id
+    void checkOwner(const Tree* tree) const {
+        if (tree->getOwner() != (fNodeOwner ? fNodeOwner : instance())) {
+            throw std::runtime_error("Node " + std::to_string(tree->getId()) + " belongs to another TreeAlgebra");
+        }
+    }
+    
+    // Side tables of query(), by Algebra::instance() of the algebra whose
+    // values they hold: an algebra built later at the same address, even
+    // of the same type, gets a new table
+    struct AttachedSideTable {
+        std::unique_ptr<SideTableBase> table;
+        uint64_t epoch = 0;
+        std::string algebra;
+    };
+    mutable std::map<uint64_t, AttachedSideTable> fSideTables;
+    
+    // Fixpoint options and statistics of the last semantic evaluation
+    FixpointOptions fFixpointOptions;
+    mutable FixpointStats fFixpointStats;
+    
+    // Timeline of the solver, when tracing
+    SolverTrace* fTrace = nullptr;
+    
     // Intern method for hash-consing
     std::shared_ptr<Tree> intern(std::shared_ptr<Tree> candidate) const {
-        auto it = fTrees.find(candidate);
-        if (it != fTrees.end()) {
-            // Found existing tree, return it
-            return *it;
-        } else {
-            // New tree, add to table and return
-            fTrees.insert(candidate);
-            return candidate;
+        auto [tree, inserted] = fTrees.insert(std::move(candidate));
+        if (inserted) {
+            // New tree: number it
+            tree->fId = fNodeCount++;
+            tree->fOwner = instance();
+            if (tree->fType == Tree::NodeType::Var) {
+                tree->fEpoch = fDefinitionEpoch;
+            }
         }
+        return tree;
     }
     
 public:
@@ -442,6 +856,11 @@ public:
         return intern(candidate);
     }
     
+    std::shared_ptr<Tree> integer(int64_t value) const override {
+        auto candidate = std::shared_ptr<Tree>(new Tree(ConstantOp::Integer, value));
+        return intern(candidate);
+    }
+    
     std::shared_ptr<Tree> add(const std::shared_ptr<Tree>& a, const std::shared_ptr<Tree>& b) const override {
         auto candidate = std::shared_ptr<Tree>(new Tree(BinaryOp::Add, a, b));
         return intern(candidate);
@@ -471,6 +890,48 @@ public:
         auto candidate = std::shared_ptr<Tree>(new Tree(UnaryOp::Abs, a));
         return intern(candidate);
     }
+
+    std::shared_ptr<Tree> sqrt(const std::shared_ptr<Tree>& a) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(UnaryOp::Sqrt, a)));
+    }
+
+    std::shared_ptr<Tree> exp(const std::shared_ptr<Tree>& a) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(UnaryOp::Exp, a)));
+    }
+
+    std::shared_ptr<Tree> log(const std::shared_ptr<Tree>& a) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(UnaryOp::Log, a)));
+    }
+
+    std::shared_ptr<Tree> sin(const std::shared_ptr<Tree>& a) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(UnaryOp::Sin, a)));
+    }
+
+    std::shared_ptr<Tree> cos(const std::shared_ptr<Tree>& a) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(UnaryOp::Cos, a)));
+    }
+
+    std::shared_ptr<Tree> tanh(const std::shared_ptr<Tree>& a) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(UnaryOp::Tanh, a)));
+    }
+
+    std::shared_ptr<Tree> min(const std::shared_ptr<Tree>& a, const std::shared_ptr<Tree>& b) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(BinaryOp::Min, a, b)));
+    }
+
+    std::shared_ptr<Tree> max(const std::shared_ptr<Tree>& a, const std::shared_ptr<Tree>& b) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(BinaryOp::Max, a, b)));
+    }
+
+    std::shared_ptr<Tree> pow(const std::shared_ptr<Tree>& a, const std::shared_ptr<Tree>& b) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(BinaryOp::Pow, a, b)));
+    }
+    
+    // A tree is not a value: branch() stays Both, and the node keeps both operands
+    std::shared_ptr<Tree> select(const std::shared_ptr<Tree>& c, const std::shared_ptr<Tree>& a,
+                                 const std::shared_ptr<Tree>& b) const override {
+        return intern(std::shared_ptr<Tree>(new Tree(c, a, b)));
+    }
     
     // InitialAlgebra methods
     std::shared_ptr<Tree> var() const override {
@@ -485,6 +946,17 @@ public:
         return intern(candidate);
     }
     
+    // A variable that did not exist: var() may meet an index created by
+    // var(index)
+    std::shared_ptr<Tree> freshVar() const {
+        const size_t before = fNodeCount;
+        auto v = var();
+        while (fNodeCount == before) {
+            v = var();
+        }
+        return v;
+    }
+    
     std::shared_ptr<Tree> define(const std::shared_ptr<Tree>& var, 
                                   const std::shared_ptr<Tree>& def) const override {
         // Associate a definition to a variable
@@ -492,35 +964,165 @@ public:
             throw std::runtime_error("Can only define variables");
         }
         var->setDefinition(def);
+        fDefinitions.set(var->getId(), def);
         return var;
     }
     
+    // Number of interned nodes: ids are in [0, nodeCount())
+    size_t nodeCount() const {
+        return fNodeCount;
+    }
+    
+    // Changes with every definition of a variable of this algebra, made by
+    // define() or Tree::setDefinition(): values cached across evaluations
+    // are stale once it changed. Other algebras do not move it.
+    uint64_t definitionEpoch() const {
+        return fDefinitionEpoch->load(std::memory_order_relaxed);
+    }
+    
+    // Definitions made by define(). Tree::setDefinition() bypasses it.
+    const DefinitionTable& definitions() const {
+        return fDefinitions;
+    }
+    
+    // Evaluations read the definitions of variables from table instead of
+    // the variables themselves, until readDefinitionsFrom(nullptr): this is
+    // how a SnapshotReader evaluates a TreeSnapshot. They take the nodes of
+    // the algebra owner, whose instance() the table was copied from, rather
+    // than nodes of this algebra. The table must outlive its use.
+    void readDefinitionsFrom(const DefinitionTable* table, uint64_t owner = 0) {
+        fDefinitionSource = table;
+        fNodeOwner = table ? owner : 0;
+    }
+    
+    // Copies of nodes of src into this algebra: values[i] is the node of
+    // this algebra for roots[i]. Nodes are translated bottom-up, without
+    // recursion, and each one is interned once whatever the sharing of the
+    // source DAG. Every source variable reached, through operands or
+    // definitions, becomes a fresh variable of this algebra (source
+    // indices would collide with ours), defined by the translation of its
+    // definition: recursive systems are carried over as they are.
+    //
+    // The translation is kept per source algebra, so importing from the
+    // same source again reuses the nodes and variables already imported;
+    // a source variable is defined once, when first imported. src must
+    // not be modified during the import (build on workers, then merge).
+    std::vector<std::shared_ptr<Tree>> import(const TreeAlgebra& src,
+                                              const std::vector<std::shared_ptr<Tree>>& roots) const {
+        if (&src == this) {
+            return roots;
+        }
+        auto& map = fImports[src.instance()];
+        if (map.empty()) {
+            fTrees.reserve(fTrees.size() + src.nodeCount());   // At most, no rehash while importing
+        }
+        if (map.size() < src.nodeCount()) {
+            map.resize(src.nodeCount());
+        }
+        
+        std::vector<std::pair<Tree*, bool>> stack;   // Node, operands translated
+        std::vector<Tree*> variables;                // Source variables to define
+        auto translate = [&](Tree* root) {
+            stack.emplace_back(root, false);
+            while (!stack.empty()) {
+                auto [node, expanded] = stack.back();
+                stack.pop_back();
+                if (map[node->getId()]) {
+                    continue;
+                }
+                switch (node->getType()) {
+                    case Tree::NodeType::Var:
+                        map[node->getId()] = freshVar();
+                        variables.push_back(node);
+                        break;
+                    case Tree::NodeType::Num:
+                        map[node->getId()] = node->getConstantOp() == ConstantOp::Integer
+                            ? integer(node->getInteger()) : num(node->getValue());
+                        break;
+                    case Tree::NodeType::Unary:
+                        if (!expanded) {
+                            stack.emplace_back(node, true);
+                            stack.emplace_back(node->getOperand().get(), false);
+                        } else {
+                            map[node->getId()] = unary(node->getUnaryOp(), map[node->getOperand()->getId()]);
+                        }
+                        break;
+                    case Tree::NodeType::Binary:
+                        if (!expanded) {
+                            stack.emplace_back(node, true);
+                            stack.emplace_back(node->getRight().get(), false);
+                            stack.emplace_back(node->getLeft().get(), false);
+                        } else {
+                            map[node->getId()] = binary(node->getBinaryOp(), map[node->getLeft()->getId()],
+                                                        map[node->getRight()->getId()]);
+                        }
+                        break;
+                    case Tree::NodeType::Select:
+                        if (!expanded) {
+                            stack.emplace_back(node, true);
+                            stack.emplace_back(node->getElse().get(), false);
+                            stack.emplace_back(node->getThen().get(), false);
+                            stack.emplace_back(node->getCondition().get(), false);
+                        } else {
+                            map[node->getId()] = select(map[node->getCondition()->getId()],
+                                                        map[node->getThen()->getId()], map[node->getElse()->getId()]);
+                        }
+                        break;
+                }
+            }
+        };
+        
+        std::vector<std::shared_ptr<Tree>> values;
+        values.reserve(roots.size());
+        for (const auto& root : roots) {
+            const auto* interned = src.fTrees.find(root);
+            if (!interned || *interned != root) {
+                throw std::runtime_error("Imported roots must be nodes of the source algebra");
+            }
+            translate(root.get());
+            values.push_back(map[root->getId()]);
+        }
+        // Definitions reach new variables, whose definitions are translated in turn
+        for (size_t i = 0; i < variables.size(); ++i) {
+            if (auto definition = variables[i]->getDefinition()) {
+                translate(definition.get());
+                define(map[variables[i]->getId()], map[definition->getId()]);
+            }
+        }
+        return values;
+    }
+    
+    // Forgets what was imported from other algebras: a later import()
+    // creates new variables for the source variables met again
+    void clearImports() {
+        fImports.clear();
+    }
+    
     // Auxiliary functions for fixpoint evaluation
     template<typename T>
-    void memoize(Tree* tree, const T& value, const std::set<Tree*>& dependencies, 
-                 std::map<Tree*, T>& definitiveMemo, Hypotheses<T>& hypotheses) const {
-        if (dependencies.empty()) {
+    void memoize(Tree* tree, const T& value, SCCDependencies dependencies, 
+                 SideTable<T>& definitiveMemo, Hypotheses<T>& hypotheses) const {
+        if (!dependencies) {
             // No dependencies -> definitive memoization
-            definitiveMemo[tree] = value;
-        } else if (!hypotheses.sccStack.empty()) {
+            definitiveMemo.set(tree->getId(), value);
+        } else if (!hypotheses.empty()) {
             // Dependencies -> hypothetical memoization for top SCC
-            hypotheses.sccStack.back().hypotheticalMemo[tree] = value;
+            hypotheses.top().hypotheticalMemo[tree] = value;
         }
     }
     
     template<typename T>
-    std::optional<T> checkDefinitiveMemo(Tree* tree, const std::map<Tree*, T>& definitiveMemo) const {
-        auto it = definitiveMemo.find(tree);
-        if (it != definitiveMemo.end()) {
-            return it->second;
+    std::optional<T> checkDefinitiveMemo(Tree* tree, const SideTable<T>& definitiveMemo) const {
+        if (const T* value = definitiveMemo.find(tree->getId())) {
+            return *value;
         }
         return std::nullopt;
     }
     
     template<typename T>
     std::optional<T> checkHypotheticalMemo(Tree* tree, const Hypotheses<T>& hypotheses) const {
-        if (!hypotheses.sccStack.empty()) {
-            const auto& topFrame = hypotheses.sccStack.back();
+        if (!hypotheses.empty()) {
+            const auto& topFrame = hypotheses.top();
             auto it = topFrame.hypotheticalMemo.find(tree);
             if (it != topFrame.hypotheticalMemo.end()) {
                 return it->second;
@@ -531,72 +1133,137 @@ public:
     
     template<typename T>
     void merge(size_t position, Hypotheses<T>& hypotheses) const {
-        if (position >= hypotheses.sccStack.size()) return;
-        
-        // Collect all SCCs from position to top
-        std::set<Tree*> mergedSCC;
-        std::map<Tree*, T> mergedMemo;
-        
-        for (size_t i = position; i < hypotheses.sccStack.size(); ++i) {
-            const auto& frame = hypotheses.sccStack[i];
-            mergedSCC.insert(frame.scc.begin(), frame.scc.end());
-            mergedMemo.insert(frame.hypotheticalMemo.begin(), frame.hypotheticalMemo.end());
-        }
-        
-        // Remove merged frames
-        hypotheses.sccStack.erase(hypotheses.sccStack.begin() + position, hypotheses.sccStack.end());
-        
-        // Add merged frame
-        hypotheses.sccStack.emplace_back(mergedSCC);
-        hypotheses.sccStack.back().hypotheticalMemo = mergedMemo;
+        hypotheses.merge(position);
     }
     
     template<typename T>
-    void promote(std::map<Tree*, T>& definitiveMemo, Hypotheses<T>& hypotheses) const {
-        if (hypotheses.sccStack.empty()) return;
+    void promote(SideTable<T>& definitiveMemo, Hypotheses<T>& hypotheses) const {
+        if (hypotheses.empty()) return;
         
         // Move hypothetical memoization to definitive
-        const auto& topFrame = hypotheses.sccStack.back();
+        auto& topFrame = hypotheses.top();
         for (const auto& [tree, value] : topFrame.hypotheticalMemo) {
-            definitiveMemo[tree] = value;
+            definitiveMemo.insert(tree->getId(), value);
         }
+        topFrame.hypotheticalMemo.clear();
         
-        // Also promote final variable values from hypotheticalValues
-        // These contain the converged values from the last iteration
+        // Also promote final variable values: the converged values of the last
+        // iteration, or the equations built for an initial algebra
         for (Tree* var : topFrame.scc) {
-            if (hypotheses.hypotheticalValues.count(var)) {
-                definitiveMemo[var] = hypotheses.hypotheticalValues[var];
+            auto eq = hypotheses.equations.find(var);
+            if (eq != hypotheses.equations.end()) {
+                definitiveMemo.set(var->getId(), eq->second);
+                hypotheses.equations.erase(eq);
+            } else if (hypotheses.hypotheticalValues.count(var)) {
+                definitiveMemo.set(var->getId(), hypotheses.hypotheticalValues[var]);
             }
+            hypotheses.hypotheticalValues.erase(var);
         }
         
         // Pop the top SCC
-        hypotheses.sccStack.pop_back();
+        hypotheses.pop();
     }
     
+    // Compile the dependent part of a definition into the spine, returns its slot
     template<typename T>
-    void clean(Hypotheses<T>& hypotheses) const {
-        if (hypotheses.sccStack.empty()) return;
-        
-        auto& topFrame = hypotheses.sccStack.back();
-        std::map<Tree*, T> cleanedMemo;
+    size_t compileSpine(Tree* tree, SCCSpine<T>& spine, std::unordered_map<Tree*, size_t>& slotOf,
+                        const SideTable<T>& definitiveMemo, const Algebra<T>& algebra) const {
+        auto known = slotOf.find(tree);
+        if (known != slotOf.end()) {
+            return known->second;
+        }
         
-        // Keep only variable entries
-        for (const auto& [tree, value] : topFrame.hypotheticalMemo) {
-            if (topFrame.scc.count(tree) > 0) {  // Only keep variables in this SCC
-                cleanedMemo[tree] = value;
+        size_t slot;
+        if (const T* definitive = definitiveMemo.find(tree->getId())) {
+            // SCC-independent: evaluated once by the discovery pass
+            slot = spine.slots.size();
+            spine.slots.push_back(*definitive);
+            ++spine.independentNodes;
+        } else {
+            switch (tree->getType()) {
+                case Tree::NodeType::Unary: {
+                    size_t operand = compileSpine(tree->getOperand().get(), spine, slotOf, definitiveMemo, algebra);
+                    slot = spine.slots.size();
+                    spine.slots.push_back(T(spine.slots[operand]));
+                    spine.steps.push_back({tree, operand, operand, slot});
+                    break;
+                }
+                case Tree::NodeType::Binary: {
+                    size_t left = compileSpine(tree->getLeft().get(), spine, slotOf, definitiveMemo, algebra);
+                    size_t right = compileSpine(tree->getRight().get(), spine, slotOf, definitiveMemo, algebra);
+                    slot = spine.slots.size();
+                    spine.slots.push_back(T(spine.slots[left]));
+                    spine.steps.push_back({tree, left, right, slot});
+                    break;
+                }
+                case Tree::NodeType::Select: {
+                    // A definitive condition was decided by the discovery pass, which
+                    // evaluated only the taken operand: the select is that operand
+                    Tree* condition = tree->getCondition().get();
+                    if (const T* decided = definitiveMemo.find(condition->getId())) {
+                        auto branch = algebra.branch(*decided);
+                        if (branch != Algebra<T>::Branch::Both) {
+                            Tree* taken = branch == Algebra<T>::Branch::Then ? tree->getThen().get() : tree->getElse().get();
+                            slot = compileSpine(taken, spine, slotOf, definitiveMemo, algebra);
+                            break;
+                        }
+                    }
+                    size_t c = compileSpine(condition, spine, slotOf, definitiveMemo, algebra);
+                    if (!definitiveMemo.find(condition->getId())) {
+                        // Decided by each round: the discovery pass evaluated one operand
+                        // at most, the other may not be evaluable at all
+                        slot = spine.slots.size();
+                        spine.slots.push_back(T(spine.slots[c]));
+                        spine.steps.push_back({tree, c, c, slot, c, true});
+                        ++spine.lazySteps;
+                        break;
+                    }
+                    size_t then = compileSpine(tree->getThen().get(), spine, slotOf, definitiveMemo, algebra);
+                    size_t otherwise = compileSpine(tree->getElse().get(), spine, slotOf, definitiveMemo, algebra);
+                    slot = spine.slots.size();
+                    spine.slots.push_back(T(spine.slots[then]));
+                    spine.steps.push_back({tree, c, then, slot, otherwise});
+                    break;
+                }
+                default:
+                    // Constants and solved variables are definitive, SCC variables have slots
+                    throw std::runtime_error("Unclassified node in SCC spine");
             }
         }
-        
-        topFrame.hypotheticalMemo = cleanedMemo;
+        slotOf.emplace(tree, slot);
+        return slot;
+    }
+    
+    // Build the spine of the SCC on top of the stack from its discovery pass
+    template<typename T>
+    SCCSpine<T> buildSpine(const std::vector<Tree*>& scc, const SideTable<T>& definitiveMemo,
+                           Hypotheses<T>& hypotheses, const Algebra<T>& algebra) const {
+        SCCSpine<T> spine;
+        std::unordered_map<Tree*, size_t> slotOf;
+        for (Tree* var : scc) {
+            slotOf.emplace(var, spine.slots.size());
+            spine.slots.push_back(hypotheses.hypotheticalValues[var]);
+        }
+        for (Tree* var : scc) {
+            auto definition = getDefinition(var);
+            if (!definition) {
+                throw std::runtime_error("Variable " + std::to_string(var->getVarIndex()) + " has no definition");
+            }
+            spine.definitions.push_back(compileSpine(definition.get(), spine, slotOf, definitiveMemo, algebra));
+        }
+        return spine;
     }
     
     std::shared_ptr<Tree> getDefinition(Tree* var) const {
+        if (fDefinitionSource) {
+            return fDefinitionSource->get(var->getId());
+        }
         return var->getDefinition();
     }
     
     template<typename T>
     bool hasTopSCC(const Hypotheses<T>& hypotheses) const {
-        return !hypotheses.sccStack.empty();
+        return !hypotheses.empty();
     }
     
     // Main evaluation method - public API
@@ -612,6 +1279,38 @@ public:
         }
     }
     
+    // Values of several roots in one pass: the memo and the SCC solutions
+    // are shared, so a subterm or a fixpoint common to several roots is
+    // evaluated once. values[i] is the value of roots[i].
+    template<typename T>
+    std::vector<T> eval(const std::vector<std::shared_ptr<Tree>>& roots, const Algebra<T>& algebra) const {
+        if constexpr (std::is_same_v<T, std::shared_ptr<Tree>>) {
+            if (dynamic_cast<const TreeAlgebra*>(&algebra) == this) {
+                return roots;
+            }
+        }
+        if (!dynamic_cast<const InitialAlgebra<T>*>(&algebra) && !dynamic_cast<const SemanticAlgebra<T>*>(&algebra)) {
+            throw std::runtime_error("Unknown algebra type");
+        }
+        static thread_local SideTable<T> definitiveMemo;
+        definitiveMemo.clear();
+        fFixpointStats = FixpointStats();
+        SolverTrace::Span span(fTrace, "eval", "eval");
+        
+        std::vector<T> values;
+        values.reserve(roots.size());
+        for (const auto& root : roots) {
+            // The stack is empty between roots: every SCC met is solved
+            Hypotheses<T> hypotheses;
+            values.push_back(evalInternal(root, definitiveMemo, hypotheses, algebra).first);
+        }
+        if (span) {
+            span.setArgs(SolverTrace::Args().add("roots", static_cast<uint64_t>(roots.size()))
+                .add("algebra", typeName(algebra)).str());
+        }
+        return values;
+    }
+    
     // Evaluation for initial algebras (equation building)
     template<typename T>
     T evalInitial(const std::shared_ptr<Tree>& tree, const InitialAlgebra<T>& algebra) const {
@@ -621,9 +1320,9 @@ public:
             return reinterpret_cast<const T&>(tree);
         }
         
-        // For other initial algebras, we build equations rather than iterate
-        // For now, use the existing algorithm (will be refined later)
-        static thread_local std::map<Tree*, T> definitiveMemo;
+        // For other initial algebras, we build equations rather than iterate:
+        // each recursive variable becomes a fresh var() bound with define()
+        static thread_local SideTable<T> definitiveMemo;
         definitiveMemo.clear();
         
         Hypotheses<T> hypotheses;
@@ -638,42 +1337,149 @@ public:
     T evalSemantic(const std::shared_ptr<Tree>& tree, const SemanticAlgebra<T>& algebra) const {
         // For semantic algebras, we need full fixpoint computation capability
         // Use the same algorithm as initial algebras but with semantic convergence
-        static thread_local std::map<Tree*, T> definitiveMemo;
+        static thread_local SideTable<T> definitiveMemo;
         definitiveMemo.clear();
+        fFixpointStats = FixpointStats();
+        SolverTrace::Span span(fTrace, "eval", "eval");
         
         Hypotheses<T> hypotheses;
         auto [result, deps] = evalInternal(tree, definitiveMemo, hypotheses, algebra);
+        if (span) {
+            span.setArgs(traceArgs(tree.get(), "root").add("algebra", typeName(algebra)).str());
+        }
         return result;
     }
     
+    // Fixpoint statistics of the last evaluation into a semantic algebra
+    const FixpointStats& fixpointStats() const {
+        return fFixpointStats;
+    }
+    
+    const FixpointOptions& fixpointOptions() const {
+        return fFixpointOptions;
+    }
+    
+    void setFixpointOptions(const FixpointOptions& options) {
+        fFixpointOptions = options;
+    }
+    
+    // Records the phases of the following semantic evaluations into trace,
+    // until setTrace(nullptr). The trace must outlive its use.
+    void setTrace(SolverTrace* trace) {
+        fTrace = trace;
+    }
+    
+    SolverTrace* trace() const {
+        return fTrace;
+    }
+    
+    // Side table attached to an algebra instance, emptied when a definition
+    // changed since it was last used. The table is keyed by the instance()
+    // of the algebra, never reused by another one: release it when the
+    // algebra is destroyed to free its memory.
+    template<typename T>
+    SideTable<T>& sideTable(const Algebra<T>& algebra) const {
+        auto& attached = fSideTables[algebra.instance()];
+        if (!attached.table) {
+            attached.table = std::make_unique<SideTable<T>>();
+            attached.epoch = definitionEpoch();
+            attached.algebra = typeName(algebra);
+        } else if (attached.epoch != definitionEpoch()) {
+            attached.table->clear();
+            attached.epoch = definitionEpoch();
+        }
+        return static_cast<SideTable<T>&>(*attached.table);
+    }
+    
+    // Value of a tree in a semantic algebra, kept in the algebra's side table:
+    // a value already computed, for this node or as part of another query,
+    // costs one array load. Otherwise the evaluation runs with the side table
+    // as its definitive memo, so every node it solves is kept.
+    template<typename T>
+    T query(const std::shared_ptr<Tree>& tree, const SemanticAlgebra<T>& algebra) const {
+        checkOwner(tree.get());
+        SideTable<T>& table = sideTable<T>(algebra);
+        if (const T* value = table.find(tree->getId())) {
+            return *value;
+        }
+        fFixpointStats = FixpointStats();
+        SolverTrace::Span span(fTrace, "eval", "query");
+        Hypotheses<T> hypotheses;
+        auto [result, deps] = evalInternal(tree, table, hypotheses, algebra);
+        if (span) {
+            span.setArgs(traceArgs(tree.get(), "root").add("algebra", typeName(algebra)).str());
+        }
+        return result;
+    }
+    
+    template<typename T>
+    void releaseSideTable(const Algebra<T>& algebra) const {
+        fSideTables.erase(algebra.instance());
+    }
+    
+    void releaseSideTables() const {
+        fSideTables.clear();
+    }
+    
+    // Memory used by the side tables of query(), one entry per algebra
+    std::vector<SideTableUsage> sideTableUsage() const {
+        std::vector<SideTableUsage> usage;
+        for (const auto& [algebra, attached] : fSideTables) {
+            bool stale = attached.epoch != definitionEpoch();
+            usage.push_back({attached.algebra, stale ? 0 : attached.table->size(),
+                             attached.table->capacity(), attached.table->bytes()});
+        }
+        return usage;
+    }
+    
+    // Demangled type of an algebra, names its side table
+    template<typename T>
+    static std::string typeName(const Algebra<T>& algebra) {
+        const char* mangled = typeid(algebra).name();
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+        std::string name = status == 0 && demangled ? demangled : mangled;
+        std::free(demangled);
+        return name;
+    }
+    
+public:
     
     // Internal evaluation method (legacy, will be split later)
     template<typename T>
-    std::pair<T, std::set<Tree*>> evalInternal(const std::shared_ptr<Tree>& tree, 
-                                               std::map<Tree*, T>& definitiveMemo,
+    std::pair<T, SCCDependencies> evalInternal(const std::shared_ptr<Tree>& tree, 
+                                               SideTable<T>& definitiveMemo,
                                                Hypotheses<T>& hypotheses, 
                                                const Algebra<T>& algebra) const {
         Tree* treePtr = tree.get();
-        
+        checkOwner(treePtr);
+        EvalProfiler* profiler = EvalProfiler::current();
+        if (profiler) {
+            profiler->visit(treePtr->getId());
+        }
         
         // Check definitive memoization first
         auto definitiveResult = checkDefinitiveMemo(treePtr, definitiveMemo);
         if (definitiveResult) {
-            return {*definitiveResult, std::set<Tree*>{}};  // No dependencies
+            return {*definitiveResult, std::nullopt};  // No dependencies
         }
         
         // Check hypothetical memoization for current top SCC
         auto hypotheticalResult = checkHypotheticalMemo(treePtr, hypotheses);
         if (hypotheticalResult && hasTopSCC(hypotheses)) {
-            return {*hypotheticalResult, hypotheses.sccStack.back().scc};
+            return {*hypotheticalResult, hypotheses.sccStack.size() - 1};
         }
         
+        EvalProfiler::Frame frame(profiler, treePtr->getId(), [treePtr]() { return profileLabel(*treePtr); });
+        
         // Evaluate based on tree type
         switch (tree->getType()) {
             case Tree::NodeType::Num: {
-                T value = algebra.num(tree->getValue());
-                memoize(treePtr, value, std::set<Tree*>{}, definitiveMemo, hypotheses);
-                return {value, std::set<Tree*>{}};
+                T value = tree->getConstantOp() == ConstantOp::Integer
+                    ? algebra.integer(tree->getInteger())
+                    : algebra.num(tree->getValue());
+                memoize(treePtr, value, std::nullopt, definitiveMemo, hypotheses);
+                return {value, std::nullopt};
             }
             
             case Tree::NodeType::Unary: {
@@ -688,14 +1494,33 @@ public:
                 auto [rightValue, rightDeps] = evalInternal(tree->getRight(), definitiveMemo, hypotheses, algebra);
                 T value = algebra.binary(static_cast<typename Algebra<T>::BinaryOp>(tree->getBinaryOp()), leftValue, rightValue);
                 
-                std::set<Tree*> combinedDeps;
-                combinedDeps.insert(leftDeps.begin(), leftDeps.end());
-                combinedDeps.insert(rightDeps.begin(), rightDeps.end());
+                SCCDependencies combinedDeps = combineDependencies(leftDeps, rightDeps);
                 
                 memoize(treePtr, value, combinedDeps, definitiveMemo, hypotheses);
                 return {value, combinedDeps};
             }
             
+            case Tree::NodeType::Select: {
+                // Only the operand the condition decides is evaluated. A condition
+                // depending on hypotheses may decide otherwise in later rounds:
+                // the result depends on them too, and iterate() picks again.
+                auto [conditionValue, conditionDeps] = evalInternal(tree->getCondition(), definitiveMemo, hypotheses, algebra);
+                auto branch = algebra.branch(conditionValue);
+                if (branch != Algebra<T>::Branch::Both) {
+                    auto [value, operandDeps] = evalInternal(branch == Algebra<T>::Branch::Then ? tree->getThen() : tree->getElse(),
+                                                             definitiveMemo, hypotheses, algebra);
+                    SCCDependencies deps = combineDependencies(conditionDeps, operandDeps);
+                    memoize(treePtr, value, deps, definitiveMemo, hypotheses);
+                    return {value, deps};
+                }
+                auto [thenValue, thenDeps] = evalInternal(tree->getThen(), definitiveMemo, hypotheses, algebra);
+                auto [elseValue, elseDeps] = evalInternal(tree->getElse(), definitiveMemo, hypotheses, algebra);
+                T value = algebra.select(conditionValue, thenValue, elseValue);
+                SCCDependencies combinedDeps = combineDependencies(conditionDeps, combineDependencies(thenDeps, elseDeps));
+                memoize(treePtr, value, combinedDeps, definitiveMemo, hypotheses);
+                return {value, combinedDeps};
+            }
+            
             case Tree::NodeType::Var: {
                 return evalVar(treePtr, definitiveMemo, hypotheses, algebra);
             }
@@ -707,8 +1532,8 @@ public:
     
     // Variable evaluation method
     template<typename T>
-    std::pair<T, std::set<Tree*>> evalVar(Tree* var, 
-                                          std::map<Tree*, T>& definitiveMemo,
+    std::pair<T, SCCDependencies> evalVar(Tree* var, 
+                                          SideTable<T>& definitiveMemo,
                                           Hypotheses<T>& hypotheses, 
                                           const Algebra<T>& algebra) const {
         
@@ -716,40 +1541,38 @@ public:
         auto position = hypotheses.findSCCPosition(var);
         if (position) {
             // Variable is on stack - found a cycle! Merge SCCs
+            const size_t depth = hypotheses.sccStack.size();
             merge(*position, hypotheses);
+            if (fTrace) {
+                fTrace->instant("merge", "scc", traceArgs(var)
+                    .add("frames", static_cast<uint64_t>(depth - *position))
+                    .add("variables", static_cast<uint64_t>(hypotheses.top().scc.size())).str());
+            }
             
-            // Return current approximation
-            if (hypotheses.hypotheticalValues.count(var)) {
-                return {hypotheses.hypotheticalValues[var], hypotheses.sccStack.back().scc};
-            } else {
-                // Initialize with bottom if not yet computed
-                // Only semantic algebras have bottom()
-                if (auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra)) {
-                    T bottomValue = semanticAlg->bottom();
-                    hypotheses.hypotheticalValues[var] = bottomValue;
-                    return {bottomValue, hypotheses.sccStack.back().scc};
-                } else if (auto* initialAlg = dynamic_cast<const InitialAlgebra<T>*>(&algebra)) {
-                    // For initial algebras, use a fresh variable as "bottom"
-                    T varValue = initialAlg->var();
-                    hypotheses.hypotheticalValues[var] = varValue;
-                    return {varValue, hypotheses.sccStack.back().scc};
-                } else {
-                    throw std::runtime_error("Unknown algebra type in evalVar");
-                }
+            // Return current approximation (placeholder for initial algebras)
+            auto it = hypotheses.hypotheticalValues.find(var);
+            if (it == hypotheses.hypotheticalValues.end()) {
+                throw std::runtime_error("Variable " + std::to_string(var->getVarIndex()) + " on stack without hypothesis");
             }
+            return {it->second, *position};
         }
         
         // New variable - start computing its fixpoint
-        std::set<Tree*> newSCC = {var};
-        
-        // Push new SCC on stack
-        hypotheses.sccStack.emplace_back(newSCC);
+        size_t varPosition = hypotheses.push(var);
+        SolverTrace::Span span(fTrace, "var", "var");
+        if (span) {
+            span.rename("var" + std::to_string(var->getVarIndex()));
+            span.setArgs(traceArgs(var).str());
+        }
         
         // Initialize variable to bottom/var depending on algebra type
+        auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra);
+        auto* initialAlg = dynamic_cast<const InitialAlgebra<T>*>(&algebra);
         T bottomValue;
-        if (auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra)) {
+        if (semanticAlg) {
             bottomValue = semanticAlg->bottom();
-        } else if (auto* initialAlg = dynamic_cast<const InitialAlgebra<T>*>(&algebra)) {
+        } else if (initialAlg) {
+            // For initial algebras, use a fresh variable as "bottom"
             bottomValue = initialAlg->var();
         } else {
             throw std::runtime_error("Unknown algebra type in evalVar");
@@ -765,128 +1588,388 @@ public:
         // Evaluate definition
         auto [value, dependencies] = evalInternal(definition, definitiveMemo, hypotheses, algebra);
         
-        // Update variable's value
-        hypotheses.hypotheticalValues[var] = value;
+        // Update variable's value. Initial algebras keep the placeholder as the
+        // value of the variable and record the equation placeholder = definition.
+        if (semanticAlg) {
+            hypotheses.hypotheticalValues[var] = value;
+        } else if (dependencies) {
+            hypotheses.equations[var] = initialAlg->define(bottomValue, value);
+        }
         
-        // Check if we're still at the same SCC (no merging happened)
-        if (!hypotheses.sccStack.empty() && hypotheses.sccStack.back().scc == newSCC) {
+        // Check if var is the entry point of the SCC on top of the stack
+        if (hypotheses.isHead(var, varPosition)) {
             // If no dependencies, this is a simple definition - promote directly
-            if (dependencies.empty()) {
-                // std::cout << "[DEBUG] No dependencies, promoting directly" << std::endl;
-                definitiveMemo[var] = value;
-                hypotheses.sccStack.pop_back();  // Remove the SCC from stack
-                return {value, std::set<Tree*>{}};  // No dependencies
+            if (!dependencies) {
+                definitiveMemo.set(var->getId(), value);
+                hypotheses.hypotheticalValues.erase(var);
+                hypotheses.pop();  // Remove the SCC from stack
+                return {value, std::nullopt};  // No dependencies
             } else {
                 // Has dependencies - compute fixpoint for this SCC
-                return fixpoint(newSCC, definitiveMemo, hypotheses, algebra);
+                return fixpoint(var, definitiveMemo, hypotheses, algebra);
             }
         } else {
-            // SCC was merged, continue with merged SCC
-            return {value, hypotheses.sccStack.back().scc};
+            // var was merged into an SCC below it, whose head will solve it
+            return {hypotheses.hypotheticalValues[var], dependencies};
         }
     }
     
-    // Fixpoint computation for an SCC
+    // Fixpoint computation for the SCC headed by var
     template<typename T>
-    std::pair<T, std::set<Tree*>> fixpoint(const std::set<Tree*>& scc, 
-                                           std::map<Tree*, T>& definitiveMemo, 
+    std::pair<T, SCCDependencies> fixpoint(Tree* var, 
+                                           SideTable<T>& definitiveMemo, 
                                            Hypotheses<T>& hypotheses, 
                                            const Algebra<T>& algebra) const {
-        // Clean hypothetical memo: keep only variable entries, discard sub-expressions
-        clean(hypotheses);
-        
-        // Iterate until all variables in SCC reach their fixpoints
-        bool converged = iterate(scc, definitiveMemo, hypotheses, algebra);
+        // Initial algebras: the equations built by the discovery pass are the result
+        if (dynamic_cast<const SemanticAlgebra<T>*>(&algebra)) {
+            std::vector<Tree*> scc(hypotheses.top().scc.begin(), hypotheses.top().scc.end());
+            EvalProfiler::Frame frame(EvalProfiler::current(), var->getId(), scc.size(),
+                                      [var]() { return "fix(" + profileLabel(*var) + ")"; });
+            SolverTrace::Span span(fTrace, "fixpoint", "iterate");
+            const size_t rounds = fFixpointStats.rounds;
+            
+            // Iterate until all variables in SCC reach their fixpoints
+            std::optional<bool> converged = iterate(var, scc, definitiveMemo, hypotheses, algebra);
+            if (span) {
+                span.setArgs(traceArgs(var, "scc").add("size", static_cast<uint64_t>(scc.size()))
+                    .add("rounds", static_cast<uint64_t>(fFixpointStats.rounds - rounds))
+                    .add("converged", converged.value_or(false)).str());
+            }
+            if (!converged) {
+                // Now part of an SCC below, like a merge of the discovery pass
+                return {hypotheses.hypotheticalValues[var], hypotheses.sccStack.size() - 1};
+            }
+            if (!*converged) {
+                throw std::runtime_error("Fixpoint computation did not converge");
+            }
+        }
         
-        if (converged) {
-            // Success! Move everything to definitive and pop stack
-            promote(definitiveMemo, hypotheses);
+        // Success! Move everything to definitive and pop stack
+        SolverTrace::Span span(fTrace, "scc", "promote");
+        if (span) {
+            span.setArgs(traceArgs(var, "scc").add("size", static_cast<uint64_t>(hypotheses.top().scc.size()))
+                .add("memo", static_cast<uint64_t>(hypotheses.top().hypotheticalMemo.size())).str());
+        }
+        promote(definitiveMemo, hypotheses);
+        const T* value = definitiveMemo.find(var->getId());
+        return {value ? *value : T(), std::nullopt};  // No more dependencies
+    }
+    
+    // Solve an affine SCC as the linear system (I - A)·x = b, writing the
+    // solution into the variable slots of the spine. Returns false (slots
+    // untouched) if a definition is not affine, if ||A||∞ ≥ 1 (iteration
+    // from bottom would not be guaranteed to reach this fixpoint) or if the
+    // elimination fails.
+    template<typename T>
+    bool solveAffine(SCCSpine<T>& spine, const SemanticAlgebra<T>& algebra) const {
+        if constexpr (!std::is_floating_point_v<T>) {
+            return false;
+        } else {
+            if (!fFixpointOptions.solveAffine || !algebra.hasLinearSemantics()) {
+                return false;
+            }
+            const size_t n = spine.definitions.size();
             
-            // Return value of any variable from the SCC (they should all be equivalent)
-            if (!scc.empty()) {
-                Tree* representative = *scc.begin();
-                auto it = definitiveMemo.find(representative);
-                if (it != definitiveMemo.end()) {
-                    return {it->second, std::set<Tree*>{}};  // No more dependencies
+            // Affine form of every slot: variables, then independent values
+            // (constants), then the steps in post-order
+            std::vector<AffineForm> forms(spine.slots.size());
+            for (size_t i = 0; i < spine.slots.size(); ++i) {
+                forms[i] = i < n ? AffineForm::variable(i) : AffineForm::value(static_cast<double>(spine.slots[i]));
+            }
+            // Forms are copied at every step: give up when that costs more than
+            // a few iteration rounds would (e.g. long sums over dense couplings)
+            const size_t termBudget = fFixpointOptions.fillFactor * (spine.steps.size() + n);
+            size_t terms = 0;
+            for (const auto& step : spine.steps) {
+                const AffineForm& a = forms[step.left];
+                const AffineForm& b = forms[step.right];
+                AffineForm& result = forms[step.result];
+                if (step.lazy) {
+                    return false;   // Piecewise in the hypotheses
+                }
+                if (step.tree->getType() == Tree::NodeType::Select) {
+                    // Affine when a constant condition picks one operand
+                    auto branch = a.isConstant() ? algebra.branch(a.constant) : Algebra<T>::Branch::Both;
+                    if (branch == Algebra<T>::Branch::Both) return false;
+                    result = branch == Algebra<T>::Branch::Then ? b : forms[step.otherwise];
+                    continue;
+                }
+                if (step.tree->getType() == Tree::NodeType::Unary) {
+                    if (!a.isConstant()) return false;
+                    result = AffineForm::value(algebra.unary(
+                        static_cast<typename Algebra<T>::UnaryOp>(step.tree->getUnaryOp()), a.constant));
+                    continue;
+                }
+                auto op = static_cast<typename Algebra<T>::BinaryOp>(step.tree->getBinaryOp());
+                if (a.isConstant() && b.isConstant()) {
+                    result = AffineForm::value(algebra.binary(op, a.constant, b.constant));
+                } else if (op == Algebra<T>::BinaryOp::Add) {
+                    result = AffineForm::combine(a, 1.0, b, 1.0);
+                } else if (op == Algebra<T>::BinaryOp::Sub) {
+                    result = AffineForm::combine(a, 1.0, b, -1.0);
+                } else if (op == Algebra<T>::BinaryOp::Mul && a.isConstant()) {
+                    result = b.scaled(a.constant);
+                } else if (op == Algebra<T>::BinaryOp::Mul && b.isConstant()) {
+                    result = a.scaled(b.constant);
+                } else if (op == Algebra<T>::BinaryOp::Div && b.isConstant() && b.constant != 0.0) {
+                    result = a.scaled(1.0 / b.constant);
+                } else {
+                    return false;  // Not affine
+                }
+                terms += result.terms.size();
+                if (terms > termBudget) {
+                    return false;
                 }
             }
             
-            // Fallback (should not happen)
-            if (auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra)) {
-                return {semanticAlg->bottom(), std::set<Tree*>{}};
-            } else if (auto* initialAlg = dynamic_cast<const InitialAlgebra<T>*>(&algebra)) {
-                return {initialAlg->var(), std::set<Tree*>{}};
-            } else {
-                throw std::runtime_error("Unknown algebra type in fixpoint fallback");
+            // Rows of I - A; the fast path requires ||A||∞ < 1
+            LinearSystem system(n);
+            for (size_t i = 0; i < n; ++i) {
+                const AffineForm& form = forms[spine.definitions[i]];
+                double rowNorm = 0.0;
+                system.add(i, i, 1.0);
+                for (const auto& [j, coefficient] : form.terms) {
+                    system.add(i, j, -coefficient);
+                    rowNorm += std::abs(coefficient);
+                }
+                if (!(rowNorm < 1.0)) {
+                    return false;
+                }
+                system.setRhs(i, form.constant);
+            }
+            
+            std::vector<double> solution;
+            bool dense = n <= fFixpointOptions.denseLimit
+                || (n <= fFixpointOptions.denseMatrixLimit && 4 * system.nonZeros() >= n * n);
+            bool solved = dense
+                ? system.solveDense(solution)
+                : system.solveSparse(solution, fFixpointOptions.fillFactor * system.nonZeros());
+            if (!solved) {
+                return false;
+            }
+            for (size_t i = 0; i < n; ++i) {
+                spine.slots[i] = static_cast<T>(solution[i]);
+            }
+            return true;
+        }
+    }
+    
+    // Iterate until convergence for an SCC, re-evaluating only its dependent
+    // spine. Lazy steps may reach variables that join the SCC: scc is then
+    // extended and the iteration starts again from the values reached.
+    // Returns nullopt when they merged it into an SCC lower on the stack,
+    // whose head will solve it.
+    template<typename T>
+    std::optional<bool> iterate(Tree* head, std::vector<Tree*>& scc, SideTable<T>& definitiveMemo,
+                                Hypotheses<T>& hypotheses, const Algebra<T>& algebra) const {
+        const size_t depth = hypotheses.sccStack.size();
+        fFixpointStats.sccs++;
+        for (;;) {
+            std::optional<bool> converged = iterateSpine(head, scc, definitiveMemo, hypotheses, algebra);
+            if (converged) {
+                return converged;
+            }
+            if (hypotheses.sccStack.size() != depth) {
+                return std::nullopt;
+            }
+            const auto& members = hypotheses.top().scc;
+            for (Tree* var : members) {
+                if (std::find(scc.begin(), scc.end(), var) == scc.end()) {
+                    scc.push_back(var);
+                }
             }
-        } else {
-            throw std::runtime_error("Fixpoint computation did not converge");
         }
     }
     
-    // Iterate until convergence for an SCC
+    // Rounds over the spine of scc. Returns nullopt, the values of the last
+    // round published as hypotheses, when the SCC on top of the stack grew.
     template<typename T>
-    bool iterate(const std::set<Tree*>& scc, std::map<Tree*, T>& definitiveMemo,
-                 Hypotheses<T>& hypotheses, const Algebra<T>& algebra) const {
+    std::optional<bool> iterateSpine(Tree* head, const std::vector<Tree*>& scc, SideTable<T>& definitiveMemo,
+                                     Hypotheses<T>& hypotheses, const Algebra<T>& algebra) const {
         const int MAX_ITER = 10000;  // Safety limit to avoid infinite loops
+        auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra);
+        SolverTrace* trace = fTrace;
+        
+        SCCSpine<T> spine;
+        {
+            SolverTrace::Span span(trace, "fixpoint", "spine");
+            spine = buildSpine(scc, definitiveMemo, hypotheses, algebra);
+            if (span) {
+                span.setArgs(traceArgs(head, "scc").add("steps", static_cast<uint64_t>(spine.steps.size()))
+                    .add("independent", static_cast<uint64_t>(spine.independentNodes)).str());
+            }
+        }
+        fFixpointStats.dependentNodes += spine.steps.size();
+        fFixpointStats.independentNodes += spine.independentNodes;
+        
+        // Affine SCCs start from their exact solution: the rounds below then
+        // only confirm it, usually in one round
+        if (semanticAlg) {
+            SolverTrace::Span span(trace, "fixpoint", "solveAffine");
+            const bool solved = solveAffine(spine, *semanticAlg);
+            if (solved) {
+                fFixpointStats.affineSCCs++;
+            }
+            if (span) {
+                span.setArgs(traceArgs(head, "scc").add("solved", solved).str());
+            }
+        }
+        
+        // Extrapolation of the iterates, for floating-point algebras with linear semantics
+        std::unique_ptr<SafeguardedAcceleration<T>> accelerator;
+        if constexpr (std::is_floating_point_v<T>) {
+            if (semanticAlg && semanticAlg->hasLinearSemantics()
+                && fFixpointOptions.acceleration != Acceleration::None) {
+                accelerator = std::make_unique<SafeguardedAcceleration<T>>(
+                    makeAccelerator<T>(fFixpointOptions.acceleration, fFixpointOptions.andersonDepth));
+            }
+        }
+        
+        // Operand of a lazy step, from the hypotheses of the current round
+        auto evalOperand = [&](const std::shared_ptr<Tree>& operand) {
+            return evalInternal(operand, definitiveMemo, hypotheses, algebra).first;
+        };
         
-        for (int iteration = 0; iteration < MAX_ITER; ++iteration) {
-            // Store previous values for convergence check
-            std::map<Tree*, T> previousValues;
-            for (Tree* var : scc) {
-                if (hypotheses.hypotheticalValues.count(var)) {
-                    previousValues[var] = hypotheses.hypotheticalValues[var];
+        const size_t n = scc.size();
+        std::vector<T> current;
+        std::vector<T> newValues;
+        std::vector<T> next;
+        EvalProfiler* profiler = EvalProfiler::current();
+        current.reserve(n);
+        newValues.reserve(n);
+        bool converged = false;
+        for (int iteration = 0; iteration < MAX_ITER && !converged; ++iteration) {
+            SolverTrace::Span span(trace, "fixpoint", "round");
+            if (spine.lazySteps) {
+                // Lazy steps read the hypotheses: this round's, not memoized ones
+                for (size_t i = 0; i < n; ++i) {
+                    hypotheses.hypotheticalValues[scc[i]] = spine.slots[i];
                 }
+                hypotheses.top().hypotheticalMemo.clear();
             }
-            
-            // Compute new values for each variable in the SCC
-            std::map<Tree*, T> newValues;
-            for (Tree* var : scc) {
-                auto definition = getDefinition(var);
-                if (!definition) {
-                    throw std::runtime_error("Variable " + std::to_string(var->getVarIndex()) + " has no definition");
+            // Evaluate the spine from the current hypotheses (variable slots)
+            for (const auto& step : spine.steps) {
+                Tree* tree = step.tree;
+                if (tree->getType() == Tree::NodeType::Unary) {
+                    spine.slots[step.result] = algebra.unary(static_cast<typename Algebra<T>::UnaryOp>(tree->getUnaryOp()),
+                                                             spine.slots[step.left]);
+                } else if (step.lazy) {
+                    const T c = spine.slots[step.left];
+                    switch (algebra.branch(c)) {
+                        case Algebra<T>::Branch::Then: spine.slots[step.result] = evalOperand(tree->getThen()); break;
+                        case Algebra<T>::Branch::Else: spine.slots[step.result] = evalOperand(tree->getElse()); break;
+                        case Algebra<T>::Branch::Both:
+                            spine.slots[step.result] = algebra.select(c, evalOperand(tree->getThen()),
+                                                                      evalOperand(tree->getElse()));
+                            break;
+                    }
+                } else if (tree->getType() == Tree::NodeType::Select) {
+                    const T& c = spine.slots[step.left];
+                    T& result = spine.slots[step.result];
+                    switch (algebra.branch(c)) {
+                        case Algebra<T>::Branch::Then: result = spine.slots[step.right]; break;
+                        case Algebra<T>::Branch::Else: result = spine.slots[step.otherwise]; break;
+                        case Algebra<T>::Branch::Both:
+                            result = algebra.select(c, spine.slots[step.right], spine.slots[step.otherwise]);
+                            break;
+                    }
+                } else {
+                    spine.slots[step.result] = algebra.binary(static_cast<typename Algebra<T>::BinaryOp>(tree->getBinaryOp()),
+                                                              spine.slots[step.left], spine.slots[step.right]);
                 }
-                
-                // Evaluate the definition (this will use current hypothetical values)
-                auto [value, deps] = evalInternal(definition, definitiveMemo, hypotheses, algebra);
-                newValues[var] = value;
             }
-            
-            // Update all variables with new values
-            for (const auto& [var, value] : newValues) {
-                hypotheses.hypotheticalValues[var] = value;
+            fFixpointStats.rounds++;
+            fFixpointStats.nodeEvaluations += spine.steps.size();
+            if (profiler) {
+                profiler->round(spine.steps.size());
+            }
+            if (spine.lazySteps && hypotheses.top().scc.size() != n) {
+                // A taken operand reached variables merged into this SCC since:
+                // start again with them, from this round's hypotheses
+                if (accelerator) {
+                    fFixpointStats.accelerationResets += accelerator->resets;
+                }
+                return std::nullopt;
             }
             
             // Check if all variables reached their fixpoints
-            bool allConverged = true;
-            for (Tree* var : scc) {
-                if (previousValues.count(var) && newValues.count(var)) {
-                    // Use semantic convergence test instead of strict equality
-                    if (auto* semanticAlg = dynamic_cast<const SemanticAlgebra<T>*>(&algebra)) {
-                        if (!semanticAlg->isConverged(previousValues[var], newValues[var])) {
-                            allConverged = false;
-                            break;
-                        }
-                    } else {
-                        // Fallback to strict equality for non-semantic algebras
-                        if (previousValues[var] != newValues[var]) {
-                            allConverged = false;
-                            break;
-                        }
-                    }
+            current.assign(spine.slots.begin(), spine.slots.begin() + n);
+            newValues.clear();
+            for (size_t definition : spine.definitions) {
+                newValues.push_back(spine.slots[definition]);
+            }
+            converged = true;
+            for (size_t i = 0; i < n && converged; ++i) {
+                // Use semantic convergence test instead of strict equality
+                if (semanticAlg) {
+                    converged = semanticAlg->isConverged(current[i], newValues[i]);
                 } else {
-                    // First iteration or missing value
-                    allConverged = false;
-                    break;
+                    // Fallback to strict equality for non-semantic algebras
+                    converged = current[i] == newValues[i];
                 }
             }
             
-            if (allConverged) {
-                return true;  // Converged!
+            if (span) {
+                span.setArgs(traceRound(head, iteration, current, newValues, semanticAlg));
+            }
+            
+            // Update all variables with new values, or with an extrapolation of them
+            const std::vector<T>* update = &newValues;
+            if constexpr (std::is_floating_point_v<T>) {
+                if (!converged && accelerator) {
+                    // next() also resumes from the plain image when it rejects an extrapolation
+                    if (accelerator->next(current, newValues, next)) {
+                        fFixpointStats.acceleratedRounds++;
+                    }
+                    update = &next;
+                }
             }
+            std::copy(update->begin(), update->end(), spine.slots.begin());
+        }
+        if (accelerator) {
+            fFixpointStats.accelerationResets += accelerator->resets;
+        }
+        
+        // Publish the last round: variable values and spine results for promotion
+        for (size_t i = 0; i < scc.size(); ++i) {
+            hypotheses.hypotheticalValues[scc[i]] = spine.slots[i];
+        }
+        auto& memo = hypotheses.top().hypotheticalMemo;
+        for (const auto& step : spine.steps) {
+            memo[step.tree] = spine.slots[step.result];
         }
         
-        return false;  // Did not converge within MAX_ITER iterations
+        return converged;  // false if it did not converge within MAX_ITER iterations
+    }
+    
+    // Trace arguments naming a node by its id
+    static SolverTrace::Args traceArgs(const Tree* tree, const char* name = "id") {
+        SolverTrace::Args args;
+        args.add(name, static_cast<uint64_t>(tree->getId()));
+        return args;
+    }
+    
+    // Trace arguments of an iteration round: variables that changed, and
+    // the largest change when values have a distance
+    template<typename T>
+    static std::string traceRound(Tree* head, int iteration, const std::vector<T>& previous,
+                                  const std::vector<T>& next, const SemanticAlgebra<T>* semanticAlg) {
+        uint64_t changed = 0;
+        std::optional<double> delta;
+        for (size_t i = 0; i < previous.size(); ++i) {
+            if (semanticAlg ? !semanticAlg->isConverged(previous[i], next[i]) : !(previous[i] == next[i])) {
+                changed++;
+            }
+            if (std::optional<double> d = SolverTrace::distance(previous[i], next[i])) {
+                delta = std::max(delta.value_or(0.0), *d);
+            }
+        }
+        SolverTrace::Args args = traceArgs(head, "scc");
+        args.add("round", static_cast<uint64_t>(iteration)).add("changed", changed);
+        if (delta) {
+            args.add("delta", *delta);
+        }
+        return args.str();
     }
     
     // Alpha-equivalence implementation
@@ -940,6 +2023,8 @@ private:
         switch (t1->getType()) {
             // Constantes: (Num, Num) → value(T₁*) = value(T₂*)
             case Tree::NodeType::Num:
+                if (t1->getConstantOp() != t2->getConstantOp()) return false;
+                if (t1->getConstantOp() == ConstantOp::Integer) return t1->getInteger() == t2->getInteger();
                 return t1->getValue() == t2->getValue();
             
             // Opérations unaires: (Op, Op) → op(T₁*) = op(T₂*) ∧ recurse on children
@@ -953,6 +2038,11 @@ private:
                        alphaEquivMemo(t1->getLeft().get(), t2->getLeft().get()) &&
                        alphaEquivMemo(t1->getRight().get(), t2->getRight().get());
             
+            case Tree::NodeType::Select:
+                return alphaEquivMemo(t1->getCondition().get(), t2->getCondition().get()) &&
+                       alphaEquivMemo(t1->getThen().get(), t2->getThen().get()) &&
+                       alphaEquivMemo(t1->getElse().get(), t2->getElse().get());
+            
             // Variables: handleVarsDAG(v₁*, v₂*, memo, varMap)
             case Tree::NodeType::Var:
                 return handleVarsDAG(t1, t2);
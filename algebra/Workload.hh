@@ -0,0 +1,447 @@
+#ifndef WORKLOAD_HH
+#define WORKLOAD_HH
+
+#include "TreeAlgebra.hh"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Workload - Synthetic TreeAlgebra Workloads
+ * ==========================================
+ *
+ * PURPOSE
+ * -------
+ * Builds reproducible expression DAGs and recursive equation systems with
+ * controllable shape, so that performance problems can be reproduced without
+ * sharing real models and so that benchmarks have comparable inputs.
+ *
+ * GENERATED STRUCTURE
+ * -------------------
+ * A workload is made of two parts:
+ *
+ * **Recursive systems**: `sccCount` strongly connected components of
+ * `sccSize` variables each, bound with define(). Every definition is
+ *   xᵢ = Σⱼ cᵢⱼ·term(xⱼ) + kᵢ
+ * with Σⱼ|cᵢⱼ| = contraction < 1, so DoubleAlgebra iteration converges.
+ * term(x) is x for affine systems and abs(x - k) for nonlinear ones.
+ * The topology decides which xⱼ appear in the definition of xᵢ:
+ *   - Ring:   xᵢ → xᵢ₊₁ (mod n)
+ *   - Chain:  xᵢ → xᵢ₋₁, xᵢ₊₁ (bidirectional path)
+ *   - Clique: xᵢ → every xⱼ
+ *   - Nested: xᵢ → xᵢ, xᵢ₊₁ (mod n); every variable closes its own loop, so
+ *             on-the-fly SCC discovery sees n nested SCCs collapsing into one
+ *
+ * **Non-recursive DAG**: `nodeCount` operator nodes drawn from the operator
+ * mix. Each operand is either a node already used elsewhere (probability
+ * `sharingRatio`), a node not used yet, or a fresh leaf. Leaves are constants
+ * from a pool of `constantPool` values, or (probability `varLeafRatio`) a
+ * variable of one of the recursive systems. Nodes that end up with no parent
+ * are summed into the `rootCount` roots so that everything is reachable.
+ *
+ * **Piecewise nodes**: with `selectWeight` > 0, an operator node is, with
+ * that weight against the operator mixes, a conditional
+ * select(a - b, c, d) (a > b ? c : d) over four operands drawn as above
+ * (a binary node instead when `maxDepth` < 2 leaves no room for it).
+ *
+ * DEPTH PROFILE
+ * -------------
+ * Operands are chosen by creation order, which tracks depth:
+ *   - Uniform: any earlier node
+ *   - Shallow: favours early (low) nodes, giving wide and flat DAGs
+ *   - Deep:    favours recent (high) nodes, giving long spines
+ * No node is deeper than `maxDepth`; a leaf is used instead.
+ *
+ * DETERMINISM
+ * -----------
+ * All choices come from a SplitMix64 stream seeded with `seed`. Unlike the
+ * std::*_distribution classes it is bit-for-bit identical on every standard
+ * library, so a (params, seed) pair names the same workload everywhere.
+ * Variable indices depend on the TreeAlgebra's counter, but two workloads
+ * generated from the same parameters are always alpha-equivalent.
+ */
+
+// SplitMix64 (Steele, Lea, Flood 2014) with portable derived distributions
+class WorkloadRandom {
+private:
+    uint64_t fState;
+
+public:
+    explicit WorkloadRandom(uint64_t seed) : fState(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (fState += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform in [0, 1)
+    double uniform() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    // Uniform in [0, n), 0 when n == 0
+    size_t below(size_t n) {
+        return n == 0 ? 0 : static_cast<size_t>(next() % n);
+    }
+
+    // Index drawn proportionally to weights, weights.size() if all are zero
+    template<size_t N>
+    size_t pick(const std::array<double, N>& weights) {
+        double total = 0.0;
+        for (double w : weights) total += w;
+        if (total <= 0.0) return N;
+        double r = uniform() * total;
+        size_t last = 0;
+        for (size_t i = 0; i < N; ++i) {
+            if (r < weights[i]) return i;
+            r -= weights[i];
+            if (weights[i] > 0.0) last = i;
+        }
+        return last;   // Rounding: the last index that has a weight
+    }
+};
+
+struct WorkloadParams {
+    enum class DepthProfile { Uniform, Shallow, Deep };
+    enum class Constants { SmallIntegers, Uniform, LowBits };
+    enum class Topology { Ring, Chain, Clique, Nested };
+
+    static constexpr size_t UNARY_COUNT = static_cast<size_t>(UnaryOp::COUNT);
+    static constexpr size_t BINARY_COUNT = static_cast<size_t>(BinaryOp::COUNT);
+
+    uint64_t seed = 1;
+
+    // Non-recursive DAG
+    size_t nodeCount = 1000;
+    size_t rootCount = 1;
+    double sharingRatio = 0.5;
+    size_t maxDepth = 64;
+    DepthProfile depthProfile = DepthProfile::Uniform;
+    // Weights in UnaryOp / BinaryOp order; the elementary functions, min,
+    // max and pow are 0 by default
+    std::array<double, UNARY_COUNT> unaryMix = {0.5};                     // Abs
+    std::array<double, BINARY_COUNT> binaryMix = {4.0, 2.0, 3.0, 0.5, 0.25}; // Add Sub Mul Div Mod
+    double selectWeight = 0.0;   // Piecewise nodes select(a - b, c, d), against the mixes above
+
+    // Constant distribution
+    Constants constants = Constants::SmallIntegers;
+    double constantMin = 1.0;
+    double constantMax = 16.0;
+    size_t constantPool = 64;
+
+    // Recursive systems
+    size_t sccCount = 0;
+    size_t sccSize = 1;
+    Topology topology = Topology::Ring;
+    double contraction = 0.5;
+    bool nonlinear = false;
+    double varLeafRatio = 0.1;
+};
+
+struct WorkloadStats {
+    size_t nodes = 0;         // Distinct reachable nodes, definitions included
+    size_t constants = 0;
+    size_t operators = 0;
+    size_t variables = 0;
+    size_t sharedNodes = 0;   // Nodes with more than one parent
+    size_t maxDepth = 0;      // Longest operator path, variables count as leaves
+};
+
+struct Workload {
+    WorkloadParams params;
+    std::vector<std::shared_ptr<Tree>> roots;
+    std::vector<std::vector<std::shared_ptr<Tree>>> sccs;  // Variables of each recursive system
+};
+
+class WorkloadGenerator {
+private:
+    WorkloadParams fParams;
+
+    struct Entry {
+        std::shared_ptr<Tree> node;
+        size_t depth;
+    };
+
+    std::vector<double> makeConstants(WorkloadRandom& rng) const {
+        std::vector<double> pool;
+        size_t count = fParams.constantPool > 0 ? fParams.constantPool : 1;
+        double lo = fParams.constantMin;
+        double hi = fParams.constantMax;
+        for (size_t i = 0; i < count; ++i) {
+            switch (fParams.constants) {
+                case WorkloadParams::Constants::SmallIntegers: {
+                    double span = std::floor(hi) - std::ceil(lo) + 1.0;
+                    pool.push_back(std::ceil(lo) + std::floor(rng.uniform() * std::max(span, 1.0)));
+                    break;
+                }
+                case WorkloadParams::Constants::Uniform:
+                    pool.push_back(lo + rng.uniform() * (hi - lo));
+                    break;
+                case WorkloadParams::Constants::LowBits: {
+                    // Same sign, exponent and high mantissa bits: only the low 16 bits differ
+                    double base = lo;
+                    uint64_t bits;
+                    std::memcpy(&bits, &base, sizeof bits);
+                    bits = (bits & ~uint64_t(0xffff)) | (i & 0xffff);
+                    double value;
+                    std::memcpy(&value, &bits, sizeof value);
+                    pool.push_back(value);
+                    break;
+                }
+            }
+        }
+        return pool;
+    }
+
+    std::vector<size_t> neighbours(size_t i, size_t n) const {
+        std::vector<size_t> deps;
+        switch (fParams.topology) {
+            case WorkloadParams::Topology::Ring:
+                deps.push_back((i + 1) % n);
+                break;
+            case WorkloadParams::Topology::Chain:
+                if (i > 0) deps.push_back(i - 1);
+                if (i + 1 < n) deps.push_back(i + 1);
+                if (deps.empty()) deps.push_back(i);
+                break;
+            case WorkloadParams::Topology::Clique:
+                for (size_t j = 0; j < n; ++j) deps.push_back(j);
+                break;
+            case WorkloadParams::Topology::Nested:
+                deps.push_back(i);
+                if (n > 1) deps.push_back((i + 1) % n);
+                break;
+        }
+        return deps;
+    }
+
+    std::vector<std::shared_ptr<Tree>> makeSCC(const TreeAlgebra& alg, WorkloadRandom& rng,
+                                               const std::vector<double>& constants) const {
+        size_t n = fParams.sccSize > 0 ? fParams.sccSize : 1;
+        std::vector<std::shared_ptr<Tree>> vars;
+        for (size_t i = 0; i < n; ++i) {
+            vars.push_back(alg.var());
+        }
+        for (size_t i = 0; i < n; ++i) {
+            auto deps = neighbours(i, n);
+            double c = fParams.contraction / static_cast<double>(deps.size());
+            std::shared_ptr<Tree> acc;
+            for (size_t j : deps) {
+                std::shared_ptr<Tree> term = vars[j];
+                if (fParams.nonlinear) {
+                    term = alg.abs(alg.sub(term, alg.num(constants[rng.below(constants.size())])));
+                }
+                double sign = rng.uniform() < 0.5 ? -1.0 : 1.0;
+                auto scaled = alg.mul(alg.num(sign * c), term);
+                acc = acc ? alg.add(acc, scaled) : scaled;
+            }
+            alg.define(vars[i], alg.add(acc, alg.num(constants[rng.below(constants.size())])));
+        }
+        return vars;
+    }
+
+    // Biased choice of an index in [0, n) following the depth profile
+    size_t choose(WorkloadRandom& rng, size_t n) const {
+        double u = rng.uniform();
+        switch (fParams.depthProfile) {
+            case WorkloadParams::DepthProfile::Uniform:
+                break;
+            case WorkloadParams::DepthProfile::Shallow:
+                u = u * u * u;
+                break;
+            case WorkloadParams::DepthProfile::Deep:
+                u = 1.0 - u * u * u;
+                break;
+        }
+        return std::min(static_cast<size_t>(u * static_cast<double>(n)), n - 1);
+    }
+
+public:
+    explicit WorkloadGenerator(const WorkloadParams& params) : fParams(params) {}
+
+    const WorkloadParams& params() const { return fParams; }
+
+    Workload generate(const TreeAlgebra& alg) const {
+        WorkloadRandom rng(fParams.seed);
+        Workload workload;
+        workload.params = fParams;
+
+        auto constants = makeConstants(rng);
+        std::vector<std::shared_ptr<Tree>> allVars;
+        for (size_t s = 0; s < fParams.sccCount; ++s) {
+            workload.sccs.push_back(makeSCC(alg, rng, constants));
+            allVars.insert(allVars.end(), workload.sccs.back().begin(), workload.sccs.back().end());
+        }
+
+        std::vector<Entry> pool;       // Every operator node, in creation order
+        std::vector<Entry> unused;     // Nodes without a parent yet
+
+        // Each recursive system must be reachable from some root
+        for (const auto& scc : workload.sccs) {
+            unused.push_back({scc.front(), 0});
+        }
+
+        auto leaf = [&]() -> Entry {
+            if (!allVars.empty() && rng.uniform() < fParams.varLeafRatio) {
+                return {allVars[rng.below(allVars.size())], 0};
+            }
+            return {alg.num(constants[rng.below(constants.size())]), 0};
+        };
+
+        // An operand no deeper than limit
+        auto operand = [&](size_t limit) -> Entry {
+            if (!pool.empty() && rng.uniform() < fParams.sharingRatio) {
+                const Entry& e = pool[choose(rng, pool.size())];
+                return e.depth > limit ? leaf() : e;
+            }
+            if (!unused.empty()) {
+                size_t k = choose(rng, unused.size());
+                if (unused[k].depth > limit) {
+                    return leaf();  // Stays unused, will be folded into a root
+                }
+                Entry e = unused[k];
+                unused[k] = unused.back();
+                unused.pop_back();
+                return e;
+            }
+            return leaf();
+        };
+
+        double unaryWeight = 0.0;
+        double binaryWeight = 0.0;
+        for (double w : fParams.unaryMix) unaryWeight += w;
+        for (double w : fParams.binaryMix) binaryWeight += w;
+
+        // Operands of a node one level up; a select is two levels above its
+        // condition operands a and b (a - b is in between), one above c and d
+        const size_t limit = fParams.maxDepth > 0 ? fParams.maxDepth - 1 : 0;
+        const size_t conditionLimit = limit > 0 ? limit - 1 : 0;
+        for (size_t i = 0; i < fParams.nodeCount; ++i) {
+            Entry node;
+            const double r = rng.uniform() * (unaryWeight + binaryWeight + fParams.selectWeight);
+            bool unary = r < unaryWeight;
+            if (r >= unaryWeight + binaryWeight && fParams.maxDepth >= 2) {
+                Entry a = operand(conditionLimit);
+                Entry b = operand(conditionLimit);
+                Entry c = operand(limit);
+                Entry d = operand(limit);
+                const size_t depth = std::max(std::max(a.depth, b.depth) + 1, std::max(c.depth, d.depth));
+                node = {alg.select(alg.sub(a.node, b.node), c.node, d.node), depth + 1};
+            } else if (unary) {
+                auto op = static_cast<UnaryOp>(rng.pick(fParams.unaryMix));
+                Entry a = operand(limit);
+                node = {alg.unary(op, a.node), a.depth + 1};
+            } else {
+                auto op = static_cast<BinaryOp>(std::min(rng.pick(fParams.binaryMix),
+                                                         WorkloadParams::BINARY_COUNT - 1));
+                Entry a = operand(limit);
+                Entry b = operand(limit);
+                node = {alg.binary(op, a.node, b.node), std::max(a.depth, b.depth) + 1};
+            }
+            pool.push_back(node);
+            unused.push_back(node);
+        }
+
+        // Fold dangling nodes into the roots pairwise, keeping the added depth logarithmic
+        size_t rootCount = fParams.rootCount > 0 ? fParams.rootCount : 1;
+        while (unused.size() > rootCount) {
+            std::vector<Entry> next;
+            size_t remaining = unused.size();
+            for (size_t i = 0; i < unused.size(); ++i) {
+                if (i + 1 < unused.size() && remaining > rootCount) {
+                    const Entry& a = unused[i];
+                    const Entry& b = unused[++i];
+                    next.push_back({alg.add(a.node, b.node), std::max(a.depth, b.depth) + 1});
+                    --remaining;
+                } else {
+                    next.push_back(unused[i]);
+                }
+            }
+            unused.swap(next);
+        }
+        while (unused.size() < rootCount) {
+            unused.push_back(leaf());
+        }
+        for (const auto& e : unused) {
+            workload.roots.push_back(e.node);
+        }
+        return workload;
+    }
+
+    // Structural statistics of everything reachable from the roots
+    static WorkloadStats measure(const std::vector<std::shared_ptr<Tree>>& roots) {
+        WorkloadStats stats;
+        std::unordered_map<Tree*, size_t> parents;
+        std::unordered_map<Tree*, size_t> depth;     // Present once a node is expanded
+        std::vector<std::pair<Tree*, bool>> stack;
+
+        auto children = [](Tree* t) {
+            std::vector<Tree*> result;
+            switch (t->getType()) {
+                case Tree::NodeType::Num:
+                    break;
+                case Tree::NodeType::Unary:
+                    result.push_back(t->getOperand().get());
+                    break;
+                case Tree::NodeType::Binary:
+                    result.push_back(t->getLeft().get());
+                    result.push_back(t->getRight().get());
+                    break;
+                case Tree::NodeType::Var:
+                    if (t->getDefinition()) result.push_back(t->getDefinition().get());
+                    break;
+                case Tree::NodeType::Select:
+                    result.push_back(t->getCondition().get());
+                    result.push_back(t->getThen().get());
+                    result.push_back(t->getElse().get());
+                    break;
+            }
+            return result;
+        };
+
+        for (const auto& root : roots) {
+            parents.emplace(root.get(), 0);
+            stack.push_back({root.get(), false});
+            while (!stack.empty()) {
+                auto [t, expanded] = stack.back();
+                stack.pop_back();
+                if (expanded) {
+                    // Variables are leaves for depth purposes (their definitions may be cyclic)
+                    size_t d = 0;
+                    if (t->getType() != Tree::NodeType::Var) {
+                        for (Tree* c : children(t)) d = std::max(d, depth[c] + 1);
+                    }
+                    depth[t] = d;
+                    stats.maxDepth = std::max(stats.maxDepth, d);
+                    continue;
+                }
+                if (depth.count(t)) continue;
+                depth[t] = 0;
+                stack.push_back({t, true});
+                for (Tree* c : children(t)) {
+                    ++parents[c];
+                    if (!depth.count(c)) stack.push_back({c, false});
+                }
+            }
+        }
+
+        for (const auto& [t, count] : parents) {
+            ++stats.nodes;
+            if (count > 1) ++stats.sharedNodes;
+            switch (t->getType()) {
+                case Tree::NodeType::Num: ++stats.constants; break;
+                case Tree::NodeType::Var: ++stats.variables; break;
+                default: ++stats.operators; break;
+            }
+        }
+        return stats;
+    }
+};
+
+#endif
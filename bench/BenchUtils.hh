@@ -0,0 +1,150 @@
+#ifndef BENCH_UTILS_HH
+#define BENCH_UTILS_HH
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <pthread.h>
+#include <stdexcept>
+#include <string>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Shared helpers for the benchmark executables
+
+class Stopwatch {
+private:
+    std::chrono::steady_clock::time_point fStart = std::chrono::steady_clock::now();
+
+public:
+    void restart() { fStart = std::chrono::steady_clock::now(); }
+
+    double seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - fStart).count();
+    }
+};
+
+// Best wall-clock time of `runs` executions of fn, in seconds
+template<typename F>
+double bestOf(int runs, F&& fn) {
+    double best = 1e300;
+    for (int i = 0; i < runs; ++i) {
+        Stopwatch sw;
+        fn();
+        double t = sw.seconds();
+        if (t < best) best = t;
+    }
+    return best;
+}
+
+// Problem sizes can be scaled down for quick runs: BENCH_SCALE=0.1 ./bench_x
+inline double benchScale() {
+    const char* s = std::getenv("BENCH_SCALE");
+    return s ? std::atof(s) : 1.0;
+}
+
+inline size_t scaled(size_t n) {
+    double v = static_cast<double>(n) * benchScale();
+    return v < 1.0 ? 1 : static_cast<size_t>(v);
+}
+
+// Keep a value alive so the optimizer cannot drop the computation producing it
+template<typename T>
+void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Last-level cache misses of the calling thread, through perf_event_open.
+// Unavailable (available() false, count() 0) outside Linux, without a
+// hardware PMU (most VMs) or when perf_event_paranoid forbids it.
+class CacheMissCounter {
+private:
+    int fFd = -1;
+
+#if defined(__linux__)
+    static int open(uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+
+public:
+    CacheMissCounter() {
+#if defined(__linux__)
+        fFd = open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL
+                   | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        if (fFd < 0) {
+            fFd = open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        }
+#endif
+    }
+
+    ~CacheMissCounter() {
+#if defined(__linux__)
+        if (fFd >= 0) close(fFd);
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool available() const { return fFd >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        if (fFd >= 0) {
+            ioctl(fFd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fFd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // Misses since start()
+    uint64_t stop() {
+        uint64_t count = 0;
+#if defined(__linux__)
+        if (fFd >= 0) {
+            ioctl(fFd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fFd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+};
+
+// Evaluation of deeply nested definitions recurses once per nesting level:
+// run fn on a thread with a large stack instead of the main thread
+inline void runWithStack(size_t bytes, const std::function<void()>& fn) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, bytes);
+    auto trampoline = [](void* arg) -> void* {
+        (*static_cast<const std::function<void()>*>(arg))();
+        return nullptr;
+    };
+    pthread_t thread;
+    if (pthread_create(&thread, &attr, trampoline, const_cast<std::function<void()>*>(&fn)) != 0) {
+        pthread_attr_destroy(&attr);
+        throw std::runtime_error("runWithStack: cannot create thread");
+    }
+    pthread_join(thread, nullptr);
+    pthread_attr_destroy(&attr);
+}
+
+#endif
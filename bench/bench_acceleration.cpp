@@ -0,0 +1,81 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+
+// Nonlinear SCCs (abs terms, no affine fast path): rounds to convergence and
+// solve time with plain iteration, Aitken Δ² and Anderson(m)
+
+struct Strategy {
+    const char* label;
+    Acceleration acceleration;
+    size_t depth;
+};
+
+static void row(WorkloadParams::Topology topology, const char* label, size_t size, double contraction) {
+    WorkloadParams params;
+    params.nodeCount = 0;
+    params.sccCount = 1;
+    params.sccSize = size;
+    params.topology = topology;
+    params.contraction = contraction;
+    params.nonlinear = true;
+    
+    TreeAlgebra alg;
+    DoubleAlgebra doubleAlg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    
+    std::cout << std::left << std::setw(8) << label << std::right
+              << std::setw(7) << size << std::setw(7) << std::setprecision(3) << contraction;
+    
+    const Strategy strategies[] = {
+        {"plain", Acceleration::None, 0},
+        {"aitken", Acceleration::Aitken, 0},
+        {"anderson3", Acceleration::Anderson, 3},
+        {"anderson8", Acceleration::Anderson, 8},
+    };
+    for (const Strategy& strategy : strategies) {
+        FixpointOptions options;
+        options.acceleration = strategy.acceleration;
+        options.andersonDepth = strategy.depth;
+        alg.setFixpointOptions(options);
+        
+        double seconds = 0.0;
+        bool failed = false;
+        runWithStack(size_t(1) << 30, [&]() {
+            try {
+                seconds = bestOf(3, [&]() { doNotOptimize(alg.eval(w.sccs[0][0], doubleAlg)); });
+            } catch (const std::runtime_error&) {
+                failed = true;
+            }
+        });
+        if (failed) {
+            std::cout << std::setw(20) << "no convergence";
+        } else {
+            std::cout << std::setw(8) << alg.fixpointStats().rounds
+                      << std::setw(12) << std::fixed << std::setprecision(3) << seconds * 1e3;
+        }
+        std::cout.unsetf(std::ios::fixed);
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(8) << "topology" << std::right << std::setw(7) << "vars" << std::setw(7) << "rho";
+    for (const char* label : {"plain", "aitken", "anderson3", "anderson8"}) {
+        std::cout << std::setw(8) << label << std::setw(12) << "(ms)";
+    }
+    std::cout << std::endl;
+    
+    using Topology = WorkloadParams::Topology;
+    for (double contraction : {0.9, 0.99, 0.999}) {
+        for (size_t size : {scaled(10), scaled(1000)}) {
+            row(Topology::Ring, "ring", size, contraction);
+            row(Topology::Chain, "chain", size, contraction);
+            row(Topology::Nested, "nested", size, contraction);
+        }
+    }
+    return 0;
+}
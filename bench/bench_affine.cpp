@@ -0,0 +1,71 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+
+// Affine SCCs: linear-system fast path against plain iteration. Systems have
+// contraction 0.9, a typical slowly converging recursive filter. Solve time
+// includes SCC discovery, which both columns share.
+
+static double solve(TreeAlgebra& alg, const std::shared_ptr<Tree>& root, bool affine, size_t& rounds) {
+    FixpointOptions options;
+    options.solveAffine = affine;
+    alg.setFixpointOptions(options);
+    
+    DoubleAlgebra doubleAlg;
+    double seconds = 0.0;
+    runWithStack(size_t(1) << 30, [&]() {
+        seconds = bestOf(3, [&]() { doNotOptimize(alg.eval(root, doubleAlg)); });
+    });
+    rounds = alg.fixpointStats().rounds;
+    return seconds;
+}
+
+static void row(WorkloadParams::Topology topology, const char* label, size_t size) {
+    WorkloadParams params;
+    params.nodeCount = 0;
+    params.sccCount = 1;
+    params.sccSize = size;
+    params.topology = topology;
+    params.contraction = 0.9;
+    
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    
+    size_t iterRounds = 0;
+    size_t affineRounds = 0;
+    double iterated = solve(alg, w.sccs[0][0], false, iterRounds);
+    double solved = solve(alg, w.sccs[0][0], true, affineRounds);
+    const char* solver = alg.fixpointStats().affineSCCs == 0 ? "-"
+                       : size <= alg.fixpointOptions().denseLimit || topology == WorkloadParams::Topology::Clique
+                       ? "dense" : "sparse";
+    
+    std::cout << std::left << std::setw(10) << label << std::right
+              << std::setw(8) << size
+              << std::setw(14) << std::fixed << std::setprecision(3) << iterated * 1e3
+              << std::setw(8) << iterRounds
+              << std::setw(14) << solved * 1e3
+              << std::setw(8) << affineRounds
+              << std::setw(8) << solver
+              << std::setw(10) << std::setprecision(1) << iterated / solved << "x"
+              << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(10) << "topology" << std::right
+              << std::setw(8) << "vars"
+              << std::setw(14) << "iterate (ms)" << std::setw(8) << "rounds"
+              << std::setw(14) << "affine (ms)" << std::setw(8) << "rounds"
+              << std::setw(8) << "solver" << std::setw(11) << "speedup" << std::endl;
+    
+    using Topology = WorkloadParams::Topology;
+    const std::vector<size_t> sizes = {scaled(10), scaled(100), scaled(1000), scaled(10000)};
+    for (size_t size : sizes) row(Topology::Ring, "ring", size);
+    for (size_t size : sizes) row(Topology::Chain, "chain", size);
+    for (size_t size : sizes) row(Topology::Nested, "nested", size);
+    // Every variable in every definition: n² coefficients
+    for (size_t size : {scaled(10), scaled(100), scaled(300)}) row(Topology::Clique, "clique", size);
+    return 0;
+}
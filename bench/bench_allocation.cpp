@@ -0,0 +1,67 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/Tape.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Tapes of growing DAGs evaluated again and again in DoubleAlgebra, with
+// one slot per instruction against slots allocated by liveness: the peak
+// slot count (next to the widest depth level of the DAG), the memory of
+// the slots, and the time per evaluation.
+
+template<typename F>
+static double perEvaluation(size_t repeats, F f) {
+    return bestOf(3, [&]() {
+        for (size_t r = 0; r < repeats; ++r) {
+            f();
+        }
+    }) / static_cast<double>(repeats);
+}
+
+int main() {
+    DoubleAlgebra doubles;
+    std::cout << std::left << std::setw(10) << "nodes" << std::right << std::setw(10) << "width"
+              << std::setw(12) << "slots" << std::setw(10) << "peak" << std::setw(12) << "KB"
+              << std::setw(10) << "peak KB" << std::setw(12) << "ms/eval" << std::setw(10) << "peak ms"
+              << std::setw(10) << "speedup" << std::endl;
+    for (size_t nodes : {scaled(10000), scaled(100000), scaled(1000000)}) {
+        TreeAlgebra alg;
+        WorkloadParams params;
+        params.nodeCount = nodes;
+        params.rootCount = 16;
+        params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+        params.constants = WorkloadParams::Constants::Uniform;
+        params.constantMin = 0.5;
+        params.constantMax = 1.5;
+        params.maxDepth = 16;
+        Workload w = WorkloadGenerator(params).generate(alg);
+        CompactGraph graph = compact(w.roots);
+
+        TapeOptions options;
+        options.allocate = false;
+        Tape unallocated(graph, options);
+        Tape allocated(graph);
+        const size_t repeats = std::max<size_t>(1, scaled(5000000) / graph.size());
+        std::vector<double> slots;
+        const double t0 = perEvaluation(repeats, [&]() {
+            unallocated.evaluate(doubles, slots);
+            doNotOptimize(slots.data());
+        });
+        std::vector<double> registers;
+        const double t1 = perEvaluation(repeats, [&]() {
+            allocated.evaluate(doubles, registers);
+            doNotOptimize(registers.data());
+        });
+        std::cout << std::left << std::setw(10) << graph.size() << std::right
+                  << std::setw(10) << allocated.stats().width
+                  << std::setw(12) << unallocated.slotCount() << std::setw(10) << allocated.slotCount()
+                  << std::setw(12) << unallocated.slotCount() * sizeof(double) / 1024
+                  << std::setw(10) << allocated.slotCount() * sizeof(double) / 1024
+                  << std::fixed << std::setprecision(3) << std::setw(12) << t0 * 1e3 << std::setw(10) << t1 * 1e3
+                  << std::setprecision(2) << std::setw(10) << t0 / t1 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Outputs of one model evaluated by one eval() per root, against one batch
+// eval(roots) sharing its memo and SCC solutions. The roots of a model
+// share most of their sub-DAG and SCCs: separate calls evaluate them again
+// for every root.
+
+template<typename T>
+static void row(const char* label, size_t rootCount, const Algebra<T>& algebra) {
+    TreeAlgebra alg;
+    WorkloadParams params;
+    params.nodeCount = scaled(50000);
+    params.rootCount = rootCount;
+    params.sccCount = 64;
+    params.sccSize = 8;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+
+    size_t separateSCCs = 0;
+    const double separate = bestOf(3, [&]() {
+        separateSCCs = 0;
+        for (const auto& root : w.roots) {
+            doNotOptimize(alg.eval(root, algebra));
+            separateSCCs += alg.fixpointStats().sccs;
+        }
+    });
+    std::vector<T> values;
+    const double batch = bestOf(3, [&]() {
+        values = alg.eval(w.roots, algebra);
+        doNotOptimize(values.data());
+    });
+    std::cout << std::left << std::setw(18) << label << std::right
+              << std::setw(8) << rootCount << std::fixed
+              << std::setw(12) << std::setprecision(2) << separate * 1e3
+              << std::setw(12) << batch * 1e3
+              << std::setw(10) << std::setprecision(1) << separate / batch
+              << std::setw(12) << separateSCCs
+              << std::setw(10) << alg.fixpointStats().sccs << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(18) << "algebra" << std::right
+              << std::setw(8) << "roots" << std::setw(12) << "N calls ms" << std::setw(12) << "batch ms"
+              << std::setw(10) << "speedup" << std::setw(12) << "SCCs (N)" << std::setw(10) << "SCCs"
+              << std::endl;
+    for (size_t roots : {1, 16, 128, 512}) {
+        row("DoubleAlgebra", roots, DoubleAlgebra());
+    }
+    for (size_t roots : {1, 16, 128, 512}) {
+        row("IntervalAlgebra", roots, IntervalAlgebra());
+    }
+    return 0;
+}
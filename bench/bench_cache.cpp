@@ -0,0 +1,76 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/ResultCache.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <filesystem>
+#include <unistd.h>
+
+// Three runs of the interval and double analyses of a model with many
+// roots over one cache directory: cold, unchanged model, and a model where
+// one root in 16 was edited. Each run builds the model in a fresh
+// TreeAlgebra, as a separate process would.
+
+static Workload model(TreeAlgebra& alg, bool edited) {
+    WorkloadParams params;
+    params.nodeCount = scaled(50000);
+    params.rootCount = 256;
+    params.sccCount = 16;
+    params.sccSize = 4;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    if (edited) {
+        for (size_t i = 0; i < w.roots.size(); i += 16) {
+            w.roots[i] = alg.add(w.roots[i], alg.num(1.0));
+        }
+    }
+    return w;
+}
+
+static void run(const char* label, const std::string& directory, bool edited) {
+    TreeAlgebra alg;
+    Workload w = model(alg, edited);
+    ResultCache cache(directory);
+    Stopwatch sw;
+    auto ranges = cache.evaluate(alg, w.roots, IntervalAlgebra());
+    auto values = cache.evaluate(alg, w.roots, DoubleAlgebra());
+    const double total = sw.seconds();
+    doNotOptimize(ranges.data());
+    doNotOptimize(values.data());
+
+    const ResultCacheStats& s = cache.stats();
+    std::cout << std::left << std::setw(12) << label << std::right << std::fixed
+              << std::setw(6) << s.hits << "/" << std::setw(4) << s.lookups
+              << std::setw(8) << std::setprecision(1) << 100.0 * s.hitRate() << "%"
+              << std::setw(10) << std::setprecision(1) << total * 1e3
+              << std::setw(10) << s.hashSeconds * 1e3
+              << std::setw(10) << s.evalSeconds * 1e3
+              << std::setw(10) << s.savedSeconds * 1e3
+              << std::setw(10) << s.bytesWritten
+              << std::setw(10) << s.bytesRead << std::endl;
+}
+
+int main() {
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / ("algebra-cache-bench-" + std::to_string(getpid()));
+    std::filesystem::remove_all(directory);
+
+    std::cout << std::left << std::setw(12) << "run" << std::right
+              << std::setw(11) << "hits" << std::setw(9) << "rate"
+              << std::setw(10) << "total ms" << std::setw(10) << "hash ms"
+              << std::setw(10) << "eval ms" << std::setw(10) << "saved ms"
+              << std::setw(10) << "written" << std::setw(10) << "read" << std::endl;
+    run("cold", directory.string(), false);
+    run("unchanged", directory.string(), false);
+    run("edited", directory.string(), true);
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/CompactGraph.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <vector>
+
+// Bottom-up evaluation of a large DAG, before and after compaction: the
+// same post-order sweep over the heap-allocated trees (values in a side
+// array indexed by node id) and over the CompactGraph, with the memoized
+// recursive TreeAlgebra::eval for reference
+
+struct Measure {
+    double seconds;
+    uint64_t misses;
+};
+
+template<typename F>
+static Measure measure(CacheMissCounter& counter, F&& fn) {
+    Measure best{1e300, 0};
+    for (int run = 0; run < 3; ++run) {
+        counter.start();
+        Stopwatch sw;
+        fn();
+        double t = sw.seconds();
+        uint64_t misses = counter.stop();
+        if (t < best.seconds) best = {t, misses};
+    }
+    return best;
+}
+
+static void row(const char* label, const Measure& m, size_t nodes, const CacheMissCounter& counter) {
+    const double n = static_cast<double>(nodes);
+    std::cout << "  " << std::left << std::setw(22) << label << std::right
+              << std::setw(10) << std::fixed << std::setprecision(1) << m.seconds * 1e3
+              << std::setw(12) << m.seconds * 1e9 / n;
+    if (counter.available()) {
+        std::cout << std::setw(14) << std::setprecision(3) << static_cast<double>(m.misses) / n;
+    } else {
+        std::cout << std::setw(14) << "n/a";
+    }
+    std::cout << std::endl;
+}
+
+// Churn the allocator: blocks of random sizes, half of them freed in random
+// order, so that the trees allocated next land in scattered holes, as in a
+// long-running process
+static std::vector<std::unique_ptr<char[]>> fragmentHeap(size_t blocks) {
+    WorkloadRandom rng(11);
+    std::vector<std::unique_ptr<char[]>> heap(blocks);
+    for (auto& block : heap) {
+        block.reset(new char[16 + rng.below(240)]);
+    }
+    for (size_t i = 0; i < blocks / 2; ++i) {
+        heap[rng.below(blocks)].reset();
+    }
+    return heap;
+}
+
+static void scenario(const char* title, bool fragmented) {
+    auto heap = fragmented ? fragmentHeap(scaled(4000000)) : std::vector<std::unique_ptr<char[]>>();
+
+    TreeAlgebra alg;
+    WorkloadParams params;
+    params.nodeCount = scaled(1000000);
+    params.rootCount = 64;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+
+    CacheMissCounter counter;
+    std::unique_ptr<CompactGraph> graph;
+    Measure build = measure(counter, [&]() { graph = std::make_unique<CompactGraph>(w.roots); });
+    const size_t n = graph->size();
+
+    // The trees in the order of the compact graph: both sweeps do the same
+    // operations in the same order, only the memory layout differs
+    std::vector<Tree*> order(n);
+    {
+        std::vector<std::shared_ptr<Tree>> pending(w.roots);
+        std::vector<bool> seen(alg.nodeCount(), false);
+        while (!pending.empty()) {
+            auto t = pending.back();
+            pending.pop_back();
+            if (seen[t->getId()]) continue;
+            seen[t->getId()] = true;
+            order[graph->position(t)] = t.get();
+            if (t->getType() == Tree::NodeType::Unary) pending.push_back(t->getOperand());
+            if (t->getType() == Tree::NodeType::Binary) {
+                pending.push_back(t->getLeft());
+                pending.push_back(t->getRight());
+            }
+        }
+    }
+
+    DoubleAlgebra doubles;
+    std::vector<double> byId(alg.nodeCount());
+    Measure pointers = measure(counter, [&]() {
+        for (Tree* t : order) {
+            double v;
+            switch (t->getType()) {
+                case Tree::NodeType::Num:
+                    v = t->getConstantOp() == ConstantOp::Integer
+                        ? doubles.integer(t->getInteger()) : doubles.num(t->getValue());
+                    break;
+                case Tree::NodeType::Unary:
+                    v = doubles.unary(static_cast<Algebra<double>::UnaryOp>(t->getUnaryOp()),
+                                      byId[t->getOperand()->getId()]);
+                    break;
+                case Tree::NodeType::Binary:
+                    v = doubles.binary(static_cast<Algebra<double>::BinaryOp>(t->getBinaryOp()),
+                                       byId[t->getLeft()->getId()], byId[t->getRight()->getId()]);
+                    break;
+                default:
+                    v = 0.0;
+                    break;
+            }
+            byId[t->getId()] = v;
+        }
+        doNotOptimize(byId.data());
+    });
+
+    std::vector<double> values;
+    Measure compactSweep = measure(counter, [&]() {
+        graph->evaluate(doubles, values);
+        doNotOptimize(values.data());
+    });
+
+    Measure eval = measure(counter, [&]() {
+        for (const auto& root : w.roots) doNotOptimize(alg.eval(root, doubles));
+    });
+
+    // Both sweeps computed the same values
+    for (size_t i = 0; i < w.roots.size(); ++i) {
+        if (values[graph->roots()[i]] != byId[w.roots[i]->getId()]) {
+            std::cerr << "bench_compact: sweeps disagree" << std::endl;
+        }
+    }
+
+    std::cout << title << ": " << n << " nodes, compact graph " << std::fixed << std::setprecision(1)
+              << static_cast<double>(graph->bytes()) / (1 << 20) << " MiB" << std::endl
+              << "  " << std::left << std::setw(22) << "" << std::right
+              << std::setw(10) << "ms" << std::setw(12) << "ns/node" << std::setw(14) << "LLC miss/node"
+              << std::endl;
+    row("compact()", build, n, counter);
+    row("TreeAlgebra::eval", eval, n, counter);
+    row("sweep over trees", pointers, n, counter);
+    row("sweep over compact", compactSweep, n, counter);
+    std::cout << std::endl;
+}
+
+int main() {
+    scenario("Fresh heap", false);
+    scenario("Fragmented heap", true);
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/CostModel.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <utility>
+#include <vector>
+
+// How well the static estimate predicts the evaluation time of
+// TreeAlgebra::eval across operator mixes and shapes. The interpreter pays
+// a fixed overhead per node on top of the operation latencies: both are
+// fitted by least squares, time ≈ d·nodes + s·work, and the fitted table
+// (latencies.withDispatch(d / s), scaled by s) is compared to the
+// measurements
+
+struct Sample {
+    std::string label;
+    WorkloadParams params;
+    CostEstimate estimate;
+    double modelTime = 0.0;
+    double evalTime = 0.0;
+
+    Sample(std::string label, WorkloadParams params) : label(std::move(label)), params(std::move(params)) {}
+};
+
+static WorkloadParams mix(std::array<double, WorkloadParams::BINARY_COUNT> binaryMix, double abs) {
+    WorkloadParams params;
+    params.nodeCount = scaled(50000);
+    params.rootCount = 1;
+    params.varLeafRatio = 0.0;
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.binaryMix = binaryMix;
+    params.unaryMix = {abs};
+    return params;
+}
+
+static std::vector<Sample> graphs() {
+    std::vector<Sample> samples;
+    samples.emplace_back("+ -", mix({1, 1, 0, 0, 0}, 0));
+    samples.emplace_back("+ - * |x|", mix({4, 2, 3, 0, 0}, 0.5));
+    samples.emplace_back("default mix", mix({4, 2, 3, 0.5, 0.25}, 0.5));
+    samples.emplace_back("/ mod", mix({0, 0, 0, 1, 1}, 0));
+    WorkloadParams shallow = mix({4, 2, 3, 0.5, 0.25}, 0.5);
+    shallow.depthProfile = WorkloadParams::DepthProfile::Shallow;
+    samples.emplace_back("shallow", shallow);
+    WorkloadParams deep = shallow;
+    deep.depthProfile = WorkloadParams::DepthProfile::Deep;
+    deep.maxDepth = 100000;
+    samples.emplace_back("deep", deep);
+    WorkloadParams recursive = mix({4, 2, 3, 0.5, 0.25}, 0.5);
+    recursive.sccCount = 50;
+    recursive.sccSize = 8;
+    recursive.varLeafRatio = 0.1;
+    samples.emplace_back("50 recursive SCCs", recursive);
+    return samples;
+}
+
+template<typename T>
+static void table(const char* title, const Algebra<T>& algebra, const LatencyTable& latencies) {
+    std::vector<Sample> samples = graphs();
+    for (auto& sample : samples) {
+        TreeAlgebra alg;
+        Workload w = WorkloadGenerator(sample.params).generate(alg);
+        CostModel model(latencies);
+        sample.modelTime = bestOf(3, [&]() { sample.estimate = model.estimate(w.roots); });
+        sample.evalTime = bestOf(3, [&]() {
+            for (const auto& root : w.roots) {
+                doNotOptimize(alg.eval(root, algebra));
+            }
+        });
+    }
+
+    // Least squares fit of time = d·nodes + s·work (2x2 normal equations)
+    double nn = 0, nw = 0, ww = 0, nt = 0, wt = 0;
+    for (const auto& sample : samples) {
+        const double n = static_cast<double>(sample.estimate.nodes);
+        const double w = sample.estimate.work;
+        nn += n * n; nw += n * w; ww += w * w;
+        nt += n * sample.evalTime; wt += w * sample.evalTime;
+    }
+    const double det = nn * ww - nw * nw;
+    const double d = std::max(0.0, (nt * ww - wt * nw) / det);
+    const double s = std::max(1e-15, (wt * nn - nt * nw) / det);
+
+    std::cout << title << ": fitted " << std::fixed << std::setprecision(1) << d * 1e9
+              << " ns per node, " << std::setprecision(3) << s * 1e9 << " ns per latency unit" << std::endl
+              << std::left << std::setw(20) << "graph" << std::right
+              << std::setw(9) << "nodes" << std::setw(11) << "work" << std::setw(8) << "span"
+              << std::setw(8) << "par." << std::setw(11) << "eval (ms)" << std::setw(12) << "model (ms)"
+              << std::setw(13) << "predicted" << std::setw(8) << "error"
+              << std::endl;
+    const LatencyTable fitted = latencies.withDispatch(d / s);
+    for (const auto& sample : samples) {
+        TreeAlgebra alg;
+        Workload w = WorkloadGenerator(sample.params).generate(alg);
+        CostModel model(fitted);
+        const double predicted = model.estimate(w.roots).work * s;
+        std::cout << std::left << std::setw(20) << sample.label << std::right
+                  << std::setw(9) << sample.estimate.nodes
+                  << std::setw(11) << std::setprecision(0) << sample.estimate.work
+                  << std::setw(8) << sample.estimate.span
+                  << std::setw(8) << std::setprecision(1) << sample.estimate.parallelism()
+                  << std::setw(11) << std::setprecision(2) << sample.evalTime * 1e3
+                  << std::setw(12) << sample.modelTime * 1e3
+                  << std::setw(13) << predicted * 1e3
+                  << std::setw(7) << std::setprecision(0) << 100.0 * (predicted - sample.evalTime) / sample.evalTime << "%"
+                  << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    // Deep workloads recurse once per level
+    runWithStack(size_t(1) << 30, []() {
+        table("DoubleAlgebra, doublePrecision()", DoubleAlgebra(), LatencyTable::doublePrecision());
+        table("IntervalAlgebra, interval()", IntervalAlgebra(), LatencyTable::interval());
+    });
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+
+// Merging a model built in one TreeAlgebra into another: import() against
+// evaluating the roots with the target as initial algebra (the memoized,
+// recursive evaluator, which also rebuilds recursive variables), and the
+// cost of importing a second time from the same source.
+
+static void row(size_t nodes) {
+    TreeAlgebra src;
+    WorkloadParams params;
+    params.nodeCount = nodes;
+    params.rootCount = 64;
+    params.sccCount = 64;
+    params.sccSize = 8;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(src);
+    const double n = static_cast<double>(src.nodeCount());
+
+    double evaluated = 0.0;
+    double imported = 0.0;
+    double again = 0.0;
+    size_t evalNodes = 0;
+    size_t importNodes = 0;
+    runWithStack(size_t(1) << 30, [&]() {
+        evaluated = bestOf(3, [&]() {
+            TreeAlgebra dst;
+            doNotOptimize(src.eval(w.roots, dst).data());
+            evalNodes = dst.nodeCount();
+        });
+        std::unique_ptr<TreeAlgebra> dst;
+        imported = bestOf(3, [&]() {
+            dst = std::make_unique<TreeAlgebra>();
+            doNotOptimize(dst->import(src, w.roots).data());
+            importNodes = dst->nodeCount();
+        });
+        again = bestOf(3, [&]() { doNotOptimize(dst->import(src, w.roots).data()); });
+
+        // Same values in both algebras, up to the rounding of the solves
+        // (the fresh variables change the order of the SCCs)
+        DoubleAlgebra doubles;
+        TreeAlgebra check;
+        auto roots = check.import(src, w.roots);
+        const double a = check.eval(roots[0], doubles);
+        const double b = src.eval(w.roots[0], doubles);
+        if (std::abs(a - b) > 1e-9 * std::abs(b)) {
+            std::cout << "value mismatch: " << a << " " << b << std::endl;
+        }
+    });
+
+    std::cout << std::right << std::setw(10) << src.nodeCount() << std::fixed
+              << std::setw(12) << std::setprecision(2) << evaluated * 1e3
+              << std::setw(12) << imported * 1e3
+              << std::setw(10) << evaluated / imported
+              << std::setw(12) << std::setprecision(1) << n / imported / 1e6
+              << std::setw(12) << std::setprecision(3) << again * 1e3
+              << std::setw(12) << evalNodes << std::setw(12) << importNodes << std::endl;
+}
+
+int main() {
+    std::cout << std::right << std::setw(10) << "nodes" << std::setw(12) << "eval ms" << std::setw(12) << "import ms"
+              << std::setw(10) << "speedup" << std::setw(12) << "Mnodes/s" << std::setw(12) << "again ms"
+              << std::setw(12) << "eval nodes" << std::setw(12) << "imp nodes" << std::endl;
+    for (size_t nodes : {10000, 100000, 1000000}) {
+        row(scaled(nodes));
+    }
+    return 0;
+}
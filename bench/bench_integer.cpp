@@ -0,0 +1,96 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntegerAlgebra.hh"
+#include "algebra/RationalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+
+// Exact integers: the Integer fast path against native int64_t arithmetic on
+// an index computation, then tree evaluation in the exact algebras
+
+template<typename I>
+static I indexLoop(size_t n) {
+    // Strided, wrapped index computation: acc = (acc * 31 + i * stride) % m
+    I acc(1);
+    const I stride(17);
+    const I modulus(1000003);
+    const I mult(31);
+    for (size_t i = 0; i < n; ++i) {
+        acc = (acc * mult + I(static_cast<int64_t>(i)) * stride) % modulus;
+    }
+    return acc;
+}
+
+// Sum of squares overflowing int64_t: the BigInt path for comparison
+static Integer bigLoop(size_t n) {
+    Integer acc(std::numeric_limits<int64_t>::max());
+    for (size_t i = 0; i < n; ++i) {
+        acc = acc + Integer(static_cast<int64_t>(i)) * Integer(static_cast<int64_t>(i));
+    }
+    return acc;
+}
+
+static void loopRow(const char* label, size_t n, double seconds, double reference) {
+    std::cout << std::left << std::setw(24) << label << std::right
+              << std::setw(12) << std::fixed << std::setprecision(3) << seconds * 1e3
+              << std::setw(12) << std::setprecision(2) << seconds * 1e9 / static_cast<double>(n)
+              << std::setw(10) << std::setprecision(2) << seconds / reference << "x"
+              << std::endl;
+}
+
+template<typename T>
+static double evalTime(const TreeAlgebra& alg, const Workload& w, const Algebra<T>& algebra) {
+    return bestOf(3, [&]() {
+        for (const auto& root : w.roots) {
+            doNotOptimize(alg.eval(root, algebra));
+        }
+    });
+}
+
+int main() {
+    const size_t n = scaled(10000000);
+    
+    std::cout << std::left << std::setw(24) << "index loop" << std::right
+              << std::setw(12) << "time (ms)" << std::setw(12) << "ns/iter" << std::setw(11) << "vs int64"
+              << std::endl;
+    int64_t nativeResult = 0;
+    Integer integerResult;
+    double native = bestOf(5, [&]() { nativeResult = indexLoop<int64_t>(n); doNotOptimize(nativeResult); });
+    double integer = bestOf(5, [&]() { integerResult = indexLoop<Integer>(n); doNotOptimize(integerResult); });
+    double big = bestOf(5, [&]() { doNotOptimize(bigLoop(n)); });
+    if (integerResult != Integer(nativeResult)) {
+        std::cerr << "Integer and int64_t results differ" << std::endl;
+        return 1;
+    }
+    loopRow("int64_t", n, native, native);
+    loopRow("Integer (fast path)", n, integer, native);
+    loopRow("Integer (BigInt path)", n, big, native);
+    
+    // Tree evaluation: non-recursive DAG of +, -, * over small integers
+    WorkloadParams params;
+    params.nodeCount = scaled(100000);
+    params.rootCount = 16;
+    params.binaryMix = {4, 2, 3, 0, 0};
+    params.unaryMix = {0};
+    params.maxDepth = 12;
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    auto stats = WorkloadGenerator::measure(w.roots);
+    
+    DoubleAlgebra doubleAlg;
+    IntegerAlgebra integerAlg;
+    RationalAlgebra rationalAlg;
+    double doubleTime = evalTime(alg, w, doubleAlg);
+    double integerTime = evalTime(alg, w, integerAlg);
+    double rationalTime = evalTime(alg, w, rationalAlg);
+    
+    std::cout << std::endl << std::left << std::setw(24) << "tree eval" << std::right
+              << std::setw(12) << "time (ms)" << std::setw(12) << "ns/node" << std::setw(11) << "vs double"
+              << std::endl;
+    loopRow("DoubleAlgebra", stats.nodes, doubleTime, doubleTime);
+    loopRow("IntegerAlgebra", stats.nodes, integerTime, doubleTime);
+    loopRow("RationalAlgebra", stats.nodes, rationalTime, doubleTime);
+    return 0;
+}
@@ -0,0 +1,227 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/FlatHashSet.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+// Intern table alternatives on the nodes of real and degenerate graphs:
+// std::unordered_set (chained buckets, one allocation per node) against
+// FlatHashSet (open addressing, control-byte probing), each with the
+// previous xor-shift combiner and with the 64-bit mixer of TreeHash
+
+// The combiner TreeHash used before: identity hashes of the operand
+// addresses and integers, combined with shifts and xors
+struct LegacyTreeHash {
+    size_t operator()(const std::shared_ptr<Tree>& t) const {
+        size_t h = 0;
+        switch (t->getType()) {
+            case Tree::NodeType::Num:
+                if (t->getConstantOp() == ConstantOp::Integer) {
+                    h = std::hash<int64_t>{}(t->getInteger()) ^ 0x5bd1e995;
+                } else {
+                    h = std::hash<double>{}(t->getValue());
+                }
+                break;
+            case Tree::NodeType::Unary:
+                h = std::hash<int>{}(static_cast<int>(t->getUnaryOp()));
+                h ^= std::hash<void*>{}(t->getOperand().get()) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                break;
+            case Tree::NodeType::Binary:
+                h = std::hash<int>{}(static_cast<int>(t->getBinaryOp()));
+                h ^= std::hash<void*>{}(t->getLeft().get()) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                h ^= std::hash<void*>{}(t->getRight().get()) + 0x517cc1b7 + (h << 6) + (h >> 2);
+                break;
+            case Tree::NodeType::Var:
+                h = std::hash<int>{}(t->getVarIndex()) ^ 0xdeadbeef;
+                break;
+            case Tree::NodeType::Select:
+                h = std::hash<void*>{}(t->getCondition().get());
+                h ^= std::hash<void*>{}(t->getThen().get()) + 0x9e3779b9 + (h << 6) + (h >> 2);
+                h ^= std::hash<void*>{}(t->getElse().get()) + 0x517cc1b7 + (h << 6) + (h >> 2);
+                break;
+        }
+        return h;
+    }
+};
+
+using Nodes = std::vector<std::shared_ptr<Tree>>;
+
+struct Probes {
+    double mean = 0.0;   // Groups (flat) or bucket entries (chained) visited by a successful lookup
+    size_t max = 0;
+};
+
+template<typename Hash>
+static Probes probes(const std::unordered_set<std::shared_ptr<Tree>, Hash, TreeEqual>& set) {
+    Probes p;
+    double total = 0.0;
+    for (size_t b = 0; b < set.bucket_count(); ++b) {
+        size_t n = set.bucket_size(b);
+        total += static_cast<double>(n * (n + 1) / 2);   // The k-th entry costs k comparisons
+        p.max = std::max(p.max, n);
+    }
+    p.mean = total / static_cast<double>(set.size());
+    return p;
+}
+
+template<typename Hash>
+static Probes probes(const FlatHashSet<std::shared_ptr<Tree>, Hash, TreeEqual>& set) {
+    Probes p;
+    auto histogram = set.probeLengths();
+    double total = 0.0;
+    for (size_t k = 0; k < histogram.size(); ++k) {
+        total += static_cast<double>((k + 1) * histogram[k]);
+    }
+    p.mean = total / static_cast<double>(set.size());
+    p.max = histogram.size();
+    return p;
+}
+
+template<typename Hash>
+static void insertAll(std::unordered_set<std::shared_ptr<Tree>, Hash, TreeEqual>& set, const Nodes& nodes) {
+    for (const auto& node : nodes) set.insert(node);
+}
+
+template<typename Hash>
+static void insertAll(FlatHashSet<std::shared_ptr<Tree>, Hash, TreeEqual>& set, const Nodes& nodes) {
+    for (const auto& node : nodes) set.insert(node);
+}
+
+template<typename Hash>
+static bool contains(const std::unordered_set<std::shared_ptr<Tree>, Hash, TreeEqual>& set,
+                     const std::shared_ptr<Tree>& node) {
+    return set.find(node) != set.end();
+}
+
+template<typename Hash>
+static bool contains(const FlatHashSet<std::shared_ptr<Tree>, Hash, TreeEqual>& set,
+                     const std::shared_ptr<Tree>& node) {
+    return set.find(node) != nullptr;
+}
+
+template<typename Set>
+static void measure(const char* table, const char* hash, const Nodes& hits, const Nodes& misses) {
+    double insertTime = bestOf(3, [&]() {
+        Set set;
+        insertAll(set, hits);
+        doNotOptimize(set.size());
+    });
+    Set set;
+    insertAll(set, hits);
+    size_t found = 0;
+    double hitTime = bestOf(3, [&]() {
+        for (const auto& node : hits) found += contains(set, node);
+    });
+    double missTime = bestOf(3, [&]() {
+        for (const auto& node : misses) found += contains(set, node);
+    });
+    doNotOptimize(found);
+    Probes p = probes(set);
+    const double n = static_cast<double>(hits.size());
+    std::cout << "  " << std::left << std::setw(16) << table << std::setw(10) << hash << std::right
+              << std::setw(11) << std::fixed << std::setprecision(1) << insertTime * 1e9 / n
+              << std::setw(11) << hitTime * 1e9 / n
+              << std::setw(11) << missTime * 1e9 / static_cast<double>(misses.size())
+              << std::setw(10) << std::setprecision(2) << p.mean
+              << std::setw(8) << p.max
+              << std::endl;
+}
+
+static void compare(const std::string& title, const Nodes& hits, const Nodes& misses) {
+    std::cout << title << ", " << hits.size() << " nodes" << std::endl
+              << "  " << std::left << std::setw(16) << "table" << std::setw(10) << "hash" << std::right
+              << std::setw(11) << "insert ns" << std::setw(11) << "hit ns" << std::setw(11) << "miss ns"
+              << std::setw(10) << "probes" << std::setw(8) << "max"
+              << std::endl;
+    measure<std::unordered_set<std::shared_ptr<Tree>, LegacyTreeHash, TreeEqual>>("unordered_set", "legacy", hits, misses);
+    measure<std::unordered_set<std::shared_ptr<Tree>, TreeHash, TreeEqual>>("unordered_set", "mixed", hits, misses);
+    measure<FlatHashSet<std::shared_ptr<Tree>, LegacyTreeHash, TreeEqual>>("FlatHashSet", "legacy", hits, misses);
+    measure<FlatHashSet<std::shared_ptr<Tree>, TreeHash, TreeEqual>>("FlatHashSet", "mixed", hits, misses);
+    std::cout << std::endl;
+}
+
+// Every node reachable from the roots, definitions included
+static Nodes collect(const Nodes& roots) {
+    Nodes nodes;
+    std::unordered_set<Tree*> seen;
+    Nodes pending(roots);
+    while (!pending.empty()) {
+        auto tree = pending.back();
+        pending.pop_back();
+        if (!seen.insert(tree.get()).second) continue;
+        nodes.push_back(tree);
+        switch (tree->getType()) {
+            case Tree::NodeType::Unary: pending.push_back(tree->getOperand()); break;
+            case Tree::NodeType::Binary: pending.push_back(tree->getLeft()); pending.push_back(tree->getRight()); break;
+            case Tree::NodeType::Var: if (tree->getDefinition()) pending.push_back(tree->getDefinition()); break;
+            default: break;
+        }
+    }
+    return nodes;
+}
+
+int main() {
+    const size_t n = scaled(200000);
+    // The degenerate inputs are smaller: with the legacy hash every integer
+    // lands in the same group of FlatHashSet, and insertion is quadratic
+    const size_t small = scaled(20000);
+
+    {
+        // Generated DAGs: the misses are the nodes of a second generation
+        TreeAlgebra alg;
+        TreeAlgebra other;
+        WorkloadParams params;
+        params.nodeCount = n;
+        params.rootCount = 16;
+        params.sccCount = 20;
+        Nodes hits = collect(WorkloadGenerator(params).generate(alg).roots);
+        params.seed = 2;
+        Nodes misses = collect(WorkloadGenerator(params).generate(other).roots);
+        compare("Workload DAG", hits, misses);
+    }
+    {
+        // Real constants one ulp apart, integers differing above bit 32
+        TreeAlgebra alg;
+        Nodes hits;
+        Nodes misses;
+        for (size_t i = 0; i < small / 2; ++i) {
+            hits.push_back(alg.num(1.0 + static_cast<double>(i) * 0x1.0p-52));
+            hits.push_back(alg.integer(static_cast<int64_t>(i) << 32));
+            misses.push_back(alg.num(2.0 + static_cast<double>(i) * 0x1.0p-51));
+            misses.push_back(alg.integer((static_cast<int64_t>(i) << 32) + 1));
+        }
+        compare("Low-bit constants", hits, misses);
+    }
+    {
+        // Products of a small pool of operands: the hash only sees addresses
+        TreeAlgebra alg;
+        Nodes leaves;
+        for (int i = 0; i < 512; ++i) leaves.push_back(alg.integer(i));
+        Nodes hits;
+        Nodes misses;
+        for (size_t i = 0; hits.size() < small; ++i) {
+            hits.push_back(alg.mul(leaves[i % 512], leaves[(i / 512) % 512]));
+            misses.push_back(alg.add(leaves[i % 512], leaves[(i / 512) % 512]));
+        }
+        compare("Operand grid", hits, misses);
+    }
+
+    // End to end: building workloads through TreeAlgebra
+    WorkloadParams params;
+    params.nodeCount = n;
+    params.rootCount = 16;
+    double build = bestOf(3, [&]() {
+        TreeAlgebra alg;
+        doNotOptimize(WorkloadGenerator(params).generate(alg).roots.size());
+    });
+    TreeAlgebra alg;
+    WorkloadGenerator(params).generate(alg);
+    std::cout << "TreeAlgebra: " << alg.nodeCount() << " nodes generated in "
+              << std::setprecision(1) << build * 1e3 << " ms ("
+              << build * 1e9 / static_cast<double>(alg.nodeCount()) << " ns/node)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/SignalEngine.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// The operations of the signature over arrays: one virtual call per element
+// (unary(op, x), what an evaluator does) against the batched operations of
+// NumericAlgebra, in ns per element, then a signal program of arithmetic
+// only against the same program with elementary functions. The kernel
+// width follows the target: build with -march=native to use AVX2/AVX-512.
+
+template<typename T>
+static void row(const NumericAlgebra<T>& alg, const char* label, typename Algebra<T>::UnaryOp op,
+                double lo, double hi) {
+    const size_t n = 4096;
+    const size_t rounds = scaled(200);
+    std::vector<T> a(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = static_cast<T>(lo + (hi - lo) * ((i * 2654435761u) % n) / n);
+    }
+    const Algebra<T>& generic = alg;
+    const double scalar = bestOf(3, [&]() {
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = generic.unary(op, a[i]);
+            }
+            doNotOptimize(out.data());
+        }
+    });
+    const double batched = bestOf(3, [&]() {
+        for (size_t r = 0; r < rounds; ++r) {
+            alg.unary(op, a.data(), out.data(), n);
+            doNotOptimize(out.data());
+        }
+    });
+    const double elements = static_cast<double>(n * rounds);
+    std::cout << std::left << std::setw(14) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << scalar / elements * 1e9
+              << std::setw(12) << batched / elements * 1e9
+              << std::setw(10) << std::setprecision(1) << scalar / batched << std::endl;
+}
+
+template<typename T>
+static void binaryRow(const NumericAlgebra<T>& alg, const char* label, typename Algebra<T>::BinaryOp op) {
+    const size_t n = 4096;
+    const size_t rounds = scaled(200);
+    std::vector<T> a(n), b(n), out(n);
+    for (size_t i = 0; i < n; ++i) {
+        a[i] = static_cast<T>(0.5 + (i % 97) / 97.0);
+        b[i] = static_cast<T>(0.5 + (i % 89) / 89.0);
+    }
+    const Algebra<T>& generic = alg;
+    const double scalar = bestOf(3, [&]() {
+        for (size_t r = 0; r < rounds; ++r) {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = generic.binary(op, a[i], b[i]);
+            }
+            doNotOptimize(out.data());
+        }
+    });
+    const double batched = bestOf(3, [&]() {
+        for (size_t r = 0; r < rounds; ++r) {
+            alg.binary(op, a.data(), b.data(), out.data(), n);
+            doNotOptimize(out.data());
+        }
+    });
+    const double elements = static_cast<double>(n * rounds);
+    std::cout << std::left << std::setw(14) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(12) << scalar / elements * 1e9
+              << std::setw(12) << batched / elements * 1e9
+              << std::setw(10) << std::setprecision(1) << scalar / batched << std::endl;
+}
+
+template<typename T>
+static void operations(const NumericAlgebra<T>& alg, const char* type) {
+    using U = typename Algebra<T>::UnaryOp;
+    using B = typename Algebra<T>::BinaryOp;
+    std::cout << std::endl << std::left << std::setw(14) << type << std::right << std::setw(12) << "scalar ns"
+              << std::setw(12) << "batched ns" << std::setw(10) << "speedup" << std::endl;
+    row<T>(alg, "exp", U::Exp, -20.0, 20.0);
+    row<T>(alg, "log", U::Log, 1e-3, 1e3);
+    row<T>(alg, "sin", U::Sin, -10.0, 10.0);
+    row<T>(alg, "cos", U::Cos, -10.0, 10.0);
+    row<T>(alg, "tanh", U::Tanh, -5.0, 5.0);
+    row<T>(alg, "sqrt", U::Sqrt, 0.0, 1e3);
+    row<T>(alg, "abs", U::Abs, -1.0, 1.0);
+    binaryRow<T>(alg, "add", B::Add);
+    binaryRow<T>(alg, "mul", B::Mul);
+    binaryRow<T>(alg, "min", B::Min);
+    binaryRow<T>(alg, "max", B::Max);
+    binaryRow<T>(alg, "pow", B::Pow);
+}
+
+// ns per sample of a block-processed chain of `stages` operations on one input
+static double signal(bool elementary, size_t stages) {
+    TreeAlgebra alg;
+    SignalProgram program(alg);
+    auto in = program.input();
+    auto x = in;
+    for (size_t s = 0; s < stages; ++s) {
+        x = elementary ? alg.tanh(alg.mul(alg.num(1.5), alg.sin(x)))
+                       : alg.add(alg.mul(alg.num(0.75), x), alg.mul(alg.num(0.25), in));
+    }
+    program.output(x);
+    const size_t blockSize = 256;
+    SignalEngine<float> engine(program, blockSize);
+    std::vector<float> input(blockSize), output(blockSize);
+    for (size_t i = 0; i < blockSize; ++i) {
+        input[i] = std::sin(0.01f * static_cast<float>(i));
+    }
+    const float* inputs[] = {input.data()};
+    float* outputs[] = {output.data()};
+    const size_t blocks = scaled(2000);
+    const double t = bestOf(3, [&]() {
+        for (size_t b = 0; b < blocks; ++b) {
+            engine.process(inputs, outputs, blockSize);
+        }
+        doNotOptimize(output.data());
+    });
+    return t / static_cast<double>(blocks * blockSize) * 1e9;
+}
+
+int main() {
+    operations(DoubleAlgebra(), "double");
+    operations(FloatAlgebra(), "float");
+
+    // Arithmetic-only workloads take the same paths as before
+    TreeAlgebra alg;
+    WorkloadParams params;
+    params.nodeCount = scaled(100000);
+    params.binaryMix = {4, 2, 3, 0, 0};
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    DoubleAlgebra doubles;
+    const double eval = bestOf(3, [&]() { doNotOptimize(alg.eval(w.roots, doubles).data()); });
+    std::cout << std::endl << "DoubleAlgebra, " << alg.nodeCount() << " arithmetic nodes: " << std::fixed
+              << std::setprecision(2) << eval * 1e3 << " ms" << std::endl;
+
+    std::cout << std::endl << std::left << std::setw(14) << "signal (float)" << std::right
+              << std::setw(12) << "ns/sample" << std::setw(12) << "ns/op" << std::endl;
+    for (bool elementary : {false, true}) {
+        const size_t stages = 16;
+        const double t = signal(elementary, stages);
+        std::cout << std::left << std::setw(14) << (elementary ? "tanh, sin" : "add, mul") << std::right
+                  << std::setw(12) << t << std::setw(12) << t / (3 * stages) << std::endl;
+    }
+    return 0;
+}
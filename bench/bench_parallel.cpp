@@ -0,0 +1,83 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/CompactGraph.hh"
+#include "algebra/ThreadPool.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <vector>
+
+// Level-synchronous evaluation of a wide, shallow DAG on 1 to 32 threads,
+// against the sequential sweeps of the post-order and level layouts.
+// Speedups above the number of hardware threads are not to be expected.
+
+template<typename T>
+static void row(const char* label, const Algebra<T>& algebra,
+                const CompactGraph& postOrder, const CompactGraph& leveled) {
+    const double n = static_cast<double>(postOrder.size());
+    std::vector<T> values;
+    const double sequential = bestOf(3, [&]() {
+        postOrder.evaluate(algebra, values);
+        doNotOptimize(values.data());
+    });
+    const double levels = bestOf(3, [&]() {
+        leveled.evaluate(algebra, values);
+        doNotOptimize(values.data());
+    });
+    std::cout << label << std::endl
+              << "  " << std::left << std::setw(20) << "sequential" << std::right << std::fixed
+              << std::setw(10) << std::setprecision(1) << sequential * 1e3
+              << std::setw(10) << sequential * 1e9 / n << std::endl
+              << "  " << std::left << std::setw(20) << "sequential, levels" << std::right
+              << std::setw(10) << levels * 1e3
+              << std::setw(10) << levels * 1e9 / n
+              << std::setw(10) << std::setprecision(2) << sequential / levels << std::endl;
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        ThreadPool pool(threads);
+        const double parallel = bestOf(3, [&]() {
+            leveled.evaluate(algebra, values, pool);
+            doNotOptimize(values.data());
+        });
+        std::cout << "  " << std::left << std::setw(20) << (std::to_string(threads) + " threads") << std::right
+                  << std::setw(10) << std::setprecision(1) << parallel * 1e3
+                  << std::setw(10) << parallel * 1e9 / n
+                  << std::setw(10) << std::setprecision(2) << sequential / parallel << std::endl;
+    }
+}
+
+int main() {
+    TreeAlgebra alg;
+    WorkloadParams params;
+    params.nodeCount = scaled(1000000);
+    params.rootCount = 256;
+    params.maxDepth = 24;
+    params.depthProfile = WorkloadParams::DepthProfile::Shallow;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    Workload w = WorkloadGenerator(params).generate(alg);
+
+    CompactGraph postOrder = compact(w.roots);
+    Stopwatch sw;
+    CompactGraph leveled = compact(w.roots, CompactLayout::Levels);
+    const double build = sw.seconds();
+
+    size_t widest = 0;
+    for (const auto& level : leveled.levels()) {
+        widest = std::max<size_t>(widest, level.end - level.begin);
+    }
+    std::cout << leveled.size() << " nodes, " << leveled.levels().size() << " levels (widest "
+              << widest << "), compacted by levels in " << std::fixed << std::setprecision(1)
+              << build * 1e3 << " ms, " << std::thread::hardware_concurrency() << " hardware threads"
+              << std::endl
+              << "  " << std::left << std::setw(20) << "" << std::right
+              << std::setw(10) << "ms" << std::setw(10) << "ns/node" << std::setw(10) << "speedup"
+              << std::endl;
+    row("DoubleAlgebra", DoubleAlgebra(), postOrder, leveled);
+    row("IntervalAlgebra", IntervalAlgebra(), postOrder, leveled);
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/NumericAlgebra.hh"
+#include "algebra/PrecisionReport.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Single against double precision: evaluation time of the numeric algebras,
+// throughput of a vectorizable kernel, and the error of float results
+
+static void row(const char* label, double seconds, size_t n, double reference) {
+    std::cout << std::left << std::setw(24) << label << std::right
+              << std::setw(12) << std::fixed << std::setprecision(3) << seconds * 1e3
+              << std::setw(12) << std::setprecision(2) << seconds * 1e9 / static_cast<double>(n)
+              << std::setw(10) << std::setprecision(2) << reference / seconds << "x"
+              << std::endl;
+}
+
+static void header(const char* title, const char* unit) {
+    std::cout << std::left << std::setw(24) << title << std::right
+              << std::setw(12) << "time (ms)" << std::setw(12) << unit << std::setw(11) << "speedup"
+              << std::endl;
+}
+
+template<typename T>
+static double evalTime(const TreeAlgebra& alg, const Workload& w, const Algebra<T>& algebra) {
+    return bestOf(3, [&]() {
+        for (const auto& root : w.roots) {
+            doNotOptimize(alg.eval(root, algebra));
+        }
+    });
+}
+
+// y = a·x + b·y over a block, the shape of a biquad section: the compiler
+// vectorizes it with twice as many lanes in float
+template<typename T>
+static double kernelTime(size_t n, size_t passes) {
+    std::vector<T> x(n);
+    std::vector<T> y(n, T(0));
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = static_cast<T>(i % 97) * T(0.01);
+    }
+    const T a = T(0.3);
+    const T b = T(0.6);
+    return bestOf(5, [&]() {
+        for (size_t pass = 0; pass < passes; ++pass) {
+            T* __restrict yp = y.data();
+            const T* __restrict xp = x.data();
+            for (size_t i = 0; i < n; ++i) {
+                yp[i] = a * xp[i] + b * yp[i];
+            }
+            doNotOptimize(y[pass % n]);
+        }
+    });
+}
+
+int main() {
+    // Tree evaluation: the interpreter is dominated by dispatch and memo
+    // lookups, precision barely matters
+    WorkloadParams params;
+    params.nodeCount = scaled(100000);
+    params.rootCount = 16;
+    params.maxDepth = 12;
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    auto stats = WorkloadGenerator::measure(w.roots);
+
+    DoubleAlgebra doubleAlg;
+    FloatAlgebra floatAlg;
+    MixedAlgebra mixedAlg;
+    double doubleTime = evalTime(alg, w, doubleAlg);
+    double floatTime = evalTime(alg, w, floatAlg);
+    double mixedTime = evalTime(alg, w, mixedAlg);
+
+    header("tree eval", "ns/node");
+    row("NumericAlgebra<double>", doubleTime, stats.nodes, doubleTime);
+    row("NumericAlgebra<float>", floatTime, stats.nodes, doubleTime);
+    row("<float, double>", mixedTime, stats.nodes, doubleTime);
+
+    // Vector kernel: the throughput block evaluation can reach
+    const size_t block = 4096;   // Fits in L1 for both types
+    const size_t passes = scaled(20000);
+    double kernelDouble = kernelTime<double>(block, passes);
+    double kernelFloat = kernelTime<float>(block, passes);
+    std::cout << std::endl;
+    header("vector kernel", "ns/sample");
+    row("double", kernelDouble, block * passes, kernelDouble);
+    row("float", kernelFloat, block * passes, kernelDouble);
+
+    // Error analysis: float against double on the same roots, with constants
+    // near 1 so that deep products stay in range
+    WorkloadParams dag = params;
+    dag.nodeCount = scaled(20000);
+    dag.rootCount = 256;
+    dag.constants = WorkloadParams::Constants::Uniform;
+    dag.constantMin = 0.5;
+    dag.constantMax = 1.5;
+    TreeAlgebra dagAlg;
+    Workload d = WorkloadGenerator(dag).generate(dagAlg);
+    std::cout << std::endl << "float vs double, +-*/% DAG (" << d.roots.size() << " roots)" << std::endl;
+    comparePrecision(dagAlg, d.roots, floatAlg, doubleAlg).print(std::cout);
+
+    WorkloadParams recursive;
+    recursive.nodeCount = scaled(2000);
+    recursive.rootCount = 64;
+    recursive.sccCount = 16;
+    recursive.sccSize = 8;
+    recursive.varLeafRatio = 0.2;
+    recursive.binaryMix = {4, 2, 3, 0, 0};
+    recursive.constants = WorkloadParams::Constants::Uniform;
+    recursive.constantMin = 0.5;
+    recursive.constantMax = 1.5;
+    TreeAlgebra recursiveAlg;
+    Workload r = WorkloadGenerator(recursive).generate(recursiveAlg);
+    std::cout << std::endl << "float vs double, recursive systems (" << r.roots.size() << " roots)" << std::endl;
+    comparePrecision(recursiveAlg, r.roots, floatAlg, doubleAlg).print(std::cout);
+    std::cout << std::endl << "mixed vs double, recursive systems" << std::endl;
+    comparePrecision(recursiveAlg, r.roots, mixedAlg, doubleAlg).print(std::cout);
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/EvalProfiler.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+// Cost of profiling TreeAlgebra::eval at several sample periods, against
+// an evaluation without profiler: for a fresh profiler (labels and
+// contexts are created) and for one that profiled the graph before. Then
+// the report of the finest profile.
+
+int main() {
+    TreeAlgebra alg;
+    WorkloadParams params;
+    params.nodeCount = scaled(200000);
+    params.rootCount = 1;
+    params.sccCount = 64;
+    params.sccSize = 8;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    DoubleAlgebra doubles;
+
+    const double plain = bestOf(3, [&]() { doNotOptimize(alg.eval(w.roots[0], doubles)); });
+    std::cout << WorkloadGenerator::measure(w.roots).nodes << " nodes, " << params.sccCount << " SCCs" << std::endl
+              << std::left << std::setw(16) << "period" << std::right << std::setw(10) << "ms"
+              << std::setw(10) << "overhead" << std::setw(10) << "again" << std::setw(10) << "overhead"
+              << std::setw(10) << "samples" << std::endl
+              << std::left << std::setw(16) << "no profiler" << std::right << std::fixed
+              << std::setw(10) << std::setprecision(1) << plain * 1e3 << std::endl;
+
+    EvalProfiler finest(1);
+    for (uint32_t period : {1, 16, 256}) {
+        EvalProfiler profiler(period);
+        const double profiled = bestOf(3, [&]() {
+            profiler.clear();
+            EvalProfiler::Scope scope(profiler);
+            doNotOptimize(alg.eval(w.roots[0], doubles));
+        });
+        const uint64_t samples = profiler.samples();
+        const double again = bestOf(3, [&]() {
+            EvalProfiler::Scope scope(profiler);
+            doNotOptimize(alg.eval(w.roots[0], doubles));
+        });
+        std::cout << std::left << std::setw(16) << period << std::right
+                  << std::setw(10) << std::setprecision(1) << profiled * 1e3
+                  << std::setw(9) << std::setprecision(2) << profiled / plain << "x"
+                  << std::setw(10) << std::setprecision(1) << again * 1e3
+                  << std::setw(9) << std::setprecision(2) << again / plain << "x"
+                  << std::setw(10) << samples << std::endl;
+        if (period == 1) {
+            profiler.clear();
+            EvalProfiler::Scope scope(profiler);
+            alg.eval(w.roots[0], doubles);
+            finest = profiler;
+        }
+    }
+
+    std::ostringstream folded;
+    finest.writeFolded(folded);
+    std::cout << std::endl << folded.str().size() << " bytes of folded stacks" << std::endl;
+    finest.report(std::cout, 10);
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/RangeAnalysis.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+
+// Whole-graph range inference on generated signal graphs, against the
+// fixpoint solver running IntervalAlgebra root by root
+
+static WorkloadParams graph(size_t nodes, bool withDivision) {
+    WorkloadParams params;
+    params.nodeCount = nodes;
+    params.rootCount = 64;
+    params.maxDepth = 24;
+    params.sccCount = nodes / 500;
+    params.sccSize = 8;
+    params.topology = WorkloadParams::Topology::Ring;
+    params.nonlinear = true;
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.25;
+    params.constantMax = 2.0;
+    if (!withDivision) {
+        params.binaryMix = {4, 2, 3, 0, 0};
+    }
+    return params;
+}
+
+static void row(const char* label, size_t nodes, bool withDivision) {
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(graph(nodes, withDivision)).generate(alg);
+
+    RangeAnalysis analysis;
+    double time = bestOf(3, [&]() { analysis.analyze(w.roots); });
+    const RangeStats& stats = analysis.stats();
+    const double bounded = 100.0 * static_cast<double>(stats.nodes - stats.unbounded) / static_cast<double>(stats.nodes);
+    std::cout << std::left << std::setw(16) << label << std::right
+              << std::setw(10) << stats.nodes
+              << std::setw(8) << stats.recursiveSCCs
+              << std::setw(8) << stats.rounds
+              << std::setw(12) << std::fixed << std::setprecision(2) << time * 1e3
+              << std::setw(10) << std::setprecision(0) << time * 1e9 / static_cast<double>(stats.nodes)
+              << std::setw(10) << std::setprecision(1) << bounded << "%"
+              << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(16) << "graph" << std::right
+              << std::setw(10) << "nodes" << std::setw(8) << "SCCs" << std::setw(8) << "rounds"
+              << std::setw(12) << "time (ms)" << std::setw(10) << "ns/node" << std::setw(11) << "bounded"
+              << std::endl;
+    for (size_t nodes : {scaled(10000), scaled(100000)}) {
+        row("+ - *", nodes, false);
+        row("+ - * / %", nodes, true);
+    }
+
+    // The fixpoint solver with IntervalAlgebra on the same kind of graph
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(graph(scaled(10000), false)).generate(alg);
+    IntervalAlgebra intervalAlg;
+    size_t failed = 0;
+    size_t unbounded = 0;
+    Stopwatch sw;
+    for (const auto& root : w.roots) {
+        try {
+            if (!alg.eval(root, intervalAlg).isBounded()) unbounded++;
+        } catch (const std::runtime_error&) {
+            failed++;   // MAX_ITER reached
+        }
+    }
+    double solverTime = sw.seconds();
+    RangeAnalysis analysis;
+    sw.restart();
+    analysis.analyze(w.roots);
+    double analysisTime = sw.seconds();
+    size_t analysisUnbounded = 0;
+    for (const auto& root : w.roots) {
+        if (!analysis.range(root).isBounded()) analysisUnbounded++;
+    }
+    std::cout << std::endl << "roots of a " << WorkloadGenerator::measure(w.roots).nodes << "-node graph:" << std::endl
+              << "  fixpoint solver + IntervalAlgebra: " << std::setprecision(1) << solverTime * 1e3 << " ms, "
+              << failed << "/" << w.roots.size() << " did not converge, " << unbounded << " unbounded" << std::endl
+              << "  range analysis:                    " << analysisTime * 1e3 << " ms, "
+              << analysisUnbounded << "/" << w.roots.size() << " unbounded" << std::endl;
+    return 0;
+}
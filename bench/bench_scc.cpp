@@ -0,0 +1,58 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+
+// On-the-fly SCC discovery and iteration cost: one recursive system of
+// growing size, evaluated from its first variable. The last columns give the
+// iteration rounds and the node evaluations per round (dependent spine) next
+// to the subterms evaluated only once.
+
+static void row(WorkloadParams::Topology topology, const char* label, size_t size) {
+    WorkloadParams params;
+    params.nodeCount = 0;
+    params.sccCount = 1;
+    params.sccSize = size;
+    params.topology = topology;
+    
+    TreeAlgebra alg;
+    DoubleAlgebra doubleAlg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    
+    double value = 0.0;
+    double seconds = 0.0;
+    runWithStack(size_t(1) << 30, [&]() {
+        seconds = bestOf(3, [&]() { value = alg.eval(w.sccs[0][0], doubleAlg); });
+    });
+    
+    std::cout << std::left << std::setw(10) << label << std::right
+              << std::setw(10) << size
+              << std::setw(14) << std::fixed << std::setprecision(3) << seconds * 1e3
+              << std::setw(14) << std::setprecision(1) << seconds * 1e9 / static_cast<double>(size)
+              << std::setw(16) << std::setprecision(6) << value
+              << std::setw(8) << alg.fixpointStats().rounds
+              << std::setw(12) << std::setprecision(0) << alg.fixpointStats().evaluationsPerRound()
+              << std::setw(12) << alg.fixpointStats().independentNodes
+              << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(10) << "topology" << std::right
+              << std::setw(10) << "vars" << std::setw(14) << "time (ms)" << std::setw(14) << "ns/var"
+              << std::setw(16) << "x0" << std::setw(8) << "rounds" << std::setw(12) << "evals/round"
+              << std::setw(12) << "independent" << std::endl;
+    
+    using Topology = WorkloadParams::Topology;
+    for (size_t size : {scaled(100), scaled(1000), scaled(10000)}) {
+        row(Topology::Nested, "nested", size);
+    }
+    for (size_t size : {scaled(100), scaled(1000), scaled(10000)}) {
+        row(Topology::Chain, "chain", size);
+    }
+    for (size_t size : {scaled(100), scaled(1000), scaled(10000)}) {
+        row(Topology::Ring, "ring", size);
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/RangeAnalysis.hh"
+#include "algebra/CompactGraph.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Piecewise functions written with select against their arithmetic
+// encoding c·a + (1 - c)·b, c a 0/1 step: the lazy evaluator pays the taken
+// branch only, the encoding pays both plus three operations. The branches
+// are chains of `cost` elementary operations on x. Then the widths the two
+// forms give under RangeAnalysis, and the eager compact sweep, which
+// computes both operands of every select.
+
+struct Piecewise {
+    std::vector<std::shared_ptr<Tree>> selects;
+    std::vector<std::shared_ptr<Tree>> encoded;
+};
+
+static std::shared_ptr<Tree> chain(TreeAlgebra& alg, std::shared_ptr<Tree> x, double k, size_t cost) {
+    for (size_t i = 0; i < cost; ++i) {
+        x = alg.sin(alg.add(alg.mul(alg.num(k), x), alg.num(0.1 * static_cast<double>(i))));
+    }
+    return x;
+}
+
+// `pieces` piecewise functions of their own point x_i in [-1, 1]
+static Piecewise build(TreeAlgebra& alg, size_t pieces, size_t cost) {
+    Piecewise p;
+    for (size_t i = 0; i < pieces; ++i) {
+        const double xi = -1.0 + 2.0 * static_cast<double>((i * 2654435761u) % 1000) / 1000.0;
+        auto x = alg.num(xi);
+        auto a = chain(alg, x, 1.25, cost);
+        auto b = chain(alg, x, 0.75, cost);
+        auto step = alg.max(alg.num(0.0), alg.min(alg.num(1.0), alg.mul(alg.num(1e6), x)));
+        p.selects.push_back(alg.select(x, a, b));
+        p.encoded.push_back(alg.add(alg.mul(step, a), alg.mul(alg.sub(alg.num(1.0), step), b)));
+    }
+    return p;
+}
+
+int main() {
+    const size_t pieces = scaled(2000);
+    DoubleAlgebra doubles;
+
+    std::cout << std::left << std::setw(8) << "cost" << std::right << std::setw(14) << "select ms"
+              << std::setw(14) << "encoded ms" << std::setw(10) << "speedup" << std::setw(14) << "compact ms"
+              << std::endl;
+    for (size_t cost : {1, 4, 16}) {
+        // Fresh algebras: eval() memoizes per call only, but nodes shared by
+        // both forms must not be counted once for one and free for the other
+        TreeAlgebra selectAlg;
+        TreeAlgebra encodedAlg;
+        Piecewise s = build(selectAlg, pieces, cost);
+        Piecewise e = build(encodedAlg, pieces, cost);
+        const double lazy = bestOf(3, [&]() { doNotOptimize(selectAlg.eval(s.selects, doubles).data()); });
+        const double arithmetic = bestOf(3, [&]() { doNotOptimize(encodedAlg.eval(e.encoded, doubles).data()); });
+        CompactGraph graph(s.selects);
+        std::vector<double> values;
+        const double sweep = bestOf(3, [&]() {
+            graph.evaluate(doubles, values);
+            doNotOptimize(values.data());
+        });
+        std::cout << std::left << std::setw(8) << cost << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << lazy * 1e3 << std::setw(14) << arithmetic * 1e3
+                  << std::setw(10) << std::setprecision(2) << arithmetic / lazy
+                  << std::setw(14) << std::setprecision(3) << sweep * 1e3 << std::endl;
+    }
+
+    // Interval widths: |x| on [0.5, 1] and on [-1, 1]
+    TreeAlgebra alg;
+    auto x = alg.var();
+    auto neg = alg.sub(alg.num(0.0), x);
+    auto step = alg.max(alg.num(0.0), alg.min(alg.num(1.0), alg.mul(alg.num(1e6), x)));
+    auto selected = alg.select(x, x, neg);
+    auto encoded = alg.add(alg.mul(step, x), alg.mul(alg.sub(alg.num(1.0), step), neg));
+    std::cout << std::endl << std::left << std::setw(24) << "|x|, x in" << std::right << std::setw(14)
+              << "select" << std::setw(14) << "encoded" << std::endl;
+    for (Interval range : {Interval(0.5, 1.0), Interval(-1.0, 1.0)}) {
+        RangeAnalysis analysis;
+        analysis.setInputRange(x, range);
+        analysis.analyze({selected, encoded});
+        std::cout << std::left << std::setw(24) << range << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(14) << analysis.range(selected).width()
+                  << std::setw(14) << analysis.range(encoded).width() << std::endl;
+    }
+    return 0;
+}
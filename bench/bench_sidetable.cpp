@@ -0,0 +1,97 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// Many queries for the value of nodes scattered over a large graph: eval()
+// restarts from scratch at every call, query() answers from the side table
+// of the algebra once a node has been solved by any earlier query
+
+static std::vector<std::shared_ptr<Tree>> reachable(const std::vector<std::shared_ptr<Tree>>& roots) {
+    std::vector<std::shared_ptr<Tree>> nodes;
+    std::vector<bool> seen;
+    std::vector<std::shared_ptr<Tree>> pending(roots);
+    while (!pending.empty()) {
+        auto tree = pending.back();
+        pending.pop_back();
+        if (tree->getId() >= seen.size()) seen.resize(tree->getId() * 2 + 1, false);
+        if (seen[tree->getId()]) continue;
+        seen[tree->getId()] = true;
+        nodes.push_back(tree);
+        switch (tree->getType()) {
+            case Tree::NodeType::Unary: pending.push_back(tree->getOperand()); break;
+            case Tree::NodeType::Binary: pending.push_back(tree->getLeft()); pending.push_back(tree->getRight()); break;
+            case Tree::NodeType::Var: if (tree->getDefinition()) pending.push_back(tree->getDefinition()); break;
+            default: break;
+        }
+    }
+    return nodes;
+}
+
+template<typename T>
+static void row(const char* label, const SemanticAlgebra<T>& algebra) {
+    TreeAlgebra alg;
+    WorkloadParams params;
+    params.nodeCount = scaled(100000);
+    params.rootCount = 64;
+    params.sccCount = 20;
+    params.sccSize = 8;
+    params.binaryMix = {4, 2, 3, 0, 0};
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    std::vector<std::shared_ptr<Tree>> nodes = reachable(w.roots);
+
+    // The same pseudo-random sequence of nodes for both methods
+    const size_t evalQueries = scaled(2000);
+    const size_t queries = scaled(2000000);
+    WorkloadRandom rng(7);
+    std::vector<size_t> picks(queries);
+    for (auto& p : picks) p = rng.below(nodes.size());
+
+    Stopwatch sw;
+    for (size_t i = 0; i < evalQueries; ++i) {
+        doNotOptimize(alg.eval(nodes[picks[i]], algebra));
+    }
+    const double evalTime = sw.seconds() / static_cast<double>(evalQueries);
+
+    sw.restart();
+    for (size_t i = 0; i < queries; ++i) {
+        doNotOptimize(alg.query(nodes[picks[i]], algebra));
+    }
+    const double queryTime = sw.seconds() / static_cast<double>(queries);
+
+    // Everything is in the table now: pure lookups
+    const double warmTime = bestOf(3, [&]() {
+        for (size_t i = 0; i < queries; ++i) {
+            doNotOptimize(alg.query(nodes[picks[i]], algebra));
+        }
+    }) / static_cast<double>(queries);
+
+    const SideTableUsage usage = alg.sideTableUsage().front();
+    std::cout << std::left << std::setw(18) << label << std::right
+              << std::setw(9) << nodes.size()
+              << std::setw(13) << std::fixed << std::setprecision(1) << evalTime * 1e6
+              << std::setw(13) << std::setprecision(3) << queryTime * 1e6
+              << std::setw(12) << std::setprecision(1) << warmTime * 1e9
+              << std::setw(10) << std::setprecision(0) << evalTime / warmTime
+              << std::setw(10) << usage.entries
+              << std::setw(10) << std::setprecision(2) << static_cast<double>(usage.bytes) / (1 << 20)
+              << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(18) << "algebra" << std::right
+              << std::setw(9) << "nodes" << std::setw(13) << "eval (us)" << std::setw(13) << "query (us)"
+              << std::setw(12) << "warm (ns)" << std::setw(10) << "speedup" << std::setw(10) << "entries"
+              << std::setw(10) << "MiB"
+              << std::endl;
+    row("DoubleAlgebra", DoubleAlgebra());
+    row("IntervalAlgebra", IntervalAlgebra());
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/SignalEngine.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+// CPU load of one reverb channel at 48 kHz: a 16-tap FIR and a waveshaper
+// (non-recursive, block stages), 8 damped comb filters and 4 allpass
+// filters in the style of Freeverb (recursive, sample stages)
+
+static std::shared_ptr<Tree> comb(const TreeAlgebra& alg, SignalProgram& program,
+                                  const std::shared_ptr<Tree>& in, size_t length) {
+    // line = delay(in + 0.84·f, length), f = 0.8·line + 0.2·f (one-pole damping)
+    auto f = alg.var();
+    auto line = program.delay(alg.add(in, alg.mul(alg.num(0.84), f)), length);
+    alg.define(f, alg.add(alg.mul(alg.num(0.8), line), alg.mul(alg.num(0.2), f)));
+    return line;
+}
+
+static std::shared_ptr<Tree> allpass(const TreeAlgebra& alg, SignalProgram& program,
+                                     const std::shared_ptr<Tree>& in, size_t length) {
+    // w = in + 0.5·delay(w, length), out = delay(w, length) - in
+    auto w = alg.var();
+    auto line = program.delay(w, length);
+    alg.define(w, alg.add(in, alg.mul(alg.num(0.5), line)));
+    return alg.sub(line, in);
+}
+
+static void reverb(const TreeAlgebra& alg, SignalProgram& program) {
+    auto in = program.input();
+
+    // Pre-filter and soft saturation x / (1 + |x|)
+    auto fir = alg.mul(alg.num(0.1), in);
+    for (size_t k = 1; k < 16; ++k) {
+        fir = alg.add(fir, alg.mul(alg.num(0.1 / static_cast<double>(k + 1)), program.delay(in, k)));
+    }
+    auto shaped = alg.div(fir, alg.add(alg.num(1.0), alg.abs(fir)));
+
+    const size_t combs[] = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617};
+    auto wet = comb(alg, program, shaped, combs[0]);
+    for (size_t k = 1; k < 8; ++k) {
+        wet = alg.add(wet, comb(alg, program, shaped, combs[k]));
+    }
+    for (size_t length : {556, 441, 341, 225}) {
+        wet = allpass(alg, program, wet, length);
+    }
+    program.output(alg.add(alg.mul(alg.num(0.3), wet), alg.mul(alg.num(0.7), in)));
+}
+
+template<typename T>
+static void measure(const char* type, size_t blockSize, size_t seconds) {
+    TreeAlgebra alg;
+    SignalProgram program(alg);
+    reverb(alg, program);
+    SignalEngine<T> engine(program, blockSize);
+
+    const size_t rate = 48000;
+    const size_t n = seconds * rate;
+    std::vector<T> input(blockSize);
+    std::vector<T> output(blockSize);
+    for (size_t i = 0; i < blockSize; ++i) {
+        input[i] = static_cast<T>((i * 7919) % 1000) * T(0.001) - T(0.5);
+    }
+    const T* in = input.data();
+    T* out = output.data();
+
+    double time = bestOf(3, [&]() {
+        for (size_t done = 0; done < n; done += blockSize) {
+            engine.process(&in, &out, blockSize);
+            doNotOptimize(output[0]);
+        }
+    });
+
+    const auto& stats = engine.stats();
+    const double nsPerSample = time * 1e9 / static_cast<double>(n);
+    const double load = time / static_cast<double>(seconds);   // Fraction of real time
+    std::cout << std::left << std::setw(8) << type << std::right
+              << std::setw(8) << blockSize
+              << std::setw(10) << stats.blockInstructions
+              << std::setw(10) << stats.sampleInstructions
+              << std::setw(12) << std::fixed << std::setprecision(1) << nsPerSample
+              << std::setw(11) << std::setprecision(2) << load * 100.0 << "%"
+              << std::setw(12) << std::setprecision(0) << 1.0 / load
+              << std::endl;
+}
+
+int main() {
+    const size_t seconds = scaled(10);
+    std::cout << "Reverb channel, " << seconds << " s of audio at 48 kHz per run" << std::endl;
+    std::cout << std::left << std::setw(8) << "type" << std::right
+              << std::setw(8) << "block" << std::setw(10) << "block op" << std::setw(10) << "sample op"
+              << std::setw(12) << "ns/sample" << std::setw(12) << "CPU load" << std::setw(12) << "channels"
+              << std::endl;
+
+    // Block size 1 degenerates to per-sample evaluation of everything
+    for (size_t blockSize : {1, 16, 64, 256}) {
+        measure<float>("float", blockSize, seconds);
+    }
+    for (size_t blockSize : {1, 64, 256}) {
+        measure<double>("double", blockSize, seconds);
+    }
+    return 0;
+}
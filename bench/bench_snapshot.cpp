@@ -0,0 +1,150 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/Snapshot.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Snapshots of a model being edited: the cost of publishing one and of the
+// first define() after it, the cost of evaluating through a snapshot, and
+// one writer redefining variables while readers evaluate, with a global
+// mutex around both against published snapshots. On fewer cores than
+// threads, the threads share them: compare throughputs, not speedups.
+
+static WorkloadParams model(size_t nodes) {
+    WorkloadParams params;
+    params.nodeCount = nodes;
+    params.rootCount = 64;
+    params.sccCount = 64;
+    params.sccSize = 8;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    return params;
+}
+
+static void publishing(size_t nodes) {
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(model(nodes)).generate(alg);
+    SnapshotPublisher publisher;
+    const auto& var = w.sccs[0][0];
+    const double publish = bestOf(5, [&]() { doNotOptimize(publisher.publish(alg, w.roots)); });
+    const double redefine = bestOf(5, [&]() {
+        publisher.publish(alg, w.roots);
+        Stopwatch sw;
+        alg.define(var, var->getDefinition());   // Copies one chunk
+        doNotOptimize(sw.seconds());
+    });
+    SnapshotReader reader(publisher);
+    DoubleAlgebra doubles;
+    const double direct = bestOf(3, [&]() { doNotOptimize(alg.eval(w.roots, doubles).data()); });
+    const double snapshot = bestOf(3, [&]() { doNotOptimize(reader.evalRoots(doubles).data()); });
+    std::cout << std::right << std::setw(10) << alg.nodeCount() << std::fixed
+              << std::setw(12) << std::setprecision(2) << publish * 1e6
+              << std::setw(12) << redefine * 1e6
+              << std::setw(12) << direct * 1e3
+              << std::setw(12) << snapshot * 1e3
+              << std::setw(10) << snapshot / direct << std::endl;
+}
+
+struct Throughput {
+    double evaluations;   // Per second, all readers
+    double defines;       // Per second
+};
+
+// One writer redefining SCC variables (with their own definitions, so the
+// values stay the same) for `seconds`, readers evaluating all the roots.
+// makeReader is called on each reader thread and returns its evaluation.
+static Throughput mixed(const Workload& w, size_t readers, double seconds,
+                        const std::function<void(const std::shared_ptr<Tree>&)>& define,
+                        const std::function<std::function<void()>()>& makeReader) {
+    std::atomic<bool> done{false};
+    std::atomic<size_t> evaluations{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < readers; ++t) {
+        threads.emplace_back([&]() {
+            auto read = makeReader();
+            while (!done.load(std::memory_order_relaxed)) {
+                read();
+                evaluations++;
+            }
+        });
+    }
+    size_t defines = 0;
+    Stopwatch sw;
+    while (sw.seconds() < seconds) {
+        const auto& scc = w.sccs[defines % w.sccs.size()];
+        define(scc[defines % scc.size()]);
+        defines++;
+    }
+    const double elapsed = sw.seconds();
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return Throughput{evaluations / elapsed, defines / elapsed};
+}
+
+int main() {
+    std::cout << std::right << std::setw(10) << "nodes" << std::setw(12) << "publish us"
+              << std::setw(12) << "define us" << std::setw(12) << "eval ms" << std::setw(12) << "snap ms"
+              << std::setw(10) << "ratio" << std::endl;
+    for (size_t nodes : {10000, 100000, 1000000}) {
+        publishing(scaled(nodes));
+    }
+
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(model(scaled(20000))).generate(alg);
+    const double seconds = 0.5 * benchScale() < 0.05 ? 0.05 : 0.5 * benchScale();
+    std::cout << std::endl << std::right << std::setw(10) << "readers"
+              << std::setw(16) << "mutex eval/s" << std::setw(16) << "mutex def/s"
+              << std::setw(16) << "snap eval/s" << std::setw(16) << "snap def/s" << std::endl;
+    for (size_t readers : {1, 2, 4}) {
+        // Everything behind one lock
+        std::mutex lock;
+        Throughput locked = mixed(w, readers, seconds,
+            [&](const std::shared_ptr<Tree>& var) {
+                std::lock_guard<std::mutex> guard(lock);
+                alg.define(var, var->getDefinition());
+            },
+            [&]() {
+                return [&]() {
+                    DoubleAlgebra doubles;
+                    std::lock_guard<std::mutex> guard(lock);
+                    doNotOptimize(alg.eval(w.roots, doubles).data());
+                };
+            });
+
+        // A snapshot published every 64 definitions, one reader per thread
+        SnapshotPublisher publisher;
+        publisher.publish(alg, w.roots);
+        size_t edits = 0;
+        Throughput snapshots = mixed(w, readers, seconds,
+            [&](const std::shared_ptr<Tree>& var) {
+                alg.define(var, var->getDefinition());
+                if (++edits % 64 == 0) {
+                    publisher.publish(alg, w.roots);
+                }
+            },
+            [&]() {
+                auto reader = std::make_shared<SnapshotReader>(publisher);
+                return [reader]() {
+                    reader->refresh();
+                    doNotOptimize(reader->evalRoots(DoubleAlgebra()).data());
+                };
+            });
+        std::cout << std::setw(10) << readers << std::fixed << std::setprecision(0)
+                  << std::setw(16) << locked.evaluations << std::setw(16) << locked.defines
+                  << std::setw(16) << snapshots.evaluations << std::setw(16) << snapshots.defines << std::endl;
+    }
+    return 0;
+}
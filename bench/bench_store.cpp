@@ -0,0 +1,199 @@
+#include "algebra/NodeStore.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Worker processes evaluating one model: each building its own TreeAlgebra
+// against each attaching to a NodeStore written once (in /dev/shm when it
+// exists). For each worker: the time to be ready (build or attach), the
+// first evaluation, and the growth of its resident memory: RSS, and PSS,
+// where pages shared by k processes count for 1/k. The workers hold their
+// memory until all of them have measured it.
+
+static WorkloadParams model() {
+    WorkloadParams params;
+    params.nodeCount = scaled(1000000);
+    params.rootCount = 64;
+    params.sccCount = 64;
+    params.sccSize = 8;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    return params;
+}
+
+struct Memory {
+    double rss = 0.0;       // KiB
+    double pss = 0.0;
+    double priv = 0.0;      // Pages of this process only
+};
+
+static Memory memory() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    Memory m;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        std::string key;
+        double kb = 0.0;
+        fields >> key >> kb;
+        if (key == "Rss:") m.rss = kb;
+        if (key == "Pss:") m.pss = kb;
+        if (key == "Private_Clean:" || key == "Private_Dirty:") m.priv += kb;
+    }
+    return m;
+}
+
+struct Worker {
+    double ready = 0.0;   // Seconds
+    double eval = 0.0;
+    Memory growth;
+};
+
+// Runs `workers` processes doing ready() then evaluating, and returns
+// their averages
+static Worker run(int workers, const std::function<std::function<double()>()>& ready) {
+    int readyPipe[2];
+    int goPipe[2];
+    int resultPipe[2];
+    if (pipe(readyPipe) != 0 || pipe(goPipe) != 0 || pipe(resultPipe) != 0) {
+        throw std::runtime_error("pipe");
+    }
+    for (int k = 0; k < workers; ++k) {
+        if (fork() == 0) {
+            Worker w;
+            const auto before = memory();
+            Stopwatch sw;
+            auto evaluate = ready();
+            w.ready = sw.seconds();
+            sw.restart();
+            doNotOptimize(evaluate());
+            w.eval = sw.seconds();
+            char c = 0;
+            if (::write(readyPipe[1], &c, 1) != 1 || ::read(goPipe[0], &c, 1) != 1) _exit(1);
+            const auto after = memory();
+            w.growth.rss = after.rss - before.rss;
+            w.growth.pss = after.pss - before.pss;
+            w.growth.priv = after.priv - before.priv;
+            if (::write(resultPipe[1], &w, sizeof(w)) != sizeof(w)) _exit(1);
+            _exit(0);
+        }
+    }
+    char c = 0;
+    for (int k = 0; k < workers; ++k) {
+        if (::read(readyPipe[0], &c, 1) != 1) throw std::runtime_error("worker");
+    }
+    for (int k = 0; k < workers; ++k) {
+        if (::write(goPipe[1], &c, 1) != 1) throw std::runtime_error("worker");
+    }
+    Worker total;
+    for (int k = 0; k < workers; ++k) {
+        Worker w;
+        if (::read(resultPipe[0], &w, sizeof(w)) != sizeof(w)) throw std::runtime_error("worker");
+        total.ready += w.ready / workers;
+        total.eval += w.eval / workers;
+        total.growth.rss += w.growth.rss / workers;
+        total.growth.pss += w.growth.pss / workers;
+        total.growth.priv += w.growth.priv / workers;
+    }
+    while (wait(nullptr) > 0) {}
+    for (int fd : {readyPipe[0], readyPipe[1], goPipe[0], goPipe[1], resultPipe[0], resultPipe[1]}) {
+        ::close(fd);
+    }
+    return total;
+}
+
+static void row(const char* label, int workers, const Worker& w) {
+    std::cout << std::left << std::setw(10) << label << std::right << std::setw(8) << workers << std::fixed
+              << std::setw(12) << std::setprecision(2) << w.ready * 1e3
+              << std::setw(12) << w.eval * 1e3
+              << std::setw(12) << std::setprecision(1) << w.growth.rss / 1024.0
+              << std::setw(12) << w.growth.priv / 1024.0
+              << std::setw(12) << w.growth.pss / 1024.0 << std::endl;
+}
+
+int main() {
+    const std::filesystem::path shm("/dev/shm");
+    const std::filesystem::path dir = std::filesystem::exists(shm) ? shm : std::filesystem::temp_directory_path();
+    const std::string path = (dir / ("algebra-bench-" + std::to_string(getpid()) + ".store")).string();
+
+    // The model is built and written by another process: the workers fork
+    // from a small one and share nothing with the model's builder
+    double times[3] = {0.0, 0.0, 0.0};   // Build, compact, write
+    size_t nodes = 0;
+    {
+        int result[2];
+        if (pipe(result) != 0) return 1;
+        if (fork() == 0) {
+            Stopwatch sw;
+            TreeAlgebra alg;
+            Workload w = WorkloadGenerator(model()).generate(alg);
+            times[0] = sw.seconds();
+            sw.restart();
+            CompactGraph graph(w.roots);
+            times[1] = sw.seconds();
+            sw.restart();
+            NodeStore::write(path, graph);
+            times[2] = sw.seconds();
+            nodes = alg.nodeCount();
+            if (::write(result[1], times, sizeof(times)) != sizeof(times) ||
+                ::write(result[1], &nodes, sizeof(nodes)) != sizeof(nodes)) _exit(1);
+            _exit(0);
+        }
+        if (::read(result[0], times, sizeof(times)) != sizeof(times) ||
+            ::read(result[0], &nodes, sizeof(nodes)) != sizeof(nodes)) return 1;
+        wait(nullptr);
+        ::close(result[0]);
+        ::close(result[1]);
+    }
+    {
+        NodeStore store = NodeStore::open(path);
+        const double attach = bestOf(5, [&]() { doNotOptimize(NodeStore::open(path).size()); });
+        const double verify = bestOf(3, [&]() { store.verify(); });
+        std::cout << nodes << " nodes built in " << std::fixed << std::setprecision(1) << times[0] * 1e3
+                  << " ms; compacted in " << times[1] * 1e3 << " ms; store of " << store.size() << " nodes, "
+                  << store.bytes() / 1048576.0 << " MiB written in " << times[2] * 1e3 << " ms, attached in "
+                  << std::setprecision(3) << attach * 1e3 << " ms, verified in " << std::setprecision(1)
+                  << verify * 1e3 << " ms" << std::endl << std::endl;
+    }
+
+    std::cout << std::left << std::setw(10) << "workers" << std::right << std::setw(8) << "N"
+              << std::setw(12) << "ready ms" << std::setw(12) << "eval ms"
+              << std::setw(12) << "RSS MiB" << std::setw(12) << "priv MiB" << std::setw(12) << "PSS MiB"
+              << std::endl;
+    for (int workers : {1, 4}) {
+        row("private", workers, run(workers, []() {
+            auto alg = std::make_shared<TreeAlgebra>();
+            auto w = std::make_shared<Workload>(WorkloadGenerator(model()).generate(*alg));
+            return std::function<double()>([alg, w]() {
+                double sum = 0.0;
+                runWithStack(size_t(1) << 30, [&]() {
+                    for (double v : alg->eval(w->roots, DoubleAlgebra())) sum += v;
+                });
+                return sum;
+            });
+        }));
+        row("store", workers, run(workers, [&path]() {
+            auto attached = std::make_shared<NodeStore>(NodeStore::open(path));
+            return std::function<double()>([attached]() {
+                double sum = 0.0;
+                for (double v : attached->evalRoots(DoubleAlgebra())) sum += v;
+                return sum;
+            });
+        }));
+    }
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/Tape.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+// Evaluations per second of one arithmetic DAG: the CompactGraph sweep,
+// then its tape without passes, with the superinstructions and dead-slot
+// elimination, with the depth-level schedule on top, and evaluated by a
+// DoubleAlgebra contracting multiply-adds. A small DAG (its slots fit in
+// L1) and a large one.
+
+static void print(const std::string& label, size_t size, double seconds, double baseline) {
+    std::cout << std::left << std::setw(26) << label << std::right << std::setw(12) << size
+              << std::fixed << std::setprecision(0) << std::setw(14) << 1.0 / seconds
+              << std::setprecision(2) << std::setw(10) << baseline / seconds << std::endl;
+}
+
+template<typename T>
+static void rows(const char* type, const CompactGraph& graph, const std::vector<const Algebra<T>*>& algebras,
+                 size_t repeats) {
+    const Algebra<T>& algebra = *algebras[0];
+    std::vector<T> values;
+    const double sweep = bestOf(3, [&]() {
+        for (size_t r = 0; r < repeats; ++r) {
+            graph.evaluate(algebra, values);
+            doNotOptimize(values.data());
+        }
+    }) / static_cast<double>(repeats);
+    std::cout << std::endl << type << ", " << graph.size() << " nodes" << std::endl;
+    std::cout << std::left << std::setw(26) << "" << std::right << std::setw(12) << "instructions"
+              << std::setw(14) << "evals/s" << std::setw(10) << "speedup" << std::endl;
+    print("compact sweep", graph.size(), sweep, sweep);
+
+    struct Variant {
+        const char* label;
+        TapeOptions options;
+        const Algebra<T>* algebra;
+    };
+    TapeOptions none;
+    none.fuse = false;
+    none.eliminateDead = false;
+    TapeOptions fused;
+    TapeOptions scheduled;
+    scheduled.schedule = true;
+    std::vector<Variant> variants = {
+        {"tape", none, &algebra},
+        {"tape, fused", fused, &algebra},
+        {"tape, fused, scheduled", scheduled, &algebra},
+    };
+    if (algebras.size() > 1) {
+        variants.push_back({"tape, fused, contracted", fused, algebras[1]});
+    }
+    for (const Variant& v : variants) {
+        Tape tape(graph, v.options);
+        std::vector<T> slots;
+        const double t = bestOf(3, [&]() {
+            for (size_t r = 0; r < repeats; ++r) {
+                tape.evaluate(*v.algebra, slots);
+                doNotOptimize(slots.data());
+            }
+        }) / static_cast<double>(repeats);
+        print(v.label, tape.stats().instructions, t, sweep);
+    }
+}
+
+int main() {
+    DoubleAlgebra doubles;
+    DoubleAlgebra contracted(Contraction::FusedMultiplyAdd);
+    IntervalAlgebra intervals;
+
+    for (size_t nodes : {scaled(2000), scaled(500000)}) {
+        TreeAlgebra alg;
+        WorkloadParams params;
+        params.nodeCount = nodes;
+        params.rootCount = 16;
+        params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+        params.constants = WorkloadParams::Constants::Uniform;
+        params.constantMin = 0.5;
+        params.constantMax = 1.5;
+        params.maxDepth = 16;
+        Workload w = WorkloadGenerator(params).generate(alg);
+        CompactGraph graph = compact(w.roots);
+        const size_t repeats = std::max<size_t>(1, scaled(2000000) / graph.size());
+        rows<double>("double", graph, {&doubles, &contracted}, repeats);
+        rows<Interval>("interval", graph, {&intervals}, std::max<size_t>(1, repeats / 4));
+    }
+    return 0;
+}
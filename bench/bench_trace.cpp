@@ -0,0 +1,72 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/SolverTrace.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+// Cost of the solver trace: evaluations without a trace (the hooks only
+// test a null pointer) and with one, for a DAG over many small SCCs and for
+// one large ring, then the size and writing time of the JSON.
+
+static void row(const char* label, const WorkloadParams& params) {
+    TreeAlgebra alg;
+    DoubleAlgebra doubles;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    const auto& root = params.nodeCount ? w.roots[0] : w.sccs[0][0];
+
+    double off = 0.0;
+    double on = 0.0;
+    SolverTrace trace;
+    runWithStack(size_t(1) << 30, [&]() {
+        off = bestOf(3, [&]() { doNotOptimize(alg.eval(root, doubles)); });
+        alg.setTrace(&trace);
+        on = bestOf(3, [&]() {
+            trace.clear();
+            doNotOptimize(alg.eval(root, doubles));
+        });
+        alg.setTrace(nullptr);
+    });
+
+    std::ostringstream json;
+    const double write = bestOf(3, [&]() {
+        json.str("");
+        trace.write(json);
+    });
+    std::cout << std::left << std::setw(12) << label << std::right << std::fixed
+              << std::setw(10) << std::setprecision(2) << off * 1e3
+              << std::setw(10) << on * 1e3
+              << std::setw(9) << on / off << "x"
+              << std::setw(10) << trace.size()
+              << std::setw(10) << alg.fixpointStats().rounds
+              << std::setw(10) << std::setprecision(1) << json.str().size() / 1024.0
+              << std::setw(10) << std::setprecision(2) << write * 1e3 << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(12) << "model" << std::right
+              << std::setw(10) << "off ms" << std::setw(10) << "on ms" << std::setw(10) << "cost"
+              << std::setw(10) << "events" << std::setw(10) << "rounds"
+              << std::setw(10) << "JSON KiB" << std::setw(10) << "write ms" << std::endl;
+
+    WorkloadParams dag;
+    dag.nodeCount = scaled(100000);
+    dag.sccCount = 256;
+    dag.sccSize = 8;
+    dag.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    dag.constants = WorkloadParams::Constants::Uniform;
+    dag.constantMin = 0.5;
+    dag.constantMax = 1.5;
+    dag.maxDepth = 12;
+    row("dag+sccs", dag);
+
+    WorkloadParams ring;
+    ring.nodeCount = 0;
+    ring.sccCount = 1;
+    ring.sccSize = scaled(2000);
+    ring.topology = WorkloadParams::Topology::Ring;
+    row("ring", ring);
+    return 0;
+}
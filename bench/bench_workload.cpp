@@ -0,0 +1,80 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include "BenchUtils.hh"
+#include <iostream>
+#include <iomanip>
+
+// Generation cost and evaluation throughput of synthetic workloads
+
+static void row(const char* label, const WorkloadParams& params) {
+    TreeAlgebra alg;
+    DoubleAlgebra doubleAlg;
+    
+    Stopwatch sw;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    double genTime = sw.seconds();
+    auto stats = WorkloadGenerator::measure(w.roots);
+    
+    double evalTime = bestOf(3, [&]() {
+        for (const auto& root : w.roots) {
+            doNotOptimize(alg.eval(root, doubleAlg));
+        }
+    });
+    
+    std::cout << std::left << std::setw(28) << label << std::right
+              << std::setw(10) << stats.nodes
+              << std::setw(10) << stats.sharedNodes
+              << std::setw(8) << stats.maxDepth
+              << std::setw(12) << std::fixed << std::setprecision(2) << genTime * 1e3
+              << std::setw(12) << evalTime * 1e3
+              << std::setw(12) << std::setprecision(1) << evalTime * 1e9 / static_cast<double>(stats.nodes)
+              << std::endl;
+}
+
+int main() {
+    std::cout << std::left << std::setw(28) << "workload" << std::right
+              << std::setw(10) << "nodes" << std::setw(10) << "shared" << std::setw(8) << "depth"
+              << std::setw(12) << "gen (ms)" << std::setw(12) << "eval (ms)" << std::setw(12) << "ns/node"
+              << std::endl;
+    
+    for (size_t n : {1000, 10000, 100000}) {
+        WorkloadParams params;
+        params.nodeCount = scaled(n);
+        params.rootCount = 16;
+        std::string label = "dag n=" + std::to_string(params.nodeCount);
+        row(label.c_str(), params);
+    }
+    
+    {
+        WorkloadParams params;
+        params.nodeCount = scaled(100000);
+        params.rootCount = 16;
+        params.sharingRatio = 0.0;
+        row("tree-like", params);
+        params.sharingRatio = 0.95;
+        row("heavily shared", params);
+        params.sharingRatio = 0.5;
+        params.depthProfile = WorkloadParams::DepthProfile::Shallow;
+        row("shallow", params);
+        params.depthProfile = WorkloadParams::DepthProfile::Deep;
+        params.maxDepth = 1000;
+        row("deep", params);
+    }
+    
+    using Topology = WorkloadParams::Topology;
+    const std::pair<const char*, Topology> topologies[] = {
+        {"scc ring", Topology::Ring}, {"scc chain", Topology::Chain},
+        {"scc clique", Topology::Clique}, {"scc nested", Topology::Nested}};
+    for (const auto& [label, topology] : topologies) {
+        WorkloadParams params;
+        params.nodeCount = scaled(10000);
+        params.rootCount = 16;
+        params.sccCount = 8;
+        params.sccSize = 8;
+        params.topology = topology;
+        row(label, params);
+    }
+    
+    return 0;
+}
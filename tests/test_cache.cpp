@@ -0,0 +1,195 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/StructuralHash.hh"
+#include "algebra/ResultCache.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+
+// x = a·x + b, y = x + c, root = y * 2
+static std::shared_ptr<Tree> model(TreeAlgebra& alg, double a, double b, double c) {
+    auto x = alg.var();
+    auto y = alg.var();
+    alg.define(x, alg.add(alg.mul(alg.num(a), x), alg.num(b)));
+    alg.define(y, alg.add(x, alg.num(c)));
+    return alg.mul(y, alg.num(2.0));
+}
+
+void test_structural_hash() {
+    std::cout << "Testing structural hashes..." << std::endl;
+
+    TreeAlgebra alg1;
+    TreeAlgebra alg2;
+    alg2.var();   // Shifts the indices of the variables of alg2
+    alg2.var();
+    StructuralHasher hasher;
+
+    // Same content, other algebra and variable indices: same hash
+    StructuralHash h1 = hasher.hash(alg1, model(alg1, 0.5, 1.0, 3.0));
+    StructuralHash h2 = hasher.hash(alg2, model(alg2, 0.5, 1.0, 3.0));
+    std::cout << "hash " << h1.hex() << std::endl;
+    assert(h1 == h2);
+    assert(h1.hex().size() == 32);
+
+    // Any change in a definition changes the hash
+    assert(hasher.hash(alg1, model(alg1, 0.5, 1.0, 4.0)) != h1);
+    assert(hasher.hash(alg1, model(alg1, 0.25, 1.0, 3.0)) != h1);
+    assert(hasher.hash(alg1, model(alg1, 0.5, 1.0, 3.0)) == h1);
+
+    // Structure, not values: 2 + 3 and 3 + 2 differ, integers and reals differ
+    assert(hasher.hash(alg1, alg1.add(alg1.num(2.0), alg1.num(3.0))) != hasher.hash(alg1, alg1.add(alg1.num(3.0), alg1.num(2.0))));
+    assert(hasher.hash(alg1, alg1.num(2.0)) != hasher.hash(alg1, alg1.integer(2)));
+    assert(hasher.hash(alg1, alg1.num(0.0)) == hasher.hash(alg2, alg2.num(-0.0)));
+
+    // Variables are told apart by their definitions and their position
+    auto u = alg1.var();
+    auto v = alg1.var();
+    alg1.define(u, alg1.num(1.0));
+    alg1.define(v, alg1.num(2.0));
+    assert(hasher.hash(alg1, alg1.add(u, v)) != hasher.hash(alg1, alg1.add(v, u)));
+    assert(hasher.hash(alg1, alg1.add(u, u)) != hasher.hash(alg1, alg1.add(u, v)));
+    auto input = alg1.var();
+    auto other = alg1.var();
+    assert(hasher.hash(alg1, alg1.abs(input)) == hasher.hash(alg1, alg1.abs(other)));   // Two inputs
+    assert(hasher.hash(alg1, alg1.abs(input)) != hasher.hash(alg1, alg1.abs(u)));
+
+    // Hashes of roots are kept until a definition changes
+    StructuralHash before = hasher.hash(alg1, alg1.abs(input));
+    assert(hasher.hash(alg1, alg1.abs(input)) == before);
+    alg1.define(input, alg1.num(1.0));
+    assert(hasher.hash(alg1, alg1.abs(input)) != before);
+    assert(hasher.hash(alg1, alg1.abs(input)) == hasher.hash(alg1, alg1.abs(u)));
+    v->setDefinition(alg1.num(5.0));   // Not through define()
+    StructuralHasher unmemoised;
+    assert(hasher.hash(alg1, alg1.add(u, v)) == unmemoised.hash(alg1, alg1.add(u, v)));
+    v->setDefinition(alg1.num(2.0));
+
+    // Mutual recursion, built in two orders
+    auto p = alg1.var();
+    auto q = alg1.var();
+    alg1.define(p, alg1.add(q, alg1.num(1.0)));
+    alg1.define(q, alg1.mul(p, alg1.num(0.5)));
+    auto q2 = alg2.var();
+    auto p2 = alg2.var();
+    alg2.define(q2, alg2.mul(p2, alg2.num(0.5)));
+    alg2.define(p2, alg2.add(q2, alg2.num(1.0)));
+    assert(hasher.hash(alg1, p) == hasher.hash(alg2, p2));
+    assert(hasher.hash(alg1, p) != hasher.hash(alg1, q));
+
+    // A fresh hasher (another run) agrees
+    StructuralHasher fresh;
+    assert(fresh.hash(alg2, p2) == hasher.hash(alg1, p));
+
+    std::cout << "Structural hash test passed!" << std::endl;
+}
+
+void test_result_cache() {
+    std::cout << "Testing ResultCache..." << std::endl;
+
+    const std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / ("algebra-cache-test-" + std::to_string(getpid()));
+    std::filesystem::remove_all(directory);
+
+    DoubleAlgebra doubles;
+    IntervalAlgebra intervals;
+    std::vector<double> first;
+    {
+        TreeAlgebra alg;
+        std::vector<std::shared_ptr<Tree>> roots;
+        for (int i = 0; i < 10; ++i) roots.push_back(model(alg, 0.5, i, 1.0));
+        ResultCache cache(directory.string());
+        first = cache.evaluate(alg, roots, doubles);
+        cache.evaluate(alg, roots, intervals);
+        assert(cache.stats().lookups == 20 && cache.stats().hits == 0 && cache.stats().stores == 20);
+        for (int i = 0; i < 10; ++i) {
+            assert(std::abs(first[i] - 2.0 * (2.0 * i + 1.0)) < 1e-6);
+        }
+        // Evaluated again in the same run: hits
+        cache.evaluate(alg, roots, doubles);
+        assert(cache.stats().hits == 10);
+        assert(cache.entries(TreeAlgebra::typeName(doubles)) == 10);
+    }
+
+    // Another run, on a model where one root changed
+    {
+        TreeAlgebra alg;
+        std::vector<std::shared_ptr<Tree>> roots;
+        for (int i = 0; i < 10; ++i) roots.push_back(model(alg, 0.5, i == 3 ? 100.0 : i, 1.0));
+        ResultCache cache(directory.string());
+        std::vector<double> values = cache.evaluate(alg, roots, doubles);
+        const ResultCacheStats& stats = cache.stats();
+        std::cout << stats.hits << "/" << stats.lookups << " hits, " << stats.bytesRead << " bytes read" << std::endl;
+        assert(stats.hits == 9 && stats.misses() == 1);
+        for (int i = 0; i < 10; ++i) {
+            if (i != 3) assert(values[i] == first[i]);
+        }
+        assert(std::abs(values[3] - 402.0) < 1e-6);
+        assert(stats.savedSeconds >= 0.0);
+
+        // A root edited with Tree::setDefinition() is evaluated again
+        auto x = alg.var();
+        auto edited = alg.add(x, alg.num(1.0));
+        x->setDefinition(alg.num(1000.0));
+        assert(cache.evaluate(alg, edited, doubles) == 1001.0);
+        x->setDefinition(alg.num(2000.0));
+        assert(cache.evaluate(alg, edited, doubles) == 2001.0);
+
+        // Values of other types, under explicit ids
+        cache.store("labels", cache.key(alg, roots[0]), std::string("first root"));
+        assert(*cache.lookup<std::string>("labels", cache.key(alg, roots[0])) == "first root");
+        assert(!cache.lookup<std::string>("labels", cache.key(alg, roots[1])));
+    }
+
+    // An interrupted write leaves a partial record: it is dropped
+    {
+        std::filesystem::path file;   // The largest log
+        for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+            if (file.empty() || entry.file_size() > std::filesystem::file_size(file)) {
+                file = entry.path();
+            }
+        }
+        const auto size = std::filesystem::file_size(file);
+        std::ofstream(file, std::ios::app | std::ios::binary) << "partial record";
+        TreeAlgebra alg;
+        ResultCache cache(directory.string());
+        auto root = model(alg, 0.5, 3.0, 1.0);
+        double a = cache.evaluate(alg, root, doubles);
+        double b = cache.evaluate(alg, root, intervals).inf;
+        assert(cache.stats().hits == 2);
+        assert(std::abs(a - 14.0) < 1e-6 && b <= a);
+        assert(std::filesystem::file_size(file) == size);
+    }
+
+    // Two writers on one directory: each record is indexed where it landed
+    {
+        TreeAlgebra alg;
+        auto k1 = model(alg, 0.5, 1.0, 1.0);
+        auto k2 = model(alg, 0.5, 2.0, 1.0);
+        ResultCache(directory.string()).store("writers", StructuralHash{0, 0}, 0.0);   // Creates the log
+        ResultCache first(directory.string());
+        ResultCache second(directory.string());
+        assert(!first.lookup<double>("writers", first.key(alg, k1)));
+        assert(!second.lookup<double>("writers", second.key(alg, k2)));
+        second.store("writers", second.key(alg, k2), 222.0);
+        first.store("writers", first.key(alg, k1), 111.0);
+        assert(*first.lookup<double>("writers", first.key(alg, k1)) == 111.0);
+        assert(*second.lookup<double>("writers", second.key(alg, k2)) == 222.0);
+        ResultCache reader(directory.string());
+        assert(*reader.lookup<double>("writers", reader.key(alg, k1)) == 111.0);
+        assert(*reader.lookup<double>("writers", reader.key(alg, k2)) == 222.0);
+    }
+
+    std::filesystem::remove_all(directory);
+    std::cout << "ResultCache test passed!" << std::endl;
+}
+
+int main() {
+    test_structural_hash();
+    test_result_cache();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/CompactGraph.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/StringAlgebra.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+// Every operand before its users, except definitions inside recursive ranges
+static void checkOrder(const CompactGraph& graph) {
+    for (size_t p = 0; p < graph.size(); ++p) {
+        const CompactNode& n = graph.node(p);
+        if (n.getType() == Tree::NodeType::Unary) assert(n.a < p);
+        if (n.getType() == Tree::NodeType::Binary) assert(n.a < p && n.b < p);
+    }
+}
+
+void test_layout() {
+    std::cout << "Testing the compact layout..." << std::endl;
+
+    TreeAlgebra alg;
+    // (x + y) * |x - 3|, the leaves shared
+    auto x = alg.num(2.0);
+    auto y = alg.integer(5);
+    auto expr = alg.mul(alg.add(x, y), alg.abs(alg.sub(x, alg.num(3.0))));
+    CompactGraph graph = compact({expr});
+
+    assert(graph.size() == 7);
+    assert(!graph.hasRecursion());
+    checkOrder(graph);
+    // Post-order, left operand first: x y (x+y) 3 (x-3) |x-3| product
+    assert(graph.position(x) == 0 && graph.position(y) == 1);
+    assert(graph.roots().size() == 1 && graph.roots()[0] == 6);
+    assert(graph.real(graph.node(0)) == 2.0);
+    assert(graph.integer(graph.node(1)) == 5);
+    assert(graph.position(alg.num(42.0)) == CompactNode::NONE);
+    std::cout << graph.size() << " nodes in " << graph.bytes() << " bytes" << std::endl;
+
+    std::vector<double> values = graph.evaluate(DoubleAlgebra());
+    assert(values[6] == alg.eval(expr, DoubleAlgebra()));
+    assert(values[6] == 7.0);
+
+    // Initial algebras evaluate graphs without recursion
+    auto text = graph.evaluate(StringAlgebra());
+    assert(text[6] == alg.eval(expr, StringAlgebra()));
+
+    std::cout << "Compact layout test passed!" << std::endl;
+}
+
+void test_workload() {
+    std::cout << "Testing compact evaluation of a workload..." << std::endl;
+
+    TreeAlgebra alg;
+    WorkloadParams params;
+    params.nodeCount = 5000;
+    params.rootCount = 8;
+    params.sccCount = 0;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+
+    CompactGraph graph = compact(w.roots);
+    checkOrder(graph);
+    assert(!graph.hasRecursion());
+    std::cout << graph.size() << " nodes, " << graph.bytes() << " bytes" << std::endl;
+
+    // Same operations in the same order: identical values
+    DoubleAlgebra doubles;
+    IntervalAlgebra intervals;
+    std::vector<double> values = graph.evaluate(doubles);
+    std::vector<Interval> ranges = graph.evaluate(intervals);
+    for (size_t i = 0; i < w.roots.size(); ++i) {
+        uint32_t p = graph.roots()[i];
+        assert(p == graph.position(w.roots[i]));
+        assert(values[p] == alg.eval(w.roots[i], doubles));
+        assert(ranges[p] == alg.eval(w.roots[i], intervals));
+    }
+
+    std::cout << "Compact workload test passed!" << std::endl;
+}
+
+void test_recursion() {
+    std::cout << "Testing recursive components..." << std::endl;
+
+    TreeAlgebra alg;
+    // x = 0.5·x + 1 (fixpoint 2), y = 0.25·y + x (fixpoint 8/3), z = y + 1
+    auto x = alg.var();
+    auto y = alg.var();
+    alg.define(x, alg.add(alg.mul(alg.num(0.5), x), alg.num(1.0)));
+    alg.define(y, alg.add(alg.mul(alg.num(0.25), y), x));
+    auto z = alg.add(y, alg.num(1.0));
+
+    CompactGraph graph = compact({z});
+    assert(graph.hasRecursion());
+    assert(graph.stats().recursiveComponents == 2);
+    checkOrder(graph);
+    // The component of x comes before the component of y, z last
+    assert(graph.position(x) < graph.position(y));
+    assert(graph.roots()[0] == graph.size() - 1);
+
+    DoubleAlgebra doubles;
+    std::vector<double> values;
+    const size_t rounds = graph.evaluate(doubles, values);
+    std::cout << "x = " << values[graph.position(x)] << ", y = " << values[graph.position(y)]
+              << " in " << rounds << " rounds" << std::endl;
+    assert(rounds > 2);
+    assert(std::abs(values[graph.position(x)] - 2.0) < 1e-6);
+    assert(std::abs(values[graph.position(y)] - 8.0 / 3.0) < 1e-6);
+    assert(std::abs(values[graph.position(z)] - alg.eval(z, doubles)) < 1e-6);
+
+    // A snapshot: redefining x changes the trees, not the graph
+    alg.define(x, alg.num(1.0));
+    assert(graph.evaluate(doubles)[graph.position(x)] == values[graph.position(x)]);
+
+    // Recursion needs a bottom
+    bool thrown = false;
+    try {
+        graph.evaluate(StringAlgebra());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Inputs have no value
+    auto input = alg.var();
+    CompactGraph open = compact({alg.add(input, alg.num(1.0))});
+    thrown = false;
+    try {
+        open.evaluate(doubles);
+    } catch (const std::runtime_error& e) {
+        std::cout << "expected error: " << e.what() << std::endl;
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Workload with recursive components
+    WorkloadParams params;
+    params.nodeCount = 2000;
+    params.rootCount = 8;
+    params.sccCount = 4;
+    params.sccSize = 5;
+    params.binaryMix = {4, 2, 3, 0, 0};
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    TreeAlgebra walg;
+    Workload w = WorkloadGenerator(params).generate(walg);
+    CompactGraph wgraph = compact(w.roots);
+    checkOrder(wgraph);
+    std::vector<double> wvalues;
+    const size_t wrounds = wgraph.evaluate(doubles, wvalues);
+    std::cout << wgraph.stats().recursiveComponents << " recursive components, "
+              << wgraph.stats().recursiveNodes << " nodes, " << wrounds << " rounds" << std::endl;
+    for (size_t i = 0; i < w.roots.size(); ++i) {
+        double expected = walg.eval(w.roots[i], doubles);
+        double value = wvalues[wgraph.roots()[i]];
+        assert(std::isfinite(expected));
+        assert(std::abs(value - expected) <= 1e-6 * std::max(1.0, std::abs(expected)));
+    }
+
+    std::cout << "Recursive components test passed!" << std::endl;
+}
+
+int main() {
+    test_layout();
+    test_workload();
+    test_recursion();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/CostAlgebra.hh"
+#include "algebra/CostModel.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+void test_tree_costs() {
+    std::cout << "Testing CostAlgebra on trees..." << std::endl;
+
+    TreeAlgebra alg;
+    // (x + y) · (x + y) / |x|, the sum shared by both factors
+    auto x = alg.num(2.0);
+    auto y = alg.num(3.0);
+    auto sum = alg.add(x, y);
+    auto expr = alg.div(alg.mul(sum, sum), alg.abs(x));
+
+    CostAlgebra unit(LatencyTable::unit());
+    Cost cost = alg.eval(expr, unit);
+    std::cout << "unit: work " << cost.work << ", span " << cost.span << std::endl;
+    assert(cost.work == 5.0);   // The sum is paid twice
+    assert(cost.span == 3.0);
+
+    CostAlgebra doubles(LatencyTable::doublePrecision());
+    cost = alg.eval(expr, doubles);
+    std::cout << "double: work " << cost.work << ", span " << cost.span << std::endl;
+    assert(cost.work == 4 + 4 + 4 + 1 + 14);
+    assert(cost.span == 4 + 4 + 14);
+    assert(std::abs(cost.parallelism() - 27.0 / 22.0) < 1e-12);
+
+    // A recursive variable costs two unfoldings of its definition
+    auto v = alg.var();
+    alg.define(v, alg.add(alg.mul(alg.num(0.5), v), alg.num(1.0)));
+    Cost loop = alg.eval(v, unit);
+    std::cout << "recursive: work " << loop.work << ", span " << loop.span << std::endl;
+    assert(loop.work == 4.0);
+
+    std::cout << "Tree costs test passed!" << std::endl;
+}
+
+void test_dag_costs() {
+    std::cout << "Testing CostModel on shared graphs..." << std::endl;
+
+    TreeAlgebra alg;
+    auto x = alg.num(2.0);
+    auto y = alg.num(3.0);
+    auto sum = alg.add(x, y);
+    auto expr = alg.div(alg.mul(sum, sum), alg.abs(x));
+
+    CostModel model(LatencyTable::doublePrecision());
+    const CostEstimate& estimate = model.estimate(expr);
+    std::cout << estimate.nodes << " nodes, work " << estimate.work << ", span " << estimate.span << std::endl;
+    assert(estimate.nodes == 6);
+    assert(estimate.operations == 4);
+    assert(estimate.work == 4 + 4 + 1 + 14);   // The sum is paid once
+    assert(estimate.span == 4 + 4 + 14);
+    assert(model.span(sum) == 4.0);
+    assert(model.latency(expr) == 14.0);
+    assert(model.cost(alg.mul(sum, sum)) == (Cost{8.0, 8.0}));
+
+    // An interpreter's overhead is paid by every constant and operation
+    CostModel interpreted(LatencyTable::unit().withDispatch(1.0));
+    assert(interpreted.estimate(expr).work == 2 * 1.0 + 4 * 2.0);
+    assert(interpreted.lastEstimate().span == 1.0 + 3 * 2.0);
+
+    // A balanced sum of 64 leaves: 63 additions on 6 levels
+    std::vector<std::shared_ptr<Tree>> level;
+    for (int i = 0; i < 64; ++i) level.push_back(alg.num(static_cast<double>(i)));
+    while (level.size() > 1) {
+        std::vector<std::shared_ptr<Tree>> next;
+        for (size_t i = 0; i < level.size(); i += 2) next.push_back(alg.add(level[i], level[i + 1]));
+        level = next;
+    }
+    CostModel unit(LatencyTable::unit());
+    unit.estimate(level[0]);
+    assert(unit.lastEstimate().work == 63.0);
+    assert(unit.lastEstimate().span == 6.0);
+    assert(unit.lastEstimate().parallelism() == 10.5);
+
+    std::cout << "DAG costs test passed!" << std::endl;
+}
+
+void test_recursive_costs() {
+    std::cout << "Testing CostModel on recursive components..." << std::endl;
+
+    TreeAlgebra alg;
+    // a = 0.5·b + 1, b = |a| - 2, out = a / 3 + 4·4
+    auto a = alg.var();
+    auto b = alg.var();
+    alg.define(a, alg.add(alg.mul(alg.num(0.5), b), alg.num(1.0)));
+    alg.define(b, alg.sub(alg.abs(a), alg.num(2.0)));
+    auto out = alg.add(alg.div(a, alg.num(3.0)), alg.mul(alg.num(4.0), alg.num(4.0)));
+
+    CostModel model(LatencyTable::unit());
+    const CostEstimate& estimate = model.estimate(out);
+    std::cout << estimate.recursiveComponents << " recursive component(s), "
+              << estimate.recursiveNodes << " nodes, work per round " << estimate.recursiveWork
+              << ", work " << estimate.work << ", span " << estimate.span << std::endl;
+    assert(estimate.recursiveComponents == 1);
+    assert(estimate.recursiveNodes == 6);      // a, b and their four operations
+    assert(estimate.recursiveWork == 4.0);
+    assert(estimate.work == 7.0);
+    assert(estimate.workFor(10) == 7.0 + 9 * 4.0);
+    assert(estimate.span == 4.0 + 1.0 + 1.0);  // A round, the division, the sum
+    assert(model.span(a) == model.span(b));
+    assert(model.cost(a).work == 4.0);
+
+    // Generated systems: work counts each node once
+    WorkloadParams params;
+    params.nodeCount = 2000;
+    params.sccCount = 5;
+    params.sccSize = 8;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    model.estimate(w.roots);
+    WorkloadStats stats = WorkloadGenerator::measure(w.roots);
+    assert(model.lastEstimate().nodes == stats.nodes);
+    assert(model.lastEstimate().work == static_cast<double>(model.lastEstimate().operations));
+    assert(model.lastEstimate().recursiveComponents == 5);
+
+    std::cout << "Recursive costs test passed!" << std::endl;
+}
+
+int main() {
+    test_tree_costs();
+    test_dag_costs();
+    test_recursive_costs();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
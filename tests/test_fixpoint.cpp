@@ -1,8 +1,12 @@
 #include "algebra/TreeAlgebra.hh"
 #include "algebra/DoubleAlgebra.hh"
 #include "algebra/StringAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/Workload.hh"
 #include <iostream>
 #include <cassert>
+#include <cmath>
+#include <map>
 
 void test_simple_eval() {
     std::cout << "Testing simple eval method..." << std::endl;
@@ -404,6 +408,391 @@ void test_string_algebra_complex() {
     }
 }
 
+void test_numeric_recursion() {
+    std::cout << "Testing numeric fixpoints of recursive variables..." << std::endl;
+    
+    TreeAlgebra treeAlg;
+    DoubleAlgebra doubleAlg;
+    IntervalAlgebra intervalAlg;
+    
+    // z = 0.5 * z + 1  =>  z = 2
+    auto z = treeAlg.var();
+    treeAlg.define(z, treeAlg.add(treeAlg.mul(treeAlg.num(0.5), z), treeAlg.num(1.0)));
+    double zValue = treeAlg.eval(z, doubleAlg);
+    std::cout << "z = " << zValue << " (expected 2) in " << treeAlg.fixpointStats().rounds << " round(s)" << std::endl;
+    assert(std::abs(zValue - 2.0) < 1e-8);
+    
+    Interval zRange = treeAlg.eval(z, intervalAlg);
+    std::cout << "z in " << zRange << " (expected [2, 2]) in " << treeAlg.fixpointStats().rounds << " rounds" << std::endl;
+    assert(std::abs(zRange.inf - 2.0) < 1e-6 && std::abs(zRange.sup - 2.0) < 1e-6);
+    
+    // x = 0.5 * y + 1, y = 0.5 * x + 2  =>  x = 8/3, y = 10/3
+    auto x = treeAlg.var();
+    auto y = treeAlg.var();
+    treeAlg.define(x, treeAlg.add(treeAlg.mul(treeAlg.num(0.5), y), treeAlg.num(1.0)));
+    treeAlg.define(y, treeAlg.add(treeAlg.mul(treeAlg.num(0.5), x), treeAlg.num(2.0)));
+    
+    // Every entry point gives the same solution
+    assert(std::abs(treeAlg.eval(x, doubleAlg) - 8.0 / 3.0) < 1e-8);
+    assert(std::abs(treeAlg.eval(y, doubleAlg) - 10.0 / 3.0) < 1e-8);
+    assert(std::abs(treeAlg.eval(treeAlg.add(x, y), doubleAlg) - 6.0) < 1e-8);
+    assert(std::abs(treeAlg.eval(treeAlg.sub(y, x), doubleAlg) - 2.0 / 3.0) < 1e-8);
+    
+    std::cout << "Numeric recursion test passed!" << std::endl;
+}
+
+// Direct evaluation of a definition with given values for the variables
+static double evalWith(Tree* t, const std::map<Tree*, double>& values) {
+    switch (t->getType()) {
+        case Tree::NodeType::Num: return t->getValue();
+        case Tree::NodeType::Var: return values.at(t);
+        case Tree::NodeType::Unary: return DoubleAlgebra().unary(
+            static_cast<Algebra<double>::UnaryOp>(t->getUnaryOp()), evalWith(t->getOperand().get(), values));
+        case Tree::NodeType::Binary: return DoubleAlgebra().binary(
+            static_cast<Algebra<double>::BinaryOp>(t->getBinaryOp()),
+            evalWith(t->getLeft().get(), values), evalWith(t->getRight().get(), values));
+        case Tree::NodeType::Select: return evalWith(t->getCondition().get(), values) > 0.0
+            ? evalWith(t->getThen().get(), values) : evalWith(t->getElse().get(), values);
+    }
+    return 0.0;
+}
+
+void test_generated_systems() {
+    std::cout << "Testing fixpoints of generated recursive systems..." << std::endl;
+    
+    using Topology = WorkloadParams::Topology;
+    for (Topology topology : {Topology::Ring, Topology::Chain, Topology::Clique, Topology::Nested}) {
+        for (bool nonlinear : {false, true}) {
+            WorkloadParams params;
+            params.nodeCount = 0;
+            params.sccCount = 1;
+            params.sccSize = 40;
+            params.topology = topology;
+            params.nonlinear = nonlinear;
+            
+            TreeAlgebra treeAlg;
+            DoubleAlgebra doubleAlg;
+            Workload w = WorkloadGenerator(params).generate(treeAlg);
+            
+            // The values obtained from every entry point satisfy every equation
+            std::map<Tree*, double> values;
+            for (const auto& v : w.sccs[0]) {
+                values[v.get()] = treeAlg.eval(v, doubleAlg);
+            }
+            for (const auto& v : w.sccs[0]) {
+                double residual = values[v.get()] - evalWith(v->getDefinition().get(), values);
+                assert(std::abs(residual) < 1e-8);
+            }
+        }
+    }
+    
+    std::cout << "Generated recursive systems test passed!" << std::endl;
+}
+
+void test_dependent_spine() {
+    std::cout << "Testing that iterations re-evaluate only the dependent spine..." << std::endl;
+    
+    TreeAlgebra treeAlg;
+    DoubleAlgebra doubleAlg;
+    
+    // x = 0.5 * x + k, where k does not depend on x
+    auto k = treeAlg.num(0.0);
+    for (int i = 1; i <= 100; ++i) {
+        k = treeAlg.add(k, treeAlg.mul(treeAlg.num(i), treeAlg.num(0.01)));
+    }
+    auto x = treeAlg.var();
+    treeAlg.define(x, treeAlg.add(treeAlg.mul(treeAlg.num(0.5), x), k));
+    
+    double value = treeAlg.eval(x, doubleAlg);
+    const FixpointStats& stats = treeAlg.fixpointStats();
+    std::cout << "x = " << value << ", " << stats.rounds << " rounds, "
+              << stats.evaluationsPerRound() << " node evaluations per round" << std::endl;
+    assert(std::abs(value - 101.0) < 1e-6);
+    assert(stats.sccs == 1);
+    assert(stats.dependentNodes == 2);      // The mul and the add over x
+    assert(stats.independentNodes == 2);    // 0.5 and k
+    assert(stats.evaluationsPerRound() == 2.0);
+    assert(stats.nodeEvaluations == 2 * stats.rounds);
+    
+    // Statistics are reset by every evaluation
+    treeAlg.eval(k, doubleAlg);
+    assert(treeAlg.fixpointStats().rounds == 0);
+    
+    std::cout << "Dependent spine test passed!" << std::endl;
+}
+
+void test_affine_fast_path() {
+    std::cout << "Testing the linear-system fast path for affine SCCs..." << std::endl;
+    
+    TreeAlgebra treeAlg;
+    DoubleAlgebra doubleAlg;
+    IntervalAlgebra intervalAlg;
+    
+    // x = 0.5*x + 0.3*y + 1, y = 0.2*x + 2  =>  x = 1.6 / 0.44, y = 0.2*x + 2
+    auto x = treeAlg.var();
+    auto y = treeAlg.var();
+    treeAlg.define(x, treeAlg.add(treeAlg.add(treeAlg.mul(treeAlg.num(0.5), x), 
+                                              treeAlg.mul(treeAlg.num(0.3), y)), treeAlg.num(1.0)));
+    treeAlg.define(y, treeAlg.add(treeAlg.mul(treeAlg.num(0.2), x), treeAlg.num(2.0)));
+    
+    double xValue = treeAlg.eval(x, doubleAlg);
+    std::cout << "x = " << xValue << " in " << treeAlg.fixpointStats().rounds << " round(s)" << std::endl;
+    assert(std::abs(xValue - 1.6 / 0.44) < 1e-12);
+    assert(treeAlg.fixpointStats().affineSCCs == 1);
+    assert(treeAlg.fixpointStats().rounds == 1);
+    
+    // Disabled: same fixpoint by iteration
+    FixpointOptions options;
+    options.solveAffine = false;
+    treeAlg.setFixpointOptions(options);
+    double iterated = treeAlg.eval(x, doubleAlg);
+    std::cout << "x = " << iterated << " in " << treeAlg.fixpointStats().rounds << " rounds without it" << std::endl;
+    assert(std::abs(iterated - xValue) < 1e-8);
+    assert(treeAlg.fixpointStats().affineSCCs == 0);
+    assert(treeAlg.fixpointStats().rounds > 1);
+    treeAlg.setFixpointOptions(FixpointOptions());
+    
+    // Algebras without linear semantics always iterate
+    treeAlg.eval(x, intervalAlg);
+    assert(treeAlg.fixpointStats().affineSCCs == 0);
+    
+    // Nonlinear definitions iterate
+    auto z = treeAlg.var();
+    treeAlg.define(z, treeAlg.add(treeAlg.mul(treeAlg.num(0.5), treeAlg.abs(z)), treeAlg.num(1.0)));
+    assert(std::abs(treeAlg.eval(z, doubleAlg) - 2.0) < 1e-8);
+    assert(treeAlg.fixpointStats().affineSCCs == 0);
+    
+    // Expansive systems are not solved: iteration from bottom does not reach x = 1
+    auto w = treeAlg.var();
+    treeAlg.define(w, treeAlg.sub(treeAlg.mul(treeAlg.num(2.0), w), treeAlg.num(1.0)));
+    bool diverged = false;
+    try {
+        treeAlg.eval(w, doubleAlg);
+    } catch (const std::runtime_error&) {
+        diverged = true;
+    }
+    assert(diverged);
+    
+    // Systems above the dense limit use sparse elimination
+    FixpointOptions sparseOptions;
+    sparseOptions.denseLimit = 16;
+    using Topology = WorkloadParams::Topology;
+    for (Topology topology : {Topology::Ring, Topology::Chain, Topology::Nested}) {
+        WorkloadParams params;
+        params.nodeCount = 0;
+        params.sccCount = 1;
+        params.sccSize = 100;
+        params.topology = topology;
+        params.contraction = 0.95;
+        
+        TreeAlgebra generatedAlg;
+        generatedAlg.setFixpointOptions(sparseOptions);
+        Workload workload = WorkloadGenerator(params).generate(generatedAlg);
+        std::map<Tree*, double> values;
+        for (const auto& v : workload.sccs[0]) {
+            values[v.get()] = generatedAlg.eval(v, doubleAlg);
+            assert(generatedAlg.fixpointStats().affineSCCs == 1);
+            assert(generatedAlg.fixpointStats().rounds == 1);
+        }
+        for (const auto& v : workload.sccs[0]) {
+            assert(std::abs(values[v.get()] - evalWith(v->getDefinition().get(), values)) < 1e-8);
+        }
+    }
+    
+    std::cout << "Affine fast path test passed!" << std::endl;
+}
+
+// Extrapolates far away from the fixpoint, to exercise the safeguard
+class DivergingAccelerator : public Accelerator<double> {
+public:
+    bool extrapolate(const std::vector<double>& x, const std::vector<double>& fx, std::vector<double>& next) override {
+        next = fx;
+        for (double& value : next) {
+            value = value * 1000.0 + 1000.0;
+        }
+        return true;
+    }
+    void reset() override {}
+};
+
+void test_acceleration() {
+    std::cout << "Testing convergence acceleration..." << std::endl;
+    
+    TreeAlgebra treeAlg;
+    DoubleAlgebra doubleAlg;
+    
+    // x = 0.99 * |x - 200| + 1  =>  x = 100, plain iteration oscillates slowly
+    auto x = treeAlg.var();
+    treeAlg.define(x, treeAlg.add(treeAlg.mul(treeAlg.num(0.99), 
+                                              treeAlg.abs(treeAlg.sub(x, treeAlg.num(200.0)))), treeAlg.num(1.0)));
+    
+    FixpointOptions options;
+    size_t plainRounds = 0;
+    for (Acceleration acceleration : {Acceleration::None, Acceleration::Aitken, Acceleration::Anderson}) {
+        options.acceleration = acceleration;
+        treeAlg.setFixpointOptions(options);
+        double value = treeAlg.eval(x, doubleAlg);
+        size_t rounds = treeAlg.fixpointStats().rounds;
+        std::cout << "x = " << value << " in " << rounds << " rounds ("
+                  << treeAlg.fixpointStats().acceleratedRounds << " accelerated)" << std::endl;
+        assert(std::abs(value - 100.0) < 1e-6);
+        if (acceleration == Acceleration::None) {
+            plainRounds = rounds;
+        } else {
+            assert(rounds * 10 < plainRounds);
+        }
+    }
+    
+    // Generated nonlinear systems: same fixpoints, fewer rounds with Anderson
+    using Topology = WorkloadParams::Topology;
+    for (Topology topology : {Topology::Ring, Topology::Chain, Topology::Nested}) {
+        WorkloadParams params;
+        params.nodeCount = 0;
+        params.sccCount = 1;
+        params.sccSize = 10;
+        params.topology = topology;
+        params.contraction = 0.99;
+        params.nonlinear = true;
+        
+        TreeAlgebra generatedAlg;
+        Workload workload = WorkloadGenerator(params).generate(generatedAlg);
+        double plain = generatedAlg.eval(workload.sccs[0][0], doubleAlg);
+        size_t plainRounds = generatedAlg.fixpointStats().rounds;
+        
+        FixpointOptions anderson;
+        anderson.acceleration = Acceleration::Anderson;
+        anderson.andersonDepth = 8;
+        generatedAlg.setFixpointOptions(anderson);
+        double accelerated = generatedAlg.eval(workload.sccs[0][0], doubleAlg);
+        size_t acceleratedRounds = generatedAlg.fixpointStats().rounds;
+        std::cout << "generated system: " << plainRounds << " rounds, " 
+                  << acceleratedRounds << " with Anderson(8)" << std::endl;
+        assert(std::abs(plain - accelerated) < 1e-6);
+        assert(acceleratedRounds < plainRounds);
+    }
+    
+    // The safeguard rejects extrapolations that do not reduce the residual,
+    // then switches the strategy off
+    SafeguardedAcceleration<double> safeguarded(std::make_unique<DivergingAccelerator>());
+    std::vector<double> point = {0.0};
+    std::vector<double> next;
+    for (int round = 0; round < 20; ++round) {
+        std::vector<double> image = {0.5 * point[0] + 1.0};
+        safeguarded.next(point, image, next);
+        point = next;
+    }
+    assert(!safeguarded.enabled());
+    assert(safeguarded.resets == 3);
+    assert(std::abs(point[0] - 2.0) < 1e-3);
+    
+    // Aitken extrapolations of generated nonlinear rings and chains are all
+    // rejected: each costs one round, then the solver resumes from the plain
+    // iterates instead of from the image of the rejected point
+    for (Topology topology : {Topology::Ring, Topology::Chain}) {
+        WorkloadParams params;
+        params.nodeCount = 0;
+        params.sccCount = 1;
+        params.sccSize = 10;
+        params.topology = topology;
+        params.contraction = 0.5;
+        params.nonlinear = true;
+        
+        TreeAlgebra generatedAlg;
+        Workload workload = WorkloadGenerator(params).generate(generatedAlg);
+        double plain = generatedAlg.eval(workload.sccs[0][0], doubleAlg);
+        size_t plainRounds = generatedAlg.fixpointStats().rounds;
+        
+        FixpointOptions aitken;
+        aitken.acceleration = Acceleration::Aitken;
+        generatedAlg.setFixpointOptions(aitken);
+        double accelerated = generatedAlg.eval(workload.sccs[0][0], doubleAlg);
+        const FixpointStats& stats = generatedAlg.fixpointStats();
+        assert(stats.accelerationResets == 3);
+        assert(stats.acceleratedRounds == stats.accelerationResets);
+        assert(stats.rounds == plainRounds + stats.accelerationResets);
+        assert(std::abs(plain - accelerated) < 1e-9);
+    }
+    
+    std::cout << "Acceleration test passed!" << std::endl;
+}
+
+void test_initial_algebra_equations() {
+    std::cout << "Testing equations built for initial algebras..." << std::endl;
+    
+    TreeAlgebra treeAlg;
+    TreeAlgebra otherTreeAlg;
+    StringAlgebra stringAlg;
+    
+    // x = x + 1 is rendered as a single equation over a fresh variable
+    auto x = treeAlg.var();
+    treeAlg.define(x, treeAlg.add(x, treeAlg.num(1.0)));
+    auto str = treeAlg.eval(x, stringAlg);
+    std::cout << "x = " << str.first << std::endl;
+    assert(str.first == "x1 + 1");
+    
+    // Evaluating into another TreeAlgebra rebuilds an alpha-equivalent system
+    auto a = treeAlg.var();
+    auto b = treeAlg.var();
+    treeAlg.define(a, treeAlg.add(b, treeAlg.num(1.0)));
+    treeAlg.define(b, treeAlg.mul(a, treeAlg.num(2.0)));
+    auto t = treeAlg.sub(a, b);
+    auto copy = treeAlg.eval(t, otherTreeAlg);
+    assert(copy.get() != t.get());
+    assert(treeAlg.alphaEquivalent(t, copy));
+    
+    std::cout << "Initial algebra equations test passed!" << std::endl;
+}
+
+void test_batch_eval() {
+    std::cout << "Testing batch evaluation of many roots..." << std::endl;
+    
+    WorkloadParams params;
+    params.nodeCount = 5000;
+    params.rootCount = 64;
+    params.sccCount = 8;
+    params.sccSize = 4;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    TreeAlgebra treeAlg;
+    Workload w = WorkloadGenerator(params).generate(treeAlg);
+    
+    // Same values as one eval() per root (an SCC shared by several roots
+    // may be solved from another entry point: equal up to convergence)
+    DoubleAlgebra doubleAlg;
+    IntervalAlgebra intervalAlg;
+    size_t separateSCCs = 0;
+    std::vector<double> separate;
+    for (const auto& root : w.roots) {
+        separate.push_back(treeAlg.eval(root, doubleAlg));
+        separateSCCs += treeAlg.fixpointStats().sccs;
+    }
+    std::vector<double> batch = treeAlg.eval(w.roots, doubleAlg);
+    assert(batch.size() == w.roots.size());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        assert(std::abs(batch[i] - separate[i]) <= 1e-9 * std::max(1.0, std::abs(separate[i])));
+    }
+    std::cout << treeAlg.fixpointStats().sccs << " SCCs solved in one pass, " << separateSCCs
+              << " in " << w.roots.size() << " evaluations" << std::endl;
+    assert(treeAlg.fixpointStats().sccs == params.sccCount && separateSCCs > params.sccCount);
+    
+    std::vector<Interval> ranges = treeAlg.eval(w.roots, intervalAlg);
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        assert(ranges[i].inf <= batch[i] + 1e-9 && batch[i] - 1e-9 <= ranges[i].sup);
+    }
+    
+    // Initial algebras: the roots themselves, or one rendering per root
+    assert(treeAlg.eval(w.roots, treeAlg) == w.roots);
+    auto a = treeAlg.add(treeAlg.num(1.0), treeAlg.num(2.0));
+    auto strings = treeAlg.eval({a, treeAlg.abs(a)}, StringAlgebra());
+    assert(strings.size() == 2 && strings[0].first == treeAlg.eval(a, StringAlgebra()).first);
+    assert(treeAlg.eval(std::vector<std::shared_ptr<Tree>>(), doubleAlg).empty());
+    
+    std::cout << "Batch evaluation test passed!" << std::endl;
+}
+
 int main() {
     test_simple_eval();
     test_simple_variable_eval();
@@ -415,6 +804,13 @@ int main() {
     test_alpha_equivalence();
     test_grand_alpha_equivalence();
     test_string_algebra_complex();
+    test_numeric_recursion();
+    test_generated_systems();
+    test_dependent_spine();
+    test_affine_fast_path();
+    test_acceleration();
+    test_initial_algebra_equations();
+    test_batch_eval();
     
     std::cout << "\nAll tests passed!" << std::endl;
     return 0;
@@ -0,0 +1,146 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/StringAlgebra.hh"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+void test_shared_dag() {
+    std::cout << "Testing the import of a shared DAG..." << std::endl;
+
+    // x_{i+1} = x_i + x_i: 2^200 paths, 202 nodes
+    TreeAlgebra src;
+    auto x = src.num(1.0);
+    for (int i = 0; i < 200; ++i) {
+        x = src.add(x, x);
+    }
+    auto small = src.mul(src.integer(3), src.abs(src.num(-2.0)));
+
+    TreeAlgebra dst;
+    auto before = dst.num(1.0);   // Already in dst: shared, not duplicated
+    auto imported = dst.import(src, {x, small});
+    assert(imported.size() == 2);
+    std::cout << "Source " << src.nodeCount() << " nodes, target " << dst.nodeCount() << " nodes" << std::endl;
+    assert(dst.nodeCount() == src.nodeCount());
+    assert(std::abs(dst.eval(imported[0], DoubleAlgebra()) - std::ldexp(1.0, 200)) < 1e45);
+    assert(dst.eval(imported[1], DoubleAlgebra()) == 6.0);
+    assert(imported[1] == dst.mul(dst.integer(3), dst.abs(dst.num(-2.0))));
+    assert(imported[1]->getLeft()->getConstantOp() == ConstantOp::Integer);
+    assert(dst.num(1.0) == before);
+
+    // Importing again creates nothing, importing from itself is the identity
+    const size_t count = dst.nodeCount();
+    assert(dst.import(src, {small, x}) == std::vector<std::shared_ptr<Tree>>({imported[1], imported[0]}));
+    assert(dst.nodeCount() == count);
+    assert(dst.import(dst, imported) == imported);
+
+    // Nodes of another algebra are refused
+    TreeAlgebra other;
+    bool threw = false;
+    try {
+        dst.import(src, {other.add(other.num(7.0), other.num(8.0))});
+    } catch (const std::runtime_error& e) {
+        std::cout << "Expected error: " << e.what() << std::endl;
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Shared DAG test passed!" << std::endl;
+}
+
+void test_recursive_definitions() {
+    std::cout << "Testing the import of recursive definitions..." << std::endl;
+
+    // x = 0.5·y + 1, y = 0.5·x + 1, z = x + y (not recursive)
+    TreeAlgebra src;
+    auto x = src.var();
+    auto y = src.var();
+    auto z = src.var();
+    src.define(x, src.add(src.mul(src.num(0.5), y), src.num(1.0)));
+    src.define(y, src.add(src.mul(src.num(0.5), x), src.num(1.0)));
+    src.define(z, src.add(x, y));
+    auto undefined = src.var();
+
+    // The target already has variables 1 and 2, with other meanings
+    TreeAlgebra dst;
+    auto a = dst.var();
+    dst.define(a, dst.num(10.0));
+    auto b = dst.var(3);   // An explicit index that var() will meet
+    dst.define(b, dst.num(20.0));
+
+    auto imported = dst.import(src, {z, undefined});
+    auto iz = imported[0];
+    assert(iz->getType() == Tree::NodeType::Var);
+    assert(iz != a && iz != b && iz->getVarIndex() != 1 && iz->getVarIndex() != 3);
+    assert(std::abs(dst.eval(iz, DoubleAlgebra()) - 4.0) < 1e-9);
+    assert(dst.eval(a, DoubleAlgebra()) == 10.0 && dst.eval(b, DoubleAlgebra()) == 20.0);
+    assert(!imported[1]->getDefinition());
+    std::cout << "z = " << dst.eval(iz, StringAlgebra()).first << std::endl;
+
+    // x and y were imported through z: importing x again finds them
+    const size_t count = dst.nodeCount();
+    auto ix = dst.import(src, {x})[0];
+    assert(dst.nodeCount() == count);
+    assert(iz->getDefinition()->getLeft() == ix);
+    assert(std::abs(dst.eval(ix, DoubleAlgebra()) - 2.0) < 1e-9);
+
+    // After clearImports(), the same source variables are new variables
+    dst.clearImports();
+    auto again = dst.import(src, {z})[0];
+    assert(again != iz && std::abs(dst.eval(again, DoubleAlgebra()) - 4.0) < 1e-9);
+
+    std::cout << "Recursive definition test passed!" << std::endl;
+}
+
+void test_workers() {
+    std::cout << "Testing the merge of worker algebras..." << std::endl;
+
+    // Each worker builds s_w = 0.5·s_w + c_w and the shared expression
+    // (c·c + 1) for c in 1..50 in its own algebra
+    const size_t workers = 4;
+    std::vector<TreeAlgebra> algebras(workers);
+    std::vector<std::vector<std::shared_ptr<Tree>>> roots(workers);
+    std::vector<std::thread> threads;
+    for (size_t w = 0; w < workers; ++w) {
+        threads.emplace_back([&, w]() {
+            TreeAlgebra& alg = algebras[w];
+            auto s = alg.var();
+            alg.define(s, alg.add(alg.mul(alg.num(0.5), s), alg.num(static_cast<double>(w + 1))));
+            roots[w].push_back(s);
+            for (int c = 1; c <= 50; ++c) {
+                roots[w].push_back(alg.add(alg.mul(alg.num(c), alg.num(c)), alg.num(1.0)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    TreeAlgebra shared;
+    std::vector<std::vector<std::shared_ptr<Tree>>> merged;
+    for (size_t w = 0; w < workers; ++w) {
+        merged.push_back(shared.import(algebras[w], roots[w]));
+    }
+    for (size_t w = 0; w < workers; ++w) {
+        assert(std::abs(shared.eval(merged[w][0], DoubleAlgebra()) - 2.0 * (w + 1)) < 1e-9);
+        for (size_t c = 1; c < merged[w].size(); ++c) {
+            assert(merged[w][c] == merged[0][c]);   // One node for all workers
+        }
+    }
+    std::cout << "Shared algebra: " << shared.nodeCount() << " nodes for " << workers << " workers of "
+              << algebras[0].nodeCount() << std::endl;
+
+    std::cout << "Worker merge test passed!" << std::endl;
+}
+
+int main() {
+    test_shared_dag();
+    test_recursive_definitions();
+    test_workers();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/StringAlgebra.hh"
+#include "algebra/IntegerAlgebra.hh"
+#include "algebra/RationalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <limits>
+
+void test_integer_fast_path() {
+    std::cout << "Testing Integer small values and promotion..." << std::endl;
+
+    const int64_t max = std::numeric_limits<int64_t>::max();
+    const int64_t min = std::numeric_limits<int64_t>::min();
+
+    Integer a(max);
+    assert(a.isSmall());
+
+    // Overflow promotes, coming back into range demotes
+    Integer b = a + Integer(1);
+    assert(!b.isSmall());
+    assert(b.toString() == "9223372036854775808");
+    Integer c = b - Integer(1);
+    assert(c.isSmall() && c == a);
+
+    Integer d = Integer(min) * Integer(-1);
+    assert(!d.isSmall());
+    assert(d.toString() == "9223372036854775808");
+    assert(Integer(min) / Integer(-1) == d);
+    assert(Integer(min) % Integer(-1) == Integer(0));
+    assert(-Integer(min) == d);
+    assert(Integer(min).abs() == d);
+
+    // Truncated division, as for int64_t
+    assert(Integer(-7) / Integer(2) == Integer(-3));
+    assert(Integer(-7) % Integer(2) == Integer(-1));
+    assert(Integer(7) % Integer(-2) == Integer(1));
+
+    bool threw = false;
+    try {
+        Integer(1) / Integer(0);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Integer fast path test passed!" << std::endl;
+}
+
+void test_big_integers() {
+    std::cout << "Testing big integer arithmetic..." << std::endl;
+
+    // 30! and 2^100
+    Integer factorial(1);
+    for (int i = 2; i <= 30; ++i) {
+        factorial = factorial * Integer(i);
+    }
+    std::cout << "30! = " << factorial << std::endl;
+    assert(factorial.toString() == "265252859812191058636308480000000");
+
+    Integer twoTo100 = Integer::powerOfTwo(100);
+    assert(twoTo100.toString() == "1267650600228229401496703205376");
+    assert(Integer::fromDouble(std::ldexp(1.0, 100)) == twoTo100);
+    assert(Integer::fromDouble(-std::ldexp(3.0, 70)) == -(Integer(3) * Integer::powerOfTwo(70)));
+
+    // Division back to the factors
+    Integer quotient = factorial;
+    for (int i = 30; i >= 2; --i) {
+        assert(quotient % Integer(i) == Integer(0));
+        quotient = quotient / Integer(i);
+    }
+    assert(quotient == Integer(1));
+
+    // a = (a / b)·b + a % b with |a % b| < |b| on random multi-limb values
+    WorkloadRandom random(7);
+    for (int round = 0; round < 200; ++round) {
+        Integer x(1);
+        Integer y(1);
+        for (uint64_t i = 0; i < 1 + random.below(4); ++i) {
+            x = x * Integer(static_cast<int64_t>(random.next() >> 2)) + Integer(static_cast<int64_t>(random.below(1000)));
+        }
+        for (uint64_t i = 0; i < 1 + random.below(3); ++i) {
+            y = y * Integer(static_cast<int64_t>(random.next() >> 3)) + Integer(1);
+        }
+        if (random.below(2)) x = -x;
+        if (random.below(2)) y = -y;
+
+        Integer q = x / y;
+        Integer r = x % y;
+        assert(q * y + r == x);
+        assert(r.abs() < y.abs());
+        assert(r.isZero() || r.isNegative() == x.isNegative());
+    }
+
+    // gcd
+    assert(Integer::gcd(Integer(12), Integer(-18)) == Integer(6));
+    assert(Integer::gcd(factorial, twoTo100) == Integer::powerOfTwo(26));
+
+    std::cout << "Big integer test passed!" << std::endl;
+}
+
+void test_rationals() {
+    std::cout << "Testing rationals..." << std::endl;
+
+    Rational third(Integer(1), Integer(3));
+    Rational sixth(Integer(-2), Integer(-12));
+    assert(sixth.numerator() == Integer(1) && sixth.denominator() == Integer(6));
+    assert(third + sixth == Rational(Integer(1), Integer(2)));
+    assert(third - sixth == sixth);
+    assert(third * Rational(3) == Rational(1));
+    assert(third / sixth == Rational(2));
+    assert(Rational(Integer(7), Integer(2)) % Rational(2) == Rational(Integer(3), Integer(2)));
+    assert(Rational(Integer(-7), Integer(2)) % Rational(2) == Rational(Integer(-3), Integer(2)));
+    assert(third < Rational(Integer(1), Integer(2)));
+
+    // Doubles are converted exactly
+    Rational tenth = Rational::fromDouble(0.1);
+    std::cout << "0.1 = " << tenth << std::endl;
+    assert(tenth.toString() == "3602879701896397/36028797018963968");
+    assert(Rational::fromDouble(0.75) == Rational(Integer(3), Integer(4)));
+    assert(Rational::fromDouble(-2.0) == Rational(-2));
+
+    std::cout << "Rational test passed!" << std::endl;
+}
+
+void test_integer_constants_in_trees() {
+    std::cout << "Testing integer constants in trees..." << std::endl;
+
+    TreeAlgebra treeAlg;
+    DoubleAlgebra doubleAlg;
+    StringAlgebra stringAlg;
+    IntegerAlgebra integerAlg;
+    RationalAlgebra rationalAlg;
+
+    // Hash-consing distinguishes integer and real constants
+    auto two = treeAlg.integer(2);
+    assert(two == treeAlg.integer(2));
+    assert(two != treeAlg.num(2.0));
+    assert(two->getConstantOp() == ConstantOp::Integer);
+    assert(treeAlg.num(2.0)->getConstantOp() == ConstantOp::Real);
+    assert(!treeAlg.alphaEquivalent(two, treeAlg.num(2.0)));
+
+    // 2^62 * 4 + 1 is exact in IntegerAlgebra, rounded in DoubleAlgebra
+    auto big = treeAlg.add(treeAlg.mul(treeAlg.integer(int64_t(1) << 62), treeAlg.integer(4)), treeAlg.integer(1));
+    Integer exact = treeAlg.eval(big, integerAlg);
+    std::cout << "2^62 * 4 + 1 = " << exact << std::endl;
+    assert(exact == Integer::powerOfTwo(64) + Integer(1));
+    assert((*big)(integerAlg) == exact);
+    assert(treeAlg.eval(big, doubleAlg) == std::ldexp(1.0, 64));
+    assert(treeAlg.eval(big, stringAlg).first == "4611686018427387904 * 4 + 1");
+
+    // Rationals: 1/3 + 1/6
+    auto sum = treeAlg.add(treeAlg.div(treeAlg.integer(1), treeAlg.integer(3)),
+                           treeAlg.div(treeAlg.integer(1), treeAlg.integer(6)));
+    assert(treeAlg.eval(sum, rationalAlg) == Rational(Integer(1), Integer(2)));
+
+    // Integer fixpoint: x = x / 2 + 10 is stationary at 19
+    auto x = treeAlg.var();
+    treeAlg.define(x, treeAlg.add(treeAlg.div(x, treeAlg.integer(2)), treeAlg.integer(10)));
+    Integer fixpoint = treeAlg.eval(x, integerAlg);
+    std::cout << "x = x / 2 + 10 => x = " << fixpoint << std::endl;
+    assert(fixpoint == Integer(19));
+
+    // Fractional real constants have no integer meaning
+    bool threw = false;
+    try {
+        treeAlg.eval(treeAlg.num(0.5), integerAlg);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Integer constants test passed!" << std::endl;
+}
+
+int main() {
+    test_integer_fast_path();
+    test_big_integers();
+    test_rationals();
+    test_integer_constants_in_trees();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
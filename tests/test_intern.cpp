@@ -0,0 +1,132 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/FlatHashSet.hh"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <set>
+
+struct IntHash {
+    size_t operator()(uint64_t x) const { return hashMix(x); }
+};
+
+struct IntEqual {
+    bool operator()(uint64_t a, uint64_t b) const { return a == b; }
+};
+
+// Worst case: every element in the same home group with the same tag
+struct ConstantHash {
+    size_t operator()(uint64_t) const { return 42; }
+};
+
+static double meanProbe(const std::vector<size_t>& histogram) {
+    double total = 0.0;
+    double count = 0.0;
+    for (size_t k = 0; k < histogram.size(); ++k) {
+        total += static_cast<double>(k * histogram[k]);
+        count += static_cast<double>(histogram[k]);
+    }
+    return count > 0.0 ? total / count : 0.0;
+}
+
+void test_flat_hash_set() {
+    std::cout << "Testing FlatHashSet..." << std::endl;
+
+    FlatHashSet<uint64_t, IntHash, IntEqual> set;
+    assert(set.empty() && set.find(7) == nullptr);
+    for (uint64_t i = 0; i < 100000; ++i) {
+        auto [element, inserted] = set.insert(i * 3);
+        assert(inserted && element == i * 3);
+    }
+    assert(set.size() == 100000);
+    assert(set.size() * 8 <= set.capacity() * 7);   // Load factor at most 7/8
+    for (uint64_t i = 0; i < 300000; ++i) {
+        const uint64_t* found = set.find(i);
+        assert((found != nullptr) == (i % 3 == 0));
+        assert(!found || *found == i);
+    }
+    auto [again, inserted] = set.insert(300);
+    assert(!inserted && again == 300);
+    assert(set.size() == 100000);
+
+    size_t sum = 0;
+    set.forEach([&](uint64_t x) { sum += x; });
+    assert(sum == 3 * (99999ULL * 100000ULL / 2));
+
+    // Every element is found by its probe sequence, most in their home group
+    auto histogram = set.probeLengths();
+    size_t counted = 0;
+    for (size_t n : histogram) counted += n;
+    assert(counted == set.size());
+    std::cout << "load " << static_cast<double>(set.size()) / static_cast<double>(set.capacity())
+              << ", mean probe length " << meanProbe(histogram) << ", max " << histogram.size() - 1 << std::endl;
+    assert(histogram[0] > set.size() * 3 / 4);
+
+    // reserve() grows once, keeping the elements
+    FlatHashSet<uint64_t, IntHash, IntEqual> reserved;
+    reserved.insert(42);
+    reserved.reserve(10000);
+    const size_t capacity = reserved.capacity();
+    assert(10000 * 8 <= capacity * 7 && reserved.find(42) != nullptr);
+    for (uint64_t i = 0; i < 10000; ++i) reserved.insert(i);
+    assert(reserved.capacity() == capacity && reserved.size() == 10000);
+    reserved.reserve(10);
+    assert(reserved.capacity() == capacity);
+
+    // A constant hash still works, every probe visits the whole sequence
+    FlatHashSet<uint64_t, ConstantHash, IntEqual> degenerate;
+    for (uint64_t i = 0; i < 500; ++i) degenerate.insert(i);
+    for (uint64_t i = 0; i < 600; ++i) assert((degenerate.find(i) != nullptr) == (i < 500));
+
+    std::cout << "FlatHashSet test passed!" << std::endl;
+}
+
+void test_tree_hash() {
+    std::cout << "Testing the intern table of TreeAlgebra..." << std::endl;
+
+    TreeAlgebra alg;
+    // Equal constants are one node, integers and reals are distinct
+    assert(alg.num(0.0) == alg.num(-0.0));
+    assert(alg.num(2.0) != alg.integer(2));
+    assert(alg.integer(2) == alg.integer(2));
+    assert(TreeHash{}(alg.num(0.0)) == TreeHash{}(alg.num(-0.0)));
+
+    // Constants that differ only in their low bits, and their sums
+    const size_t before = alg.nodeCount();
+    std::vector<std::shared_ptr<Tree>> nodes;
+    for (int64_t i = 0; i < 20000; ++i) {
+        nodes.push_back(alg.num(1.0 + static_cast<double>(i) * 0x1.0p-52));
+        nodes.push_back(alg.integer(i << 32));
+    }
+    const size_t constants = nodes.size();
+    for (size_t i = 1; i < constants; ++i) {
+        nodes.push_back(alg.add(nodes[i - 1], nodes[i]));
+    }
+    assert(alg.nodeCount() == before + nodes.size());
+
+    // Mixed hashes: low and top bits uniform over the nodes
+    std::set<size_t> groups;
+    std::set<size_t> tags;
+    for (const auto& node : nodes) {
+        size_t h = TreeHash{}(node);
+        groups.insert(h & 1023);
+        tags.insert(h >> 57);
+    }
+    assert(groups.size() == 1024 && tags.size() == 128);
+
+    // Interning again finds every node
+    for (int64_t i = 0; i < 20000; ++i) {
+        assert(alg.num(1.0 + static_cast<double>(i) * 0x1.0p-52) == nodes[2 * i]);
+    }
+    assert(alg.add(nodes[0], nodes[1]) == nodes[40000]);
+    assert(alg.nodeCount() == before + nodes.size());
+
+    std::cout << "Intern table test passed!" << std::endl;
+}
+
+int main() {
+    test_flat_hash_set();
+    test_tree_hash();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
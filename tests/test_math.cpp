@@ -0,0 +1,287 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntegerAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/StringAlgebra.hh"
+#include "algebra/CostAlgebra.hh"
+#include "algebra/SignalEngine.hh"
+#include "algebra/RangeAnalysis.hh"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+// Operations of the numeric algebras (UnaryOp and BinaryOp are the Tree ones)
+using NumericUnary = Algebra<double>::UnaryOp;
+using NumericBinary = Algebra<double>::BinaryOp;
+
+// Distance in units in the last place of U between two values of type U
+template<typename U>
+static double ulps(U x, U expected) {
+    if (std::isnan(expected)) return std::isnan(x) ? 0.0 : 1e9;
+    if (std::isinf(expected) || x == expected) return x == expected ? 0.0 : 1e9;
+    const U ulp = std::nextafter(std::abs(expected), std::numeric_limits<U>::infinity()) - std::abs(expected);
+    return std::abs(static_cast<double>(x) - static_cast<double>(expected)) / static_cast<double>(ulp);
+}
+
+static std::vector<double> samples(size_t n, double lo, double hi) {
+    std::vector<double> x(n);
+    uint64_t state = 42;
+    for (auto& v : x) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        v = lo + (hi - lo) * (static_cast<double>(state >> 11) * 0x1.0p-53);
+    }
+    return x;
+}
+
+void test_signature() {
+    std::cout << "Testing the extended signature..." << std::endl;
+
+    TreeAlgebra alg;
+    DoubleAlgebra doubles;
+    auto x = alg.num(0.5);
+    auto y = alg.num(3.0);
+    assert(std::abs(alg.exp(x)->operator()(doubles) - std::exp(0.5)) < 1e-15);
+    assert(std::abs(alg.log(y)->operator()(doubles) - std::log(3.0)) < 1e-15);
+    assert(std::abs(alg.sin(x)->operator()(doubles) - std::sin(0.5)) < 1e-15);
+    assert(std::abs(alg.cos(x)->operator()(doubles) - std::cos(0.5)) < 1e-15);
+    assert(std::abs(alg.tanh(x)->operator()(doubles) - std::tanh(0.5)) < 1e-15);
+    assert((*alg.sqrt(alg.num(9.0)))(doubles) == 3.0);
+    assert((*alg.min(x, y))(doubles) == 0.5 && (*alg.max(x, y))(doubles) == 3.0);
+    assert((*alg.pow(y, alg.num(2.0)))(doubles) == 9.0);
+
+    // Hash-consing tells the operations apart
+    assert(alg.sin(x) == alg.sin(x) && alg.sin(x) != alg.cos(x));
+    assert(alg.min(x, y) != alg.max(x, y));
+    assert(alg.unary(UnaryOp::Tanh, x) == alg.tanh(x));
+    assert(alg.binary(BinaryOp::Pow, x, y) == alg.pow(x, y));
+
+    // Exact algebras only have min and max
+    IntegerAlgebra integers;
+    auto m = alg.max(alg.num(4.0), alg.num(-7.0));
+    assert((*m)(integers) == 4);
+    bool threw = false;
+    try {
+        (*alg.exp(alg.num(1.0)))(integers);
+    } catch (const std::runtime_error& e) {
+        std::cout << "Expected error: " << e.what() << std::endl;
+        threw = true;
+    }
+    assert(threw);
+
+    StringAlgebra strings;
+    auto e = alg.mul(alg.add(alg.sin(x), alg.num(1.0)), alg.pow(alg.min(x, y), alg.sqrt(y)));
+    std::cout << (*e)(strings).first << std::endl;
+    assert((*e)(strings).first == "(sin(0.5) + 1) * pow(min(0.5, 3), sqrt(3))");
+
+    CostAlgebra costs(LatencyTable::doublePrecision());
+    Cost c = (*alg.exp(alg.add(x, y)))(costs);
+    assert(c.span == 4.0 + 40.0 && c.work == 44.0);
+    assert(LatencyTable::unit().binaryLatency(NumericBinary::Pow) == 1.0);
+
+    std::cout << "Signature test passed!" << std::endl;
+}
+
+// Every value of f on points of a must lie in the interval image
+template<typename F, typename G>
+static void checkUnary(const char* name, const Interval& a, F f, G image) {
+    const Interval r = image(a);
+    for (size_t k = 0; k <= 200; ++k) {
+        const double x = k == 200 ? a.sup : a.inf + (a.sup - a.inf) * (k / 200.0);
+        const double y = f(x);
+        if (std::isnan(y)) continue;
+        if (!r.contains(y)) {
+            std::cout << name << a << " = " << r << " misses " << name << "(" << x << ") = " << y << std::endl;
+            assert(false);
+        }
+    }
+}
+
+void test_interval_soundness() {
+    std::cout << "Testing interval elementary functions..." << std::endl;
+
+    IntervalAlgebra I;
+    const std::vector<Interval> ranges = {
+        Interval(-1.0, 1.0), Interval(0.1, 0.2), Interval(-3.0, -2.5), Interval(1.0, 7.0),
+        Interval(1.5, 1.6), Interval(3.0, 3.3), Interval(-100.0, -95.0), Interval(0.0, 0.0),
+        Interval(-0.5, 2.0), Interval(20.0, 21.0), Interval(-700.0, 700.0)};
+    for (const auto& a : ranges) {
+        checkUnary("exp", a, [](double x) { return std::exp(x); }, [&](const Interval& v) { return I.exp(v); });
+        checkUnary("log", a, [](double x) { return std::log(x); }, [&](const Interval& v) { return I.log(v); });
+        checkUnary("sqrt", a, [](double x) { return std::sqrt(x); }, [&](const Interval& v) { return I.sqrt(v); });
+        checkUnary("sin", a, [](double x) { return std::sin(x); }, [&](const Interval& v) { return I.sin(v); });
+        checkUnary("cos", a, [](double x) { return std::cos(x); }, [&](const Interval& v) { return I.cos(v); });
+        checkUnary("tanh", a, [](double x) { return std::tanh(x); }, [&](const Interval& v) { return I.tanh(v); });
+        for (double n : {0.0, 1.0, 2.0, 3.0, -1.0, -2.0, 0.5, 2.5}) {
+            checkUnary("pow", a, [n](double x) { return std::pow(x, n); },
+                       [&](const Interval& v) { return I.pow(v, Interval::point(n)); });
+        }
+    }
+
+    // Periodic functions are tight away from their extrema...
+    Interval s = I.sin(Interval(0.1, 0.2));
+    assert(s.sup < 0.2 && s.inf > 0.09);
+    // ...reach ±1 where an extremum is inside, and [-1, 1] over a period
+    assert(I.sin(Interval(1.5, 1.6)).sup == 1.0);
+    assert(I.cos(Interval(3.0, 3.3)).inf == -1.0);
+    assert(I.sin(Interval(0.0, 7.0)) == Interval(-1.0, 1.0));
+    assert(I.cos(Interval::universe()) == Interval(-1.0, 1.0));
+
+    // Domains
+    assert(I.sqrt(Interval(-2.0, -1.0)).isEmpty());
+    assert(I.log(Interval(-2.0, -1.0)).isEmpty());
+    assert(I.log(Interval(-2.0, 0.0)).contains(-std::numeric_limits<double>::infinity()));
+    assert(I.log(Interval(0.0, 1.0)).inf == -std::numeric_limits<double>::infinity());
+    assert(I.sqrt(Interval(-1.0, 4.0)).inf == 0.0);
+    Interval even = I.pow(Interval(-3.0, 2.0), Interval::point(2.0));
+    assert(even.inf == 0.0 && even.sup >= 9.0 && even.sup < 9.0001);
+    assert(I.min(Interval(0.0, 5.0), Interval(1.0, 2.0)) == Interval(0.0, 2.0));
+    assert(I.max(Interval(0.0, 5.0), Interval(1.0, 2.0)) == Interval(1.0, 5.0));
+
+    std::cout << "Interval test passed!" << std::endl;
+}
+
+template<typename U>
+static void checkBatched(const char* label, NumericUnary op, double lo, double hi, double tolerance) {
+    NumericAlgebra<U> alg;
+    const auto batchedOp = static_cast<typename Algebra<U>::UnaryOp>(op);
+    for (size_t n : {0, 1, 7, 8, 13, 1000}) {
+        std::vector<U> a;
+        for (double v : samples(n, lo, hi)) a.push_back(static_cast<U>(v));
+        std::vector<U> out(n);
+        alg.unary(batchedOp, a.data(), out.data(), n);
+        double worst = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            worst = std::max(worst, ulps(out[i], alg.unary(batchedOp, a[i])));
+        }
+        if (worst > tolerance) {
+            std::cout << label << " on [" << lo << ", " << hi << "]: " << worst << " ulps" << std::endl;
+            assert(false);
+        }
+        // In place
+        alg.unary(batchedOp, a.data(), a.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            assert(a[i] == out[i] || (std::isnan(a[i]) && std::isnan(out[i])));
+        }
+    }
+}
+
+void test_batched() {
+    std::cout << "Testing batched operations..." << std::endl;
+
+    checkBatched<double>("exp", NumericUnary::Exp, -700.0, 700.0, 2.0);
+    checkBatched<double>("exp", NumericUnary::Exp, -745.0, -708.0, 2.0);   // Subnormal results
+    checkBatched<double>("log", NumericUnary::Log, 1e-300, 1e300, 2.0);
+    checkBatched<double>("log", NumericUnary::Log, 0.5, 2.0, 2.0);
+    checkBatched<double>("sin", NumericUnary::Sin, -10.0, 10.0, 2.0);
+    checkBatched<double>("sin", NumericUnary::Sin, -2e5, 2e5, 2.0);        // Library fallback past 1e5
+    checkBatched<double>("cos", NumericUnary::Cos, -10.0, 10.0, 2.0);
+    checkBatched<double>("tanh", NumericUnary::Tanh, -20.0, 20.0, 2.0);
+    checkBatched<double>("tanh", NumericUnary::Tanh, -0.7, 0.7, 2.0);
+    checkBatched<double>("sqrt", NumericUnary::Sqrt, 0.0, 1e6, 0.0);
+    checkBatched<double>("abs", NumericUnary::Abs, -5.0, 5.0, 0.0);
+    checkBatched<float>("exp", NumericUnary::Exp, -80.0, 80.0, 2.0);
+    checkBatched<float>("log", NumericUnary::Log, 1e-30, 1e30, 2.0);
+    checkBatched<float>("sin", NumericUnary::Sin, -100.0, 100.0, 2.0);
+    checkBatched<float>("cos", NumericUnary::Cos, -100.0, 100.0, 2.0);
+    checkBatched<float>("tanh", NumericUnary::Tanh, -10.0, 10.0, 2.0);
+    checkBatched<float>("sqrt", NumericUnary::Sqrt, 0.0, 1e6, 0.0);
+
+    // Special values
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    std::vector<double> special = {0.0, -0.0, inf, -inf, nan, 1e-310, -1.0, 710.0, -746.0, 1e300};
+    DoubleAlgebra doubles;
+    for (NumericUnary op : {NumericUnary::Exp, NumericUnary::Log, NumericUnary::Sin, NumericUnary::Cos,
+                            NumericUnary::Tanh, NumericUnary::Sqrt}) {
+        std::vector<double> out(special.size());
+        doubles.unary(op, special.data(), out.data(), special.size());
+        for (size_t i = 0; i < special.size(); ++i) {
+            const double expected = doubles.unary(op, special[i]);
+            if (ulps(out[i], expected) > 2.0) {
+                std::cout << "op " << static_cast<int>(op) << " of " << special[i] << ": " << out[i]
+                          << " instead of " << expected << std::endl;
+                assert(false);
+            }
+        }
+    }
+
+    // Binary operations agree exactly with the scalar ones, NaN included
+    std::vector<double> a = samples(37, -4.0, 4.0);
+    std::vector<double> b = samples(37, -4.0, 4.0);
+    std::reverse(b.begin(), b.end());
+    a[3] = nan;
+    b[5] = nan;
+    for (NumericBinary op : {NumericBinary::Add, NumericBinary::Sub, NumericBinary::Mul, NumericBinary::Div,
+                             NumericBinary::Mod, NumericBinary::Min, NumericBinary::Max, NumericBinary::Pow}) {
+        std::vector<double> out(a.size());
+        doubles.binary(op, a.data(), b.data(), out.data(), a.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            const double expected = doubles.binary(op, a[i], b[i]);
+            assert(out[i] == expected || (std::isnan(out[i]) && std::isnan(expected)));
+        }
+    }
+    assert(std::isnan(doubles.min(nan, 1.0)) && std::isnan(doubles.max(1.0, nan)));
+
+    std::cout << "Batched test passed!" << std::endl;
+}
+
+void test_signal_and_ranges() {
+    std::cout << "Testing elementary functions in signal programs..." << std::endl;
+
+    TreeAlgebra alg;
+    SignalProgram program(alg);
+    auto in = program.input();
+    // Block stage: tanh(3·in) + 0.1·sin(in); sample stage: x = 0.5·max(x, in) + 0.2·cos(x)
+    auto block = alg.add(alg.tanh(alg.mul(alg.num(3.0), in)), alg.mul(alg.num(0.1), alg.sin(in)));
+    auto x = alg.var();
+    alg.define(x, alg.add(alg.mul(alg.num(0.5), alg.max(x, in)), alg.mul(alg.num(0.2), alg.cos(x))));
+    auto shaped = alg.exp(alg.min(in, alg.num(0.0)));
+    program.output(block);
+    program.output(x);
+    program.output(shaped);
+
+    const size_t n = 1000;
+    std::vector<double> input = samples(n, -1.0, 1.0);
+    SignalEngine<double> engine(program, 64);
+    assert(engine.stats().sampleStages == 1);
+    std::vector<double> out0(n), out1(n), out2(n);
+    const double* inputs[] = {input.data()};
+    double* outputs[] = {out0.data(), out1.data(), out2.data()};
+    engine.process(inputs, outputs, n);
+    double state = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        assert(std::abs(out0[i] - (std::tanh(3.0 * input[i]) + 0.1 * std::sin(input[i]))) < 1e-14);
+        state = 0.5 * std::max(state, input[i]) + 0.2 * std::cos(state);
+        assert(std::abs(out1[i] - state) < 1e-12);
+        assert(std::abs(out2[i] - std::exp(std::min(input[i], 0.0))) < 1e-15);
+    }
+
+    RangeAnalysis analysis;
+    analysis.analyze(program, {Interval(-1.0, 1.0)});
+    std::cout << "block in " << analysis.range(block) << ", x in " << analysis.range(x)
+              << ", shaped in " << analysis.range(shaped) << std::endl;
+    assert(analysis.range(block).isBounded() && analysis.range(block).sup < 1.1);
+    assert(analysis.range(shaped).inf > 0.36 && analysis.range(shaped).sup <= 1.0 + 1e-12);
+    for (size_t i = 0; i < n; ++i) {
+        assert(analysis.range(block).contains(out0[i]));
+        assert(analysis.range(x).contains(out1[i]));
+        assert(analysis.range(shaped).contains(out2[i]));
+    }
+
+    std::cout << "Signal test passed!" << std::endl;
+}
+
+int main() {
+    test_signature();
+    test_interval_soundness();
+    test_batched();
+    test_signal_and_ranges();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,150 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/NumericAlgebra.hh"
+#include "algebra/PrecisionReport.hh"
+#include "algebra/Workload.hh"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <type_traits>
+
+class DoubleAlgebra;   // A class, not an alias: it can be forward-declared and derived from
+
+// Coarser convergence: subclasses can override the fixpoint parameters
+class CoarseAlgebra : public DoubleAlgebra {
+public:
+    bool isConverged(const double& prev, const double& current) const override {
+        return std::abs(prev - current) < 1e-3;
+    }
+};
+
+// Saturating sum: and the operations
+class SaturatingAlgebra : public DoubleAlgebra {
+public:
+    double add(const double& a, const double& b) const override {
+        return std::min(DoubleAlgebra::add(a, b), 10.0);
+    }
+};
+
+void test_numeric_instances() {
+    std::cout << "Testing float, double and mixed-precision algebras..." << std::endl;
+
+    static_assert(std::is_base_of_v<NumericAlgebra<double>, DoubleAlgebra>);
+
+    TreeAlgebra treeAlg;
+    DoubleAlgebra doubleAlg;
+    FloatAlgebra floatAlg;
+    MixedAlgebra mixedAlg;
+
+    // (0.1 + 0.2) * 3 is rounded to float at every step
+    auto e = treeAlg.mul(treeAlg.add(treeAlg.num(0.1), treeAlg.num(0.2)), treeAlg.integer(3));
+    float f = treeAlg.eval(e, floatAlg);
+    double d = treeAlg.eval(e, doubleAlg);
+    assert(f == (0.1f + 0.2f) * 3.0f);
+    assert(d == (0.1 + 0.2) * 3.0);
+    assert(treeAlg.eval(e, mixedAlg) == f);   // Double rounding is innocuous for + and *
+    assert((*e)(floatAlg) == f);
+
+    // fmod of operands of very different magnitudes is exact in both
+    float big = 16777216.0f;   // 2^24
+    assert(floatAlg.mod(big, 3.0f) == mixedAlg.mod(big, 3.0f));
+    assert(floatAlg.mod(-7.5f, 2.0f) == -1.5f);
+
+    // Tolerances are scaled to the type
+    assert(floatAlg.isConverged(1.0f, 1.0f + 4e-6f));
+    assert(!floatAlg.isConverged(1.0f, 1.0f + 4e-5f));
+    assert(!doubleAlg.isConverged(1.0, 1.0 + 4e-6));
+    assert(floatAlg.bottom() == 0.0f);
+
+    // Subclasses of DoubleAlgebra keep its operations...
+    CoarseAlgebra coarse;
+    auto x = treeAlg.var();
+    treeAlg.define(x, treeAlg.add(treeAlg.mul(treeAlg.num(0.5), x), treeAlg.num(1.0)));
+    assert(coarse.isConverged(1.0, 1.0005) && !doubleAlg.isConverged(1.0, 1.0005));
+    assert(treeAlg.eval(e, coarse) == d);
+    assert(std::abs(treeAlg.eval(x, coarse) - 2.0) < 1e-2);
+
+    // ... or replace them
+    SaturatingAlgebra saturating;
+    auto sum = treeAlg.add(treeAlg.num(8.0), treeAlg.num(5.0));
+    assert(treeAlg.eval(sum, saturating) == 10.0);
+    assert(treeAlg.eval(sum, doubleAlg) == 13.0);
+    assert(saturating.mulAdd(2.0, 4.0, 5.0) == 10.0);   // Unfused: through add()
+
+    std::cout << "Numeric instances test passed!" << std::endl;
+}
+
+void test_float_fixpoints() {
+    std::cout << "Testing fixpoints in single precision..." << std::endl;
+
+    TreeAlgebra treeAlg;
+    FloatAlgebra floatAlg;
+    DoubleAlgebra doubleAlg;
+
+    // Affine: x = 0.5*x + 0.3*y + 1, y = 0.2*x + 2, solved as a linear system
+    auto x = treeAlg.var();
+    auto y = treeAlg.var();
+    treeAlg.define(x, treeAlg.add(treeAlg.add(treeAlg.mul(treeAlg.num(0.5), x),
+                                              treeAlg.mul(treeAlg.num(0.3), y)), treeAlg.num(1.0)));
+    treeAlg.define(y, treeAlg.add(treeAlg.mul(treeAlg.num(0.2), x), treeAlg.num(2.0)));
+    float xValue = treeAlg.eval(x, floatAlg);
+    std::cout << "x = " << xValue << " in " << treeAlg.fixpointStats().rounds << " round(s)" << std::endl;
+    assert(std::abs(xValue - 1.6f / 0.44f) < 1e-5f);
+    assert(treeAlg.fixpointStats().affineSCCs == 1);
+
+    // Nonlinear, accelerated: z = 0.99 * |z| / (1 + |z| / 100) + 1
+    auto z = treeAlg.var();
+    auto absZ = treeAlg.abs(z);
+    treeAlg.define(z, treeAlg.add(treeAlg.div(treeAlg.mul(treeAlg.num(0.99), absZ),
+                                              treeAlg.add(treeAlg.num(1.0), treeAlg.div(absZ, treeAlg.num(100.0)))),
+                                  treeAlg.num(1.0)));
+    double reference = treeAlg.eval(z, doubleAlg);
+    for (Acceleration acceleration : {Acceleration::None, Acceleration::Aitken, Acceleration::Anderson}) {
+        FixpointOptions options;
+        options.acceleration = acceleration;
+        treeAlg.setFixpointOptions(options);
+        float zValue = treeAlg.eval(z, floatAlg);
+        std::cout << "z = " << zValue << " in " << treeAlg.fixpointStats().rounds << " rounds" << std::endl;
+        assert(std::abs(zValue - reference) < 1e-3 * std::abs(reference));
+    }
+
+    std::cout << "Float fixpoints test passed!" << std::endl;
+}
+
+void test_precision_report() {
+    std::cout << "Testing the float/double error report..." << std::endl;
+
+    WorkloadParams params;
+    params.nodeCount = 2000;
+    params.rootCount = 32;
+    params.binaryMix = {4, 1, 3, 0, 0};   // +, -, *
+    params.unaryMix = {0};
+    params.maxDepth = 8;
+    TreeAlgebra treeAlg;
+    Workload w = WorkloadGenerator(params).generate(treeAlg);
+
+    FloatAlgebra floatAlg;
+    DoubleAlgebra doubleAlg;
+    PrecisionReport report = comparePrecision(treeAlg, w.roots, floatAlg, doubleAlg);
+    report.print(std::cout);
+    assert(report.count + report.overflows + report.skipped == w.roots.size());
+    assert(report.count > 0);
+    assert(report.maxRelError >= report.meanRelError);
+    assert(report.maxUlps >= report.maxRelError / std::numeric_limits<float>::epsilon() / 2);
+
+    // Double against itself is exact
+    PrecisionReport exact = comparePrecision(treeAlg, w.roots, doubleAlg, doubleAlg);
+    assert(exact.maxAbsError == 0.0 && exact.maxUlps == 0.0);
+
+    std::cout << "Precision report test passed!" << std::endl;
+}
+
+int main() {
+    test_numeric_instances();
+    test_float_fixpoints();
+    test_precision_report();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/CompactGraph.hh"
+#include "algebra/ThreadPool.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+
+void test_thread_pool() {
+    std::cout << "Testing ThreadPool..." << std::endl;
+
+    for (size_t threads : {1, 2, 4}) {
+        ThreadPool pool(threads);
+        assert(pool.size() == threads);
+
+        // Every index exactly once, over many consecutive loops. A pool of
+        // one thread runs the whole range in one call.
+        std::vector<std::atomic<int>> hits(10000);
+        for (int loop = 0; loop < 50; ++loop) {
+            pool.parallelFor(0, hits.size(), 64, [&](size_t first, size_t last) {
+                assert(first < last && (last - first <= 64 || threads == 1));
+                for (size_t i = first; i < last; ++i) hits[i]++;
+            });
+        }
+        for (const auto& h : hits) assert(h == 50);
+
+        // Empty and single-chunk loops
+        int calls = 0;
+        pool.parallelFor(5, 5, 16, [&](size_t, size_t) { calls++; });
+        pool.parallelFor(0, 10, 16, [&](size_t first, size_t last) { calls++; assert(first == 0 && last == 10); });
+        assert(calls == 1);
+
+        // Exceptions reach the caller, the pool stays usable
+        bool thrown = false;
+        try {
+            pool.parallelFor(0, 1000, 10, [&](size_t first, size_t last) {
+                if (first <= 500 && 500 < last) throw std::runtime_error("chunk failed");
+            });
+        } catch (const std::runtime_error& e) {
+            thrown = std::string(e.what()) == "chunk failed";
+        }
+        assert(thrown);
+        std::atomic<size_t> sum{0};
+        pool.parallelFor(0, 100, 1, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) sum += i;
+        });
+        assert(sum == 4950);
+
+        // Named bodies, passed as lvalues
+        sum = 0;
+        auto body = [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) sum += i;
+        };
+        pool.parallelFor(0, 100, 1, body);
+        const auto& constBody = body;
+        pool.parallelFor(0, 100, 1, constBody);
+        assert(sum == 9900);
+    }
+
+    std::cout << "ThreadPool test passed!" << std::endl;
+}
+
+void test_levels() {
+    std::cout << "Testing the level layout..." << std::endl;
+
+    TreeAlgebra alg;
+    // (x + y) * |x - 3|: x y 3 at level 0, x+y and x-3 at 1, |x-3| at 2, product at 3
+    auto x = alg.num(2.0);
+    auto y = alg.integer(5);
+    auto expr = alg.mul(alg.add(x, y), alg.abs(alg.sub(x, alg.num(3.0))));
+    CompactGraph graph = compact({expr}, CompactLayout::Levels);
+    const auto& levels = graph.levels();
+    assert(levels.size() == 4);
+    assert(levels[0].end - levels[0].begin == 3);
+    assert(levels[1].end - levels[1].begin == 2);
+    assert(levels[3].begin == graph.roots()[0] && levels[3].end == 7);
+    assert(graph.position(x) < graph.position(y));   // Post-order inside a level
+
+    ThreadPool pool(3);
+    std::vector<double> values;
+    graph.evaluate(DoubleAlgebra(), values, pool);
+    assert(values[graph.roots()[0]] == 7.0);
+
+    // A post-order graph has no levels
+    bool thrown = false;
+    try {
+        compact({expr}).evaluate(DoubleAlgebra(), values, pool);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Level layout test passed!" << std::endl;
+}
+
+// Operands at lower levels, level ranges covering the graph
+static void checkLevels(const CompactGraph& graph) {
+    const auto& levels = graph.levels();
+    std::vector<uint32_t> levelOf(graph.size());
+    uint32_t position = 0;
+    for (uint32_t l = 0; l < levels.size(); ++l) {
+        assert(levels[l].begin == position);
+        assert(levels[l].begin <= levels[l].plainEnd && levels[l].plainEnd <= levels[l].end);
+        for (uint32_t p = levels[l].begin; p < levels[l].end; ++p) levelOf[p] = l;
+        position = levels[l].end;
+    }
+    assert(position == graph.size());
+    for (uint32_t l = 0; l < levels.size(); ++l) {
+        for (uint32_t p = levels[l].begin; p < levels[l].plainEnd; ++p) {
+            const CompactNode& n = graph.node(p);
+            if (n.getType() == Tree::NodeType::Unary) assert(levelOf[n.a] < l);
+            if (n.getType() == Tree::NodeType::Binary) assert(levelOf[n.a] < l && levelOf[n.b] < l);
+            if (n.getType() == Tree::NodeType::Var && n.a != CompactNode::NONE) assert(levelOf[n.a] < l);
+        }
+    }
+}
+
+void test_parallel_evaluation() {
+    std::cout << "Testing parallel evaluation..." << std::endl;
+
+    WorkloadParams params;
+    params.nodeCount = 20000;
+    params.rootCount = 32;
+    params.sccCount = 6;
+    params.sccSize = 4;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+
+    CompactGraph sequential = compact(w.roots);
+    CompactGraph leveled = compact(w.roots, CompactLayout::Levels);
+    assert(leveled.size() == sequential.size());
+    assert(leveled.stats().recursiveComponents == sequential.stats().recursiveComponents);
+    checkLevels(leveled);
+    std::cout << leveled.size() << " nodes in " << leveled.levels().size() << " levels, "
+              << leveled.stats().recursiveComponents << " recursive components" << std::endl;
+
+    // Same operations on the same operands: identical values, whatever
+    // the layout and the number of threads
+    DoubleAlgebra doubles;
+    IntervalAlgebra intervals;
+    std::vector<double> expected;
+    const size_t rounds = sequential.evaluate(doubles, expected);
+    std::vector<Interval> expectedRanges = sequential.evaluate(intervals);
+    std::vector<double> alone = leveled.evaluate(doubles);
+    for (size_t threads : {1, 2, 4, 8}) {
+        ThreadPool pool(threads);
+        std::vector<double> values;
+        std::vector<Interval> ranges;
+        const size_t parallelRounds = leveled.evaluate(doubles, values, pool, 64);
+        assert(parallelRounds == rounds);
+        leveled.evaluate(intervals, ranges, pool, 64);
+        for (size_t i = 0; i < w.roots.size(); ++i) {
+            assert(values[leveled.roots()[i]] == expected[sequential.roots()[i]]);
+            assert(values[leveled.roots()[i]] == alone[leveled.roots()[i]]);
+            assert(ranges[leveled.roots()[i]] == expectedRanges[sequential.roots()[i]]);
+        }
+        for (size_t p = 0; p < values.size(); ++p) {
+            assert(values[p] == alone[p] || (std::isnan(values[p]) && std::isnan(alone[p])));
+        }
+    }
+
+    std::cout << "Parallel evaluation test passed!" << std::endl;
+}
+
+int main() {
+    test_thread_pool();
+    test_levels();
+    test_parallel_evaluation();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/EvalProfiler.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/StringAlgebra.hh"
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// Sum of the weights of the folded stacks whose last frame is label
+static long long foldedWeight(const std::string& folded, const std::string& label) {
+    std::istringstream lines(folded);
+    std::string line;
+    long long total = 0;
+    while (std::getline(lines, line)) {
+        const size_t space = line.rfind(' ');
+        const size_t frame = line.rfind(';', space);
+        const std::string last = line.substr(frame == std::string::npos ? 0 : frame + 1,
+                                             space - (frame == std::string::npos ? 0 : frame + 1));
+        if (last == label) {
+            total += std::stoll(line.substr(space + 1));
+        }
+    }
+    return total;
+}
+
+void test_counts() {
+    std::cout << "Testing visit and evaluation counts..." << std::endl;
+
+    TreeAlgebra alg;
+    // shared = 2 + 3 is used three times: evaluated once by eval(), visited three times
+    auto shared = alg.add(alg.num(2.0), alg.num(3.0));
+    auto root = alg.mul(alg.add(shared, shared), alg.abs(shared));
+    DoubleAlgebra doubles;
+
+    EvalProfiler profiler(1);
+    {
+        EvalProfiler::Scope scope(profiler);
+        assert(EvalProfiler::current() == &profiler);
+        assert(alg.eval(root, doubles) == 50.0);
+    }
+    assert(EvalProfiler::current() == nullptr);
+    assert(profiler.depth() == 0);
+
+    const auto* s = profiler.node(shared->getId());
+    assert(s && s->visits == 3 && s->evaluations == 1);
+    assert(s->label == "add#" + std::to_string(shared->getId()));
+    const auto* r = profiler.node(root->getId());
+    assert(r && r->visits == 1 && r->evaluations == 1 && r->label.substr(0, 4) == "mul#");
+    assert(profiler.node(alg.num(2.0)->getId())->label.substr(0, 7) == "num(2)#");
+
+    // Tree::operator() has no memo: the shared node is evaluated three times
+    EvalProfiler direct(1);
+    {
+        EvalProfiler::Scope scope(direct);
+        assert((*root)(doubles) == 50.0);
+    }
+    assert(direct.node(shared->getId())->evaluations == 3);
+    assert(direct.node(alg.num(2.0)->getId())->evaluations == 3);
+
+    // Outside a scope nothing is recorded
+    alg.eval(root, doubles);
+    assert(profiler.node(root->getId())->visits == 1);
+
+    // Period 1: every self time is sampled, and the contexts add up
+    std::ostringstream folded;
+    profiler.writeFolded(folded);
+    std::cout << folded.str();
+    assert(profiler.contexts() == 6);   // One per evaluated node: each is evaluated once
+    long long sum = 0;
+    for (auto [id, node] : profiler.ranked()) {
+        assert(foldedWeight(folded.str(), node->label) == std::llround(node->seconds * 1e9) || node->seconds < 1e-9);
+        sum += std::llround(node->seconds * 1e9);
+    }
+    assert(std::abs(sum - std::llround(profiler.seconds() * 1e9)) <= 8);
+    assert(folded.str().find(r->label + ";add#") != std::string::npos);
+
+    // Initial algebras are profiled too
+    EvalProfiler strings(1);
+    {
+        EvalProfiler::Scope scope(strings);
+        alg.eval(root, StringAlgebra());
+    }
+    assert(strings.node(shared->getId())->visits == 3);
+
+    std::cout << "Count test passed!" << std::endl;
+}
+
+void test_fixpoints() {
+    std::cout << "Testing fixpoint profiles..." << std::endl;
+
+    TreeAlgebra alg;
+    FixpointOptions options;
+    options.solveAffine = false;
+    alg.setFixpointOptions(options);
+    // x = 0.5·y + 1, y = 0.5·x + 1: one SCC, rounds counted per SCC
+    auto x = alg.var();
+    auto y = alg.var();
+    alg.define(x, alg.add(alg.mul(alg.num(0.5), y), alg.num(1.0)));
+    alg.define(y, alg.add(alg.mul(alg.num(0.5), x), alg.num(1.0)));
+    auto z = alg.var();
+    alg.define(z, alg.add(alg.mul(alg.num(0.9), z), alg.num(2.0)));
+    auto root = alg.add(x, z);
+
+    EvalProfiler profiler;
+    {
+        EvalProfiler::Scope scope(profiler);
+        alg.eval(root, DoubleAlgebra());
+    }
+    const FixpointStats stats = alg.fixpointStats();
+    assert(profiler.sccs().size() == 2);
+    size_t rounds = 0;
+    size_t evaluations = 0;
+    for (const auto& scc : profiler.sccs()) {
+        assert(scc.solves == 1 && scc.rounds > 1);
+        assert(scc.label.substr(0, 7) == "fix(var");
+        rounds += scc.rounds;
+        evaluations += scc.nodeEvaluations;
+    }
+    assert(rounds == stats.rounds && evaluations == stats.nodeEvaluations);
+    assert(profiler.sccs()[0].size == 2 && profiler.sccs()[1].size == 1);
+
+    std::ostringstream report;
+    profiler.report(report, 5);
+    std::cout << report.str();
+    assert(report.str().find("fix(var") != std::string::npos);
+
+    // query() keeps its results: a second query does not even visit the root
+    EvalProfiler queries;
+    IntervalAlgebra intervals;
+    {
+        EvalProfiler::Scope scope(queries);
+        alg.query(root, intervals);
+        alg.query(root, intervals);
+    }
+    for (const auto& scc : queries.sccs()) assert(scc.solves == 1);
+    assert(queries.node(root->getId())->visits == 1 && queries.node(root->getId())->evaluations == 1);
+
+    std::cout << "Fixpoint profile test passed!" << std::endl;
+}
+
+void test_scopes() {
+    std::cout << "Testing scopes..." << std::endl;
+
+    TreeAlgebra alg;
+    auto undefined = alg.var();
+    auto root = alg.add(alg.num(1.0), alg.abs(undefined));
+
+    // Frames are left when an evaluation throws
+    EvalProfiler profiler(1);
+    {
+        EvalProfiler::Scope scope(profiler);
+        bool thrown = false;
+        try {
+            alg.eval(root, DoubleAlgebra());
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        assert(profiler.depth() == 0);
+
+        // Nested scopes restore the previous profiler
+        EvalProfiler inner;
+        {
+            EvalProfiler::Scope nested(inner);
+            alg.eval(alg.num(1.0), DoubleAlgebra());
+        }
+        assert(EvalProfiler::current() == &profiler);
+        assert(inner.node(alg.num(1.0)->getId())->visits == 1);
+
+        // Other threads do not see the profiler
+        auto one = alg.num(1.0);
+        std::thread other([&]() {
+            assert(EvalProfiler::current() == nullptr);
+            alg.eval(one, DoubleAlgebra());
+        });
+        other.join();
+    }
+    assert(profiler.node(alg.num(1.0)->getId())->visits == 1);
+
+    profiler.clear();
+    assert(!profiler.node(root->getId()) && profiler.contexts() == 0);
+
+    std::cout << "Scope test passed!" << std::endl;
+}
+
+int main() {
+    test_counts();
+    test_fixpoints();
+    test_scopes();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
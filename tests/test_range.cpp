@@ -0,0 +1,129 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/RangeAnalysis.hh"
+#include "algebra/SignalEngine.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+void test_feedback_ranges() {
+    std::cout << "Testing ranges of feedback loops..." << std::endl;
+
+    TreeAlgebra alg;
+    SignalProgram program(alg);
+    auto in = program.input();
+
+    // x[n] = 0.5·x[n-1] + in[n] with in in [-1, 1]: |x| ≤ 2
+    auto x = alg.var();
+    alg.define(x, alg.add(alg.mul(alg.num(0.5), x), in));
+    // Comb y[n] = in[n] + 0.75·y[n-10]: |y| ≤ 4
+    auto y = alg.var();
+    alg.define(y, alg.add(in, alg.mul(alg.num(0.75), program.delay(y, 10))));
+    // Unstable: z[n] = 2·z[n-1] + in[n]
+    auto z = alg.var();
+    alg.define(z, alg.add(alg.mul(alg.num(2.0), z), in));
+    // Non-recursive: |in| / 4 + delay(in, 3)
+    auto w = alg.add(alg.div(alg.abs(in), alg.num(4.0)), program.delay(in, 3));
+    program.output(x);
+    program.output(y);
+    program.output(z);
+    program.output(w);
+
+    RangeAnalysis analysis;
+    analysis.analyze(program, {Interval(-1.0, 1.0)});
+    std::cout << "x in " << analysis.range(x) << ", y in " << analysis.range(y)
+              << ", z in " << analysis.range(z) << ", w in " << analysis.range(w) << std::endl;
+    assert(analysis.range(x) == Interval(-2.0, 2.0));
+    assert(analysis.range(y) == Interval(-4.0, 4.0));
+    assert(analysis.range(z) == Interval::universe());
+    assert(analysis.range(w) == Interval(-1.0, 1.25));
+    assert(analysis.range(in) == Interval(-1.0, 1.0));
+
+    const RangeStats& stats = analysis.stats();
+    std::cout << stats.nodes << " nodes, " << stats.recursiveSCCs << " recursive SCCs, "
+              << stats.rounds << " rounds, " << stats.widenings << " widenings" << std::endl;
+    assert(stats.recursiveSCCs == 3);
+    assert(stats.unbounded > 0);
+
+    std::cout << "Feedback ranges test passed!" << std::endl;
+}
+
+void test_ranges_are_sound() {
+    std::cout << "Testing ranges against a simulation..." << std::endl;
+
+    TreeAlgebra alg;
+    SignalProgram program(alg);
+    auto in = program.input();
+
+    // A damped, saturated resonator: nonlinear feedback through two variables
+    auto a = alg.var();
+    auto b = alg.var();
+    auto shaped = alg.div(a, alg.add(alg.num(1.0), alg.abs(a)));
+    alg.define(a, alg.add(alg.sub(alg.mul(alg.num(0.6), shaped), alg.mul(alg.num(0.3), b)), in));
+    alg.define(b, alg.add(alg.mul(alg.num(0.5), a), alg.mul(alg.num(0.25), program.delay(b, 7))));
+    auto out = alg.mod(alg.add(a, b), alg.num(1.5));
+    program.output(a);
+    program.output(b);
+    program.output(out);
+
+    RangeAnalysis analysis;
+    analysis.analyze(program, {Interval(-0.5, 0.5)});
+    std::cout << "a in " << analysis.range(a) << ", b in " << analysis.range(b)
+              << ", out in " << analysis.range(out) << std::endl;
+    assert(analysis.range(a).isBounded() && analysis.range(b).isBounded());
+
+    SignalEngine<double> engine(program, 64);
+    const size_t n = 20000;
+    std::vector<double> input(n);
+    uint64_t state = 99;
+    for (auto& v : input) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        v = (static_cast<double>(state >> 11) * 0x1.0p-53 - 0.5) * ((state >> 7) % 3 == 0 ? 1.0 : 0.2);
+    }
+    std::vector<std::vector<double>> outputs(3, std::vector<double>(n));
+    const double* inputs[] = {input.data()};
+    double* outs[] = {outputs[0].data(), outputs[1].data(), outputs[2].data()};
+    engine.process(inputs, outs, n);
+    for (size_t i = 0; i < n; ++i) {
+        assert(analysis.range(a).contains(outputs[0][i]));
+        assert(analysis.range(b).contains(outputs[1][i]));
+        assert(analysis.range(out).contains(outputs[2][i]));
+    }
+
+    std::cout << "Sound ranges test passed!" << std::endl;
+}
+
+void test_ranges_of_workloads() {
+    std::cout << "Testing ranges of generated systems..." << std::endl;
+
+    WorkloadParams params;
+    params.nodeCount = 5000;
+    params.rootCount = 16;
+    params.sccCount = 20;
+    params.sccSize = 10;
+    params.nonlinear = true;
+    TreeAlgebra alg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+
+    RangeAnalysis analysis;
+    analysis.analyze(w.roots);
+    const RangeStats& stats = analysis.stats();
+    std::cout << stats.nodes << " nodes, " << stats.recursiveSCCs << " recursive SCCs, "
+              << stats.rounds << " rounds, " << stats.unbounded << " unbounded" << std::endl;
+    assert(stats.nodes == WorkloadGenerator::measure(w.roots).nodes);
+    for (const auto& root : w.roots) {
+        assert(!analysis.range(root).isEmpty());
+    }
+
+    std::cout << "Workload ranges test passed!" << std::endl;
+}
+
+int main() {
+    test_feedback_ranges();
+    test_ranges_are_sound();
+    test_ranges_of_workloads();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,337 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntegerAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/StringAlgebra.hh"
+#include "algebra/CostAlgebra.hh"
+#include "algebra/CostModel.hh"
+#include "algebra/CompactGraph.hh"
+#include "algebra/NodeStore.hh"
+#include "algebra/StructuralHash.hh"
+#include "algebra/SignalEngine.hh"
+#include "algebra/ThreadPool.hh"
+#include "algebra/RangeAnalysis.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+// True when evaluating f throws std::runtime_error
+template<typename F>
+static bool throws(F f) {
+    try {
+        f();
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+void test_lazy_branches() {
+    std::cout << "Testing that only the taken branch is evaluated..." << std::endl;
+
+    TreeAlgebra alg;
+    DoubleAlgebra doubles;
+    auto undefined = alg.var();   // Throws wherever it is evaluated
+    auto one = alg.num(1.0);
+    auto two = alg.num(2.0);
+    auto taken = alg.select(one, two, undefined);
+    auto otherwise = alg.select(alg.num(-1.0), undefined, two);
+    auto nan = alg.select(alg.num(std::nan("")), undefined, two);   // NaN does not hold
+
+    assert(alg.select(one, two, undefined) == taken);   // Hash-consed
+    assert(taken != alg.select(one, undefined, two));
+    for (const auto& t : {taken, otherwise, nan}) {
+        assert((*t)(doubles) == 2.0);
+        assert(alg.eval(t, doubles) == 2.0);
+        assert(alg.query(t, doubles) == 2.0);
+    }
+    assert(alg.eval(std::vector<std::shared_ptr<Tree>>{taken, otherwise}, doubles) == std::vector<double>({2.0, 2.0}));
+    assert(throws([&]() { alg.eval(alg.select(one, undefined, two), doubles); }));
+    assert(alg.eval(alg.select(alg.num(0.0), one, two), doubles) == 2.0);   // c > 0, strictly
+
+    // Exact algebras skip a division by zero in the untaken branch
+    IntegerAlgebra integers;
+    auto ratio = alg.div(alg.integer(7), alg.integer(0));
+    assert(throws([&]() { alg.eval(ratio, integers); }));
+    assert(alg.eval(alg.select(alg.integer(0), ratio, alg.integer(3)), integers) == Integer(3));
+
+    // Algebras that are not values see both branches
+    StringAlgebra strings;
+    assert(alg.eval(alg.select(alg.sub(one, two), one, two), strings).first == "select(1 - 2, 1, 2)");
+    TreeAlgebra other;
+    auto copy = other.import(alg, {taken})[0];
+    assert(copy->getType() == Tree::NodeType::Select && (*copy)(doubles) == 2.0);
+    assert(other.alphaEquivalent(copy, other.select(other.num(1.0), other.num(2.0), copy->getElse())));
+
+    std::cout << "Lazy branches test passed!" << std::endl;
+}
+
+void test_interval_select() {
+    std::cout << "Testing interval selects..." << std::endl;
+
+    TreeAlgebra alg;
+    IntervalAlgebra intervals;
+    Interval a(1.0, 2.0);
+    Interval b(-4.0, -3.0);
+    assert(intervals.select(Interval(0.5, 3.0), a, b) == a);
+    assert(intervals.select(Interval(-2.0, 0.0), a, b) == b);
+    assert(intervals.select(Interval(-1.0, 1.0), a, b) == Interval(-4.0, 2.0));
+    assert(intervals.select(Interval::empty(), a, b).isEmpty());
+
+    // |x| for x in [0.25, 2] as a select keeps [0.25, 2]; the arithmetic
+    // encoding s·x + (1 - s)·(-x), with the ramp s = max(0, min(1, x)),
+    // loses it: s and x are bounded independently
+    RangeAnalysis analysis;
+    auto x = alg.var();
+    analysis.setInputRange(x, Interval(0.25, 2.0));
+    auto piecewise = alg.select(x, x, alg.sub(alg.num(0.0), x));
+    auto s = alg.max(alg.num(0.0), alg.min(alg.num(1.0), x));
+    auto encoded = alg.add(alg.mul(s, x), alg.mul(alg.sub(alg.num(1.0), s), alg.sub(alg.num(0.0), x)));
+    analysis.analyze({piecewise, encoded});
+    std::cout << "select " << analysis.range(piecewise) << ", arithmetic " << analysis.range(encoded) << std::endl;
+    assert(analysis.range(piecewise) == Interval(0.25, 2.0));
+    assert(analysis.range(encoded).width() > 1.0);
+
+    // A straddling condition joins both branches
+    analysis.setInputRange(x, Interval(-1.0, 2.0));
+    analysis.analyze({piecewise});
+    assert(analysis.range(piecewise) == Interval(-2.0, 2.0));
+
+    std::cout << "Interval select test passed!" << std::endl;
+}
+
+void test_recursive_select() {
+    std::cout << "Testing selects in recursive definitions..." << std::endl;
+
+    TreeAlgebra alg;
+    DoubleAlgebra doubles;
+    auto half = alg.num(0.5);
+
+    // Condition depending on the hypotheses: each round evaluates the
+    // branch it picks. x = x > 3 ? x/2 : x/2 + 1 converges to 2.
+    auto x = alg.var();
+    alg.define(x, alg.select(alg.sub(x, alg.num(3.0)), alg.mul(half, x), alg.add(alg.mul(half, x), alg.num(1.0))));
+    assert(std::abs(alg.eval(x, doubles) - 2.0) < 1e-9);
+    assert(alg.fixpointStats().sccs == 1 && alg.fixpointStats().affineSCCs == 0);
+
+    // Condition independent of the SCC: the select is its taken branch,
+    // the other one is never evaluated (it would throw), and the system
+    // stays affine. y = z/2 + 1, z = y/2: y = 4/3, z = 2/3.
+    auto undefined = alg.var();
+    auto y = alg.var();
+    auto z = alg.var();
+    alg.define(y, alg.select(alg.num(1.0), alg.add(alg.mul(half, z), alg.num(1.0)), undefined));
+    alg.define(z, alg.select(alg.num(-1.0), undefined, alg.mul(half, y)));
+    assert(std::abs(alg.eval(y, doubles) - 4.0 / 3.0) < 1e-9);
+    assert(alg.fixpointStats().affineSCCs == 1);
+    assert(std::abs(alg.eval(z, doubles) - 2.0 / 3.0) < 1e-9);
+    assert(std::abs(alg.query(y, doubles) - 4.0 / 3.0) < 1e-9);
+
+    // Same systems through the compact graph: the sweep skips the nodes
+    // only the untaken operands reach (the undefined variable)
+    CompactGraph graph({x, y});
+    std::vector<double> values;
+    graph.evaluate(doubles, values);
+    assert(graph.stats().guardedNodes > 0 && graph.node(graph.position(undefined)).isGuarded());
+    assert(!graph.node(graph.position(y)).isGuarded());
+    assert(std::abs(values[graph.position(x)] - 2.0) < 1e-9);
+    assert(std::abs(values[graph.position(y)] - 4.0 / 3.0) < 1e-9);
+    assert(std::abs(values[graph.position(z)] - 2.0 / 3.0) < 1e-9);
+    auto w = alg.var();
+    alg.define(w, alg.select(alg.sub(alg.num(3.0), w), alg.add(alg.mul(half, w), alg.num(1.0)), alg.mul(half, w)));
+    CompactGraph recursive({x, w});
+    recursive.evaluate(doubles, values);
+    assert(std::abs(values[recursive.position(x)] - 2.0) < 1e-9);
+    assert(std::abs(values[recursive.position(w)] - alg.eval(w, doubles)) < 1e-9);
+
+    // Exact algebras: each round evaluates only the branch its condition
+    // takes. y = y + 1 > 0 ? y : 10 / y stays at 0 and never divides by it.
+    IntegerAlgebra integers;
+    auto v = alg.var();
+    alg.define(v, alg.select(alg.add(v, alg.integer(1)), v, alg.div(alg.integer(10), v)));
+    assert(alg.eval(v, integers) == Integer(0));
+    assert(alg.query(v, integers) == Integer(0));
+    auto five = alg.integer(5);
+    auto guarded = alg.select(alg.add(five, alg.integer(1)), alg.integer(2), alg.div(alg.integer(10), alg.integer(0)));
+    assert(alg.eval(guarded, integers) == Integer(2));
+    std::vector<Integer> exact;
+    CompactGraph both({v, guarded});
+    both.evaluate(integers, exact);
+    assert(exact[both.position(v)] == Integer(0) && exact[both.position(guarded)] == Integer(2));
+
+    // A recursive component only reached through a select is solved when
+    // the select takes it, never when it does not
+    auto p = alg.var();
+    alg.define(p, alg.select(alg.sub(alg.integer(4), p), alg.add(p, alg.integer(1)), p));   // Counts up to 4
+    auto q = alg.var();
+    alg.define(q, alg.add(q, alg.div(alg.integer(1), alg.integer(0))));   // Throws in its first round
+    auto taken = alg.select(alg.integer(1), p, q);
+    CompactGraph lazy({taken, alg.select(alg.integer(0), q, alg.integer(7))});
+    assert(lazy.stats().recursiveComponents == 2);
+    lazy.evaluate(integers, exact);
+    assert(exact[lazy.roots()[0]] == Integer(4) && exact[lazy.roots()[1]] == Integer(7));
+    assert(exact[lazy.roots()[0]] == alg.eval(taken, integers));
+    assert(throws([&]() { CompactGraph({alg.select(alg.integer(-1), p, q)}).evaluate(integers, exact); }));
+
+    // A taken branch may reach variables of the SCC that the first pass
+    // did not: from u = 0 the else branch is taken, later rounds reach t.
+    // u = u > 0 ? t : 1, t = 3 - u > 0 ? u + 1 : u, both converge to 3.
+    auto u = alg.var();
+    auto t = alg.var();
+    alg.define(u, alg.select(u, t, alg.integer(1)));
+    alg.define(t, alg.select(alg.sub(alg.integer(3), u), alg.add(u, alg.integer(1)), u));
+    assert(alg.eval(u, integers) == Integer(3));
+    assert(alg.eval(t, integers) == Integer(3));
+    assert(std::abs(alg.eval(u, doubles) - 3.0) < 1e-9);
+
+    // Or variables of an SCC still being discovered below it: b forms an
+    // SCC of its own until its then branch reaches a, which then solves
+    // both. a = b, b = b > 0 ? a : 1, both converge to 1.
+    auto a = alg.var();
+    auto b = alg.var();
+    alg.define(a, b);
+    alg.define(b, alg.select(b, a, alg.integer(1)));
+    assert(alg.eval(a, integers) == Integer(1));
+    assert(alg.eval(b, integers) == Integer(1));
+
+    // Intervals: x starts from [-1000, 1000], which straddles 3
+    IntervalAlgebra intervals;
+    Interval range = alg.eval(x, intervals);
+    assert(range.contains(2.0));
+
+    std::cout << "Recursive select test passed!" << std::endl;
+}
+
+void test_generated_piecewise() {
+    std::cout << "Testing generated piecewise workloads..." << std::endl;
+
+    TreeAlgebra alg;
+    DoubleAlgebra doubles;
+    WorkloadParams params;
+    params.nodeCount = 2000;
+    params.rootCount = 4;
+    params.selectWeight = 2.0;
+    params.sccCount = 0;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    WorkloadStats stats = WorkloadGenerator::measure(w.roots);
+    std::cout << stats.nodes << " nodes" << std::endl;
+
+    // Default parameters draw the same workloads as before
+    TreeAlgebra plain1;
+    TreeAlgebra plain2;
+    WorkloadParams defaults;
+    defaults.selectWeight = 0.0;
+    Workload a = WorkloadGenerator(defaults).generate(plain1);
+    Workload b = WorkloadGenerator(WorkloadParams()).generate(plain2);
+    assert(StructuralHasher().hash(plain1, a.roots[0]) == StructuralHasher().hash(plain2, b.roots[0]));
+
+    std::vector<double> lazy = alg.eval(w.roots, doubles);
+    CompactGraph graph(w.roots);
+    std::vector<double> values;
+    graph.evaluate(doubles, values);
+    size_t selects = 0;
+    for (size_t i = 0; i < graph.size(); ++i) {
+        selects += graph.node(i).getType() == Tree::NodeType::Select;
+    }
+    assert(selects > 100 && graph.stats().guardedNodes > 0);
+    for (size_t r = 0; r < w.roots.size(); ++r) {
+        assert(lazy[r] == values[graph.roots()[r]]);
+    }
+
+    // By levels on threads: the selects that take a guarded node compute
+    // it under a lock
+    CompactGraph leveled(w.roots, CompactLayout::Levels);
+    ThreadPool pool(4);
+    std::vector<double> parallel;
+    leveled.evaluate(doubles, parallel, pool, 16);
+    for (size_t r = 0; r < w.roots.size(); ++r) {
+        assert(lazy[r] == parallel[leveled.roots()[r]]);
+    }
+
+    // Stored and mapped back
+    const std::filesystem::path dir = std::filesystem::temp_directory_path()
+        / ("algebra-select-test-" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    const std::string path = (dir / "piecewise.store").string();
+    NodeStore::write(path, graph);
+    NodeStore store = NodeStore::open(path);
+    store.verify();
+    std::vector<double> mapped = store.evalRoots(doubles);
+    assert(mapped.size() == w.roots.size());
+    for (size_t r = 0; r < w.roots.size(); ++r) {
+        assert(mapped[r] == values[graph.roots()[r]]);
+    }
+    std::filesystem::remove_all(dir);
+
+    // Cost: a select pays its dearer branch
+    CostAlgebra costs;
+    Cost cheap = alg.eval(alg.num(1.0), costs);
+    Cost dear = alg.eval(alg.exp(alg.num(1.0)), costs);
+    Cost choice = alg.eval(alg.select(alg.num(1.0), alg.num(1.0), alg.exp(alg.num(1.0))), costs);
+    assert(choice.work == cheap.work + dear.work + costs.latencies().binaryLatency(Algebra<Cost>::BinaryOp::Add));
+    CostModel model;
+    assert(model.estimate(w.roots).operations >= selects);
+
+    std::cout << "Generated piecewise test passed!" << std::endl;
+}
+
+void test_signal_select() {
+    std::cout << "Testing selects in signal programs..." << std::endl;
+
+    TreeAlgebra alg;
+    SignalProgram program(alg);
+    auto in = program.input();
+    // Half-wave rectifier, and a hysteresis-free comparator in a feedback loop
+    auto rectified = alg.select(in, in, alg.num(0.0));
+    auto y = alg.var();
+    alg.define(y, alg.select(alg.sub(in, y), alg.add(y, alg.num(0.25)), alg.sub(y, alg.num(0.25))));
+    program.output(rectified);
+    program.output(y);
+    SignalEngine<double> engine(program, 64);
+    const size_t n = 200;
+    std::vector<double> input(n), out0(n), out1(n);
+    for (size_t i = 0; i < n; ++i) {
+        input[i] = std::sin(0.05 * static_cast<double>(i));
+    }
+    const double* inputs[] = {input.data()};
+    double* outputs[] = {out0.data(), out1.data()};
+    engine.process(inputs, outputs, n);
+    double state = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        assert(out0[i] == std::max(input[i], 0.0));
+        state = input[i] - state > 0.0 ? state + 0.25 : state - 0.25;
+        assert(out1[i] == state);
+    }
+
+    RangeAnalysis analysis;
+    analysis.analyze(program, {Interval(-1.0, 1.0)});
+    std::cout << "rectified in " << analysis.range(rectified) << std::endl;
+    assert(analysis.range(rectified) == Interval(-1.0, 1.0));   // The condition straddles 0
+    for (size_t i = 0; i < n; ++i) {
+        assert(analysis.range(y).contains(out1[i]));
+    }
+
+    std::cout << "Signal select test passed!" << std::endl;
+}
+
+int main() {
+    test_lazy_branches();
+    test_interval_select();
+    test_recursive_select();
+    test_generated_piecewise();
+    test_signal_select();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
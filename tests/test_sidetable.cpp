@@ -0,0 +1,230 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/SideTable.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <algorithm>
+#include <cmath>
+#include <new>
+#include <set>
+
+void test_node_ids() {
+    std::cout << "Testing node ids..." << std::endl;
+
+    TreeAlgebra alg;
+    auto x = alg.num(1.0);
+    auto y = alg.num(2.0);
+    auto sum = alg.add(x, y);
+    assert(alg.nodeCount() == 3);
+    assert(x->getId() == 0 && y->getId() == 1 && sum->getId() == 2);
+
+    // Hash-consed nodes keep their id, rejected candidates do not use one
+    assert(alg.add(alg.num(1.0), alg.num(2.0))->getId() == sum->getId());
+    assert(alg.nodeCount() == 3);
+
+    WorkloadParams params;
+    params.nodeCount = 500;
+    params.sccCount = 2;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    std::set<size_t> ids;
+    std::vector<Tree*> pending;
+    for (const auto& root : w.roots) pending.push_back(root.get());
+    std::set<Tree*> seen;
+    while (!pending.empty()) {
+        Tree* t = pending.back();
+        pending.pop_back();
+        if (!seen.insert(t).second) continue;
+        assert(t->getId() < alg.nodeCount());
+        ids.insert(t->getId());
+        if (t->getType() == Tree::NodeType::Unary) pending.push_back(t->getOperand().get());
+        if (t->getType() == Tree::NodeType::Binary) {
+            pending.push_back(t->getLeft().get());
+            pending.push_back(t->getRight().get());
+        }
+        if (t->getType() == Tree::NodeType::Var && t->getDefinition()) pending.push_back(t->getDefinition().get());
+    }
+    assert(ids.size() == seen.size());   // Distinct nodes, distinct ids
+
+    std::cout << "Node ids test passed!" << std::endl;
+}
+
+void test_side_table() {
+    std::cout << "Testing SideTable..." << std::endl;
+
+    SideTable<double> table;
+    assert(table.find(3) == nullptr && table.size() == 0);
+    table.set(3, 1.5);
+    table.set(1000, 2.5);
+    assert(*table.find(3) == 1.5 && *table.find(1000) == 2.5);
+    assert(table.find(4) == nullptr);
+    assert(table.size() == 2 && table.capacity() > 1000);
+    table.insert(3, 9.0);        // Already set: kept
+    table.set(1000, 3.5);        // Overwritten
+    assert(*table.find(3) == 1.5 && *table.find(1000) == 3.5 && table.size() == 2);
+
+    // clear() invalidates in O(1), the arrays stay
+    size_t bytes = table.bytes();
+    table.clear();
+    assert(table.find(3) == nullptr && table.size() == 0);
+    assert(table.bytes() == bytes);
+    table.insert(3, 4.0);
+    assert(*table.find(3) == 4.0);
+    std::cout << "capacity " << table.capacity() << ", " << table.bytes() << " bytes" << std::endl;
+    assert(table.bytes() >= table.capacity() * (sizeof(double) + sizeof(uint32_t)));
+
+    table.release();
+    assert(table.capacity() == 0 && table.find(3) == nullptr);
+
+    std::cout << "SideTable test passed!" << std::endl;
+}
+
+void test_queries() {
+    std::cout << "Testing query()..." << std::endl;
+
+    TreeAlgebra alg;
+    DoubleAlgebra doubleAlg;
+    IntervalAlgebra intervalAlg;
+
+    WorkloadParams params;
+    params.nodeCount = 2000;
+    params.rootCount = 8;
+    params.sccCount = 4;
+    params.sccSize = 5;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+
+    // Same values as eval, whatever the order of the queries
+    for (size_t i = w.roots.size(); i-- > 0;) {
+        double expected = alg.eval(w.roots[i], doubleAlg);
+        double value = alg.query(w.roots[i], doubleAlg);
+        assert(std::isfinite(expected));
+        assert(value == expected || std::abs(value - expected) <= 1e-9 * std::abs(expected));
+    }
+    const SideTable<double>& table = alg.sideTable(doubleAlg);
+    size_t known = table.size();
+    std::cout << known << " values kept after " << w.roots.size() << " queries" << std::endl;
+    assert(known > w.roots.size());
+
+    // Subterms of a queried root and repeated queries are single loads
+    auto sub = w.roots[0]->getType() == Tree::NodeType::Binary ? w.roots[0]->getLeft() : w.roots[0];
+    assert(table.find(sub->getId()) != nullptr);
+    assert(alg.query(sub, doubleAlg) == *table.find(sub->getId()));
+    assert(alg.query(w.roots[3], doubleAlg) == alg.query(w.roots[3], doubleAlg));
+    assert(table.size() == known);
+
+    // One table per algebra
+    Interval range = alg.query(w.roots[0], intervalAlg);
+    assert(range == alg.eval(w.roots[0], intervalAlg));
+    auto usage = alg.sideTableUsage();
+    assert(usage.size() == 2);
+    for (const auto& u : usage) {
+        std::cout << u.algebra << ": " << u.entries << " entries, " << u.bytes << " bytes" << std::endl;
+        assert(u.entries > 0 && u.bytes > 0);
+    }
+
+    // define() invalidates the values that could depend on it
+    auto v = alg.var();
+    auto expr = alg.add(v, alg.num(1.0));
+    alg.define(v, alg.num(2.0));
+    assert(alg.query(expr, doubleAlg) == 3.0);
+    alg.define(v, alg.num(5.0));
+    for (const auto& u : alg.sideTableUsage()) {
+        assert(u.entries == 0);
+    }
+    assert(alg.query(expr, doubleAlg) == 6.0);
+
+    // So does Tree::setDefinition()
+    v->setDefinition(alg.num(1.0));
+    assert(alg.query(expr, doubleAlg) == 2.0);
+    v->setDefinition(alg.num(2.0));
+    assert(alg.query(expr, doubleAlg) == alg.eval(expr, doubleAlg));
+    assert(alg.query(expr, doubleAlg) == 3.0);
+
+    // Definitions in another algebra do not: epochs are per algebra
+    {
+        const uint64_t epoch = alg.definitionEpoch();
+        TreeAlgebra other;
+        auto u = other.var();
+        other.define(u, other.num(1.0));
+        u->setDefinition(other.num(2.0));
+        assert(other.definitionEpoch() == 2);
+        assert(alg.definitionEpoch() == epoch);
+        assert(alg.sideTable(doubleAlg).find(expr->getId()) != nullptr);
+    }
+
+    // An algebra built at the address of a destroyed one, of the same type
+    // or not, gets its own table
+    {
+        TreeAlgebra local;
+        auto x = local.var();
+        local.define(x, local.num(-2.0));
+        auto root = local.abs(x);
+        alignas(DoubleAlgebra) alignas(IntervalAlgebra)
+            unsigned char storage[std::max(sizeof(DoubleAlgebra), sizeof(IntervalAlgebra))];
+        auto* doubles = new (storage) DoubleAlgebra();
+        assert(local.query(root, *doubles) == 2.0);
+        const uint64_t first = doubles->instance();
+        doubles->~DoubleAlgebra();
+        doubles = new (storage) DoubleAlgebra();
+        assert(doubles->instance() != first);
+        assert(local.sideTable(*doubles).size() == 0);
+        assert(local.query(root, *doubles) == 2.0);
+        doubles->~DoubleAlgebra();
+        auto* intervals = new (storage) IntervalAlgebra();
+        assert(local.query(root, *intervals) == Interval(2.0, 2.0));
+        assert(local.sideTableUsage().size() == 3);
+        local.releaseSideTable(*intervals);
+        assert(local.sideTableUsage().size() == 2);
+        intervals->~IntervalAlgebra();
+        local.releaseSideTables();
+
+        // Copies are other algebras
+        DoubleAlgebra copy(doubleAlg);
+        assert(copy.instance() != doubleAlg.instance());
+    }
+
+    // Ids are per algebra: a node of another algebra must not read ours
+    {
+        TreeAlgebra other;
+        auto foreign = other.num(42.0);
+        assert(foreign->getId() < alg.nodeCount());   // Names a node of alg too
+        bool threw = false;
+        try {
+            alg.query(foreign, doubleAlg);
+        } catch (const std::runtime_error& e) {
+            std::cout << "Expected error: " << e.what() << std::endl;
+            threw = true;
+        }
+        assert(threw);
+        threw = false;
+        try {
+            alg.eval(alg.add(foreign, alg.num(1.0)), doubleAlg);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+        assert(other.query(foreign, doubleAlg) == 42.0);
+    }
+
+    alg.releaseSideTable(intervalAlg);
+    assert(alg.sideTableUsage().size() == 1);
+    alg.releaseSideTables();
+    assert(alg.sideTableUsage().empty());
+
+    std::cout << "Query test passed!" << std::endl;
+}
+
+int main() {
+    test_node_ids();
+    test_side_table();
+    test_queries();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
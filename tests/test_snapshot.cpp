@@ -0,0 +1,207 @@
+#include "algebra/Snapshot.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+void test_definition_table() {
+    std::cout << "Testing copy-on-write definition tables..." << std::endl;
+
+    TreeAlgebra alg;
+    auto one = alg.num(1.0);
+    auto two = alg.num(2.0);
+
+    DefinitionTable table;
+    table.set(3, one);
+    table.set(5000, two);
+    assert(table.size() == 2 && table.chunks() == 5);
+    assert(table.get(3) == one && table.get(5000) == two);
+    assert(!table.find(4) && !table.find(1 << 20));
+
+    assert(table.ownedChunks() == 2);
+    DefinitionTable copy = table;
+    assert(table.ownedChunks() == 0 && copy.ownedChunks() == 0);
+    table.set(3, two);   // Copies chunk 0, chunk 4 stays shared
+    assert(table.get(3) == two && copy.get(3) == one);
+    assert(table.ownedChunks() == 1 && copy.get(5000) == two);
+    table.set(4, one);   // Written in place
+    assert(table.ownedChunks() == 1 && !copy.find(4));
+    copy.set(5000, one);   // The copy does not write into the original either
+    assert(table.get(5000) == two && copy.get(5000) == one);
+    table.set(5000, nullptr);
+    assert(table.size() == 2 && copy.size() == 2 && copy.get(5000) == one);
+
+    std::cout << "Definition table test passed!" << std::endl;
+}
+
+void test_isolation() {
+    std::cout << "Testing snapshot isolation..." << std::endl;
+
+    TreeAlgebra alg;
+    DoubleAlgebra doubles;
+    // x = 0.5·x + 1
+    auto x = alg.var();
+    alg.define(x, alg.add(alg.mul(alg.num(0.5), x), alg.num(1.0)));
+    auto root = alg.add(x, alg.num(1.0));
+
+    SnapshotPublisher publisher;
+    SnapshotReader early(publisher);
+    assert(!early.snapshot());
+    bool threw = false;
+    try {
+        early.eval(root, doubles);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    auto v1 = publisher.publish(alg, {root});
+    assert(v1->version() == 1 && publisher.version() == 1);
+    assert(v1->definitions().size() == 1 && v1->definition(x));
+    bool refreshed = early.refresh();
+    bool again = early.refresh();
+    assert(refreshed && !again);
+    SnapshotReader reader(publisher);
+    assert(std::abs(reader.eval(root, doubles) - 3.0) < 1e-9);
+    assert(reader.fixpointStats().sccs == 1);
+
+    // The writer redefines x (x = 0.5·x + 2) and adds y: v1 does not see it
+    alg.define(x, alg.add(alg.mul(alg.num(0.5), x), alg.num(2.0)));
+    auto y = alg.var();
+    alg.define(y, alg.mul(alg.num(2.0), x));
+    assert(std::abs(reader.eval(root, doubles) - 3.0) < 1e-9);
+    assert(std::abs(alg.eval(root, doubles) - 5.0) < 1e-9);
+    threw = false;
+    try {
+        reader.eval(y, doubles);   // Not a node of v1
+    } catch (const std::runtime_error& e) {
+        std::cout << "Expected error: " << e.what() << std::endl;
+        threw = true;
+    }
+    assert(threw);
+
+    auto v2 = publisher.publish(alg, {root, y});
+    refreshed = reader.refresh();
+    assert(refreshed && reader.snapshot() == v2);
+    auto values = reader.evalRoots(doubles);
+    assert(std::abs(values[0] - 5.0) < 1e-9 && std::abs(values[1] - 8.0) < 1e-9);
+    Interval range = reader.eval(y, IntervalAlgebra());
+    assert(range.inf <= 8.0 && range.sup >= 8.0);
+
+    // A reader pinned to v1 keeps it alive and unchanged
+    SnapshotReader pinned(v1);
+    refreshed = pinned.refresh();
+    assert(!refreshed);
+    assert(std::abs(pinned.eval(root, doubles) - 3.0) < 1e-9);
+
+    // A variable defined after the snapshot has no definition in it
+    auto z = alg.var();
+    auto v3 = publisher.publish(alg, {z});
+    alg.define(z, alg.num(4.0));
+    SnapshotReader late(v3);
+    threw = false;
+    try {
+        late.eval(z, doubles);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Isolation test passed!" << std::endl;
+}
+
+void test_concurrent_readers() {
+    std::cout << "Testing concurrent readers..." << std::endl;
+
+    // The writer adds one output per step i, with v_i = 0.5·v_{i-1} + 1
+    // (v_0 = 1) and s_i = 0.5·s_i + i, so root_i = v_i + s_i = 2 - 2^-i + 2i.
+    // Every step also redefines r, a variable of all versions: r = v_i.
+    const size_t steps = 400;
+    const size_t readers = 4;
+    TreeAlgebra alg;
+    SnapshotPublisher publisher;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> evaluations{0};
+    std::atomic<size_t> versions{0};
+    std::atomic<bool> failed{false};
+
+    auto expected = [](size_t i) { return 2.0 - std::ldexp(1.0, -static_cast<int>(i)) + 2.0 * i; };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < readers; ++t) {
+        threads.emplace_back([&]() {
+            DoubleAlgebra doubles;
+            SnapshotReader reader(publisher);
+            uint64_t last = 0;
+            for (;;) {
+                // A last pass after the writer is done sees its last version
+                const bool finished = done.load();
+                reader.refresh();
+                const auto& snapshot = reader.snapshot();
+                if (!snapshot) {
+                    if (finished) break;
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (snapshot->version() != last) {
+                    last = snapshot->version();
+                    versions++;
+                }
+                auto values = reader.evalRoots(doubles);
+                // roots: r, then root_0 .. root_n
+                const size_t n = values.size() - 1;
+                if (std::abs(values[0] - expected(n - 1) + 2.0 * (n - 1)) > 1e-9) failed = true;
+                for (size_t i = 1; i < values.size(); ++i) {
+                    if (std::abs(values[i] - expected(i - 1)) > 1e-9) failed = true;
+                }
+                evaluations++;
+                if (finished) break;
+            }
+        });
+    }
+
+    auto r = alg.var();
+    std::vector<std::shared_ptr<Tree>> roots{r};
+    std::shared_ptr<Tree> previous;
+    for (size_t i = 0; i < steps; ++i) {
+        auto v = alg.var();
+        alg.define(v, previous ? alg.add(alg.mul(alg.num(0.5), previous), alg.num(1.0)) : alg.num(1.0));
+        auto s = alg.var();
+        alg.define(s, alg.add(alg.mul(alg.num(0.5), s), alg.num(static_cast<double>(i))));
+        roots.push_back(alg.add(v, s));
+        alg.define(r, v);
+        previous = v;
+        if (i % 4 == 3) {
+            publisher.publish(alg, roots);
+        }
+    }
+    done = true;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::cout << evaluations.load() << " evaluations of " << versions.load() << " snapshot loads by "
+              << readers << " readers" << std::endl;
+    assert(!failed.load());
+    assert(evaluations.load() >= readers);
+
+    // The readers ended on the last version
+    SnapshotReader reader(publisher);
+    assert(reader.snapshot()->version() == steps / 4);
+    assert(reader.evalRoots(DoubleAlgebra()).size() == steps + 1);
+
+    std::cout << "Concurrent reader test passed!" << std::endl;
+}
+
+int main() {
+    test_definition_table();
+    test_isolation();
+    test_concurrent_readers();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,204 @@
+#include "algebra/NodeStore.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static std::filesystem::path directory() {
+    return std::filesystem::temp_directory_path() / ("algebra-store-test-" + std::to_string(getpid()));
+}
+
+static Workload model(TreeAlgebra& alg) {
+    WorkloadParams params;
+    params.nodeCount = 5000;
+    params.rootCount = 16;
+    params.sccCount = 8;
+    params.sccSize = 4;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    w.roots.push_back(alg.mul(alg.integer(3), alg.abs(alg.num(-2.5))));   // Both constant pools
+    return w;
+}
+
+template<typename T>
+static bool throws(const T& fn) {
+    try {
+        fn();
+    } catch (const std::runtime_error& e) {
+        std::cout << "Expected error: " << e.what() << std::endl;
+        return true;
+    }
+    return false;
+}
+
+void test_round_trip() {
+    std::cout << "Testing store round trip..." << std::endl;
+
+    const auto dir = directory();
+    std::filesystem::create_directories(dir);
+    const std::string path = (dir / "model.store").string();
+
+    TreeAlgebra alg;
+    Workload w = model(alg);
+    CompactGraph graph(w.roots);
+    NodeStore::write(path, graph);
+
+    NodeStore store = NodeStore::open(path);
+    store.verify();
+    assert(store.size() == graph.size() && store.rootCount() == w.roots.size() && store.hasRecursion());
+    std::cout << store.size() << " nodes, " << store.bytes() << " bytes" << std::endl;
+
+    // Same values as the compact graph, for every node and algebra
+    std::vector<double> expected;
+    std::vector<double> values;
+    const size_t graphRounds = graph.evaluate(DoubleAlgebra(), expected);
+    const size_t rounds = store.evaluate(DoubleAlgebra(), values);
+    assert(values == expected && rounds == graphRounds && rounds > 0);
+    auto intervals = store.evalRoots(IntervalAlgebra());
+    auto compactIntervals = graph.evaluate(IntervalAlgebra());
+    for (size_t r = 0; r < w.roots.size(); ++r) {
+        assert(store.root(r) == graph.roots()[r]);
+        assert(intervals[r] == compactIntervals[graph.roots()[r]]);
+    }
+    assert(store.evalRoots(DoubleAlgebra()).back() == 7.5);
+
+    // The store holds no pointer: it outlives the algebra
+    NodeStore moved = std::move(store);
+    assert(moved.evalRoots(DoubleAlgebra()).back() == 7.5);
+
+    std::filesystem::remove_all(dir);
+    std::cout << "Round trip test passed!" << std::endl;
+}
+
+void test_processes() {
+    std::cout << "Testing stores shared by processes..." << std::endl;
+
+    const auto dir = directory();
+    std::filesystem::create_directories(dir);
+    const std::string path = (dir / "shared.store").string();
+    std::vector<double> expected;
+    {
+        TreeAlgebra alg;
+        Workload w = model(alg);
+        CompactGraph graph(w.roots);
+        NodeStore::write(path, graph);
+        NodeStore::open(path).evalRoots(DoubleAlgebra()).swap(expected);
+    }
+
+    // Each worker process attaches to the file and evaluates it
+    const int workers = 3;
+    std::vector<pid_t> children;
+    for (int k = 0; k < workers; ++k) {
+        pid_t pid = fork();
+        assert(pid >= 0);
+        if (pid == 0) {
+            NodeStore store = NodeStore::open(path);
+            _exit(store.evalRoots(DoubleAlgebra()) == expected ? 0 : 1);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+
+    // Replacing the store leaves the open mappings to the old one
+    NodeStore old = NodeStore::open(path);
+    {
+        TreeAlgebra alg;
+        auto x = alg.var();
+        alg.define(x, alg.add(alg.mul(alg.num(0.5), x), alg.num(1.0)));
+        NodeStore::write(path, {alg.add(x, alg.integer(1))});
+    }
+    assert(old.evalRoots(DoubleAlgebra()) == expected);
+    auto fresh = NodeStore::open(path).evalRoots(DoubleAlgebra());
+    assert(fresh.size() == 1 && std::abs(fresh[0] - 3.0) < 1e-9);
+
+    std::filesystem::remove_all(dir);
+    std::cout << "Process test passed!" << std::endl;
+}
+
+void test_corruption() {
+    std::cout << "Testing corrupt stores..." << std::endl;
+
+    const auto dir = directory();
+    std::filesystem::create_directories(dir);
+    const std::string path = (dir / "corrupt.store").string();
+    TreeAlgebra alg;
+    Workload w = model(alg);
+    NodeStore::write(path, w.roots);
+    const auto size = std::filesystem::file_size(path);
+
+    assert(throws([&]() { NodeStore::open((dir / "missing.store").string()); }));
+
+    // Truncated
+    std::filesystem::resize_file(path, size - 8);
+    assert(throws([&]() { NodeStore::open(path); }));
+    NodeStore::write(path, w.roots);
+
+    // Not a store
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.write("NOTASTOR", 8);
+    }
+    assert(throws([&]() { NodeStore::open(path); }));
+    NodeStore::write(path, w.roots);
+
+    // A binary node pointing past itself: open() accepts it, verify() does not
+    size_t binary = 0;
+    {
+        NodeStore store = NodeStore::open(path);
+        while (store.node(binary).getType() != Tree::NodeType::Binary) binary++;
+    }
+    {
+        // The header starts with the magic, two 32-bit fields, then the
+        // count and offset of the node section
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t nodesOffset = 0;
+        file.seekg(24);
+        file.read(reinterpret_cast<char*>(&nodesOffset), sizeof(nodesOffset));
+        file.seekp(static_cast<std::streamoff>(nodesOffset + binary * sizeof(CompactNode) + 4));
+        const uint32_t past = 0x7fffffff;
+        file.write(reinterpret_cast<const char*>(&past), sizeof(past));
+    }
+    NodeStore store = NodeStore::open(path);
+    assert(store.node(binary).a == 0x7fffffff);
+    assert(throws([&]() { store.verify(); }));
+
+    // Unknown node flags
+    NodeStore::write(path, w.roots);
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint64_t nodesOffset = 0;
+        file.seekg(24);
+        file.read(reinterpret_cast<char*>(&nodesOffset), sizeof(nodesOffset));
+        file.seekp(static_cast<std::streamoff>(nodesOffset + binary * sizeof(CompactNode) + 2));
+        const uint8_t flags = 0x80;
+        file.write(reinterpret_cast<const char*>(&flags), sizeof(flags));
+    }
+    NodeStore flagged = NodeStore::open(path);
+    assert(throws([&]() { flagged.verify(); }));
+
+    std::filesystem::remove_all(dir);
+    std::cout << "Corruption test passed!" << std::endl;
+}
+
+int main() {
+    test_round_trip();
+    test_processes();
+    test_corruption();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,288 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/Tape.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntegerAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include "algebra/StringAlgebra.hh"
+#include "algebra/Workload.hh"
+#include <algorithm>
+#include <iostream>
+#include <cassert>
+#include <cmath>
+#include <stdexcept>
+
+static size_t countOps(const Tape& tape, TapeOp op) {
+    size_t n = 0;
+    for (const TapeInstruction& in : tape.code()) {
+        n += in.op == op;
+    }
+    return n;
+}
+
+// Operands written before they are read
+static void checkOrder(const Tape& tape) {
+    std::vector<bool> written(tape.slotCount(), false);
+    for (const TapeInstruction& in : tape.code()) {
+        switch (in.op) {
+            case TapeOp::Num: case TapeOp::Integer: break;
+            case TapeOp::Select: case TapeOp::MulAdd: case TapeOp::AddMul: assert(written[in.c]); [[fallthrough]];
+            case TapeOp::Add: case TapeOp::Sub: case TapeOp::Mul: case TapeOp::Div: case TapeOp::Mod:
+            case TapeOp::Min: case TapeOp::Max: case TapeOp::Pow: case TapeOp::AbsDiff: assert(written[in.b]); [[fallthrough]];
+            default: assert(written[in.a]);
+        }
+        written[in.dst] = true;
+    }
+    for (uint32_t slot : tape.outputs()) {
+        assert(written[slot]);
+    }
+}
+
+void test_fusion() {
+    std::cout << "Testing fused instructions..." << std::endl;
+
+    TreeAlgebra alg;
+    auto x = alg.num(1.5);
+    auto y = alg.integer(3);
+    auto z = alg.var();
+    alg.define(z, alg.num(-2.0));
+    auto shared = alg.mul(y, z);                              // Read twice: kept
+    auto expr = alg.add(alg.add(alg.mul(x, z), y),            // MulAdd
+                        alg.add(shared, alg.abs(alg.sub(shared, x))));
+    auto other = alg.add(alg.num(0.25), alg.mul(x, x));      // AddMul
+    Tape tape = compileTape({expr, other});
+    std::cout << tape.stats().nodes << " nodes, " << tape.stats().instructions << " instructions, depth "
+              << tape.stats().depth << std::endl;
+    checkOrder(tape);
+    assert(tape.stats().mulAdds == 2 && tape.stats().absDiffs == 1);
+    assert(countOps(tape, TapeOp::MulAdd) == 1 && countOps(tape, TapeOp::AddMul) == 1);
+    assert(countOps(tape, TapeOp::AbsDiff) == 1);
+    assert(countOps(tape, TapeOp::Mul) == 1 && countOps(tape, TapeOp::Sub) == 0);
+    assert(tape.stats().eliminated == 3);   // Two products and a difference
+    assert(tape.slotCount() < tape.code().size());   // Slots are reused
+
+    // Same values as the trees in every algebra, operand order included
+    std::vector<double> values = tape.evaluate(DoubleAlgebra());
+    assert(values[0] == alg.eval(expr, DoubleAlgebra()) && values[1] == alg.eval(other, DoubleAlgebra()));
+    assert(values[0] == 1.5 * -2.0 + 3.0 + (-6.0 + 7.5));
+    auto text = tape.evaluate(StringAlgebra());
+    assert(text[0] == alg.eval(expr, StringAlgebra()) && text[1] == alg.eval(other, StringAlgebra()));
+    std::cout << text[0].first << std::endl;
+    auto ranges = tape.evaluate(IntervalAlgebra());
+    assert(ranges[0] == alg.eval(expr, IntervalAlgebra()));
+
+    // Without the passes: one instruction per operator or constant
+    TapeOptions plain;
+    plain.fuse = false;
+    plain.eliminateDead = false;
+    Tape unfused = compileTape({expr, other}, plain);
+    assert(unfused.stats().mulAdds == 0 && unfused.stats().eliminated == 0);
+    assert(unfused.code().size() == unfused.stats().nodes - 1);   // z is an alias of its definition
+    assert(unfused.evaluate(DoubleAlgebra()) == values);
+
+    // Exact algebras take the integer constants as they are
+    TreeAlgebra exact;
+    auto big = exact.integer(int64_t(1) << 60);
+    auto sum = exact.add(exact.mul(big, exact.integer(4)), exact.integer(1));
+    assert(compileTape({sum}).evaluate(IntegerAlgebra())[0] == exact.eval(sum, IntegerAlgebra()));
+
+    std::cout << "Fusion test passed!" << std::endl;
+}
+
+// Saturating sum
+class SaturatingAlgebra : public DoubleAlgebra {
+public:
+    double add(const double& a, const double& b) const override {
+        return std::min(DoubleAlgebra::add(a, b), 10.0);
+    }
+};
+
+void test_contraction() {
+    std::cout << "Testing contracted multiply-adds..." << std::endl;
+
+    // (1 + 2⁻³⁰)(1 - 2⁻³⁰) - 1 = -2⁻⁶⁰: the product rounds to 1
+    TreeAlgebra alg;
+    auto e = alg.num(std::ldexp(1.0, -30));
+    auto expr = alg.add(alg.mul(alg.add(alg.num(1.0), e), alg.sub(alg.num(1.0), e)), alg.num(-1.0));
+    Tape tape = compileTape({expr});
+    assert(tape.stats().mulAdds == 1);
+    assert(tape.evaluate(DoubleAlgebra())[0] == 0.0);
+    assert(tape.evaluate(DoubleAlgebra())[0] == alg.eval(expr, DoubleAlgebra()));
+    DoubleAlgebra fused(Contraction::FusedMultiplyAdd);
+    assert(fused.contraction() == Contraction::FusedMultiplyAdd);
+    assert(tape.evaluate(fused)[0] == -std::ldexp(1.0, -60));
+    assert(alg.eval(expr, fused) == 0.0);   // Trees have no fused form
+    assert(fused.addMul(-1.0, 1.0 + std::ldexp(1.0, -30), 1.0 - std::ldexp(1.0, -30)) == -std::ldexp(1.0, -60));
+
+    // Float with double arithmetic rounds once, to float
+    MixedAlgebra mixed(Contraction::FusedMultiplyAdd);
+    assert(mixed.mulAdd(3.0f, 1.0f / 3.0f, -1.0f) == static_cast<float>(std::fma(3.0, double(1.0f / 3.0f), -1.0)));
+
+    // Subclasses may replace operations: the tape calls theirs, fused or not
+    SaturatingAlgebra saturating;
+    auto sum = alg.add(alg.mul(alg.num(2.0), alg.num(4.0)), alg.num(5.0));
+    Tape sumTape = compileTape({sum});
+    assert(sumTape.stats().mulAdds == 1);
+    assert(sumTape.evaluate(saturating)[0] == 10.0);
+    assert(sumTape.evaluate(DoubleAlgebra())[0] == 13.0);
+
+    std::cout << "Contraction test passed!" << std::endl;
+}
+
+void test_workload() {
+    std::cout << "Testing tapes of generated workloads..." << std::endl;
+
+    TreeAlgebra alg;
+    WorkloadParams params;
+    params.nodeCount = 5000;
+    params.rootCount = 8;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.unaryMix = {1.0};
+    params.selectWeight = 0.5;
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    CompactGraph graph = compact(w.roots);
+    std::vector<double> reference = graph.evaluate(DoubleAlgebra());
+    std::vector<Interval> ranges = graph.evaluate(IntervalAlgebra());
+    std::vector<float> floats = graph.evaluate(FloatAlgebra());
+
+    for (int passes = 0; passes < 8; ++passes) {
+        TapeOptions options;
+        options.fuse = passes & 1;
+        options.eliminateDead = passes & 2;
+        options.schedule = passes & 4;
+        Tape tape(graph, options);
+        checkOrder(tape);
+        if (passes == 3) {
+            std::cout << graph.size() << " nodes: " << tape.stats().instructions << " instructions, "
+                      << tape.stats().mulAdds << " multiply-adds, " << tape.stats().absDiffs
+                      << " abs-diffs, depth " << tape.stats().depth << std::endl;
+            assert(tape.stats().mulAdds > 100 && tape.stats().absDiffs > 0);
+            assert(tape.stats().eliminated == tape.stats().mulAdds + tape.stats().absDiffs);
+        }
+        std::vector<double> values = tape.evaluate(DoubleAlgebra());
+        std::vector<Interval> tapeRanges = tape.evaluate(IntervalAlgebra());
+        std::vector<float> tapeFloats = tape.evaluate(FloatAlgebra());
+        for (size_t r = 0; r < w.roots.size(); ++r) {
+            assert(values[r] == reference[graph.roots()[r]]);
+            assert(tapeRanges[r] == ranges[graph.roots()[r]]);
+            assert(tapeFloats[r] == floats[graph.roots()[r]]);
+        }
+
+        // Contracted: within a few roundings of the reference
+        std::vector<double> contracted = tape.evaluate(DoubleAlgebra(Contraction::FusedMultiplyAdd));
+        for (size_t r = 0; r < w.roots.size(); ++r) {
+            const double expected = reference[graph.roots()[r]];
+            assert(std::abs(contracted[r] - expected) <= 1e-9 * std::max(1.0, std::abs(expected)));
+        }
+    }
+
+    std::cout << "Workload tape test passed!" << std::endl;
+}
+
+// Values read after their slot was handed to another value would differ
+// from the reference
+void test_allocation() {
+    std::cout << "Testing slot allocation..." << std::endl;
+
+    // A chain: ((1 + 2) + 3) + ..., two values live at a time
+    TreeAlgebra alg;
+    auto sum = alg.num(1.0);
+    for (int i = 2; i <= 100; ++i) {
+        sum = alg.add(sum, alg.num(static_cast<double>(i)));
+    }
+    Tape chain = compileTape({sum});
+    assert(chain.stats().instructions == 199);
+    assert(chain.slotCount() == 2);
+    assert(chain.evaluate(DoubleAlgebra())[0] == 5050.0);
+
+    // An operand read twice is released once; the result may take its slot
+    auto x = alg.num(3.0);
+    auto square = alg.mul(alg.add(x, x), alg.add(x, x));
+    Tape squares = compileTape({square, x});
+    assert(squares.slotCount() == 2);
+    assert(squares.evaluate(DoubleAlgebra()) == std::vector<double>({36.0, 3.0}));
+
+    WorkloadParams params;
+    params.nodeCount = 20000;
+    params.rootCount = 8;
+    params.binaryMix = {4, 2, 3, 0, 0};   // Values stay finite
+    params.selectWeight = 0.25;
+    params.constants = WorkloadParams::Constants::Uniform;
+    params.constantMin = 0.5;
+    params.constantMax = 1.5;
+    params.maxDepth = 12;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    CompactGraph graph = compact(w.roots);
+    std::vector<double> reference = graph.evaluate(DoubleAlgebra());
+    std::vector<Interval> ranges = graph.evaluate(IntervalAlgebra());
+    auto text = graph.evaluate(StringAlgebra());
+    for (int passes = 0; passes < 4; ++passes) {
+        TapeOptions options;
+        options.fuse = passes & 1;
+        options.schedule = passes & 2;
+        Tape tape(graph, options);
+        options.allocate = false;
+        Tape unallocated(graph, options);
+        assert(unallocated.slotCount() == tape.stats().instructions);
+        std::cout << tape.stats().instructions << " instructions" << (options.schedule ? " by level" : "")
+                  << ": " << tape.slotCount() << " slots, width " << tape.stats().width << std::endl;
+        assert(tape.slotCount() * 3 < tape.stats().instructions);
+        checkOrder(tape);
+
+        std::vector<double> values = tape.evaluate(DoubleAlgebra());
+        std::vector<Interval> tapeRanges = tape.evaluate(IntervalAlgebra());
+        auto tapeText = tape.evaluate(StringAlgebra());
+        for (size_t r = 0; r < w.roots.size(); ++r) {
+            assert(values[r] == reference[graph.roots()[r]]);
+            assert(tapeRanges[r] == ranges[graph.roots()[r]]);
+            assert(tapeText[r] == text[graph.roots()[r]]);
+        }
+
+        // Slots are reused across evaluations
+        std::vector<double> slots;
+        tape.evaluate(DoubleAlgebra(), slots);
+        tape.evaluate(DoubleAlgebra(), slots);
+        assert(slots.size() == tape.slotCount() && slots[tape.outputs()[0]] == values[0]);
+    }
+
+    std::cout << "Slot allocation test passed!" << std::endl;
+}
+
+void test_errors() {
+    std::cout << "Testing tape errors..." << std::endl;
+
+    TreeAlgebra alg;
+    auto x = alg.var();
+    alg.define(x, alg.mul(alg.num(0.5), x));
+    bool thrown = false;
+    try {
+        compileTape({alg.add(x, alg.num(1.0))});
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    thrown = false;
+    try {
+        compileTape({alg.add(alg.var(), alg.num(1.0))});
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    std::cout << "Tape errors test passed!" << std::endl;
+}
+
+int main() {
+    test_fusion();
+    test_contraction();
+    test_workload();
+    test_allocation();
+    test_errors();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
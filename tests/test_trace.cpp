@@ -0,0 +1,139 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/SolverTrace.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/IntervalAlgebra.hh"
+#include <iostream>
+#include <cassert>
+#include <sstream>
+#include <string>
+
+static size_t count(const SolverTrace& trace, const std::string& name) {
+    size_t n = 0;
+    for (const auto& e : trace.events()) {
+        if (e.name == name) n++;
+    }
+    return n;
+}
+
+static bool hasArg(const SolverTrace::Event& e, const std::string& member) {
+    return e.args.find(member) != std::string::npos;
+}
+
+void test_solver_events() {
+    std::cout << "Testing solver events..." << std::endl;
+
+    TreeAlgebra alg;
+    FixpointOptions options;
+    options.solveAffine = false;
+    alg.setFixpointOptions(options);
+    // x = 0.5·y + 1, y = 0.5·x + 1 (one SCC found by a back edge), z = 0.9·z + 2
+    auto x = alg.var();
+    auto y = alg.var();
+    alg.define(x, alg.add(alg.mul(alg.num(0.5), y), alg.num(1.0)));
+    alg.define(y, alg.add(alg.mul(alg.num(0.5), x), alg.num(1.0)));
+    auto z = alg.var();
+    alg.define(z, alg.add(alg.mul(alg.num(0.9), z), alg.num(2.0)));
+    auto root = alg.add(x, z);
+
+    SolverTrace trace;
+    alg.setTrace(&trace);
+    assert(alg.trace() == &trace);
+    double value = alg.eval(root, DoubleAlgebra());
+    assert(std::abs(value - 22.0) < 1e-6);
+
+    const FixpointStats& stats = alg.fixpointStats();
+    assert(count(trace, "eval") == 1);
+    assert(count(trace, "var1") == 1 && count(trace, "var2") == 1 && count(trace, "var3") == 1);
+    assert(count(trace, "merge") >= 2);   // y -> x, z -> z
+    assert(count(trace, "iterate") == 2 && count(trace, "spine") == 2 && count(trace, "solveAffine") == 2);
+    assert(count(trace, "promote") == 2);
+    assert(count(trace, "round") == stats.rounds);
+
+    // Rounds of an SCC lie inside its iterate event, with decreasing deltas
+    const std::string sccX = "\"scc\":" + std::to_string(x->getId());
+    const SolverTrace::Event* iterate = nullptr;
+    for (const auto& e : trace.events()) {
+        if (e.name == "iterate" && hasArg(e, sccX)) iterate = &e;
+    }
+    assert(iterate && hasArg(*iterate, "\"size\":2") && hasArg(*iterate, "\"converged\":true"));
+    double firstDelta = -1.0;
+    double lastDelta = -1.0;
+    size_t rounds = 0;
+    for (const auto& e : trace.events()) {
+        if (e.name != "round" || !hasArg(e, sccX)) continue;
+        assert(e.start >= iterate->start && e.start + e.duration <= iterate->start + iterate->duration + 1e-3);
+        const size_t at = e.args.find("\"delta\":");
+        assert(at != std::string::npos);
+        const double delta = std::stod(e.args.substr(at + 8));
+        if (firstDelta < 0.0) firstDelta = delta;
+        lastDelta = delta;
+        rounds++;
+    }
+    assert(hasArg(*iterate, "\"rounds\":" + std::to_string(rounds)));
+    std::cout << rounds << " rounds for x, delta " << firstDelta << " -> " << lastDelta << std::endl;
+    assert(firstDelta > 0.5 && lastDelta < 1e-6);
+
+    // Spans are well nested: the eval event covers everything
+    const SolverTrace::Event& eval = trace.events().back();
+    assert(eval.name == "eval" && hasArg(eval, "\"root\":" + std::to_string(root->getId())));
+    for (const auto& e : trace.events()) {
+        assert(e.start >= eval.start && e.start + e.duration <= eval.start + eval.duration + 1e-3);
+    }
+
+    // Intervals have a delta, the trace can be detached
+    trace.clear();
+    alg.query(root, IntervalAlgebra());
+    assert(count(trace, "query") == 1 && count(trace, "round") > 0);
+    for (const auto& e : trace.events()) {
+        if (e.name == "round") assert(hasArg(e, "\"delta\":") && hasArg(e, "\"changed\":"));
+    }
+    alg.setTrace(nullptr);
+    const size_t before = trace.size();
+    alg.eval(root, DoubleAlgebra());
+    assert(trace.size() == before);
+
+    std::cout << "Solver event test passed!" << std::endl;
+}
+
+void test_json() {
+    std::cout << "Testing the JSON output..." << std::endl;
+
+    SolverTrace trace;
+    {
+        SolverTrace::Span span(&trace, "test", "outer");
+        span.setArgs(SolverTrace::Args().add("name", std::string("a \"quoted\"\nname"))
+                         .add("infinite", 1.0 / 0.0).add("count", uint64_t(3)).add("flag", false).str());
+        trace.instant("mark", "test");
+    }
+    {
+        SolverTrace::Span disabled(nullptr, "test", "never");
+        assert(!disabled);
+    }
+    assert(trace.size() == 2 && trace.events()[0].name == "mark" && trace.events()[1].name == "outer");
+
+    std::ostringstream out;
+    trace.write(out);
+    const std::string json = out.str();
+    std::cout << json;
+    assert(json.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[") == 0);
+    assert(json.find("\"ph\":\"X\"") != std::string::npos && json.find("\"ph\":\"i\"") != std::string::npos);
+    assert(json.find("\"name\":\"a \\\"quoted\\\"\\u000aname\"") != std::string::npos);
+    assert(json.find("\"infinite\":null") != std::string::npos);
+    assert(json.find("\"count\":3,\"flag\":false") != std::string::npos);
+
+    // Distances between iterates
+    assert(*SolverTrace::distance(1.0, 3.5) == 2.5);
+    assert(*SolverTrace::distance(Interval(0.0, 1.0), Interval(-1.0, 4.0)) == 3.0);
+    assert(*SolverTrace::distance(Interval(0.0, 1.0 / 0.0), Interval(0.0, 1.0 / 0.0)) == 0.0);
+    assert(!SolverTrace::distance(std::string("a"), std::string("b")));
+
+    std::cout << "JSON test passed!" << std::endl;
+}
+
+int main() {
+    test_solver_events();
+    test_json();
+
+    std::cout << "\nAll tests passed!" << std::endl;
+    return 0;
+}
@@ -0,0 +1,190 @@
+#include "algebra/TreeAlgebra.hh"
+#include "algebra/DoubleAlgebra.hh"
+#include "algebra/Workload.hh"
+#include <iostream>
+#include <cassert>
+#include <cmath>
+
+static bool sameValue(double a, double b) {
+    return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+void test_random_is_portable() {
+    std::cout << "Testing SplitMix64 reference values..." << std::endl;
+    
+    // Reference outputs of SplitMix64 seeded with 0
+    WorkloadRandom rng(0);
+    assert(rng.next() == 0xe220a8397b1dcdafULL);
+    assert(rng.next() == 0x6e789e6aa1b965f4ULL);
+    
+    std::cout << "SplitMix64 reference test passed!" << std::endl;
+}
+
+void test_deterministic_under_seed() {
+    std::cout << "Testing determinism under a seed..." << std::endl;
+    
+    WorkloadParams params;
+    params.seed = 42;
+    params.nodeCount = 500;
+    params.rootCount = 3;
+    params.sccCount = 2;
+    params.sccSize = 4;
+    params.topology = WorkloadParams::Topology::Chain;
+    
+    // Two independent universes, same parameters
+    TreeAlgebra alg1;
+    TreeAlgebra alg2;
+    Workload w1 = WorkloadGenerator(params).generate(alg1);
+    Workload w2 = WorkloadGenerator(params).generate(alg2);
+    
+    assert(w1.roots.size() == 3);
+    assert(w2.roots.size() == 3);
+    for (size_t i = 0; i < w1.roots.size(); ++i) {
+        assert(alg1.alphaEquivalent(w1.roots[i], w2.roots[i]));
+    }
+    
+    // Another seed gives another workload
+    params.seed = 43;
+    TreeAlgebra alg3;
+    Workload w3 = WorkloadGenerator(params).generate(alg3);
+    bool allEquivalent = true;
+    for (size_t i = 0; i < w1.roots.size(); ++i) {
+        allEquivalent = allEquivalent && alg1.alphaEquivalent(w1.roots[i], w3.roots[i]);
+    }
+    assert(!allEquivalent);
+    
+    std::cout << "Determinism test passed!" << std::endl;
+}
+
+void test_shape_parameters() {
+    std::cout << "Testing shape parameters..." << std::endl;
+    
+    WorkloadParams params;
+    params.nodeCount = 2000;
+    params.maxDepth = 12;
+    
+    params.sharingRatio = 0.0;
+    TreeAlgebra algTree;
+    auto treeLike = WorkloadGenerator::measure(WorkloadGenerator(params).generate(algTree).roots);
+    
+    params.sharingRatio = 0.9;
+    TreeAlgebra algDag;
+    auto dagLike = WorkloadGenerator::measure(WorkloadGenerator(params).generate(algDag).roots);
+    
+    std::cout << "sharing 0.0: " << treeLike.nodes << " nodes, " << treeLike.sharedNodes << " shared" << std::endl;
+    std::cout << "sharing 0.9: " << dagLike.nodes << " nodes, " << dagLike.sharedNodes << " shared" << std::endl;
+    assert(dagLike.sharedNodes > treeLike.sharedNodes);
+    assert(treeLike.operators >= 1000);
+    
+    // maxDepth caps generated nodes; only the final root folding may add a few levels
+    assert(treeLike.maxDepth <= params.maxDepth + 12);
+    
+    // Selects included, with a root per node so that nothing is folded
+    {
+        WorkloadParams piecewise = params;
+        piecewise.selectWeight = 2.0;
+        piecewise.depthProfile = WorkloadParams::DepthProfile::Deep;
+        piecewise.rootCount = piecewise.nodeCount;
+        TreeAlgebra algSelect;
+        auto selects = WorkloadGenerator::measure(WorkloadGenerator(piecewise).generate(algSelect).roots);
+        std::cout << "selects: depth " << selects.maxDepth << " (max " << piecewise.maxDepth << ")" << std::endl;
+        assert(selects.maxDepth <= piecewise.maxDepth);
+    }
+    
+    // Only additions when the mix says so
+    params.unaryMix.fill(0.0);
+    params.binaryMix.fill(0.0);
+    params.binaryMix[static_cast<size_t>(BinaryOp::Add)] = 1.0;
+    params.constants = WorkloadParams::Constants::SmallIntegers;
+    params.constantMin = 1.0;
+    params.constantMax = 3.0;
+    TreeAlgebra algAdd;
+    DoubleAlgebra doubleAlg;
+    Workload sums = WorkloadGenerator(params).generate(algAdd);
+    double total = algAdd.eval(sums.roots[0], doubleAlg);
+    assert(total >= 1.0 && total == std::floor(total));
+    
+    std::cout << "Shape parameters test passed!" << std::endl;
+}
+
+void test_constant_distributions() {
+    std::cout << "Testing constant distributions..." << std::endl;
+    
+    WorkloadParams params;
+    params.nodeCount = 300;
+    params.constants = WorkloadParams::Constants::LowBits;
+    params.constantMin = 1.0;
+    params.constantPool = 32;
+    
+    TreeAlgebra alg;
+    DoubleAlgebra doubleAlg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    auto stats = WorkloadGenerator::measure(w.roots);
+    
+    // All constants are within a few ulps of 1.0 but remain distinct nodes
+    assert(stats.constants > 1);
+    assert(stats.constants <= 32);
+    
+    std::cout << "Constant distributions test passed!" << std::endl;
+}
+
+void test_scc_topologies() {
+    std::cout << "Testing recursive system topologies..." << std::endl;
+    
+    using Topology = WorkloadParams::Topology;
+    for (Topology topology : {Topology::Ring, Topology::Chain, Topology::Clique, Topology::Nested}) {
+        WorkloadParams params;
+        params.nodeCount = 50;
+        params.sccCount = 3;
+        params.sccSize = 5;
+        params.topology = topology;
+        
+        TreeAlgebra alg;
+        Workload w = WorkloadGenerator(params).generate(alg);
+        assert(w.sccs.size() == 3);
+        
+        for (const auto& scc : w.sccs) {
+            assert(scc.size() == 5);
+            for (const auto& v : scc) {
+                assert(v->getType() == Tree::NodeType::Var);
+                assert(v->getDefinition() != nullptr);
+            }
+        }
+        
+        // Every system is reachable from the roots
+        auto stats = WorkloadGenerator::measure(w.roots);
+        assert(stats.variables == 15);
+    }
+    
+    std::cout << "Recursive system topologies test passed!" << std::endl;
+}
+
+void test_eval_matches_direct_evaluation() {
+    std::cout << "Testing eval on a generated tree-shaped workload..." << std::endl;
+    
+    WorkloadParams params;
+    params.nodeCount = 200;
+    params.rootCount = 4;
+    params.sharingRatio = 0.0;
+    
+    TreeAlgebra alg;
+    DoubleAlgebra doubleAlg;
+    Workload w = WorkloadGenerator(params).generate(alg);
+    for (const auto& root : w.roots) {
+        assert(sameValue(alg.eval(root, doubleAlg), (*root)(doubleAlg)));
+    }
+    
+    std::cout << "Eval on generated workload test passed!" << std::endl;
+}
+
+int main() {
+    test_random_is_portable();
+    test_deterministic_under_seed();
+    test_shape_parameters();
+    test_constant_distributions();
+    test_scc_topologies();
+    test_eval_matches_direct_evaluation();
+    
+    std::cout << "\nAll workload tests passed!" << std::endl;
+    return 0;
+}